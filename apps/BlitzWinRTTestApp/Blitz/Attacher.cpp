@@ -1,5 +1,6 @@
 ﻿#include "pch.h"
 #include "Attacher.h"
+#include "BlitzTrace.h"
 #if __has_include("Attacher.g.cpp")
 #include "Attacher.g.cpp"
 #endif
@@ -16,16 +17,17 @@ namespace winrt::Blitz::implementation
 			try
 			{
 				m_panel = panel.as<SwapChainPanel>();
-				::OutputDebugStringW(L"Attacher::Attacher: captured SwapChainPanel\n");
+				m_dispatcher = m_panel.DispatcherQueue();
+				trace::Log(L"Attacher: captured SwapChainPanel");
 			}
 			catch (...)
 			{
-				::OutputDebugStringW(L"Attacher::Attacher: panel is not a SwapChainPanel\n");
+				trace::Log(L"Attacher: panel is not a SwapChainPanel");
 			}
 		}
 		else
 		{
-			::OutputDebugStringW(L"Attacher::Attacher: null panel provided\n");
+			trace::Log(L"Attacher: null panel provided");
 		}
 	}
 
@@ -35,23 +37,45 @@ namespace winrt::Blitz::implementation
 
 		if (swapchainPtr == 0)
 		{
-			::OutputDebugStringW(L"Attacher::AttachSwapChain: null pointer, ignoring\n");
+			trace::Log(L"Attacher::AttachSwapChain: null pointer, ignoring");
 			return;
 		}
 
 		// C# demo used a sentinel test pointer; replicate optional ignore (same value)
 		if (swapchainPtr == 0xFEEDFACECAFEBEEFULL)
 		{
-			::OutputDebugStringW(L"Attacher::AttachSwapChain: test pointer, ignoring\n");
+			trace::Log(L"Attacher::AttachSwapChain: test pointer, ignoring");
 			return;
 		}
 
 		if (!m_panel)
 		{
-			::OutputDebugStringW(L"Attacher::AttachSwapChain: panel not set\n");
+			trace::Log(L"Attacher::AttachSwapChain: panel not set");
 			return;
 		}
 
+		auto swapUnknown = reinterpret_cast<::IUnknown*>(swapchainPtr);
+		if (m_dispatcher && !m_dispatcher.HasThreadAccess())
+		{
+			// Render worker path: hold a reference across the hop; the caller only guarantees the pointer for this call.
+			com_ptr<::IUnknown> keepAlive;
+			keepAlive.copy_from(swapUnknown);
+			auto strongThis = get_strong();
+			bool queued = m_dispatcher.TryEnqueue([strongThis, keepAlive]()
+			{
+				strongThis->SetSwapChainOnUiThread(keepAlive.get());
+			});
+			if (!queued)
+			{
+				trace::Log(L"Attacher::AttachSwapChain: TryEnqueue failed (dispatcher shutting down?)");
+			}
+			return;
+		}
+		SetSwapChainOnUiThread(swapUnknown);
+	}
+
+	void Attacher::SetSwapChainOnUiThread(::IUnknown* swapUnknown)
+	{
 		struct __declspec(uuid("63AAD0B8-7C24-40FF-85A8-640D944CC325")) ISwapChainPanelNative : ::IUnknown
 		{
 			virtual HRESULT __stdcall SetSwapChain(::IUnknown* value) = 0;
@@ -62,22 +86,19 @@ namespace winrt::Blitz::implementation
 		HRESULT qi = panelUnknown->QueryInterface(__uuidof(ISwapChainPanelNative), native.put_void());
 		if (FAILED(qi))
 		{
-			::OutputDebugStringW(L"Attacher::AttachSwapChain: QI for ISwapChainPanelNative failed\n");
+			trace::Log(L"Attacher::AttachSwapChain: QI for ISwapChainPanelNative failed");
 			return;
 		}
 
-		auto swapUnknown = reinterpret_cast<::IUnknown*>(swapchainPtr);
+		GUID const activity = trace::NewActivityId();
+		TraceLoggingWriteActivity(g_blitzTraceProvider, "AttachSwapChain", &activity, nullptr,
+			TraceLoggingOpcode(WINEVENT_OPCODE_START),
+			TraceLoggingLevel(WINEVENT_LEVEL_INFO));
 		HRESULT hr = native->SetSwapChain(swapUnknown);
-		if (FAILED(hr))
-		{
-			wchar_t buf[160];
-			swprintf_s(buf, L"Attacher::AttachSwapChain: SetSwapChain failed hr=0x%08X\n", hr);
-			::OutputDebugStringW(buf);
-		}
-		else
-		{
-			::OutputDebugStringW(L"Attacher::AttachSwapChain: success\n");
-		}
+		TraceLoggingWriteActivity(g_blitzTraceProvider, "AttachSwapChain", &activity, nullptr,
+			TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+			TraceLoggingLevel(WINEVENT_LEVEL_INFO),
+			TraceLoggingHResult(hr, "HResult"));
 	}
 
 	bool Attacher::TestAttacherConnection()
@@ -2,6 +2,7 @@
 
 #include "Attacher.g.h"
 #include <winrt/Microsoft.UI.Xaml.Controls.h>
+#include <winrt/Microsoft.UI.Dispatching.h>
 
 namespace winrt::Blitz::implementation
 {
@@ -10,11 +11,17 @@ namespace winrt::Blitz::implementation
         Attacher(winrt::Windows::Foundation::IInspectable const& panel); // panel expected to be SwapChainPanel
 
         // BlitzWinUI.ISwapChainAttacher implementation
+        // Thread affinity: may be called from any thread (the Rust render worker included). SetSwapChain must run
+        // on the panel's UI thread, so off-thread calls are marshaled to the panel's DispatcherQueue.
         void AttachSwapChain(uint64_t swapchainPtr);
         bool TestAttacherConnection();
 
     private:
+        void SetSwapChainOnUiThread(::IUnknown* swapchain);
+
         winrt::Microsoft::UI::Xaml::Controls::SwapChainPanel m_panel{ nullptr };
+        // Captured on the constructing (UI) thread so AttachSwapChain can marshal without touching m_panel off-thread.
+        winrt::Microsoft::UI::Dispatching::DispatcherQueue m_dispatcher{ nullptr };
         uint64_t m_lastSwapchainPtr{ 0 };
     };
 }
@@ -0,0 +1,39 @@
+#include "pch.h"
+#include "BlitzTrace.h"
+
+// {d9a325c4-cdb2-59c1-9981-129671d2b6ae}: the standard TraceLogging name hash of "Blitz.WinUI", as in trace.rs
+TRACELOGGING_DEFINE_PROVIDER(
+    g_blitzTraceProvider,
+    "Blitz.WinUI",
+    (0xd9a325c4, 0xcdb2, 0x59c1, 0x99, 0x81, 0x12, 0x96, 0x71, 0xd2, 0xb6, 0xae));
+
+namespace
+{
+    // Registered while the DLL is loaded; unregistering on unload keeps ETW from calling into unmapped code.
+    struct ProviderRegistration
+    {
+        ProviderRegistration() noexcept { TraceLoggingRegister(g_blitzTraceProvider); }
+        ~ProviderRegistration() { TraceLoggingUnregister(g_blitzTraceProvider); }
+    };
+    ProviderRegistration g_registration;
+}
+
+namespace winrt::Blitz::implementation::trace
+{
+    GUID NewActivityId() noexcept
+    {
+        GUID id{};
+        if (Enabled())
+        {
+            EventActivityIdControl(EVENT_ACTIVITY_CTRL_CREATE_ID, &id);
+        }
+        return id;
+    }
+
+    void Log(wchar_t const* message) noexcept
+    {
+        TraceLoggingWrite(g_blitzTraceProvider, "Log",
+            TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+            TraceLoggingWideString(message, "Message"));
+    }
+}
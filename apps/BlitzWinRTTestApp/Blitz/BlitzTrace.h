@@ -0,0 +1,25 @@
+#pragma once
+
+#include <windows.h>
+#include <TraceLoggingProvider.h>
+#include <evntprov.h>
+
+// ETW TraceLogging provider shared with the Rust host (packages/blitz-shell-winui/src/trace.rs). Both sides register
+// "Blitz.WinUI" under the same GUID, so one WPA/PerfView session sees the component's HttpFetch and AttachSwapChain
+// activities next to the host's Resolve/PaintScene/Playback/Present and Fetch activities (matched by RequestId).
+// Events cost a single enabled check while no session is listening.
+TRACELOGGING_DECLARE_PROVIDER(g_blitzTraceProvider);
+
+namespace winrt::Blitz::implementation::trace
+{
+    inline bool Enabled() noexcept
+    {
+        return TraceLoggingProviderEnabled(g_blitzTraceProvider, WINEVENT_LEVEL_INFO, 0);
+    }
+
+    // Fresh activity id while a session is listening; the zero GUID otherwise (the events are not written then).
+    GUID NewActivityId() noexcept;
+
+    // Diagnostic message as a verbose "Log" event, the event the host writes its debug_log! messages to.
+    void Log(wchar_t const* message) noexcept;
+}
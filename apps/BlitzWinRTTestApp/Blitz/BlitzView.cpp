@@ -1,5 +1,6 @@
 ﻿#include "pch.h"
 #include "BlitzView.h"
+#include "BlitzTrace.h"
 #if __has_include("BlitzView.g.cpp")
 #include "BlitzView.g.cpp"
 #endif
@@ -10,6 +11,36 @@ using namespace winrt::Microsoft::UI::Xaml::Controls;
 using namespace winrt::Microsoft::UI::Xaml::Input;
 using namespace winrt::Microsoft::UI::Xaml::Media;
 
+namespace
+{
+    // Cap per-frame batch so a stalled UI thread cannot grow it without bound (oldest points are dropped).
+    constexpr size_t kMaxBatchedPoints = 256;
+    // Compositor scrolling: logical px rendered above and below the viewport (surface = viewport + 2 * overscan).
+    constexpr uint32_t kCompositorOverscan = 512;
+    // Vsync ticks to keep polling the scroll offset after a wheel event.
+    constexpr uint32_t kScrollSettleTicks = 4;
+    // Layout size for a Host preloaded before the panel exists and the window size is unknown (logical px).
+    constexpr uint32_t kPreloadWidth = 1280;
+    constexpr uint32_t kPreloadHeight = 800;
+    // Interactive resize: no SizeChanged for this long ends the drag (the final size is then drawn unthrottled).
+    constexpr std::chrono::milliseconds kResizeSettle{ 150 };
+    // Relayouts that take longer than a frame are spaced out by their own cost while the drag lasts.
+    constexpr std::chrono::milliseconds kResizeFrameBudget{ 16 };
+    // RasterizationScale changes below this keep the Host's buffers (it applies the same tolerance).
+    constexpr float kScaleTolerance = 0.01f;
+
+    uint32_t ButtonsFromProperties(winrt::Microsoft::UI::Input::PointerPointProperties const& props)
+    {
+        uint32_t buttons = 0;
+        if (props.IsLeftButtonPressed()) buttons |= 1;
+        if (props.IsRightButtonPressed()) buttons |= 2;
+        if (props.IsMiddleButtonPressed()) buttons |= 4;
+        if (props.IsXButton1Pressed()) buttons |= 8;
+        if (props.IsXButton2Pressed()) buttons |= 16;
+        return buttons;
+    }
+}
+
 namespace winrt::Blitz::implementation
 {
     BlitzView::BlitzView()
@@ -29,9 +60,9 @@ namespace winrt::Blitz::implementation
                 catch (...) { }
             }
         }
-        if (m_host || !m_panel)
+        if (m_attacher || !m_panel)
         {
-            return; // Already initialized or missing panel
+            return; // Already attached or missing panel
         }
 
         // Create attacher using panel
@@ -48,17 +79,35 @@ namespace winrt::Blitz::implementation
     // Determine initial size/scale (logical DIPs + device scale). We pass logical size; Rust allocates physical buffer.
     float rasterScale = 1.0f;
     if (auto xr = this->XamlRoot()) { rasterScale = static_cast<float>(xr.RasterizationScale()); }
-    uint32_t width = std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(m_panel.ActualWidth())));
-    uint32_t height = std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(m_panel.ActualHeight())));
+    uint32_t width = PanelWidth();
+    uint32_t height = PanelHeight();
 
         // Pick provided HTML (if any) or fallback default snippet
         hstring initialHtml = m_html.empty() ? hstring(L"<html><body style='background:#202020;color:#EEE;font-family:sans-serif'>Blitz host</body></html>") : m_html;
         try
         {
-            // Pass logical size + rasterScale; shell forces viewport scale=1.0 but uses device_scale for buffer allocation.
-            m_host = winrt::BlitzWinUI::Host(m_attacher, width, height, rasterScale, initialHtml);
+            if (m_host)
+            {
+                // Preloaded (see PreloadHost): the document is parsed already; size it, then attach. SetPanel waits
+                // for the preload thread if it is still resolving, then only creates the swapchain and presents.
+                m_host.Resize(width, height, rasterScale);
+                m_host.SetPanel(m_attacher);
+            }
+            else
+            {
+                // Pass logical size + rasterScale; shell forces viewport scale=1.0 but uses device_scale for buffer allocation.
+                m_host = winrt::BlitzWinUI::Host(m_attacher, width, height, rasterScale, initialHtml);
+            }
+            m_hostWidth = width;
+            m_hostHeight = height;
+            m_hostScale = rasterScale;
             // Apply current overlay setting (default false unless changed before init)
             try { m_host.SetDebugOverlay(m_debugOverlayEnabled); } catch (...) {}
+            if (m_compositorScrolling) ApplyCompositorScrollingMode();
+            if (m_transparent)
+            {
+                try { m_host.SetTransparent(true); } catch (...) {}
+            }
             // Create and inject network fetcher so that resource loads (images/stylesheets) can occur.
             try
             {
@@ -69,13 +118,39 @@ namespace winrt::Blitz::implementation
             {
                 // Leave m_fetcher null; networking will remain disabled.
             }
+            // Demand-driven rendering: the host asks for frames instead of being polled every vsync.
+            try
+            {
+                m_frameScheduler = winrt::Blitz::FrameScheduler(*this);
+                m_host.SetFrameScheduler(m_frameScheduler);
+            }
+            catch (...)
+            {
+                // Without a scheduler OnRendering keeps polling the host every tick.
+                m_frameScheduler = nullptr;
+            }
+            SubscribeMemoryPressure();
         }
         catch (...)
         {
             m_host = nullptr;
+            m_attacher = nullptr;
             return;
         }
 
+        if (m_renderOnWorkerThread)
+        {
+            // Host renders and paces itself on its own thread; no CompositionTarget::Rendering subscription needed.
+            try { m_host.SetRenderWorkerEnabled(true); return; }
+            catch (...) { m_renderOnWorkerThread = false; }
+        }
+        // Tick at least once so any frame invalidated during construction gets drawn; detaches when idle.
+        EnsureRenderLoop();
+    }
+
+    void BlitzView::RequestFrame()
+    {
+        if (m_renderOnWorkerThread) return;
         EnsureRenderLoop();
     }
 
@@ -97,10 +172,49 @@ namespace winrt::Blitz::implementation
 
     void BlitzView::OnRendering(winrt::Windows::Foundation::IInspectable const&, winrt::Windows::Foundation::IInspectable const&)
     {
-        if (m_host)
+        if (!m_host)
         {
+            StopRenderLoop();
+            return;
+        }
+        // Size first: the batched pointer positions are relative to the panel at its current size
+        bool resized = FlushResize();
+        FlushInputBatch();
+        ApplyCompositorScrollOffset();
+        bool settling = m_scrollSettleTicks > 0;
+        if (settling) --m_scrollSettleTicks;
+        if (m_renderOnWorkerThread)
+        {
+            // Worker renders on its own; we only ticked to deliver the input batch (and pick up scroll offsets).
+            if (!settling && !m_resizePending) StopRenderLoop();
+            return;
+        }
+        if (!m_frameScheduler)
+        {
+            // Legacy polling path: host early-outs when nothing is dirty.
             try { m_host.RenderOnce(); }
             catch (...) { /* stop loop on persistent failure? */ }
+            if (resized) ApplyResizeStretch();
+            return;
+        }
+        auto frameStart = std::chrono::steady_clock::now();
+        bool more = false;
+        try { more = m_host.RenderPendingFrame(); }
+        catch (...) { more = false; }
+        if (resized)
+        {
+            // The new size is on screen: drop the stretch (or shrink it to a resize that arrived meanwhile)
+            ApplyResizeStretch();
+            auto cost = std::chrono::steady_clock::now() - frameStart;
+            bool dragging = m_resizeSettleTimer && m_resizeSettleTimer.IsRunning();
+            m_nextResizeAt = dragging && cost > kResizeFrameBudget ? frameStart + 2 * cost : std::chrono::steady_clock::time_point{};
+        }
+        // A re-placed raster publishes its offset when presented
+        ApplyCompositorScrollOffset();
+        if (!more && !settling && !m_resizePending)
+        {
+            // Document idle: drop the vsync subscription until the host calls RequestFrame again.
+            StopRenderLoop();
         }
     }
 
@@ -118,56 +232,144 @@ namespace winrt::Blitz::implementation
     {
         if (!m_host || !m_panel)
             return;
-    float rasterScale = 1.0f; if (auto xr = this->XamlRoot()) { rasterScale = static_cast<float>(xr.RasterizationScale()); }
-    uint32_t width = std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(m_panel.ActualWidth())));
-    uint32_t height = std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(m_panel.ActualHeight())));
-    try { m_host.Resize(width, height, rasterScale); }
-        catch (...) { }
+        // A window edge drag raises SizeChanged several times per frame; only the latest size is sent, from the next
+        // Rendering tick. Until the Host has drawn it, the frame on screen is stretched to fill the panel.
+        m_resizePending = true;
+        ApplyResizeStretch();
+        RestartResizeSettleTimer();
+        EnsureRenderLoop();
+    }
+
+    bool BlitzView::FlushResize()
+    {
+        if (!m_resizePending || !m_host || !m_panel) return false;
+        // Still paying off a slow relayout: keep showing the stretched frame a little longer
+        if (std::chrono::steady_clock::now() < m_nextResizeAt) return false;
+        m_resizePending = false;
+        float rasterScale = 1.0f; if (auto xr = this->XamlRoot()) { rasterScale = static_cast<float>(xr.RasterizationScale()); }
+        uint32_t width = PanelWidth();
+        uint32_t height = PanelHeight();
+        if (width == m_hostWidth && height == m_hostHeight && std::abs(rasterScale - m_hostScale) <= kScaleTolerance) return false;
+        try { m_host.Resize(width, height, rasterScale); }
+        catch (...) { return false; }
+        m_hostWidth = width;
+        m_hostHeight = height;
+        m_hostScale = rasterScale;
+        return true;
+    }
+
+    void BlitzView::ApplyResizeStretch()
+    {
+        if (!m_panel) return;
+        float sx = 1.0f;
+        float sy = 1.0f;
+        // The worker presents on its own schedule, so no tick knows when to drop a stretch: its frames are shown
+        // as drawn (its queue still folds a burst of resizes into one frame).
+        if (!m_renderOnWorkerThread && m_hostWidth > 0 && m_hostHeight > 0)
+        {
+            sx = static_cast<float>(PanelWidth()) / static_cast<float>(m_hostWidth);
+            sy = static_cast<float>(PanelHeight()) / static_cast<float>(m_hostHeight);
+        }
+        if (sx == m_stretchX && sy == m_stretchY) return;
+        m_stretchX = sx;
+        m_stretchY = sy;
+        // Applied by the compositor around the panel's top-left corner; pointer positions read relative to the panel
+        // stay in the stretched frame's (the Host's) coordinates.
+        m_panel.Scale({ sx, sy, 1.0f });
+    }
+
+    void BlitzView::RestartResizeSettleTimer()
+    {
+        if (!m_resizeSettleTimer)
+        {
+            try
+            {
+                m_resizeSettleTimer = DispatcherQueue().CreateTimer();
+                m_resizeSettleTimer.Interval(kResizeSettle);
+                m_resizeSettleTimer.IsRepeating(false);
+                auto weak = get_weak();
+                m_resizeSettleTimer.Tick([weak](auto&&, auto&&)
+                {
+                    // Drag over: draw the final size on the next tick, however long relayouts have been taking
+                    if (auto self = weak.get())
+                    {
+                        self->m_nextResizeAt = {};
+                        if (self->m_resizePending) self->EnsureRenderLoop();
+                    }
+                });
+            }
+            catch (...) { m_resizeSettleTimer = nullptr; return; }
+        }
+        m_resizeSettleTimer.Stop();
+        m_resizeSettleTimer.Start();
     }
 
     void BlitzView::PanelPointerMoved(winrt::Windows::Foundation::IInspectable const&, PointerRoutedEventArgs const& e)
     {
         if (!m_host || !m_panel) return;
+        // Coalesce: queue this event's points and let the next Rendering tick submit one batch.
+        // GetIntermediatePoints returns newest first and includes the current point.
+        try
+        {
+            auto points = e.GetIntermediatePoints(m_panel);
+            for (uint32_t i = points.Size(); i > 0; --i)
+            {
+                auto pos = points.GetAt(i - 1).Position();
+                m_pendingMoves.push_back((float)pos.X);
+                m_pendingMoves.push_back(ViewportY((float)pos.Y));
+            }
+        }
+        catch (...)
+        {
+            auto pos = e.GetCurrentPoint(m_panel).Position();
+            m_pendingMoves.push_back((float)pos.X);
+            m_pendingMoves.push_back(ViewportY((float)pos.Y));
+        }
+        if (m_pendingMoves.size() > kMaxBatchedPoints * 2)
+        {
+            m_pendingMoves.erase(m_pendingMoves.begin(), m_pendingMoves.end() - kMaxBatchedPoints * 2);
+        }
         auto pt = e.GetCurrentPoint(m_panel);
-        uint32_t modifiers = (uint32_t)e.KeyModifiers();
-        uint32_t buttons = 0;
-        if (pt.Properties().IsLeftButtonPressed()) buttons |= 1;
-        if (pt.Properties().IsRightButtonPressed()) buttons |= 2;
-        if (pt.Properties().IsMiddleButtonPressed()) buttons |= 4;
-        if (pt.Properties().IsXButton1Pressed()) buttons |= 8;
-        if (pt.Properties().IsXButton2Pressed()) buttons |= 16;
-        try { m_host.PointerMove((float)pt.Position().X, (float)pt.Position().Y, buttons, modifiers); } catch (...) {}
+        m_pendingButtons = ButtonsFromProperties(pt.Properties());
+        m_pendingModifiers = (uint32_t)e.KeyModifiers();
+        EnsureRenderLoop();
+    }
+
+    void BlitzView::FlushInputBatch()
+    {
+        if (m_pendingMoves.empty() || !m_host) return;
+        try { m_host.SubmitInputBatch(m_pendingMoves, m_pendingButtons, m_pendingModifiers); } catch (...) {}
+        m_pendingMoves.clear();
     }
 
     void BlitzView::PanelPointerPressed(winrt::Windows::Foundation::IInspectable const&, PointerRoutedEventArgs const& e)
     {
         if (!m_host || !m_panel) return;
+        FlushInputBatch();
         auto pt = e.GetCurrentPoint(m_panel);
+        auto props = pt.Properties();
         uint8_t button = 0;
-        if (pt.Properties().IsRightButtonPressed()) button = 2;
-        else if (pt.Properties().IsMiddleButtonPressed()) button = 1;
-        uint32_t buttons = 0;
-        if (pt.Properties().IsLeftButtonPressed()) buttons |= 1;
-        if (pt.Properties().IsRightButtonPressed()) buttons |= 2;
-        if (pt.Properties().IsMiddleButtonPressed()) buttons |= 4;
-        if (pt.Properties().IsXButton1Pressed()) buttons |= 8;
-        if (pt.Properties().IsXButton2Pressed()) buttons |= 16;
+        if (props.IsRightButtonPressed()) button = 2;
+        else if (props.IsMiddleButtonPressed()) button = 1;
+        uint32_t buttons = ButtonsFromProperties(props);
         uint32_t modifiers = (uint32_t)e.KeyModifiers();
-        try { m_host.PointerDown((float)pt.Position().X, (float)pt.Position().Y, button, buttons, modifiers); } catch (...) {}
+        try { m_host.PointerDown((float)pt.Position().X, ViewportY((float)pt.Position().Y), button, buttons, modifiers); } catch (...) {}
     }
 
     void BlitzView::PanelPointerReleased(winrt::Windows::Foundation::IInspectable const&, PointerRoutedEventArgs const& e)
     {
         if (!m_host || !m_panel) return;
+        FlushInputBatch();
         auto pt = e.GetCurrentPoint(m_panel);
         uint8_t button = 0; // heuristic: left release maps to 0
         uint32_t modifiers = (uint32_t)e.KeyModifiers();
-        try { m_host.PointerUp((float)pt.Position().X, (float)pt.Position().Y, button, 0, modifiers); } catch (...) {}
+        try { m_host.PointerUp((float)pt.Position().X, ViewportY((float)pt.Position().Y), button, 0, modifiers); } catch (...) {}
     }
 
     void BlitzView::PanelPointerWheelChanged(winrt::Windows::Foundation::IInspectable const&, PointerRoutedEventArgs const& e)
     {
         if (!m_host || !m_panel) return;
+        FlushInputBatch();
         auto pt = e.GetCurrentPoint(m_panel);
         int raw = pt.Properties().MouseWheelDelta(); // multiples of 120
         double linesPerNotch = 1.0;
@@ -179,9 +381,45 @@ namespace winrt::Blitz::implementation
             dx = dy; dy = 0.0;
         }
         try { m_host.WheelScroll(dx, dy); } catch (...) {}
+        if (m_compositorScrolling)
+        {
+            // Inline hosts have already published the new offset; the worker publishes it shortly, so keep
+            // polling for a few ticks.
+            ApplyCompositorScrollOffset();
+            m_scrollSettleTicks = kScrollSettleTicks;
+            EnsureRenderLoop();
+        }
         e.Handled(true);
     }
 
+    void BlitzView::ApplyCompositorScrollingMode()
+    {
+        if (!m_host || !m_panel) return;
+        try { m_host.SetCompositorScrolling(m_compositorScrolling ? kCompositorOverscan : 0); } catch (...) {}
+        try
+        {
+            // The swapchain is taller than the panel; clip the overscan bands to the control's bounds.
+            auto visual = winrt::Microsoft::UI::Xaml::Hosting::ElementCompositionPreview::GetElementVisual(*this);
+            visual.Clip(m_compositorScrolling ? visual.Compositor().CreateInsetClip() : nullptr);
+        }
+        catch (...) { trace::Log(L"BlitzView: could not set compositor clip"); }
+        ApplyCompositorScrollOffset();
+    }
+
+    void BlitzView::ApplyCompositorScrollOffset()
+    {
+        if (!m_host || !m_panel) return;
+        double offset = 0.0;
+        if (m_compositorScrolling)
+        {
+            try { offset = m_host.CompositorScrollOffset(); } catch (...) { return; }
+        }
+        if (offset == m_appliedScrollOffset) return;
+        m_appliedScrollOffset = offset;
+        // Translation is applied by the compositor; no XAML layout pass and no Host repaint.
+        m_panel.Translation({ 0.0f, -static_cast<float>(offset), 0.0f });
+    }
+
     // Override OnApplyTemplate to wire events after control template is applied
     void BlitzView::OnApplyTemplate()
     {
@@ -239,10 +477,59 @@ namespace winrt::Blitz::implementation
     {
         // DPI (RasterizationScale) may have changed even if logical size did not; trigger logical resize with same size but new scale.
         if (!m_host || !m_panel) return;
-        float rasterScale = 1.0f; if (auto xr = this->XamlRoot()) { rasterScale = static_cast<float>(xr.RasterizationScale()); }
-        uint32_t width = std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(m_panel.ActualWidth())));
-        uint32_t height = std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(m_panel.ActualHeight())));
-        try { m_host.Resize(width, height, rasterScale); } catch (...) {}
+        // Sent with the next tick like a size change (and dropped there if nothing moved beyond the scale tolerance)
+        m_resizePending = true;
+        EnsureRenderLoop();
+        // Minimized / hidden windows keep their frame but don't need the caches behind it.
+        bool visible = this->XamlRoot() ? this->XamlRoot().IsHostVisible() : true;
+        if (m_hostVisible && !visible) TrimHost(L"hidden");
+        m_hostVisible = visible;
+    }
+
+    void BlitzView::SubscribeMemoryPressure()
+    {
+        auto weak = get_weak();
+        // Both events are raised off the UI thread; trim on it so it doesn't race a frame.
+        auto trimOnUiThread = [weak](wchar_t const* reason)
+        {
+            if (auto self = weak.get())
+            {
+                self->DispatcherQueue().TryEnqueue([weak, reason]()
+                {
+                    if (auto self = weak.get()) self->TrimHost(reason);
+                });
+            }
+        };
+        try
+        {
+            using winrt::Windows::System::AppMemoryUsageLevel;
+            using winrt::Windows::System::MemoryManager;
+            m_memoryUsageRevoker = MemoryManager::AppMemoryUsageIncreased(winrt::auto_revoke, [trimOnUiThread](auto&&, auto&&)
+            {
+                auto level = MemoryManager::AppMemoryUsageLevel();
+                if (level == AppMemoryUsageLevel::High || level == AppMemoryUsageLevel::OverLimit) trimOnUiThread(L"memory pressure");
+            });
+        }
+        catch (...) {}
+        try
+        {
+            // Only raised for apps that take part in the suspend lifecycle (desktop apps are covered by the
+            // visibility check in OnXamlRootChanged). Trim before returning: the process is frozen afterwards.
+            m_suspendingRevoker = winrt::Windows::ApplicationModel::Core::CoreApplication::Suspending(winrt::auto_revoke, [weak](auto&&, auto&&)
+            {
+                if (auto self = weak.get()) self->TrimHost(L"suspending");
+            });
+        }
+        catch (...) {}
+    }
+
+    void BlitzView::TrimHost(wchar_t const* reason)
+    {
+        if (!m_host) return;
+        try { m_host.Trim(); } catch (...) { return; }
+        TraceLoggingWrite(g_blitzTraceProvider, "TrimHost",
+            TraceLoggingLevel(WINEVENT_LEVEL_INFO),
+            TraceLoggingWideString(reason, "Reason"));
     }
 
     // HTML property implementation
@@ -252,8 +539,37 @@ namespace winrt::Blitz::implementation
     }
     void BlitzView::HTML(winrt::hstring const& value)
     {
+        if (m_html == value) return;
         m_html = value;
-        // If host already created we could later add a live update call (not implemented yet).
+        if (m_host)
+        {
+            // Diff against the live DOM instead of reloading, so unchanged content keeps its style/layout state.
+            try { m_host.UpdateHtml(value); } catch (...) { trace::Log(L"BlitzView: UpdateHtml failed"); }
+        }
+        else if (!m_html.empty())
+        {
+            PreloadHost();
+        }
+    }
+
+    void BlitzView::PreloadHost()
+    {
+        // HTML usually arrives (binding / XAML attribute) well before the template part is loaded: construct the
+        // Host without an attacher so the markup is parsed and resolved on a background thread meanwhile.
+        // InitializeHostIfReady resizes it to the panel before attaching.
+        uint32_t width = kPreloadWidth;
+        uint32_t height = kPreloadHeight;
+        if (auto xr = this->XamlRoot())
+        {
+            auto size = xr.Size();
+            if (size.Width >= 1 && size.Height >= 1)
+            {
+                width = static_cast<uint32_t>(std::lround(size.Width));
+                height = static_cast<uint32_t>(std::lround(size.Height));
+            }
+        }
+        try { m_host = winrt::BlitzWinUI::Host(nullptr, width, height, 1.0f, m_html); }
+        catch (...) { m_host = nullptr; trace::Log(L"BlitzView: preload failed; creating the Host on attach"); }
     }
 
     bool BlitzView::DebugOverlayEnabled() const
@@ -270,5 +586,43 @@ namespace winrt::Blitz::implementation
             try { m_host.SetDebugOverlay(value); } catch (...) {}
         }
     }
-}
 
+    bool BlitzView::RenderOnWorkerThread() const
+    {
+        return m_renderOnWorkerThread;
+    }
+
+    bool BlitzView::CompositorScrolling() const
+    {
+        return m_compositorScrolling;
+    }
+
+    void BlitzView::CompositorScrolling(bool value)
+    {
+        if (m_compositorScrolling == value) return;
+        m_compositorScrolling = value;
+        ApplyCompositorScrollingMode(); // no-op until the host exists; InitializeHostIfReady applies it then
+    }
+
+    bool BlitzView::Transparent() const
+    {
+        return m_transparent;
+    }
+
+    void BlitzView::Transparent(bool value)
+    {
+        if (m_transparent == value) return;
+        m_transparent = value;
+        if (!m_host) return; // applied in InitializeHostIfReady
+        try { m_host.SetTransparent(value); } catch (...) {}
+    }
+
+    void BlitzView::RenderOnWorkerThread(bool value)
+    {
+        if (m_renderOnWorkerThread == value) return;
+        m_renderOnWorkerThread = value;
+        if (!m_host || !m_attacher) return; // applied in InitializeHostIfReady
+        try { m_host.SetRenderWorkerEnabled(value); } catch (...) {}
+        if (value) StopRenderLoop(); else EnsureRenderLoop();
+    }
+}
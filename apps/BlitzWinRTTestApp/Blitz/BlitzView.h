@@ -4,9 +4,15 @@
 #include <winrt/Microsoft.UI.Xaml.Controls.h>
 #include <winrt/Microsoft.UI.Xaml.Input.h>
 #include <winrt/Microsoft.UI.Xaml.Media.h>
+#include <winrt/Microsoft.UI.Xaml.Hosting.h>
 #include <winrt/Windows.System.h>
+#include <winrt/Windows.ApplicationModel.Core.h>
 #include <winrt/BlitzWinUI.h>
 #include <winrt/Blitz.h> // Attacher runtimeclass (same project)
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
 
 namespace winrt::Blitz::implementation
 {
@@ -27,10 +33,21 @@ namespace winrt::Blitz::implementation
         void HTML(winrt::hstring const& value); // Property setter
     bool DebugOverlayEnabled() const;
     void DebugOverlayEnabled(bool value);
+    bool RenderOnWorkerThread() const;
+    void RenderOnWorkerThread(bool value);
+    bool CompositorScrolling() const;
+    void CompositorScrolling(bool value);
+    bool Transparent() const;
+    void Transparent(bool value);
+
+        // Invoked by FrameScheduler when the Rust host has a frame pending (idle -> dirty transition).
+        void RequestFrame();
 
     private:
         // Lifecycle
         void InitializeHostIfReady();
+        // Construct the Host panel-less so HTML set before the template loads is parsed off the UI thread.
+        void PreloadHost();
         void EnsureRenderLoop();
         void StopRenderLoop();
 
@@ -46,7 +63,26 @@ namespace winrt::Blitz::implementation
     void OnXamlRootChanged(winrt::Windows::Foundation::IInspectable const&, winrt::Microsoft::UI::Xaml::XamlRootChangedEventArgs const&);
 
         // Helpers
+        // Resizes are recorded here and sent from the next Rendering tick (FlushResize), at most once per frame.
         void ForwardResize();
+        bool FlushResize();
+        // Stretch the last presented frame over the panel until the Host has drawn the panel's current size.
+        void ApplyResizeStretch();
+        void RestartResizeSettleTimer();
+        // Submit coalesced pointer moves (once per frame, and before any discrete input to keep ordering).
+        void FlushInputBatch();
+        // Compositor scrolling: turn the Host's over-sized raster + panel clip on/off, and move the panel to the
+        // Host's latest published scroll offset.
+        void ApplyCompositorScrollingMode();
+        void ApplyCompositorScrollOffset();
+        // Release the Host's cached GPU resources when the app is hidden, suspended or under memory pressure.
+        void SubscribeMemoryPressure();
+        void TrimHost(wchar_t const* reason);
+        // Pointer positions are read relative to the (translated) panel; map them back to viewport coordinates.
+        float ViewportY(float panelY) const { return panelY - static_cast<float>(m_appliedScrollOffset); }
+        // Panel size in whole logical px, as passed to the Host
+        uint32_t PanelWidth() const { return std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(m_panel.ActualWidth()))); }
+        uint32_t PanelHeight() const { return std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(m_panel.ActualHeight()))); }
 
         // State
         winrt::Microsoft::UI::Xaml::Controls::SwapChainPanel m_panel{ nullptr };
@@ -54,9 +90,33 @@ namespace winrt::Blitz::implementation
         winrt::BlitzWinUI::Host m_host{ nullptr };
     // Network fetcher (host-driven HTTP); created after host and injected via SetNetworkFetcher.
     winrt::Blitz::NetworkFetcher m_fetcher{ nullptr };
+    // Frame scheduler (host-driven invalidation); Rendering is only subscribed while frames are pending.
+    winrt::Blitz::FrameScheduler m_frameScheduler{ nullptr };
         bool m_renderLoopAttached{ false };
+    // Pointer-move batch for the current frame: x,y pairs oldest -> newest; buttons/modifiers of the newest point.
+    std::vector<float> m_pendingMoves;
+    uint32_t m_pendingButtons{ 0 };
+    uint32_t m_pendingModifiers{ 0 };
         winrt::hstring m_html; // backing for HTML property
     bool m_debugOverlayEnabled{ false }; // backing for DebugOverlayEnabled property
+    bool m_renderOnWorkerThread{ false }; // backing for RenderOnWorkerThread property
+    bool m_compositorScrolling{ false }; // backing for CompositorScrolling property
+    bool m_transparent{ false }; // backing for Transparent property
+    double m_appliedScrollOffset{ 0.0 }; // panel translation currently applied (logical px)
+    uint32_t m_scrollSettleTicks{ 0 }; // ticks left to poll the offset after a wheel (worker applies it asynchronously)
+    bool m_hostVisible{ true }; // last XamlRoot.IsHostVisible, to trim once per hide
+    // Interactive resize: size/scale last sent to the Host, the stretch applied to the panel meanwhile, and the
+    // earliest time the next relayout may run while a drag keeps resizing (spaces out relayouts slower than a frame).
+    uint32_t m_hostWidth{ 0 };
+    uint32_t m_hostHeight{ 0 };
+    float m_hostScale{ 0.0f };
+    bool m_resizePending{ false };
+    float m_stretchX{ 1.0f };
+    float m_stretchY{ 1.0f };
+    std::chrono::steady_clock::time_point m_nextResizeAt{};
+    winrt::Microsoft::UI::Dispatching::DispatcherQueueTimer m_resizeSettleTimer{ nullptr };
+    winrt::Windows::System::MemoryManager::AppMemoryUsageIncreased_revoker m_memoryUsageRevoker;
+    winrt::Windows::ApplicationModel::Core::CoreApplication::Suspending_revoker m_suspendingRevoker;
 
         // Event tokens for cleanup (not strictly necessary yet)
         winrt::event_token m_loadedToken{};
@@ -0,0 +1,416 @@
+#include "pch.h"
+#include "DiskCache.h"
+#include "BlitzTrace.h"
+#include <winrt/Windows.Security.Cryptography.h>
+#include <winrt/Windows.Security.Cryptography.Core.h>
+#include <winrt/Windows.Storage.h>
+#include <robuffer.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace winrt::Windows::Security::Cryptography;
+using namespace winrt::Windows::Security::Cryptography::Core;
+using namespace winrt::Windows::Storage::Streams;
+
+namespace
+{
+    // Read-only IBuffer over a mapped file view; the mapping lives as long as the buffer.
+    struct MappedBuffer : winrt::implements<MappedBuffer, IBuffer, ::Windows::Storage::Streams::IBufferByteAccess>
+    {
+        MappedBuffer(HANDLE mapping, uint8_t* view, uint32_t length)
+            : m_mapping(mapping), m_view(view), m_length(length) {}
+
+        ~MappedBuffer()
+        {
+            UnmapViewOfFile(m_view);
+            CloseHandle(m_mapping);
+        }
+
+        uint32_t Capacity() const { return m_length; }
+        uint32_t Length() const { return m_length; }
+        void Length(uint32_t) { throw winrt::hresult_illegal_method_call(); }
+
+        HRESULT __stdcall Buffer(uint8_t** value) noexcept final
+        {
+            *value = m_view;
+            return S_OK;
+        }
+
+    private:
+        HANDLE m_mapping;
+        uint8_t* m_view;
+        uint32_t m_length;
+    };
+
+    std::wstring Sha256Hex(IBuffer const& data)
+    {
+        auto provider = HashAlgorithmProvider::OpenAlgorithm(HashAlgorithmNames::Sha256());
+        return std::wstring(CryptographicBuffer::EncodeToHexString(provider.HashData(data)));
+    }
+
+    std::wstring Sha256Hex(std::wstring const& text)
+    {
+        return Sha256Hex(CryptographicBuffer::ConvertStringToBinary(text, BinaryStringEncoding::Utf8));
+    }
+
+    bool WriteWholeFile(std::wstring const& path, uint8_t const* data, uint32_t length)
+    {
+        // Write to a temp file and rename so readers never map a partial body.
+        std::wstring tmp = path + L".tmp";
+        HANDLE file = CreateFileW(tmp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        DWORD written = 0;
+        BOOL ok = length == 0 || WriteFile(file, data, length, &written, nullptr);
+        CloseHandle(file);
+        if (!ok || written != length || !MoveFileExW(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+        {
+            DeleteFileW(tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    struct StoredMeta
+    {
+        std::wstring url;
+        winrt::Blitz::implementation::DiskCache::Meta meta;
+    };
+
+    // Meta files are UTF-8 (see WriteMetaLocked); read them as bytes so non-ASCII urls round-trip.
+    std::optional<StoredMeta> ReadMetaFile(std::wstring const& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+        {
+            return std::nullopt;
+        }
+        std::string utf8{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+        std::wistringstream lines{ std::wstring(winrt::to_hstring(utf8)) };
+        StoredMeta stored;
+        std::wstring expires;
+        if (!std::getline(lines, stored.url) || !std::getline(lines, stored.meta.bodyHash)
+            || !std::getline(lines, stored.meta.etag) || !std::getline(lines, stored.meta.lastModified)
+            || !std::getline(lines, expires))
+        {
+            return std::nullopt;
+        }
+        stored.meta.expiresAt = _wtoi64(expires.c_str());
+        return stored;
+    }
+
+    // name without `suffix`, or empty if it doesn't end with it
+    std::wstring StripSuffix(std::wstring const& name, std::wstring_view suffix)
+    {
+        if (name.size() <= suffix.size() || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+        {
+            return {};
+        }
+        return name.substr(0, name.size() - suffix.size());
+    }
+
+    // Calls f(fileName, findData) for every file directly in dir
+    template <typename F>
+    void ForEachFile(std::wstring const& dir, F&& f)
+    {
+        WIN32_FIND_DATAW data{};
+        HANDLE find = FindFirstFileW((dir + L"\\*").c_str(), &data);
+        if (find == INVALID_HANDLE_VALUE)
+        {
+            return;
+        }
+        do
+        {
+            if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+            {
+                f(std::wstring(data.cFileName), data);
+            }
+        } while (FindNextFileW(find, &data));
+        FindClose(find);
+    }
+}
+
+namespace winrt::Blitz::implementation
+{
+    int64_t UnixNow()
+    {
+        return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    DiskCache& DiskCache::Instance()
+    {
+        static DiskCache instance;
+        return instance;
+    }
+
+    void DiskCache::SetEnabled(bool enabled)
+    {
+        std::lock_guard lock(m_lock);
+        if (enabled && m_root.empty())
+        {
+            try
+            {
+                auto folder = winrt::Windows::Storage::ApplicationData::Current().LocalCacheFolder();
+                m_root = std::wstring(folder.Path()) + L"\\BlitzCache";
+                CreateDirectoryW(m_root.c_str(), nullptr);
+                CreateDirectoryW((m_root + L"\\bodies").c_str(), nullptr);
+                CreateDirectoryW((m_root + L"\\meta").c_str(), nullptr);
+            }
+            catch (...)
+            {
+                trace::Log(L"DiskCache: no LocalCacheFolder; disk cache stays disabled");
+                m_root.clear();
+                m_enabled = false;
+                return;
+            }
+            LoadIndexLocked();
+        }
+        m_enabled = enabled;
+    }
+
+    void DiskCache::SetCapacity(uint64_t bytes)
+    {
+        std::lock_guard lock(m_lock);
+        m_capacity = bytes;
+        EvictLocked();
+    }
+
+    std::wstring DiskCache::MetaPath(std::wstring const& key) const
+    {
+        return m_root + L"\\meta\\" + key + L".meta";
+    }
+
+    std::wstring DiskCache::BodyPath(std::wstring const& bodyHash) const
+    {
+        return m_root + L"\\bodies\\" + bodyHash + L".bin";
+    }
+
+    // Rebuild the index from meta\ (most recently stored first). Entries that can't be read or whose body is gone,
+    // leftover temp files and bodies no entry uses (a crash between writes, a failed delete) are removed.
+    void DiskCache::LoadIndexLocked()
+    {
+        struct Found
+        {
+            std::wstring key;
+            std::wstring bodyHash;
+            uint64_t bodyBytes;
+            uint64_t storedAt;
+        };
+        std::vector<Found> found;
+        std::wstring const metaDir = m_root + L"\\meta";
+        ForEachFile(metaDir, [&](std::wstring const& name, WIN32_FIND_DATAW const& data)
+        {
+            std::wstring const path = metaDir + L"\\" + name;
+            std::wstring key = StripSuffix(name, L".meta");
+            auto stored = key.empty() ? std::nullopt : ReadMetaFile(path);
+            WIN32_FILE_ATTRIBUTE_DATA body{};
+            if (!stored || !GetFileAttributesExW(BodyPath(stored->meta.bodyHash).c_str(), GetFileExInfoStandard, &body))
+            {
+                DeleteFileW(path.c_str());
+                return;
+            }
+            found.push_back({ std::move(key), stored->meta.bodyHash,
+                (uint64_t(body.nFileSizeHigh) << 32) | body.nFileSizeLow,
+                (uint64_t(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime });
+        });
+        std::sort(found.begin(), found.end(), [](Found const& a, Found const& b) { return a.storedAt > b.storedAt; });
+        for (auto& entry : found)
+        {
+            auto [body, inserted] = m_bodies.try_emplace(entry.bodyHash, Body{ entry.bodyBytes, 0 });
+            if (inserted)
+            {
+                m_bytes += entry.bodyBytes;
+            }
+            ++body->second.refs;
+            m_lru.push_back({ std::move(entry.key), std::move(entry.bodyHash) });
+            m_index[m_lru.back().key] = std::prev(m_lru.end());
+        }
+
+        std::wstring const bodyDir = m_root + L"\\bodies";
+        ForEachFile(bodyDir, [&](std::wstring const& name, WIN32_FIND_DATAW const&)
+        {
+            std::wstring hash = StripSuffix(name, L".bin");
+            if (hash.empty() || m_bodies.count(hash) == 0)
+            {
+                DeleteFileW((bodyDir + L"\\" + name).c_str());
+            }
+        });
+        EvictLocked();
+    }
+
+    std::optional<DiskCache::Meta> DiskCache::LookupMeta(std::wstring const& url)
+    {
+        if (!m_enabled)
+        {
+            return std::nullopt;
+        }
+        std::wstring const key = Sha256Hex(url);
+        {
+            std::lock_guard lock(m_lock);
+            auto it = m_index.find(key);
+            if (it == m_index.end())
+            {
+                return std::nullopt;
+            }
+            m_lru.splice(m_lru.begin(), m_lru, it->second);
+        }
+        auto stored = ReadMetaFile(MetaPath(key));
+        if (!stored || stored->url != url)
+        {
+            return std::nullopt;
+        }
+        return stored->meta;
+    }
+
+    IBuffer DiskCache::MapBody(std::wstring const& bodyHash)
+    {
+        HANDLE file = CreateFileW(BodyPath(bodyHash).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return nullptr;
+        }
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0 || size.QuadPart > kMaxEntryBytes)
+        {
+            CloseHandle(file);
+            return nullptr;
+        }
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file); // the mapping keeps the file open
+        if (!mapping)
+        {
+            return nullptr;
+        }
+        auto view = static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!view)
+        {
+            CloseHandle(mapping);
+            return nullptr;
+        }
+        return winrt::make<MappedBuffer>(mapping, view, static_cast<uint32_t>(size.QuadPart));
+    }
+
+    IBuffer DiskCache::TryGetFresh(std::wstring const& url)
+    {
+        auto meta = LookupMeta(url);
+        if (!meta || meta->expiresAt <= UnixNow())
+        {
+            return nullptr;
+        }
+        return MapBody(meta->bodyHash);
+    }
+
+    void DiskCache::Store(std::wstring const& url, IBuffer const& body, Meta meta)
+    {
+        if (!m_enabled || !body || body.Length() == 0 || body.Length() > kMaxEntryBytes)
+        {
+            return;
+        }
+        try
+        {
+            meta.bodyHash = Sha256Hex(body);
+            std::wstring const key = Sha256Hex(url);
+            uint8_t* bytes = nullptr;
+            check_hresult(body.as<::Windows::Storage::Streams::IBufferByteAccess>()->Buffer(&bytes));
+            bool haveBody = false;
+            {
+                std::lock_guard lock(m_lock);
+                if (body.Length() > m_capacity)
+                {
+                    return;
+                }
+                // Held across the write so eviction can't delete the body before the entry links it
+                auto [it, inserted] = m_bodies.try_emplace(meta.bodyHash, Body{ body.Length(), 0 });
+                ++it->second.refs;
+                if (inserted)
+                {
+                    m_bytes += body.Length();
+                }
+                haveBody = !inserted;
+            }
+            bool const written = haveBody || WriteWholeFile(BodyPath(meta.bodyHash), bytes, body.Length());
+            std::lock_guard lock(m_lock);
+            if (written)
+            {
+                WriteMetaLocked(key, url, meta);
+                LinkLocked(key, meta.bodyHash);
+            }
+            ReleaseBodyLocked(meta.bodyHash);
+            EvictLocked();
+        }
+        catch (...)
+        {
+            trace::Log(L"DiskCache: store failed");
+        }
+    }
+
+    void DiskCache::UpdateFreshness(std::wstring const& url, int64_t expiresAt)
+    {
+        if (auto meta = LookupMeta(url))
+        {
+            meta->expiresAt = expiresAt;
+            std::wstring const key = Sha256Hex(url);
+            std::lock_guard lock(m_lock);
+            if (m_index.count(key) != 0) // not evicted since the lookup
+            {
+                WriteMetaLocked(key, url, *meta);
+            }
+        }
+    }
+
+    void DiskCache::WriteMetaLocked(std::wstring const& key, std::wstring const& url, Meta const& meta)
+    {
+        std::wostringstream text;
+        text << url << L'\n' << meta.bodyHash << L'\n' << meta.etag << L'\n' << meta.lastModified << L'\n' << meta.expiresAt << L'\n';
+        std::string utf8 = winrt::to_string(text.str());
+        WriteWholeFile(MetaPath(key), reinterpret_cast<uint8_t const*>(utf8.data()), static_cast<uint32_t>(utf8.size()));
+    }
+
+    // Point key's entry at bodyHash (taking a reference) and make it the most recently used
+    void DiskCache::LinkLocked(std::wstring const& key, std::wstring const& bodyHash)
+    {
+        ++m_bodies.at(bodyHash).refs;
+        if (auto it = m_index.find(key); it != m_index.end())
+        {
+            std::wstring previous = std::exchange(it->second->bodyHash, bodyHash);
+            m_lru.splice(m_lru.begin(), m_lru, it->second);
+            ReleaseBodyLocked(previous);
+            return;
+        }
+        m_lru.push_front({ key, bodyHash });
+        m_index[key] = m_lru.begin();
+    }
+
+    void DiskCache::ReleaseBodyLocked(std::wstring const& bodyHash)
+    {
+        auto it = m_bodies.find(bodyHash);
+        if (it == m_bodies.end() || --it->second.refs > 0)
+        {
+            return;
+        }
+        // A body still mapped by a live IBuffer may refuse; the next LoadIndexLocked removes it as an orphan.
+        DeleteFileW(BodyPath(bodyHash).c_str());
+        m_bytes -= it->second.bytes;
+        m_bodies.erase(it);
+    }
+
+    void DiskCache::EvictLocked()
+    {
+        while (m_bytes > m_capacity && !m_lru.empty())
+        {
+            IndexEntry victim = std::move(m_lru.back());
+            m_lru.pop_back();
+            m_index.erase(victim.key);
+            DeleteFileW(MetaPath(victim.key).c_str());
+            ReleaseBodyLocked(victim.bodyHash);
+        }
+    }
+}
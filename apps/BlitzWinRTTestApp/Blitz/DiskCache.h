@@ -0,0 +1,82 @@
+#pragma once
+
+#include <winrt/Windows.Storage.Streams.h>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace winrt::Blitz::implementation
+{
+    // Optional persistent response cache under <LocalCacheFolder>\BlitzCache, shared by all fetchers.
+    //   bodies\<sha256(body)>.bin  content-addressed bodies (identical responses stored once)
+    //   meta\<sha256(url)>.meta    url, body hash, validators and freshness deadline
+    // Bodies are served as read-only memory-mapped IBuffers, so a hit costs no copy on the way to the Host.
+    // An in-memory index (rebuilt from meta\ on enable, ordered by each entry's last store) keeps the bodies within
+    // a byte budget: least recently used entries are deleted past it, and a body goes with its last entry.
+    class DiskCache
+    {
+    public:
+        struct Meta
+        {
+            std::wstring bodyHash;
+            std::wstring etag;
+            std::wstring lastModified;
+            int64_t expiresAt{ 0 }; // unix seconds; 0 = always revalidate
+        };
+
+        static DiskCache& Instance();
+
+        // Resolves the cache directory on first enable; stays disabled if there is no LocalCacheFolder
+        // (e.g. unpackaged apps).
+        void SetEnabled(bool enabled);
+        bool Enabled() const { return m_enabled.load(); }
+        void SetCapacity(uint64_t bytes);
+
+        std::optional<Meta> LookupMeta(std::wstring const& url);
+        winrt::Windows::Storage::Streams::IBuffer MapBody(std::wstring const& bodyHash);
+        // Fresh body for url (expiresAt in the future), or nullptr.
+        winrt::Windows::Storage::Streams::IBuffer TryGetFresh(std::wstring const& url);
+
+        void Store(std::wstring const& url, winrt::Windows::Storage::Streams::IBuffer const& body, Meta meta);
+        // A 304 extends freshness without rewriting the body.
+        void UpdateFreshness(std::wstring const& url, int64_t expiresAt);
+
+        static constexpr uint32_t kMaxEntryBytes = 16 * 1024 * 1024;
+
+    private:
+        struct IndexEntry
+        {
+            std::wstring key; // sha256(url), the meta file name
+            std::wstring bodyHash;
+        };
+        struct Body
+        {
+            uint64_t bytes;
+            uint32_t refs; // index entries (and stores in progress) using it
+        };
+
+        DiskCache() = default;
+        std::wstring MetaPath(std::wstring const& key) const;
+        std::wstring BodyPath(std::wstring const& bodyHash) const;
+        void WriteMetaLocked(std::wstring const& key, std::wstring const& url, Meta const& meta);
+        void LoadIndexLocked();
+        void LinkLocked(std::wstring const& key, std::wstring const& bodyHash);
+        void ReleaseBodyLocked(std::wstring const& bodyHash);
+        void EvictLocked();
+
+        std::mutex m_lock; // guards the index and serializes meta writes and deletions
+        std::wstring m_root; // set once, before m_enabled first becomes true
+        std::atomic<bool> m_enabled{ false };
+        std::list<IndexEntry> m_lru; // front = most recently used
+        std::unordered_map<std::wstring, std::list<IndexEntry>::iterator> m_index;
+        std::unordered_map<std::wstring, Body> m_bodies;
+        uint64_t m_bytes{ 0 };
+        uint64_t m_capacity{ 256ull * 1024 * 1024 };
+    };
+
+    int64_t UnixNow();
+}
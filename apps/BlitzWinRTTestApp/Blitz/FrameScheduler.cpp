@@ -0,0 +1,36 @@
+#include "pch.h"
+#include "FrameScheduler.h"
+#if __has_include("FrameScheduler.g.cpp")
+#include "FrameScheduler.g.cpp"
+#endif
+
+using namespace winrt;
+
+namespace winrt::Blitz::implementation
+{
+    FrameScheduler::FrameScheduler(winrt::Blitz::BlitzView const& view)
+        : m_view(view), m_dispatcher(view.DispatcherQueue())
+    {
+    }
+
+    void FrameScheduler::RequestFrame()
+    {
+        // Usually called by the Rust host on the UI thread (from inside a Host method) when the document becomes
+        // dirty. Device-lost recovery wakes every Host from whichever thread saw the loss; hop to the UI thread.
+        if (m_dispatcher && !m_dispatcher.HasThreadAccess())
+        {
+            m_dispatcher.TryEnqueue([weak = m_view]()
+            {
+                if (auto view = weak.get())
+                {
+                    get_self<implementation::BlitzView>(view)->RequestFrame();
+                }
+            });
+            return;
+        }
+        if (auto view = m_view.get())
+        {
+            get_self<implementation::BlitzView>(view)->RequestFrame();
+        }
+    }
+}
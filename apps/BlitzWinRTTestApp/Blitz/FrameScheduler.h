@@ -0,0 +1,26 @@
+#pragma once
+
+#include "FrameScheduler.g.h"
+#include <winrt/BlitzWinUI.h>
+
+namespace winrt::Blitz::implementation
+{
+    struct FrameScheduler : FrameSchedulerT<FrameScheduler>
+    {
+        FrameScheduler(winrt::Blitz::BlitzView const& view);
+
+        // BlitzWinUI.IFrameScheduler implementation
+        void RequestFrame();
+
+    private:
+        winrt::weak_ref<winrt::Blitz::BlitzView> m_view;
+        winrt::Microsoft::UI::Dispatching::DispatcherQueue m_dispatcher{ nullptr };
+    };
+}
+
+namespace winrt::Blitz::factory_implementation
+{
+    struct FrameScheduler : FrameSchedulerT<FrameScheduler, implementation::FrameScheduler>
+    {
+    };
+}
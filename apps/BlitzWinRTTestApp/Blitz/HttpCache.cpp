@@ -0,0 +1,94 @@
+#include "pch.h"
+#include "HttpCache.h"
+#include <winrt/Windows.Web.Http.Filters.h>
+
+using namespace winrt::Windows::Web::Http;
+using namespace winrt::Windows::Web::Http::Filters;
+
+namespace winrt::Blitz::implementation
+{
+    HttpCache& HttpCache::Instance()
+    {
+        static HttpCache instance;
+        return instance;
+    }
+
+    HttpCache::HttpCache()
+    {
+        // This LRU sits in front of the OS HTTP cache, which keeps its default behavior: responses the LRU refuses
+        // (over MaxEntryBytes, or without validators) still load from it on repeat visits. A revalidation sent from
+        // here may come back as the OS cache's 200 instead of a 304; the fetcher then stores it as a new body.
+        HttpBaseProtocolFilter filter;
+        filter.CacheControl().ReadBehavior(HttpCacheReadBehavior::Default);
+        filter.CacheControl().WriteBehavior(HttpCacheWriteBehavior::Default);
+        m_client = HttpClient(filter);
+    }
+
+    std::optional<HttpCache::Entry> HttpCache::Lookup(std::wstring const& url)
+    {
+        std::lock_guard lock(m_lock);
+        auto it = m_index.find(url);
+        if (it == m_index.end())
+        {
+            return std::nullopt;
+        }
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return it->second->second;
+    }
+
+    void HttpCache::Store(std::wstring const& url, Entry entry)
+    {
+        uint64_t size = entry.body ? entry.body.Length() : 0;
+        if (!entry.body || size > MaxEntryBytes())
+        {
+            return;
+        }
+        std::lock_guard lock(m_lock);
+        if (auto it = m_index.find(url); it != m_index.end())
+        {
+            m_bytes -= it->second->second.body.Length();
+            m_lru.erase(it->second);
+            m_index.erase(it);
+        }
+        m_lru.emplace_front(url, std::move(entry));
+        m_index[url] = m_lru.begin();
+        m_bytes += size;
+        EvictLocked();
+    }
+
+    void HttpCache::Remove(std::wstring const& url)
+    {
+        std::lock_guard lock(m_lock);
+        if (auto it = m_index.find(url); it != m_index.end())
+        {
+            m_bytes -= it->second->second.body.Length();
+            m_lru.erase(it->second);
+            m_index.erase(it);
+        }
+    }
+
+    void HttpCache::SetCapacity(uint64_t bytes)
+    {
+        std::lock_guard lock(m_lock);
+        m_capacity = bytes;
+        EvictLocked();
+    }
+
+    void HttpCache::EvictLocked()
+    {
+        while (m_bytes > m_capacity && !m_lru.empty())
+        {
+            auto& victim = m_lru.back();
+            m_bytes -= victim.second.body.Length();
+            m_index.erase(victim.first);
+            m_lru.pop_back();
+            ++m_evictions;
+        }
+    }
+
+    HttpCache::Stats HttpCache::GetStats()
+    {
+        std::lock_guard lock(m_lock);
+        return Stats{ m_hits.load(), m_misses.load(), m_bytesServed.load(), m_bytes, m_evictions, static_cast<uint32_t>(m_index.size()) };
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <winrt/Windows.Web.Http.h>
+#include <winrt/Windows.Storage.Streams.h>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace winrt::Blitz::implementation
+{
+    // Process-wide HTTP state shared by every NetworkFetcher (one per BlitzView): a single HttpClient (one
+    // connection pool) and a size-bounded in-memory LRU of response bodies keyed by URL. Entries within their
+    // max-age are served directly; stale ones are revalidated with a conditional GET (ETag / Last-Modified) and a
+    // 304 serves the cached body. DiskCache optionally persists the same entries across runs.
+    class HttpCache
+    {
+    public:
+        struct Entry
+        {
+            winrt::Windows::Storage::Streams::IBuffer body{ nullptr }; // never written after insertion
+            winrt::hstring etag;
+            winrt::hstring lastModified;
+            int64_t expiresAt{ 0 }; // unix seconds from Cache-Control max-age; while in the future no revalidation
+        };
+
+        struct Stats
+        {
+            uint64_t hits;         // served from cache (fresh, or after a 304)
+            uint64_t misses;       // fetched from the network (no entry, or entry changed)
+            uint64_t bytesServed;  // body bytes delivered from cache
+            uint64_t bytesCached;  // current size of all cached bodies
+            uint64_t evictions;
+            uint32_t entries;
+        };
+
+        static HttpCache& Instance();
+
+        winrt::Windows::Web::Http::HttpClient Client() const { return m_client; }
+
+        // Returns the entry (and marks it most recently used) if present.
+        std::optional<Entry> Lookup(std::wstring const& url);
+        // Inserts or replaces; bodies larger than MaxEntryBytes() are ignored.
+        void Store(std::wstring const& url, Entry entry);
+        void Remove(std::wstring const& url);
+
+        void RecordHit(uint64_t bytes) { ++m_hits; m_bytesServed += bytes; }
+        void RecordMiss() { ++m_misses; }
+
+        void SetCapacity(uint64_t bytes);
+        uint64_t MaxEntryBytes() const { return m_capacity / 8; }
+        Stats GetStats();
+
+    private:
+        HttpCache();
+        void EvictLocked();
+
+        winrt::Windows::Web::Http::HttpClient m_client{ nullptr };
+
+        std::mutex m_lock;
+        std::list<std::pair<std::wstring, Entry>> m_lru; // front = most recently used
+        std::unordered_map<std::wstring, std::list<std::pair<std::wstring, Entry>>::iterator> m_index;
+        uint64_t m_bytes{ 0 };
+        uint64_t m_capacity{ 32ull * 1024 * 1024 };
+        uint64_t m_evictions{ 0 };
+
+        std::atomic<uint64_t> m_hits{ 0 };
+        std::atomic<uint64_t> m_misses{ 0 };
+        std::atomic<uint64_t> m_bytesServed{ 0 };
+    };
+}
@@ -1,8 +1,13 @@
 #include "pch.h"
 #include "NetworkFetcher.h"
+#include "HttpCache.h"
+#include "DiskCache.h"
+#include "BlitzTrace.h"
 #if __has_include("NetworkFetcher.g.cpp")
 #include "NetworkFetcher.g.cpp"
 #endif
+#include <algorithm>
+#include <optional>
 #include <string>
 #include <vector>
 #include <windows.h>
@@ -14,11 +19,112 @@ using namespace winrt::Windows::Web::Http;
 
 namespace
 {
-    void LogUrl(winrt::hstring const& url)
+    // In-flight caps: the per-origin limit matches what browsers use for HTTP/1.1 connections.
+    constexpr uint32_t kMaxInflight = 16;
+    constexpr uint32_t kMaxInflightPerOrigin = 6;
+
+    // HttpFetch ETW activity for one DoFetch: started on construction, stopped with the recorded outcome when the
+    // coroutine finishes (every co_return included). "cancelled" unless an outcome was set.
+    struct FetchActivity
     {
-        std::wstring_view v = url;
-        std::wstring line = L"[Fetch] URL '" + std::wstring(v) + L"' (len=" + std::to_wstring(v.size()) + L")\n";
-        OutputDebugStringW(line.c_str());
+        GUID id;
+        uint32_t requestId;
+        char const* outcome = "cancelled";
+        uint64_t bytes = 0;
+        winrt::hstring error;
+
+        FetchActivity(uint32_t requestId, uint32_t docId, winrt::hstring const& url) noexcept
+            : id(winrt::Blitz::implementation::trace::NewActivityId()), requestId(requestId)
+        {
+            TraceLoggingWriteActivity(g_blitzTraceProvider, "HttpFetch", &id, nullptr,
+                TraceLoggingOpcode(WINEVENT_OPCODE_START),
+                TraceLoggingLevel(WINEVENT_LEVEL_INFO),
+                TraceLoggingUInt32(requestId, "RequestId"),
+                TraceLoggingUInt32(docId, "DocId"),
+                TraceLoggingWideString(url.c_str(), "Url"));
+        }
+        ~FetchActivity()
+        {
+            TraceLoggingWriteActivity(g_blitzTraceProvider, "HttpFetch", &id, nullptr,
+                TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+                TraceLoggingLevel(WINEVENT_LEVEL_INFO),
+                TraceLoggingUInt32(requestId, "RequestId"),
+                TraceLoggingString(outcome, "Outcome"),
+                TraceLoggingUInt64(bytes, "Bytes"),
+                TraceLoggingWideString(error.c_str(), "Error"));
+        }
+        void Complete(char const* result, uint64_t length) noexcept
+        {
+            outcome = result;
+            bytes = length;
+        }
+        void Fail(winrt::hstring const& message) noexcept
+        {
+            outcome = "failed";
+            error = message;
+        }
+    };
+
+    // Freshness deadline from Cache-Control (max-age, no-cache); 0 means the entry must be revalidated before use.
+    int64_t ExpiresAt(HttpResponseMessage const& response)
+    {
+        auto headers = response.Headers();
+        if (!headers.HasKey(L"Cache-Control"))
+        {
+            return 0;
+        }
+        std::wstring cacheControl{ headers.Lookup(L"Cache-Control") };
+        if (cacheControl.find(L"no-cache") != std::wstring::npos)
+        {
+            return 0;
+        }
+        size_t pos = cacheControl.find(L"max-age=");
+        if (pos == std::wstring::npos)
+        {
+            return 0;
+        }
+        int64_t maxAge = _wtoi64(cacheControl.c_str() + pos + 8);
+        return maxAge > 0 ? UnixNow() + maxAge : 0;
+    }
+
+    // Validators make a response revalidatable and max-age makes it servable without a request; with neither
+    // (or with no-store) it is not cached.
+    HttpCache::Entry CacheValidators(HttpResponseMessage const& response)
+    {
+        HttpCache::Entry entry;
+        auto headers = response.Headers();
+        if (headers.HasKey(L"Cache-Control"))
+        {
+            winrt::hstring cacheControl = headers.Lookup(L"Cache-Control");
+            if (std::wstring_view(cacheControl).find(L"no-store") != std::wstring_view::npos)
+            {
+                return entry;
+            }
+        }
+        entry.expiresAt = ExpiresAt(response);
+        if (headers.HasKey(L"ETag"))
+        {
+            entry.etag = headers.Lookup(L"ETag");
+        }
+        auto contentHeaders = response.Content().Headers();
+        if (contentHeaders.HasKey(L"Last-Modified"))
+        {
+            entry.lastModified = contentHeaders.Lookup(L"Last-Modified");
+        }
+        return entry;
+    }
+
+    std::wstring OriginOf(winrt::hstring const& url)
+    {
+        try
+        {
+            Uri uri(url);
+            return std::wstring(uri.SchemeName()) + L"://" + std::wstring(uri.Host()) + L":" + std::to_wstring(uri.Port());
+        }
+        catch (...)
+        {
+            return std::wstring(url); // DoFetch reports the bad URL
+        }
     }
 }
 
@@ -27,43 +133,311 @@ namespace winrt::Blitz::implementation
     NetworkFetcher::NetworkFetcher(winrt::BlitzWinUI::Host const& host)
         : m_host(host)
     {
-        m_client = HttpClient();
+        m_client = HttpCache::Instance().Client(); // one connection pool for every view
     }
 
     void NetworkFetcher::Fetch(uint32_t requestId, uint32_t docId, winrt::hstring const& url, winrt::hstring const& method)
     {
-        auto urlCopy = url; (void)method; // only GET for now
-        DoFetch(requestId, docId, std::move(urlCopy), L"GET");
+        Fetch(requestId, docId, url, method, L"None");
     }
 
-    winrt::fire_and_forget NetworkFetcher::DoFetch(uint32_t requestId, uint32_t docId, winrt::hstring url, winrt::hstring method)
+    void NetworkFetcher::Fetch(uint32_t requestId, uint32_t docId, winrt::hstring const& url, winrt::hstring const& method, winrt::hstring const& kind)
+    {
+        (void)method; // only GET for now
+        Priority priority = Priority::VisibleImage;
+        if (kind == L"Css" || kind == L"Navigation") priority = Priority::Stylesheet;
+        else if (kind == L"Font") priority = Priority::Font;
+        else if (kind == L"OffscreenImage") priority = Priority::OffscreenImage;
+        {
+            std::lock_guard lock(m_queueLock);
+            m_queues[static_cast<size_t>(priority)].push_back(PendingFetch{ requestId, docId, url, OriginOf(url), priority });
+        }
+        Pump();
+    }
+
+    void NetworkFetcher::Cancel(uint32_t requestId)
+    {
+        IAsyncInfo operation{ nullptr };
+        {
+            std::lock_guard lock(m_queueLock);
+            for (auto& queue : m_queues)
+            {
+                auto it = std::find_if(queue.begin(), queue.end(), [&](PendingFetch const& p) { return p.requestId == requestId; });
+                if (it != queue.end())
+                {
+                    queue.erase(it);
+                    return;
+                }
+            }
+            auto inflight = m_inflightRequests.find(requestId);
+            if (inflight == m_inflightRequests.end())
+            {
+                return;
+            }
+            inflight->second.cancelled = true;
+            operation = inflight->second.operation;
+        }
+        if (operation)
+        {
+            operation.Cancel(); // outside the lock: completion handlers may run synchronously
+        }
+    }
+
+    void NetworkFetcher::CancelDocument(uint32_t docId)
+    {
+        std::vector<IAsyncInfo> operations;
+        {
+            std::lock_guard lock(m_queueLock);
+            for (auto& queue : m_queues)
+            {
+                auto end = std::remove_if(queue.begin(), queue.end(), [&](PendingFetch const& p) { return p.docId == docId; });
+                queue.erase(end, queue.end());
+            }
+            for (auto& [id, inflight] : m_inflightRequests)
+            {
+                if (inflight.docId != docId || inflight.cancelled)
+                {
+                    continue;
+                }
+                inflight.cancelled = true;
+                if (inflight.operation)
+                {
+                    operations.push_back(inflight.operation);
+                }
+            }
+        }
+        for (auto& operation : operations)
+        {
+            operation.Cancel();
+        }
+    }
+
+    uint64_t NetworkFetcher::CacheHits() { return HttpCache::Instance().GetStats().hits; }
+    uint64_t NetworkFetcher::CacheMisses() { return HttpCache::Instance().GetStats().misses; }
+    uint64_t NetworkFetcher::CacheBytesServed() { return HttpCache::Instance().GetStats().bytesServed; }
+    uint64_t NetworkFetcher::CacheBytes() { return HttpCache::Instance().GetStats().bytesCached; }
+    uint64_t NetworkFetcher::CacheEvictions() { return HttpCache::Instance().GetStats().evictions; }
+    uint32_t NetworkFetcher::CacheEntries() { return HttpCache::Instance().GetStats().entries; }
+    void NetworkFetcher::SetCacheCapacity(uint64_t bytes) { HttpCache::Instance().SetCapacity(bytes); }
+    void NetworkFetcher::SetDiskCacheEnabled(bool enabled) { DiskCache::Instance().SetEnabled(enabled); }
+    void NetworkFetcher::SetDiskCacheCapacity(uint64_t bytes) { DiskCache::Instance().SetCapacity(bytes); }
+
+    // Called synchronously by the host before it issues a request. Only fresh entries qualify (no network, no
+    // revalidation), so the body can be applied before the first layout. Stale entries go through Fetch.
+    winrt::Windows::Foundation::IInspectable NetworkFetcher::TryGetCached(winrt::hstring const& url)
     {
-        auto lifetime = get_strong(); (void)method;
-        LogUrl(url);
         try
         {
-            Uri uri(url);
-            HttpResponseMessage response = co_await m_client.GetAsync(uri);
+            auto& cache = HttpCache::Instance();
+            std::wstring const key{ url };
+            IBuffer body{ nullptr };
+            if (auto cached = cache.Lookup(key); cached && cached->expiresAt > UnixNow())
+            {
+                body = cached->body;
+            }
+            else if (!cached)
+            {
+                body = DiskCache::Instance().TryGetFresh(key);
+            }
+            if (!body)
+            {
+                return nullptr;
+            }
+            cache.RecordHit(body.Length());
+            return body;
+        }
+        catch (...)
+        {
+            return nullptr; // fall back to a normal fetch
+        }
+    }
+
+    bool NetworkFetcher::Track(uint32_t requestId, IAsyncInfo const& operation)
+    {
+        {
+            std::lock_guard lock(m_queueLock);
+            auto it = m_inflightRequests.find(requestId);
+            if (it != m_inflightRequests.end() && !it->second.cancelled)
+            {
+                it->second.operation = operation;
+                return true;
+            }
+        }
+        operation.Cancel();
+        return false;
+    }
+
+    bool NetworkFetcher::IsCancelled(uint32_t requestId)
+    {
+        std::lock_guard lock(m_queueLock);
+        auto it = m_inflightRequests.find(requestId);
+        return it == m_inflightRequests.end() || it->second.cancelled;
+    }
+
+    // Start as many queued requests as the caps allow, highest priority first. A saturated origin does not block
+    // requests to other origins queued behind it.
+    void NetworkFetcher::Pump()
+    {
+        std::vector<PendingFetch> ready;
+        {
+            std::lock_guard lock(m_queueLock);
+            for (auto& queue : m_queues)
+            {
+                for (auto it = queue.begin(); it != queue.end() && m_inflight < kMaxInflight;)
+                {
+                    uint32_t& perOrigin = m_inflightPerOrigin[it->origin];
+                    if (perOrigin >= kMaxInflightPerOrigin)
+                    {
+                        ++it;
+                        continue;
+                    }
+                    ++perOrigin;
+                    ++m_inflight;
+                    m_inflightRequests[it->requestId] = InflightFetch{ it->docId };
+                    ready.push_back(std::move(*it));
+                    it = queue.erase(it);
+                }
+            }
+        }
+        for (auto& request : ready)
+        {
+            DoFetch(std::move(request));
+        }
+    }
+
+    NetworkFetcher::InflightSlot::~InflightSlot()
+    {
+        {
+            std::lock_guard lock(owner->m_queueLock);
+            --owner->m_inflight;
+            owner->m_inflightRequests.erase(requestId);
+            auto it = owner->m_inflightPerOrigin.find(origin);
+            if (it != owner->m_inflightPerOrigin.end() && --it->second == 0)
+            {
+                owner->m_inflightPerOrigin.erase(it);
+            }
+        }
+        try
+        {
+            owner->Pump();
+        }
+        catch (...)
+        {
+            trace::Log(L"NetworkFetcher: Pump failed after completion");
+        }
+    }
+
+    winrt::fire_and_forget NetworkFetcher::DoFetch(PendingFetch request)
+    {
+        auto lifetime = get_strong();
+        InflightSlot slot{ this, request.requestId, request.origin }; // declared after lifetime so it is released first
+        uint32_t const requestId = request.requestId;
+        uint32_t const docId = request.docId;
+        FetchActivity activity{ requestId, docId, request.url };
+        try
+        {
+            Uri uri(request.url);
+            auto& cache = HttpCache::Instance();
+            std::wstring const cacheKey{ request.url };
+            auto& disk = DiskCache::Instance();
+            auto cached = cache.Lookup(cacheKey);
+            std::optional<DiskCache::Meta> diskMeta;
+            if (!cached)
+            {
+                // Promote a persisted entry; its body stays memory-mapped until first needed.
+                diskMeta = disk.LookupMeta(cacheKey);
+                if (diskMeta)
+                {
+                    if (IBuffer body = disk.MapBody(diskMeta->bodyHash))
+                    {
+                        cached = HttpCache::Entry{ body, winrt::hstring(diskMeta->etag), winrt::hstring(diskMeta->lastModified), diskMeta->expiresAt };
+                    }
+                }
+            }
+            if (cached && cached->expiresAt > UnixNow())
+            {
+                cache.RecordHit(cached->body.Length());
+                if (diskMeta)
+                {
+                    cache.Store(cacheKey, *cached);
+                }
+                if (m_host)
+                {
+                    m_host.CompleteFetchBuffer(requestId, docId, cached->body);
+                }
+                activity.Complete("cached", cached->body.Length());
+                co_return;
+            }
+            HttpRequestMessage message(HttpMethod::Get(), uri);
+            if (cached)
+            {
+                if (!cached->etag.empty()) message.Headers().TryAppendWithoutValidation(L"If-None-Match", cached->etag);
+                if (!cached->lastModified.empty()) message.Headers().TryAppendWithoutValidation(L"If-Modified-Since", cached->lastModified);
+            }
+            // Return as soon as headers are in so cacheability is known before the body is read.
+            auto getOp = m_client.SendRequestAsync(message, HttpCompletionOption::ResponseHeadersRead);
+            if (!Track(requestId, getOp))
+            {
+                co_return;
+            }
+            HttpResponseMessage response = co_await getOp;
+            if (cached && response.StatusCode() == HttpStatusCode::NotModified)
+            {
+                cache.RecordHit(cached->body.Length());
+                // The 304 may carry a new max-age; keep both tiers in step.
+                cached->expiresAt = ExpiresAt(response);
+                cache.Store(cacheKey, *cached);
+                disk.UpdateFreshness(cacheKey, cached->expiresAt);
+                if (m_host)
+                {
+                    m_host.CompleteFetchBuffer(requestId, docId, cached->body); // shared, read-only
+                }
+                activity.Complete("not-modified", cached->body.Length());
+                co_return;
+            }
             response.EnsureSuccessStatusCode();
-            IBuffer buffer = co_await response.Content().ReadAsBufferAsync();
-            DataReader reader = DataReader::FromBuffer(buffer);
-            std::vector<uint8_t> bytes(buffer.Length());
-            reader.ReadBytes(bytes);
-            if (m_host)
+            cache.RecordMiss();
+            IHttpContent content = response.Content();
+            auto headers = content.Headers();
+            uint64_t contentLength = headers.ContentLength() ? headers.ContentLength().Value() : 0;
+            if (!m_host)
             {
-                m_host.CompleteFetch(requestId, docId, true, bytes, L"");
+                co_return;
             }
+            HttpCache::Entry entry = CacheValidators(response);
+            bool const cacheable = (!entry.etag.empty() || !entry.lastModified.empty() || entry.expiresAt > 0)
+                && contentLength > 0 && contentLength <= cache.MaxEntryBytes();
+            if (cached && !cacheable)
+            {
+                cache.Remove(cacheKey);
+            }
+            auto readOp = content.ReadAsBufferAsync();
+            if (!Track(requestId, readOp))
+            {
+                co_return;
+            }
+            IBuffer buffer = co_await readOp;
+            if (cacheable)
+            {
+                entry.body = buffer;
+                disk.Store(cacheKey, buffer, DiskCache::Meta{ {}, std::wstring(entry.etag), std::wstring(entry.lastModified), entry.expiresAt });
+                cache.Store(cacheKey, std::move(entry));
+            }
+            // Hand the buffer over as-is; the host reads it in place (no DataReader/vector copy).
+            m_host.CompleteFetchBuffer(requestId, docId, buffer);
+            activity.Complete("network", buffer.Length());
         }
         catch (hresult_error const& e)
         {
+            if (IsCancelled(requestId))
+            {
+                co_return; // the host already dropped this request
+            }
             if (m_host)
             {
                 m_host.CompleteFetch(requestId, docId, false, {}, e.message());
             }
-            std::wstring msg = L"[Fetch] FAILED: ";
-            msg += e.message().c_str();
-            msg += L"\n";
-            OutputDebugStringW(msg.c_str());
+            activity.Fail(e.message());
         }
         co_return;
     }
@@ -4,7 +4,13 @@
 #include <winrt/BlitzWinUI.h>
 // Use dot-delimited C++/WinRT projection headers (directory style path was invalid)
 #include <winrt/Windows.Web.Http.h>
+#include <winrt/Windows.Web.Http.Headers.h>
 #include <winrt/Windows.Storage.Streams.h>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 namespace winrt::Blitz::implementation
 {
@@ -13,11 +19,67 @@ namespace winrt::Blitz::implementation
         NetworkFetcher(winrt::BlitzWinUI::Host const& host);
 
         void Fetch(uint32_t requestId, uint32_t docId, winrt::hstring const& url, winrt::hstring const& method);
+        void Fetch(uint32_t requestId, uint32_t docId, winrt::hstring const& url, winrt::hstring const& method, winrt::hstring const& kind);
+        // A queued request is dropped; an in-flight one has its current async operation cancelled and reports nothing.
+        void Cancel(uint32_t requestId);
+        void CancelDocument(uint32_t docId);
+
+        // Process-wide response cache counters (shared by all fetchers)
+        static uint64_t CacheHits();
+        static uint64_t CacheMisses();
+        static uint64_t CacheBytesServed();
+        static uint64_t CacheBytes();
+        static uint64_t CacheEvictions();
+        static uint32_t CacheEntries();
+        static void SetCacheCapacity(uint64_t bytes);
+        static void SetDiskCacheEnabled(bool enabled);
+        static void SetDiskCacheCapacity(uint64_t bytes);
+
+        // Fresh cached body for url (memory, then disk) or nullptr; never touches the network.
+        winrt::Windows::Foundation::IInspectable TryGetCached(winrt::hstring const& url);
     private:
+        // Scheduling classes, highest first. Render-blocking stylesheets go ahead of fonts, then images.
+        enum class Priority : uint8_t { Stylesheet, Font, VisibleImage, OffscreenImage, Count };
+
+        struct PendingFetch
+        {
+            uint32_t requestId;
+            uint32_t docId;
+            winrt::hstring url;
+            std::wstring origin;
+            Priority priority;
+        };
+
+        struct InflightFetch
+        {
+            uint32_t docId;
+            winrt::Windows::Foundation::IAsyncInfo operation{ nullptr }; // the await DoFetch is currently suspended on
+            bool cancelled{ false };
+        };
+
+        // Releases the in-flight slot when the fetch coroutine finishes (any exit path) and starts the next request.
+        struct InflightSlot
+        {
+            NetworkFetcher* owner;
+            uint32_t requestId;
+            std::wstring origin;
+            ~InflightSlot();
+        };
+
         winrt::BlitzWinUI::Host m_host{ nullptr };
-        winrt::Windows::Web::Http::HttpClient m_client{ nullptr };
+        winrt::Windows::Web::Http::HttpClient m_client{ nullptr }; // shared, see HttpCache
+
+        std::mutex m_queueLock; // Fetch runs on the caller thread, completions on the thread pool
+        std::array<std::deque<PendingFetch>, static_cast<size_t>(Priority::Count)> m_queues;
+        std::unordered_map<std::wstring, uint32_t> m_inflightPerOrigin;
+        uint32_t m_inflight{ 0 };
+        std::unordered_map<uint32_t, InflightFetch> m_inflightRequests;
 
-        winrt::fire_and_forget DoFetch(uint32_t requestId, uint32_t docId, winrt::hstring url, winrt::hstring method);
+        void Pump();
+        // Record the operation about to be awaited; false (and the operation is cancelled) if the request was cancelled.
+        bool Track(uint32_t requestId, winrt::Windows::Foundation::IAsyncInfo const& operation);
+        bool IsCancelled(uint32_t requestId);
+        winrt::fire_and_forget DoFetch(PendingFetch request);
     };
 }
 
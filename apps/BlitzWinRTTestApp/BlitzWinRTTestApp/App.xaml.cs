@@ -29,6 +29,10 @@ public partial class App : Application
 
     protected override void OnLaunched(LaunchActivatedEventArgs args)
     {
+        // Device, Direct2D/DirectWrite and font setup run on a background thread while the window is built.
+        BlitzWinUI.Host.Prewarm();
+        // Style and text shaping on a pool of layout threads sized for this machine.
+        BlitzWinUI.Host.SetWorkerThreads(0);
         _window = new MainWindow();
         _window.ExtendsContentIntoTitleBar = true;
         _window.AppWindow.TitleBar.PreferredHeightOption = TitleBarHeightOption.Tall;
@@ -0,0 +1,275 @@
+//! Headless rendering benchmarks.
+//!
+//! Loads the example pages (google.html, servo.html, the repository README through the readme app's markdown
+//! styles, and the WinUI test app's demo.html) and drives each through scripted sequences: the first frame after
+//! loading, scrolling down and back up, a hover sweep across the viewport, and a resize back and forth. Every
+//! frame resolves the document, paints it into an offscreen target (Direct2D on Windows, see target.rs) and is
+//! timed with the same phases as [`blitz_metrics::FrameTimings`] plus Present. The report gives p50/p99 per phase
+//! and scenario; `--json` writes it in a stable machine-readable form for release gating. `--threads` resolves
+//! with a pool of layout threads (see [`blitz_dom::set_layout_threads`]), to compare against the default of 1.
+//!
+//! Pages are loaded without a network provider, so external images, fonts and stylesheets are not fetched;
+//! results depend only on the markup in the tree.
+//!
+//! ```text
+//! cargo run --release --package bench -- [--frames N] [--threads N] [--json PATH] [--page NAME]...
+//! ```
+
+mod report;
+mod target;
+
+use std::path::{Path, PathBuf};
+use std::time::Instant;
+
+use blitz_dom::DocumentConfig;
+use blitz_html::HtmlDocument;
+use blitz_metrics::FrameTimings;
+use blitz_traits::shell::{ColorScheme, Viewport};
+
+use report::{Report, Sample};
+use target::OffscreenTarget;
+
+const WIDTH: u32 = 1280;
+const HEIGHT: u32 = 800;
+const DEFAULT_FRAMES: usize = 120;
+/// Pixels scrolled per frame in the scroll scenario
+const SCROLL_STEP: f64 = 40.0;
+
+const GITHUB_MD_STYLES: &str = include_str!("../../readme/assets/github-markdown.css");
+const BLITZ_MD_STYLES: &str = include_str!("../../readme/assets/blitz-markdown-overrides.css");
+
+struct Page {
+    name: &'static str,
+    path: &'static str,
+    markdown: bool,
+}
+
+const PAGES: &[Page] = &[
+    Page {
+        name: "google",
+        path: "examples/assets/google.html",
+        markdown: false,
+    },
+    Page {
+        name: "servo",
+        path: "examples/assets/servo.html",
+        markdown: false,
+    },
+    Page {
+        name: "readme",
+        path: "README.md",
+        markdown: true,
+    },
+    Page {
+        name: "demo",
+        path: "apps/BlitzWinRTTestApp/BlitzWinRTTestApp/Assets/demo.html",
+        markdown: false,
+    },
+];
+
+#[derive(Clone, Copy)]
+enum Scenario {
+    Load,
+    Scroll,
+    Hover,
+    Resize,
+}
+
+impl Scenario {
+    const ALL: [Scenario; 4] = [
+        Scenario::Load,
+        Scenario::Scroll,
+        Scenario::Hover,
+        Scenario::Resize,
+    ];
+
+    fn name(self) -> &'static str {
+        match self {
+            Scenario::Load => "load",
+            Scenario::Scroll => "scroll",
+            Scenario::Hover => "hover",
+            Scenario::Resize => "resize",
+        }
+    }
+}
+
+struct Options {
+    frames: usize,
+    threads: usize,
+    json: Option<PathBuf>,
+    pages: Vec<String>,
+}
+
+fn parse_args() -> Options {
+    let mut options = Options {
+        frames: DEFAULT_FRAMES,
+        threads: 1,
+        json: None,
+        pages: Vec::new(),
+    };
+    let mut args = std::env::args().skip(1);
+    while let Some(arg) = args.next() {
+        match arg.as_str() {
+            "--frames" => {
+                options.frames = args
+                    .next()
+                    .and_then(|n| n.parse().ok())
+                    .expect("--frames takes a number")
+            }
+            "--threads" => {
+                options.threads = args
+                    .next()
+                    .and_then(|n| n.parse().ok())
+                    .expect("--threads takes a number")
+            }
+            "--json" => options.json = Some(args.next().expect("--json takes a path").into()),
+            "--page" => options
+                .pages
+                .push(args.next().expect("--page takes a page name")),
+            other => panic!("unknown argument {other:?}"),
+        }
+    }
+    options
+}
+
+fn workspace_root() -> PathBuf {
+    Path::new(env!("CARGO_MANIFEST_DIR")).join("../..")
+}
+
+/// Same options and wrapper as the readme app (apps/readme/src/markdown/comrak.rs)
+fn markdown_to_html(markdown: &str) -> String {
+    let mut options = comrak::Options::default();
+    options.extension.strikethrough = true;
+    options.extension.table = true;
+    options.extension.autolink = true;
+    options.extension.tasklist = true;
+    options.extension.alerts = true;
+    options.render.unsafe_ = true;
+    options.render.tasklist_classes = true;
+    let body = comrak::markdown_to_html(markdown, &options).replace("\n</code", "</code");
+    format!("<!DOCTYPE html><html><body><div class=\"markdown-body\">{body}</div></body></html>")
+}
+
+fn load(page: &Page, width: u32, height: u32) -> HtmlDocument {
+    let path = workspace_root().join(page.path);
+    let source = std::fs::read_to_string(&path)
+        .unwrap_or_else(|e| panic!("reading {}: {e}", path.display()));
+    let mut config = DocumentConfig {
+        base_url: Some(format!("file://{}", path.display())),
+        ..Default::default()
+    };
+    let html = if page.markdown {
+        config.ua_stylesheets = Some(vec![
+            GITHUB_MD_STYLES.to_string(),
+            BLITZ_MD_STYLES.to_string(),
+        ]);
+        markdown_to_html(&source)
+    } else {
+        source
+    };
+    let mut doc = HtmlDocument::from_html(&html, config);
+    doc.set_viewport(Viewport::new(width, height, 1.0, ColorScheme::Light));
+    doc
+}
+
+/// Resolve, paint and present one frame; `start` is when its input was applied.
+fn frame(
+    doc: &mut HtmlDocument,
+    target: &mut OffscreenTarget,
+    size: (u32, u32),
+    start: Instant,
+) -> Sample {
+    doc.resolve();
+    let times = target.render(doc, size.0, size.1);
+    let mut timings: FrameTimings = blitz_metrics::take_frame_phases();
+    timings.playback_ms = times.playback_ms;
+    timings.frame_total_ms = start.elapsed().as_secs_f32() * 1000.0;
+    Sample {
+        timings,
+        present_ms: times.present_ms,
+    }
+}
+
+fn run(
+    page: &Page,
+    scenario: Scenario,
+    frames: usize,
+    target: &mut OffscreenTarget,
+) -> Vec<Sample> {
+    let mut size = (WIDTH, HEIGHT);
+    target.resize(size.0, size.1);
+    // Loading (parse included) is the first frame of every scenario; only the load scenario keeps it
+    blitz_metrics::take_frame_phases();
+    let start = Instant::now();
+    let mut doc = load(page, size.0, size.1);
+    let first = frame(&mut doc, target, size, start);
+    if let Scenario::Load = scenario {
+        // Each load frame is a fresh document
+        let mut samples = vec![first];
+        for _ in 1..frames {
+            let start = Instant::now();
+            let mut doc = load(page, size.0, size.1);
+            samples.push(frame(&mut doc, target, size, start));
+        }
+        return samples;
+    }
+
+    let mut samples = Vec::with_capacity(frames);
+    for i in 0..frames {
+        let start = Instant::now();
+        match scenario {
+            Scenario::Load => unreachable!(),
+            // Down for the first half, back up for the second
+            Scenario::Scroll => {
+                let dy = if i < frames / 2 {
+                    SCROLL_STEP
+                } else {
+                    -SCROLL_STEP
+                };
+                doc.scroll_viewport_by(0.0, dy);
+            }
+            // Diagonal sweep, wrapping around the viewport
+            Scenario::Hover => {
+                let t = (i as f32 * 17.0) % size.0 as f32;
+                doc.set_hover_to(t, (t * size.1 as f32 / size.0 as f32) % size.1 as f32);
+            }
+            // Narrow by 8 px per frame down to half width, then widen again
+            Scenario::Resize => {
+                let half = frames.max(2) / 2;
+                let steps = if i < half { i } else { frames - i };
+                size = (WIDTH - (steps as u32 * 8).min(WIDTH / 2), HEIGHT);
+                doc.set_viewport(Viewport::new(size.0, size.1, 1.0, ColorScheme::Light));
+                target.resize(size.0, size.1);
+            }
+        }
+        samples.push(frame(&mut doc, target, size, start));
+    }
+    samples
+}
+
+fn main() {
+    let options = parse_args();
+    blitz_dom::set_layout_threads(options.threads);
+    let mut target = OffscreenTarget::new(WIDTH, HEIGHT).expect("creating offscreen render target");
+    let mut report = Report::new(
+        OffscreenTarget::BACKEND,
+        blitz_dom::layout_threads(),
+        options.frames,
+        (WIDTH, HEIGHT),
+    );
+    for page in PAGES
+        .iter()
+        .filter(|p| options.pages.is_empty() || options.pages.iter().any(|n| n == p.name))
+    {
+        for scenario in Scenario::ALL {
+            let samples = run(page, scenario, options.frames, &mut target);
+            report.add(page.name, scenario.name(), &samples);
+        }
+    }
+    print!("{}", report.to_table());
+    if let Some(path) = options.json {
+        std::fs::write(&path, report.to_json())
+            .unwrap_or_else(|e| panic!("writing {}: {e}", path.display()));
+        println!("wrote {}", path.display());
+    }
+}
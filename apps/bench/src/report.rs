@@ -0,0 +1,146 @@
+//! Percentiles per phase, as a table for people and JSON for CI.
+//!
+//! The JSON layout is versioned; fields are only ever added:
+//!
+//! ```text
+//! {"version":1,"backend":"d2d","threads":1,"frames":120,"viewport":[1280,800],"results":[
+//!   {"page":"google","scenario":"scroll","frames":120,
+//!    "phases":{"parse":{"p50":0.0,"p99":0.0,"mean":0.0}, ..., "total":{...}}}]}
+//! ```
+
+use std::fmt::Write as _;
+
+use blitz_metrics::FrameTimings;
+
+/// One measured frame
+pub struct Sample {
+    pub timings: FrameTimings,
+    pub present_ms: f32,
+}
+
+const PHASES: [&str; 8] = [
+    "parse", "style", "layout", "shape", "scene", "playback", "present", "total",
+];
+
+fn phase(sample: &Sample, index: usize) -> f32 {
+    let t = &sample.timings;
+    match index {
+        0 => t.html_parse_ms,
+        1 => t.style_ms,
+        2 => t.layout_ms,
+        3 => t.text_shaping_ms,
+        4 => t.scene_build_ms,
+        5 => t.playback_ms,
+        6 => sample.present_ms,
+        _ => t.frame_total_ms,
+    }
+}
+
+#[derive(Clone, Copy, Default)]
+struct Summary {
+    p50: f32,
+    p99: f32,
+    mean: f32,
+}
+
+/// Nearest-rank percentiles, so every reported value is a frame that actually happened
+fn summarize(mut values: Vec<f32>) -> Summary {
+    if values.is_empty() {
+        return Summary::default();
+    }
+    values.sort_by(f32::total_cmp);
+    let rank =
+        |p: f32| values[((p * values.len() as f32).ceil() as usize).clamp(1, values.len()) - 1];
+    Summary {
+        p50: rank(0.50),
+        p99: rank(0.99),
+        mean: values.iter().sum::<f32>() / values.len() as f32,
+    }
+}
+
+struct Row {
+    page: &'static str,
+    scenario: &'static str,
+    frames: usize,
+    phases: [Summary; PHASES.len()],
+}
+
+pub struct Report {
+    backend: &'static str,
+    threads: usize,
+    frames: usize,
+    viewport: (u32, u32),
+    rows: Vec<Row>,
+}
+
+impl Report {
+    pub fn new(backend: &'static str, threads: usize, frames: usize, viewport: (u32, u32)) -> Self {
+        Self {
+            backend,
+            threads,
+            frames,
+            viewport,
+            rows: Vec::new(),
+        }
+    }
+
+    pub fn add(&mut self, page: &'static str, scenario: &'static str, samples: &[Sample]) {
+        let phases =
+            std::array::from_fn(|i| summarize(samples.iter().map(|s| phase(s, i)).collect()));
+        self.rows.push(Row {
+            page,
+            scenario,
+            frames: samples.len(),
+            phases,
+        });
+    }
+
+    pub fn to_table(&self) -> String {
+        let mut out = format!(
+            "backend {} | {} layout threads | {}x{} | p50 / p99 ms\n{:<8} {:<8}",
+            self.backend, self.threads, self.viewport.0, self.viewport.1, "page", "scenario"
+        );
+        for name in PHASES {
+            let _ = write!(out, " {name:>15}");
+        }
+        out.push('\n');
+        for row in &self.rows {
+            let _ = write!(out, "{:<8} {:<8}", row.page, row.scenario);
+            for s in &row.phases {
+                let _ = write!(out, " {:>15}", format!("{:.2} / {:.2}", s.p50, s.p99));
+            }
+            out.push('\n');
+        }
+        out
+    }
+
+    pub fn to_json(&self) -> String {
+        let mut out = format!(
+            "{{\"version\":1,\"backend\":\"{}\",\"threads\":{},\"frames\":{},\"viewport\":[{},{}],\"results\":[",
+            self.backend, self.threads, self.frames, self.viewport.0, self.viewport.1
+        );
+        for (i, row) in self.rows.iter().enumerate() {
+            if i > 0 {
+                out.push(',');
+            }
+            let _ = write!(
+                out,
+                "\n{{\"page\":\"{}\",\"scenario\":\"{}\",\"frames\":{},\"phases\":{{",
+                row.page, row.scenario, row.frames
+            );
+            for (j, (name, s)) in PHASES.iter().zip(&row.phases).enumerate() {
+                if j > 0 {
+                    out.push(',');
+                }
+                let _ = write!(
+                    out,
+                    "\"{name}\":{{\"p50\":{:.3},\"p99\":{:.3},\"mean\":{:.3}}}",
+                    s.p50, s.p99, s.mean
+                );
+            }
+            out.push_str("}}");
+        }
+        out.push_str("\n]}\n");
+        out
+    }
+}
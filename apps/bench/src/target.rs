@@ -0,0 +1,171 @@
+//! Render targets: where a resolved document is painted each frame.
+
+use std::time::Instant;
+
+/// What the target measured for one frame (the scene phase itself is recorded by blitz-paint)
+pub struct RenderTimes {
+    pub playback_ms: f32,
+    pub present_ms: f32,
+}
+
+#[cfg(not(windows))]
+pub use cpu::OffscreenTarget;
+#[cfg(windows)]
+pub use d2d::OffscreenTarget;
+
+fn ms_since(t: Instant) -> f32 {
+    t.elapsed().as_secs_f32() * 1000.0
+}
+
+/// Direct2D into a composition swapchain that is never attached to a visual: the same device, renderer and
+/// Present path as the WinUI host, without a window.
+#[cfg(windows)]
+mod d2d {
+    use super::{RenderTimes, ms_since};
+    use anyrender::WindowRenderer as _;
+    use anyrender_d2d::D2DWindowRenderer;
+    use blitz_dom::BaseDocument;
+    use blitz_paint::paint_scene_parallel;
+    use std::time::Instant;
+    use windows::Win32::Graphics::Direct3D::D3D_DRIVER_TYPE_HARDWARE;
+    use windows::Win32::Graphics::Direct3D11::{
+        D3D11_CREATE_DEVICE_BGRA_SUPPORT, D3D11_SDK_VERSION, D3D11CreateDevice, ID3D11Device,
+    };
+    use windows::Win32::Graphics::Dxgi::Common::{
+        DXGI_ALPHA_MODE_PREMULTIPLIED, DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_FORMAT_UNKNOWN,
+        DXGI_SAMPLE_DESC,
+    };
+    use windows::Win32::Graphics::Dxgi::{
+        CreateDXGIFactory2, DXGI_CREATE_FACTORY_FLAGS, DXGI_PRESENT, DXGI_SWAP_CHAIN_DESC1,
+        DXGI_SWAP_CHAIN_FLAG, DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL, DXGI_USAGE_RENDER_TARGET_OUTPUT,
+        IDXGIFactory2, IDXGISwapChain1,
+    };
+
+    pub struct OffscreenTarget {
+        renderer: D2DWindowRenderer,
+        swapchain: IDXGISwapChain1,
+    }
+
+    impl OffscreenTarget {
+        pub const BACKEND: &'static str = "d2d";
+
+        pub fn new(width: u32, height: u32) -> Result<Self, String> {
+            unsafe {
+                let mut device: Option<ID3D11Device> = None;
+                D3D11CreateDevice(
+                    None,
+                    D3D_DRIVER_TYPE_HARDWARE,
+                    None,
+                    D3D11_CREATE_DEVICE_BGRA_SUPPORT,
+                    None,
+                    D3D11_SDK_VERSION,
+                    Some(&mut device),
+                    None,
+                    None,
+                )
+                .map_err(|e| format!("D3D11CreateDevice failed: {e:?}"))?;
+                let device = device.ok_or("D3D11CreateDevice returned no device")?;
+                let factory: IDXGIFactory2 = CreateDXGIFactory2(DXGI_CREATE_FACTORY_FLAGS(0))
+                    .map_err(|e| format!("CreateDXGIFactory2 failed: {e:?}"))?;
+                let desc = DXGI_SWAP_CHAIN_DESC1 {
+                    Width: width,
+                    Height: height,
+                    Format: DXGI_FORMAT_B8G8R8A8_UNORM,
+                    SampleDesc: DXGI_SAMPLE_DESC {
+                        Count: 1,
+                        Quality: 0,
+                    },
+                    BufferUsage: DXGI_USAGE_RENDER_TARGET_OUTPUT,
+                    BufferCount: 2,
+                    SwapEffect: DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL,
+                    AlphaMode: DXGI_ALPHA_MODE_PREMULTIPLIED,
+                    ..Default::default()
+                };
+                let swapchain = factory
+                    .CreateSwapChainForComposition(&device, &desc, None)
+                    .map_err(|e| format!("CreateSwapChainForComposition failed: {e:?}"))?;
+                let mut renderer = D2DWindowRenderer::new();
+                renderer.set_swapchain(swapchain.clone(), width, height);
+                Ok(Self {
+                    renderer,
+                    swapchain,
+                })
+            }
+        }
+
+        pub fn resize(&mut self, width: u32, height: u32) {
+            self.renderer.set_size(width, height);
+            self.renderer.release_backbuffer_resources();
+            let _ = unsafe {
+                self.swapchain.ResizeBuffers(
+                    0,
+                    width,
+                    height,
+                    DXGI_FORMAT_UNKNOWN,
+                    DXGI_SWAP_CHAIN_FLAG(0),
+                )
+            };
+        }
+
+        /// Full redraw (no damage), presented without waiting for vsync
+        pub fn render(&mut self, doc: &BaseDocument, width: u32, height: u32) -> RenderTimes {
+            self.renderer.set_damage(None);
+            self.renderer
+                .render(|scene| paint_scene_parallel(scene, doc, 1.0, width, height, None));
+            let playback_ms = self.renderer.last_playback_ms();
+            let present_start = Instant::now();
+            let _ = unsafe { self.swapchain.Present(0, DXGI_PRESENT(0)) };
+            RenderTimes {
+                playback_ms,
+                present_ms: ms_since(present_start),
+            }
+        }
+    }
+}
+
+/// vello_cpu rasterization into a pixel buffer (there is no Present)
+#[cfg(not(windows))]
+mod cpu {
+    use super::{RenderTimes, ms_since};
+    use anyrender::ImageRenderer;
+    use anyrender_vello_cpu::VelloCpuImageRenderer;
+    use blitz_dom::BaseDocument;
+    use blitz_paint::paint_scene;
+    use std::time::Instant;
+
+    pub struct OffscreenTarget {
+        renderer: VelloCpuImageRenderer,
+        buffer: Vec<u8>,
+    }
+
+    impl OffscreenTarget {
+        pub const BACKEND: &'static str = "vello_cpu";
+
+        pub fn new(width: u32, height: u32) -> Result<Self, String> {
+            Ok(Self {
+                renderer: VelloCpuImageRenderer::new(width, height),
+                buffer: Vec::new(),
+            })
+        }
+
+        pub fn resize(&mut self, width: u32, height: u32) {
+            self.renderer = VelloCpuImageRenderer::new(width, height);
+        }
+
+        pub fn render(&mut self, doc: &BaseDocument, width: u32, height: u32) -> RenderTimes {
+            self.buffer.clear();
+            let mut recorded = None;
+            self.renderer.render(
+                |scene| {
+                    paint_scene(scene, doc, 1.0, width, height);
+                    recorded = Some(Instant::now());
+                },
+                &mut self.buffer,
+            );
+            RenderTimes {
+                playback_ms: recorded.map_or(0.0, ms_since),
+                present_ms: 0.0,
+            }
+        }
+    }
+}
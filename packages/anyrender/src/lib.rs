@@ -150,3 +150,15 @@ pub trait PaintScene {
         );
     }
 }
+
+/// A [`PaintScene`] whose recording can be split: independent parts of a scene are recorded into fragments
+/// (possibly on other threads) and spliced back in paint order, as if they had been drawn in place.
+pub trait ForkPaintScene: PaintScene {
+    type Fragment: PaintScene + Send;
+
+    /// An empty recording that can later be [`join`](Self::join)ed into this scene
+    fn fork(&self) -> Self::Fragment;
+
+    /// Append the commands recorded into `fragment` after everything recorded so far
+    fn join(&mut self, fragment: Self::Fragment);
+}
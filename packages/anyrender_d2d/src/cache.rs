@@ -0,0 +1,175 @@
+//! Byte-accounted LRU caches for device resources.
+//!
+//! Every resource cache of the renderer (bitmaps, gradient brushes, blurred shadows, font faces, glyph outlines) is an
+//! [`LruCache`] stamped with the renderer's frame counter, so one memory budget can be enforced across all of
+//! them by repeatedly evicting whichever cache holds the least recently used entry.
+
+use rustc_hash::FxHashMap;
+use std::collections::BTreeMap;
+use std::hash::Hash;
+
+struct Entry<V> {
+    value: V,
+    bytes: usize,
+    last_used: u64,
+    /// Insertion stamp, unique per cache: breaks ties between entries last used in the same frame
+    seq: u64,
+}
+
+pub(crate) struct LruCache<K, V> {
+    entries: FxHashMap<K, Entry<V>>,
+    /// Keys by (last_used, seq), so the least recently used entry is always the first
+    order: BTreeMap<(u64, u64), K>,
+    next_seq: u64,
+    bytes: usize,
+}
+
+impl<K: Hash + Eq + Clone, V: Clone> LruCache<K, V> {
+    pub(crate) fn new() -> Self {
+        Self {
+            entries: FxHashMap::default(),
+            order: BTreeMap::new(),
+            next_seq: 0,
+            bytes: 0,
+        }
+    }
+
+    /// Look up `key`, marking it used at `now`. Values are COM pointers, so the clone is a reference count bump.
+    pub(crate) fn get(&mut self, key: &K, now: u64) -> Option<V> {
+        self.get_mut(key, now).map(|value| value.clone())
+    }
+
+    /// Like [`get`](Self::get), for values that carry state updated in place
+    pub(crate) fn get_mut(&mut self, key: &K, now: u64) -> Option<&mut V> {
+        let entry = self.entries.get_mut(key)?;
+        // Repeated hits within a frame leave the order as it is
+        if entry.last_used != now {
+            if let Some(key) = self.order.remove(&(entry.last_used, entry.seq)) {
+                self.order.insert((now, entry.seq), key);
+            }
+            entry.last_used = now;
+        }
+        Some(&mut entry.value)
+    }
+
+    pub(crate) fn contains(&self, key: &K) -> bool {
+        self.entries.contains_key(key)
+    }
+
+    pub(crate) fn insert(&mut self, key: K, value: V, bytes: usize, now: u64) {
+        let seq = self.next_seq;
+        self.next_seq += 1;
+        self.order.insert((now, seq), key.clone());
+        if let Some(old) = self.entries.insert(
+            key,
+            Entry {
+                value,
+                bytes,
+                last_used: now,
+                seq,
+            },
+        ) {
+            self.order.remove(&(old.last_used, old.seq));
+            self.bytes -= old.bytes;
+        }
+        self.bytes += bytes;
+    }
+
+    pub(crate) fn bytes(&self) -> usize {
+        self.bytes
+    }
+
+    /// Last use of the least recently used entry
+    pub(crate) fn oldest(&self) -> Option<u64> {
+        self.order
+            .first_key_value()
+            .map(|(&(last_used, _), _)| last_used)
+    }
+
+    /// Drop the least recently used entry; returns the bytes released
+    pub(crate) fn pop_oldest(&mut self) -> usize {
+        let Some((_, key)) = self.order.pop_first() else {
+            return 0;
+        };
+        let bytes = self.entries.remove(&key).map_or(0, |e| e.bytes);
+        self.bytes -= bytes;
+        bytes
+    }
+
+    pub(crate) fn clear(&mut self) {
+        self.entries.clear();
+        self.order.clear();
+        self.bytes = 0;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::LruCache;
+
+    #[test]
+    fn replacing_a_key_replaces_its_bytes() {
+        let mut cache = LruCache::new();
+        cache.insert("a", 1, 100, 0);
+        cache.insert("b", 2, 50, 0);
+        cache.insert("a", 3, 30, 1);
+        assert_eq!(cache.bytes(), 80);
+        assert_eq!(cache.get(&"a", 2), Some(3));
+    }
+
+    #[test]
+    fn pop_oldest_goes_by_last_use() {
+        let mut cache = LruCache::new();
+        cache.insert("a", (), 1, 0);
+        cache.insert("b", (), 2, 1);
+        cache.insert("c", (), 4, 2);
+        // Using "a" makes "b" the least recently used
+        assert!(cache.get(&"a", 3).is_some());
+        assert!(cache.get_mut(&"c", 4).is_some());
+        assert_eq!(cache.oldest(), Some(1));
+
+        assert_eq!(cache.pop_oldest(), 2);
+        assert!(!cache.contains(&"b"));
+        assert_eq!(cache.pop_oldest(), 1);
+        assert_eq!(cache.pop_oldest(), 4);
+        assert_eq!(cache.bytes(), 0);
+        assert_eq!(cache.oldest(), None);
+        assert_eq!(cache.pop_oldest(), 0);
+    }
+
+    #[test]
+    fn clear_drops_everything() {
+        let mut cache = LruCache::new();
+        cache.insert(1u32, "x", 10, 0);
+        cache.insert(2u32, "y", 20, 0);
+        cache.clear();
+        assert_eq!(cache.bytes(), 0);
+        assert!(!cache.contains(&1));
+        assert_eq!(cache.oldest(), None);
+
+        cache.insert(1u32, "z", 5, 1);
+        assert_eq!(cache.bytes(), 5);
+    }
+
+    #[test]
+    fn order_follows_reuse_and_replacement() {
+        let mut cache = LruCache::new();
+        for (i, key) in ["a", "b", "c", "d"].into_iter().enumerate() {
+            cache.insert(key, (), 1, i as u64);
+        }
+        // Replacing "a" and hitting "b" twice in one frame leaves "c" oldest, then "d", then "b", then "a"
+        cache.insert("a", (), 1, 5);
+        assert!(cache.get(&"b", 4).is_some());
+        assert!(cache.get(&"b", 4).is_some());
+        assert_eq!(cache.oldest(), Some(2));
+        assert_eq!(cache.pop_oldest(), 1);
+        assert!(!cache.contains(&"c"));
+        assert_eq!(cache.pop_oldest(), 1);
+        assert!(!cache.contains(&"d"));
+        assert_eq!(cache.oldest(), Some(4));
+        cache.pop_oldest();
+        assert!(cache.contains(&"a"));
+        assert_eq!(cache.oldest(), Some(5));
+        assert_eq!(cache.bytes(), 1);
+    }
+}
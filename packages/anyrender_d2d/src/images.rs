@@ -0,0 +1,258 @@
+//! Background image preparation.
+//!
+//! Recorded images hold the decoded RGBA8 pixels straight from the document (shared, not copied). Before Direct2D
+//! can draw one it needs premultiplied pixels at a sensible size, which is too slow to do mid-frame for large
+//! images. The first time an image is drawn playback asks [`ImagePipeline::prepare`]: that queues the work on the
+//! rayon pool (premultiplying, then downscaling by halves towards the displayed size) and playback draws a
+//! placeholder instead. The placeholders of finished images are reported as damage so the host repaints them, and
+//! the repaint uploads the pixels, at most [`UPLOAD_BUDGET_BYTES`] per frame.
+
+use std::sync::{Arc, Mutex};
+
+use kurbo::Rect;
+use rustc_hash::{FxHashMap, FxHashSet};
+
+/// Bytes of prepared pixels uploaded per frame; the rest waits for the next frame
+pub(crate) const UPLOAD_BUDGET_BYTES: usize = 16 * 1024 * 1024;
+/// Prepared images and buffer ids not drawn for this many frames are dropped (the image was scrolled out or removed)
+const PREPARED_MAX_AGE: u64 = 600;
+
+/// Identifies one image (its pixel identity) at one downscale level
+pub(crate) type ImageKey = (u64, u8);
+/// 12 halvings shrink an image 4096 times, more than any display size needs
+pub(crate) const MAX_DOWNSCALE_LEVEL: u8 = 12;
+
+/// A pixel buffer as drawn: its address and length, and the dimensions it's drawn at
+type BufferKey = (usize, usize, u32, u32);
+
+struct BufferId {
+    id: u64,
+    // Keeps the buffer alive, so its address can't be taken by another image while the id stands
+    _data: peniko::Blob<u8>,
+    last_drawn: u64,
+}
+
+/// Premultiplied RGBA8 pixels ready to upload
+pub(crate) struct PreparedImage {
+    pub(crate) width: u32,
+    pub(crate) height: u32,
+    pub(crate) pixels: Vec<u8>,
+    last_wanted: u64,
+}
+
+type Waker = Arc<dyn Fn() + Send + Sync>;
+
+pub(crate) struct ImagePipeline {
+    in_flight: FxHashSet<ImageKey>,
+    // Filled by rayon jobs, drained on the render thread
+    finished: Arc<Mutex<Vec<(ImageKey, PreparedImage)>>>,
+    prepared: FxHashMap<ImageKey, PreparedImage>,
+    // Where placeholders were drawn (scene units), per image
+    placeholders: FxHashMap<ImageKey, Vec<Rect>>,
+    // Stable ids of the pixel buffers drawn recently, see `identity`
+    ids: FxHashMap<BufferKey, BufferId>,
+    next_id: u64,
+    waker: Option<Waker>,
+}
+
+/// Number of halvings that keep an image of `size` at least as large as `target` on both axes
+pub(crate) fn downscale_level(size: (u32, u32), target: (f64, f64)) -> u8 {
+    let mut level = 0u8;
+    let (mut w, mut h) = (size.0 as f64, size.1 as f64);
+    while level < MAX_DOWNSCALE_LEVEL
+        && w / 2.0 >= target.0.max(1.0)
+        && h / 2.0 >= target.1.max(1.0)
+    {
+        w /= 2.0;
+        h /= 2.0;
+        level += 1;
+    }
+    level
+}
+
+impl ImagePipeline {
+    pub(crate) fn new() -> Self {
+        Self {
+            in_flight: FxHashSet::default(),
+            finished: Arc::new(Mutex::new(Vec::new())),
+            prepared: FxHashMap::default(),
+            placeholders: FxHashMap::default(),
+            ids: FxHashMap::default(),
+            next_id: 0,
+            waker: None,
+        }
+    }
+
+    /// Called from a rayon thread whenever an image finishes preparing, so the host can schedule a frame
+    pub(crate) fn set_waker(&mut self, waker: Option<Waker>) {
+        self.waker = waker;
+    }
+
+    /// Identity of an image's pixels across frames, for its [`ImageKey`]. Painters typically wrap the document's
+    /// pixel buffer in a new Blob every frame (new blob id), so the buffer's address is what stays the same. The
+    /// first Blob seen is kept with the id, so the buffer can't be freed and its address reused by a different
+    /// image until the id is dropped; ids are never handed out twice.
+    pub(crate) fn identity(
+        &mut self,
+        data: &peniko::Blob<u8>,
+        size: (u32, u32),
+        frame: u64,
+    ) -> u64 {
+        let bytes = data.as_ref();
+        let key = (bytes.as_ptr() as usize, bytes.len(), size.0, size.1);
+        let next_id = &mut self.next_id;
+        let buffer = self.ids.entry(key).or_insert_with(|| {
+            *next_id += 1;
+            BufferId {
+                id: *next_id,
+                _data: data.clone(),
+                last_drawn: frame,
+            }
+        });
+        buffer.last_drawn = frame;
+        buffer.id
+    }
+
+    /// Drop the ids of images not drawn for a while, releasing their buffers
+    pub(crate) fn evict_idle_ids(&mut self, frame: u64) {
+        self.ids
+            .retain(|_, b| frame.saturating_sub(b.last_drawn) < PREPARED_MAX_AGE);
+    }
+
+    /// Take the prepared pixels for `key` if they are ready; otherwise start preparing them (once) and remember
+    /// that a placeholder is drawn at `dest`.
+    pub(crate) fn prepare(
+        &mut self,
+        key: ImageKey,
+        data: &peniko::Blob<u8>,
+        size: (u32, u32),
+        dest: Rect,
+        frame: u64,
+    ) -> Option<PreparedImage> {
+        if let Some(prepared) = self.prepared.remove(&key) {
+            self.placeholders.remove(&key);
+            return Some(prepared);
+        }
+        self.add_placeholder(key, dest);
+        if self.in_flight.insert(key) {
+            let data = data.clone();
+            let finished = self.finished.clone();
+            let waker = self.waker.clone();
+            rayon::spawn(move || {
+                let (width, height, pixels) = prepare_pixels(data.as_ref(), size, key.1);
+                finished.lock().unwrap().push((
+                    key,
+                    PreparedImage {
+                        width,
+                        height,
+                        pixels,
+                        last_wanted: frame,
+                    },
+                ));
+                if let Some(waker) = waker {
+                    waker();
+                }
+            });
+        }
+        None
+    }
+
+    /// Put back prepared pixels that didn't fit this frame's upload budget
+    pub(crate) fn defer(
+        &mut self,
+        key: ImageKey,
+        mut prepared: PreparedImage,
+        dest: Rect,
+        frame: u64,
+    ) {
+        prepared.last_wanted = frame;
+        self.prepared.insert(key, prepared);
+        self.add_placeholder(key, dest);
+    }
+
+    fn add_placeholder(&mut self, key: ImageKey, dest: Rect) {
+        let rects = self.placeholders.entry(key).or_default();
+        if !rects.contains(&dest) {
+            rects.push(dest);
+        }
+    }
+
+    /// Collect finished jobs and return the placeholder rects (scene units) that can now show their image
+    pub(crate) fn take_damage(&mut self, frame: u64) -> Vec<Rect> {
+        let finished = std::mem::take(&mut *self.finished.lock().unwrap());
+        for (key, prepared) in finished {
+            self.in_flight.remove(&key);
+            self.prepared.insert(key, prepared);
+        }
+        self.prepared
+            .retain(|_, p| frame.saturating_sub(p.last_wanted) < PREPARED_MAX_AGE);
+        let ready: Vec<ImageKey> = self
+            .placeholders
+            .keys()
+            .filter(|k| self.prepared.contains_key(k))
+            .copied()
+            .collect();
+        ready
+            .iter()
+            .filter_map(|k| self.placeholders.remove(k))
+            .flatten()
+            .collect()
+    }
+
+    /// Whether a finished or prepared image is waiting to be shown
+    pub(crate) fn has_pending(&self) -> bool {
+        !self.finished.lock().unwrap().is_empty()
+            || self
+                .placeholders
+                .keys()
+                .any(|k| self.prepared.contains_key(k))
+    }
+
+    /// Drop prepared pixels, placeholder bookkeeping and buffer ids (jobs still running deliver into the next frame)
+    pub(crate) fn clear(&mut self) {
+        self.prepared.clear();
+        self.placeholders.clear();
+        self.ids.clear();
+    }
+}
+
+/// Premultiply RGBA8 `data` of `size` and downscale it by `level` halvings (2x2 box filter, on premultiplied
+/// values so transparent pixels don't darken the edges)
+fn prepare_pixels(data: &[u8], size: (u32, u32), level: u8) -> (u32, u32, Vec<u8>) {
+    let (mut w, mut h) = size;
+    let mut pixels = data.to_vec();
+    // Direct2D expects premultiplied alpha when using PREMULTIPLIED mode
+    for px in pixels.chunks_exact_mut(4) {
+        let a = px[3] as u16;
+        if a < 255 {
+            px[0] = ((px[0] as u16 * a + 127) / 255) as u8;
+            px[1] = ((px[1] as u16 * a + 127) / 255) as u8;
+            px[2] = ((px[2] as u16 * a + 127) / 255) as u8;
+        }
+    }
+    for _ in 0..level {
+        let (nw, nh) = ((w / 2).max(1), (h / 2).max(1));
+        let mut out = vec![0u8; nw as usize * nh as usize * 4];
+        for y in 0..nh as usize {
+            for x in 0..nw as usize {
+                let mut sum = [0u32; 4];
+                for (dx, dy) in [(0, 0), (1, 0), (0, 1), (1, 1)] {
+                    let sx = (x * 2 + dx).min(w as usize - 1);
+                    let sy = (y * 2 + dy).min(h as usize - 1);
+                    let i = (sy * w as usize + sx) * 4;
+                    for c in 0..4 {
+                        sum[c] += pixels[i + c] as u32;
+                    }
+                }
+                let o = (y * nw as usize + x) * 4;
+                for c in 0..4 {
+                    out[o + c] = ((sum[c] + 2) / 4) as u8;
+                }
+            }
+        }
+        pixels = out;
+        w = nw;
+        h = nh;
+    }
+    (w, h, pixels)
+}
@@ -15,10 +15,12 @@
 //! We map the anyrender PaintScene commands onto Direct2D primitives.
 //! (Initial version implements a subset: fill rects, strokes, images, text placeholder.)
 
-use std::sync::Arc;
+use std::sync::{Arc, LazyLock, Mutex};
 use std::sync::atomic::{AtomicBool, Ordering};
 
-use anyrender::{Glyph, NormalizedCoord, Paint, PaintScene, WindowHandle, WindowRenderer};
+use anyrender::{
+    ForkPaintScene, Glyph, NormalizedCoord, Paint, PaintScene, WindowHandle, WindowRenderer,
+};
 use blitz_metrics::{
     FrameTimings, begin_init_window, end_init_window, freeze, is_frozen,
     snapshot as metrics_snapshot, unfreeze_and_reset,
@@ -27,6 +29,7 @@ use kurbo::{Affine, PathEl, Rect, Shape, Stroke};
 use peniko::color; // for color space conversions
 use peniko::{BlendMode, BrushRef, Color, Fill, Font, StyleRef};
 use rustc_hash::FxHashMap;
+use std::collections::VecDeque;
 use std::hash::{Hash, Hasher};
 use std::time::Instant;
 use windows::Win32::Graphics::Direct2D::Common::*;
@@ -34,11 +37,22 @@ use windows::Win32::Graphics::Direct2D::*;
 use windows::Win32::Graphics::Direct3D11::*;
 use windows::Win32::Graphics::DirectWrite::*;
 use windows::Win32::Graphics::Dxgi::Common::*;
-use windows::Win32::Graphics::Dxgi::{IDXGIDevice, IDXGISurface, IDXGISwapChain1};
+use windows::Win32::Foundation::RECT;
+use windows::Win32::Graphics::Dxgi::{
+    DXGI_ERROR_DEVICE_REMOVED, DXGI_ERROR_DEVICE_RESET, DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL, IDXGIDevice, IDXGIDevice3,
+    IDXGISurface, IDXGISwapChain1,
+};
 use windows::Win32::System::Diagnostics::Debug::OutputDebugStringA;
 use windows::core::Interface;
 use windows::core::PCSTR;
 
+mod cache;
+mod images;
+mod tiles;
+use cache::LruCache;
+use images::{ImageKey, ImagePipeline, UPLOAD_BUDGET_BYTES};
+use tiles::{TileCache, TileKey, TILE_SIZE};
+
 // Cache key for blurred shadow bitmaps (quantized params to limit variety)
 #[derive(Clone, Copy, Eq)]
 struct ShadowKey {
@@ -87,6 +101,147 @@ impl ShadowKey {
     }
 }
 
+// Retained path geometry. Paths are recorded with their translation baked in, so geometry is cached relative
+// to the path's first point: the same shape drawn somewhere else (scrolled content, repeated list items) hits the
+// same entry and is replayed under a translation.
+struct CachedPath {
+    geom: ID2D1PathGeometry,
+    // What the key was hashed from (see `path_cache_key`), compared on a hit so a colliding path isn't drawn as this one
+    shape: Box<[i32]>,
+    // Device-dependent tessellations for solid-brush drawing, built once a path has been drawn twice
+    fill: Option<ID2D1GeometryRealization>,
+    stroke: Option<(u32, ID2D1GeometryRealization)>, // (stroke width bits, realization)
+    uses: u32,
+    last_frame: u64,
+}
+
+// Start evicting idle geometry once this many paths are cached
+const GEOMETRY_CACHE_SOFT_LIMIT: usize = 2048;
+// Geometry not drawn for this many frames is evicted (once over the soft limit)
+const GEOMETRY_CACHE_MAX_IDLE_FRAMES: u64 = 120;
+
+// Outline geometry of a glyph run in run space (baseline origin at 0,0), for stroked text and large fills. Keyed
+// by font, size, glyphs and advances, so a run is replayed under a translation wherever it is drawn.
+#[derive(Clone)]
+struct CachedGlyphOutline {
+    geom: ID2D1PathGeometry,
+    // The run the key was hashed from, compared on a hit so a colliding run isn't drawn with this outline
+    font: FontKey,
+    size: u32,
+    glyph_indices: Box<[u16]>,
+    advances: Box<[u32]>,
+    // Realizations, built once a run has been drawn in two frames (as for paths)
+    fill: Option<ID2D1GeometryRealization>,
+    stroke: Option<(u32, ID2D1GeometryRealization)>, // (stroke width bits, realization)
+    uses: u32,
+    last_frame: u64,
+}
+
+// Fills at or above this em size draw from cached outlines: DirectWrite's glyph bitmap cache only covers moderate
+// sizes, so larger text would otherwise be rasterized from its outlines on every draw
+const LARGE_GLYPH_EM_SIZE: f32 = 64.0;
+
+fn glyph_outline_key(font: &FontKey, size: f32, glyph_indices: &[u16], advances: &[f32]) -> u64 {
+    let mut h = rustc_hash::FxHasher::default();
+    font.hash(&mut h);
+    h.write_u32(size.to_bits());
+    glyph_indices.hash(&mut h);
+    for a in advances {
+        h.write_u32(a.to_bits());
+    }
+    h.finish()
+}
+
+impl CachedGlyphOutline {
+    fn is_run(&self, font: &FontKey, size: f32, glyph_indices: &[u16], advances: &[f32]) -> bool {
+        self.size == size.to_bits()
+            && *self.glyph_indices == *glyph_indices
+            && self
+                .advances
+                .iter()
+                .copied()
+                .eq(advances.iter().map(|a| a.to_bits()))
+            && self.font == *font
+    }
+}
+
+// Default cap on cached device resources (bitmaps, brushes, shadows, font faces, glyph outlines, plus tiles when
+// tiled)
+const DEFAULT_MEMORY_BUDGET_BYTES: usize = 128 * 1024 * 1024;
+// Size estimates for resources whose footprint D2D / DirectWrite don't report; they only need to be in the
+// right order of magnitude for eviction to be fair
+const GRADIENT_BRUSH_BYTES: usize = 4 * 1024;
+const FONT_FACE_BYTES: usize = 64 * 1024;
+const GLYPH_OUTLINE_BYTES_PER_GLYPH: usize = 2 * 1024;
+
+// Drawn where an image is still being prepared off-thread
+const IMAGE_PLACEHOLDER_COLOR: Color = Color::new([0.5, 0.5, 0.5, 0.1]);
+
+// Image bitmaps are keyed by image identity and downscale level
+fn image_cache_key(key: ImageKey) -> u64 {
+    let mut h = rustc_hash::FxHasher::default();
+    key.hash(&mut h);
+    h.finish()
+}
+
+// Translation-invariant key for a path plus the origin it was recorded at. Coordinates are quantized to 1/64px so
+// float noise from different offsets doesn't split entries. The quantized shape that was hashed (each element's verb,
+// then its points) is left in `shape`.
+fn path_cache_key(path: &[PathEl], shape: &mut Vec<i32>) -> Option<(u64, kurbo::Point)> {
+    let origin = match path.first()? {
+        PathEl::MoveTo(p) => *p,
+        _ => return None,
+    };
+    shape.clear();
+    let point = |p: &kurbo::Point, shape: &mut Vec<i32>| {
+        shape.push(((p.x - origin.x) * 64.0).round() as i32);
+        shape.push(((p.y - origin.y) * 64.0).round() as i32);
+    };
+    for el in path {
+        match el {
+            PathEl::MoveTo(p) => { shape.push(0); point(p, shape); }
+            PathEl::LineTo(p) => { shape.push(1); point(p, shape); }
+            PathEl::QuadTo(p1, p2) => { shape.push(2); point(p1, shape); point(p2, shape); }
+            PathEl::CurveTo(p1, p2, p3) => { shape.push(3); point(p1, shape); point(p2, shape); point(p3, shape); }
+            PathEl::ClosePath => shape.push(4),
+        }
+    }
+    let mut h = rustc_hash::FxHasher::default();
+    shape.hash(&mut h);
+    Some((h.finish(), origin))
+}
+
+// Bounds of the path's points (control points included); exact for the rectangles and rounded rectangles we snap.
+fn path_bounds(path: &[PathEl]) -> Option<D2D_RECT_F> {
+    let mut r: Option<Rect> = None;
+    let mut add = |p: &kurbo::Point| {
+        r = Some(match r {
+            Some(r) => r.union_pt(*p),
+            None => Rect::from_points(*p, *p),
+        });
+    };
+    for el in path {
+        match el {
+            PathEl::MoveTo(p) | PathEl::LineTo(p) => add(p),
+            PathEl::QuadTo(p1, p2) => { add(p1); add(p2); }
+            PathEl::CurveTo(p1, p2, p3) => { add(p1); add(p2); add(p3); }
+            PathEl::ClosePath => {}
+        }
+    }
+    r.map(|r| D2D_RECT_F { left: r.x0 as f32, top: r.y0 as f32, right: r.x1 as f32, bottom: r.y1 as f32 })
+}
+
+fn translation(x: f64, y: f64) -> windows::Foundation::Numerics::Matrix3x2 {
+    windows::Foundation::Numerics::Matrix3x2::translation(x as f32, y as f32)
+}
+
+/// Device pixels per scene unit (DIP)
+unsafe fn dpi_scale(ctx: &ID2D1DeviceContext) -> (f64, f64) {
+    let (mut dpi_x, mut dpi_y) = (96.0f32, 96.0f32);
+    ctx.GetDpi(&mut dpi_x, &mut dpi_y);
+    (dpi_x as f64 / 96.0, dpi_y as f64 / 96.0)
+}
+
 // NOTE: Do not rely on HWND in WinUI shell path
 
 /// Scene representation for D2D backend: we store a lightweight command list then play it back.
@@ -149,6 +304,54 @@ struct FontKey {
     italic: bool,
 }
 
+/// A resolved system font face (or the lack of one) for a key
+struct SharedFontFace(Option<IDWriteFontFace>);
+// SAFETY: faces come from a DWRITE_FACTORY_TYPE_SHARED factory, whose objects are free-threaded; they are only
+// ever cloned out of the map, never mutated through it.
+unsafe impl Send for SharedFontFace {}
+
+/// System font faces resolved by any renderer in the process. Font faces are device-independent, so every Host
+/// shares one face (and DirectWrite's glyph cache for it) per family/weight/stretch/style instead of each renderer
+/// resolving and holding its own.
+static SHARED_FONT_FACES: LazyLock<Mutex<FxHashMap<FontKey, SharedFontFace>>> =
+    LazyLock::new(Default::default);
+
+/// Number of system font faces (including families that failed to resolve) shared by the renderers in this process
+pub fn shared_font_face_count() -> usize {
+    SHARED_FONT_FACES.lock().unwrap().len()
+}
+
+unsafe fn system_font_face(factory: &IDWriteFactory, key: &FontKey) -> Option<IDWriteFontFace> {
+    unsafe {
+        let mut collection: Option<IDWriteFontCollection> = None;
+        factory.GetSystemFontCollection(&mut collection, false).ok()?;
+        let collection = collection?;
+        let mut idx = 0u32;
+        let mut exists = false.into();
+        collection
+            .FindFamilyName(
+                &windows::core::HSTRING::from(&key.family),
+                &mut idx,
+                &mut exists,
+            )
+            .ok()?;
+        if !exists.as_bool() {
+            return None;
+        }
+        let family = collection.GetFontFamily(idx).ok()?;
+        let weight = DWRITE_FONT_WEIGHT(key.weight as i32);
+        // Map stretch (1..=9) directly; default normal (5)
+        let stretch = DWRITE_FONT_STRETCH(key.stretch as i32);
+        let style = if key.italic {
+            DWRITE_FONT_STYLE_ITALIC
+        } else {
+            DWRITE_FONT_STYLE_NORMAL
+        };
+        let font = family.GetFirstMatchingFont(weight, stretch, style).ok()?;
+        font.CreateFontFace().ok()
+    }
+}
+
 impl FontKey {
     fn default() -> Self {
         Self {
@@ -170,21 +373,127 @@ struct RecordedGradient {
 struct RecordedImage {
     width: u32,
     height: u32,
-    data: Vec<u8>,
+    // Shared with the document's decoded image (a reference count bump, not a copy)
+    data: peniko::Blob<u8>,
     format: peniko::ImageFormat,
     alpha: f32,
 }
 
-impl D2DScene {
-    fn reset(&mut self) {
-        self.commands.clear();
+pub struct D2DScenePainter<'a> {
+    scene: &'a mut D2DScene,
+}
+
+/// Part of a scene recorded separately (e.g. on another thread) and spliced into a [`D2DScenePainter`] with
+/// [`ForkPaintScene::join`]
+pub struct D2DSceneFragment {
+    scene: D2DScene,
+}
+
+impl ForkPaintScene for D2DScenePainter<'_> {
+    type Fragment = D2DSceneFragment;
+
+    fn fork(&self) -> D2DSceneFragment {
+        D2DSceneFragment {
+            scene: D2DScene {
+                commands: Vec::new(),
+            },
+        }
+    }
+
+    fn join(&mut self, fragment: D2DSceneFragment) {
+        self.scene.commands.extend(fragment.scene.commands);
     }
 }
 
-pub struct D2DScenePainter<'a> {
-    scene: &'a mut D2DScene,
+// The painter handed to draw closures and fragments both record into a D2DScene
+macro_rules! delegate_paint_scene {
+    ($ty:ty) => {
+        impl PaintScene for $ty {
+            fn reset(&mut self) {
+                self.scene.reset();
+            }
+            fn push_layer(
+                &mut self,
+                blend: impl Into<BlendMode>,
+                alpha: f32,
+                transform: Affine,
+                clip: &impl Shape,
+            ) {
+                self.scene.push_layer(blend, alpha, transform, clip);
+            }
+            fn pop_layer(&mut self) {
+                self.scene.pop_layer();
+            }
+            fn stroke<'b>(
+                &mut self,
+                style: &Stroke,
+                transform: Affine,
+                brush: impl Into<BrushRef<'b>>,
+                brush_transform: Option<Affine>,
+                shape: &impl Shape,
+            ) {
+                self.scene
+                    .stroke(style, transform, brush, brush_transform, shape);
+            }
+            fn fill<'b>(
+                &mut self,
+                style: Fill,
+                transform: Affine,
+                brush: impl Into<anyrender::Paint<'b>>,
+                brush_transform: Option<Affine>,
+                shape: &impl Shape,
+            ) {
+                self.scene
+                    .fill(style, transform, brush, brush_transform, shape);
+            }
+            fn draw_glyphs<'b, 's: 'b>(
+                &'s mut self,
+                font: &'b Font,
+                font_family: &str,
+                font_size: f32,
+                font_weight: u16,
+                hint: bool,
+                norm: &'b [NormalizedCoord],
+                style: impl Into<StyleRef<'b>>,
+                brush: impl Into<BrushRef<'b>>,
+                brush_alpha: f32,
+                transform: Affine,
+                glyph_transform: Option<Affine>,
+                glyphs: impl Iterator<Item = Glyph>,
+            ) {
+                self.scene.draw_glyphs(
+                    font,
+                    font_family,
+                    font_size,
+                    font_weight,
+                    hint,
+                    norm,
+                    style,
+                    brush,
+                    brush_alpha,
+                    transform,
+                    glyph_transform,
+                    glyphs,
+                );
+            }
+            fn draw_box_shadow(
+                &mut self,
+                transform: Affine,
+                rect: Rect,
+                brush: Color,
+                radius: f64,
+                std_dev: f64,
+            ) {
+                self.scene
+                    .draw_box_shadow(transform, rect, brush, radius, std_dev);
+            }
+        }
+    };
 }
 
+delegate_paint_scene!(D2DScenePainter<'_>);
+delegate_paint_scene!(D2DSceneFragment);
+
 fn debug_log_d2d(msg: &str) {
     let mut bytes = msg.as_bytes().to_vec();
     if !bytes.ends_with(b"\n") {
@@ -196,6 +505,52 @@ fn debug_log_d2d(msg: &str) {
     }
 }
 
+// Default face (Segoe UI) for glyph runs without a resolvable font
+fn default_font_face(dwf: &IDWriteFactory) -> Option<IDWriteFontFace> {
+    unsafe {
+        let mut collection: Option<IDWriteFontCollection> = None;
+        dwf.GetSystemFontCollection(&mut collection, false).ok()?;
+        let collection = collection?;
+        let mut idx = 0u32;
+        let mut exists = false.into();
+        collection
+            .FindFamilyName(windows::core::w!("Segoe UI"), &mut idx, &mut exists)
+            .ok()?;
+        if !exists.as_bool() {
+            return None;
+        }
+        let font = collection.GetFontFamily(idx).ok()?.GetFirstMatchingFont(
+            DWRITE_FONT_WEIGHT_NORMAL,
+            DWRITE_FONT_STRETCH_NORMAL,
+            DWRITE_FONT_STYLE_NORMAL,
+        );
+        font.ok()?.CreateFontFace().ok()
+    }
+}
+
+/// Load Direct2D and DirectWrite and enumerate the system font collection ahead of the first renderer, from any
+/// thread. DirectWrite keeps the shared factory and its system collection for the life of the process, so the
+/// first `set_swapchain` then only creates the device objects. Only the first call does any work.
+pub fn prewarm() {
+    static PREWARM: std::sync::Once = std::sync::Once::new();
+    PREWARM.call_once(|| {
+        let t0 = Instant::now();
+        // Dropped again: only loading d2d1.dll and its one-time initialization are worth doing early
+        let d2d = unsafe {
+            D2D1CreateFactory::<ID2D1Factory1>(D2D1_FACTORY_TYPE_MULTI_THREADED, None)
+        };
+        let face = unsafe { DWriteCreateFactory::<IDWriteFactory>(DWRITE_FACTORY_TYPE_SHARED) }
+            .ok()
+            .and_then(|dwf| default_font_face(&dwf));
+        debug_log_d2d(&format!(
+            "prewarm: d2d={} default_face={} in {:.2} ms",
+            d2d.is_ok(),
+            face.is_some(),
+            t0.elapsed().as_secs_f32() * 1000.0
+        ));
+    });
+}
+
 // Runtime-switchable verbose logging (disabled by default for perf)
 static VERBOSE_LOG: AtomicBool = AtomicBool::new(false);
 pub fn set_verbose_logging(enabled: bool) {
@@ -211,9 +566,9 @@ fn verbose_log_d2d(msg: &str) {
 // ability to skip formatting cost when verbose logging is off.
 macro_rules! vlog { ($($t:tt)*) => { if VERBOSE_LOG.load(Ordering::Relaxed) { debug_log_d2d(&format!($($t)*)); } } }
 
-impl<'a> PaintScene for D2DScenePainter<'a> {
+impl PaintScene for D2DScene {
     fn reset(&mut self) {
-        self.scene.reset();
+        self.commands.clear();
     }
     fn push_layer(
         &mut self,
@@ -229,11 +584,11 @@ impl<'a> PaintScene for D2DScenePainter<'a> {
             if t[0] == 1.0 && t[1] == 0.0 && t[2] == 0.0 && t[3] == 1.0 {
                 rect = rect + kurbo::Vec2::new(t[4], t[5]);
             }
-            self.scene.commands.push(Command::PushLayer { rect });
+            self.commands.push(Command::PushLayer { rect });
         }
     }
     fn pop_layer(&mut self) {
-        self.scene.commands.push(Command::PopLayer);
+        self.commands.push(Command::PopLayer);
     }
     fn stroke<'b>(
         &mut self,
@@ -274,7 +629,7 @@ impl<'a> PaintScene for D2DScenePainter<'a> {
                 }
             }
         }
-        self.scene.commands.push(Command::StrokePath {
+        self.commands.push(Command::StrokePath {
             path: v,
             brush: brush_rec,
             width: style.width,
@@ -317,11 +672,11 @@ impl<'a> PaintScene for D2DScenePainter<'a> {
                 }
             }
         }
-        self.scene.commands.push(Command::FillPath {
+        self.commands.push(Command::FillPath {
             path: v,
             brush: brush_rec,
         });
-        if self.scene.commands.len() == 1 {
+        if self.commands.len() == 1 {
             vlog!("first command recorded (FillPath)");
         }
     }
@@ -401,7 +756,7 @@ impl<'a> PaintScene for D2DScenePainter<'a> {
         } else {
             400
         } as u16;
-        self.scene.commands.push(Command::GlyphRun {
+        self.commands.push(Command::GlyphRun {
             glyph_indices,
             advances,
             origin: (origin_x, origin_y),
@@ -426,7 +781,7 @@ impl<'a> PaintScene for D2DScenePainter<'a> {
         let translated = rect + kurbo::Vec2::new(tx, ty);
         let inset = std_dev < 0.0;
         let std_dev = std_dev.abs();
-        self.scene.commands.push(Command::BoxShadow {
+        self.commands.push(Command::BoxShadow {
             rect: translated,
             color: brush,
             radius,
@@ -462,7 +817,7 @@ fn record_brush(b: BrushRef<'_>) -> RecordedBrush {
         BrushRef::Image(img) => RecordedBrush::Image(RecordedImage {
             width: img.width,
             height: img.height,
-            data: img.data.as_ref().to_vec(),
+            data: img.data.clone(),
             format: img.format,
             alpha: img.alpha,
         }),
@@ -482,7 +837,7 @@ fn record_paint(p: Paint<'_>) -> RecordedBrush {
         Paint::Image(img) => RecordedBrush::Image(RecordedImage {
             width: img.width,
             height: img.height,
-            data: img.data.as_ref().to_vec(),
+            data: img.data.clone(),
             format: img.format,
             alpha: img.alpha,
         }),
@@ -500,13 +855,23 @@ pub struct D2DWindowRenderer {
     dwrite_factory: Option<IDWriteFactory>,
     dwrite_font_face: Option<IDWriteFontFace>,
     dwrite_text_format: Option<IDWriteTextFormat>,
-    font_face_cache: FxHashMap<FontKey, IDWriteFontFace>,
-    // caches
-    gradient_cache: FxHashMap<u64, ID2D1Brush>,
-    image_cache: FxHashMap<u64, ID2D1Bitmap>,
+    // caches (LRU, stamped with frame_index and bounded together by memory_budget)
+    // None records a family DirectWrite doesn't have, so the lookup isn't repeated for every run
+    font_face_cache: LruCache<FontKey, Option<IDWriteFontFace>>,
+    glyph_outline_cache: LruCache<u64, CachedGlyphOutline>,
+    gradient_cache: LruCache<u64, ID2D1Brush>,
+    geometry_cache: FxHashMap<u64, CachedPath>,
+    // scratch for the shape of the path being looked up in geometry_cache
+    path_shape: Vec<i32>,
+    frame_index: u64,
+    image_cache: LruCache<u64, ID2D1Bitmap>,
+    // premultiplied / downscaled pixels prepared off-thread for images not uploaded yet
+    images: ImagePipeline,
+    // bytes uploaded into image bitmaps by the current frame
+    upload_bytes: usize,
     // shadow blur cache (bitmap of blurred rounded rect); separate from image_cache to control eviction separately
-    shadow_cache: FxHashMap<ShadowKey, ID2D1Bitmap1>,
-    shadow_cache_order: std::collections::VecDeque<ShadowKey>,
+    shadow_cache: LruCache<ShadowKey, ID2D1Bitmap1>,
+    memory_budget: usize,
     gaussian_blur_effect: Option<ID2D1Effect>,
     scene: D2DScene,
     width: u32,
@@ -539,6 +904,32 @@ pub struct D2DWindowRenderer {
     // Diagnostic: draw colored quadrants when true and no scene commands (placeholder visibility test)
     test_pattern: bool,
     show_debug_overlay: bool,
+    // Premultiplied-alpha swapchain over other content: frames start transparent instead of white and text uses
+    // grayscale antialiasing (ClearType needs an opaque background)
+    transparent: bool,
+    // --- partial redraw ---
+    // Damage for the next frame in scene units; None repaints everything
+    damage: Option<Vec<Rect>>,
+    // Only FLIP_SEQUENTIAL keeps the previous frame in the backbuffer that partial presents rely on
+    partial_present_ok: bool,
+    needs_full_redraw: bool,
+    // Backbuffer pixels touched by the last frame, for Present1; None when the whole frame was drawn
+    dirty_rects: Option<Vec<RECT>>,
+    // Pixels each of the last `buffer_count - 1` frames changed, oldest first (None: the whole frame). The
+    // backbuffer a frame draws into was last presented that many frames ago, so their damage is stale in it too.
+    recent_damage: VecDeque<Option<Vec<RECT>>>,
+    buffer_count: usize,
+    // --- tiled rendering ---
+    // Some when tiled: the scene is in content coordinates and rasterized into cached tiles
+    tiles: Option<TileCache>,
+    // Content origin of the frame planned by plan_tiled_frame (None: not a tiled frame)
+    tile_frame: Option<(f64, f64)>,
+    // Content origin last composited into the backbuffer
+    tiled_origin: Option<(f64, f64)>,
+    // World translation playback draws under (minus the tile origin while rasterizing a tile)
+    scene_offset: (f64, f64),
+    // Set when a draw failed because the device was removed; the host recreates the device and swapchain
+    device_lost: bool,
 }
 
 impl D2DWindowRenderer {
@@ -554,11 +945,17 @@ impl D2DWindowRenderer {
             dwrite_factory: None,
             dwrite_font_face: None,
             dwrite_text_format: None,
-            font_face_cache: FxHashMap::default(),
-            gradient_cache: FxHashMap::default(),
-            image_cache: FxHashMap::default(),
-            shadow_cache: FxHashMap::default(),
-            shadow_cache_order: std::collections::VecDeque::new(),
+            font_face_cache: LruCache::new(),
+            glyph_outline_cache: LruCache::new(),
+            gradient_cache: LruCache::new(),
+            geometry_cache: FxHashMap::default(),
+            path_shape: Vec::new(),
+            frame_index: 0,
+            image_cache: LruCache::new(),
+            images: ImagePipeline::new(),
+            upload_bytes: 0,
+            shadow_cache: LruCache::new(),
+            memory_budget: DEFAULT_MEMORY_BUDGET_BYTES,
             gaussian_blur_effect: None,
             scene: D2DScene::default(),
             width: 1,
@@ -588,6 +985,18 @@ impl D2DWindowRenderer {
             last_frame_metrics: FrameTimings::default(),
             test_pattern: false,
             show_debug_overlay: false,
+            transparent: false,
+            damage: None,
+            partial_present_ok: false,
+            needs_full_redraw: true,
+            dirty_rects: None,
+            recent_damage: VecDeque::new(),
+            buffer_count: 2,
+            tiles: None,
+            tile_frame: None,
+            tiled_origin: None,
+            scene_offset: (0.0, 0.0),
+            device_lost: false,
         }
     }
 
@@ -604,6 +1013,11 @@ impl D2DWindowRenderer {
         self.last_command_count
     }
 
+    /// Playback (Direct2D drawing) time of the last frame, or its tile rasterization when tiled
+    pub fn last_playback_ms(&self) -> f32 {
+        self.playback_ms
+    }
+
     pub fn set_test_pattern(&mut self, on: bool) {
         self.test_pattern = on;
     }
@@ -611,9 +1025,265 @@ impl D2DWindowRenderer {
         self.show_debug_overlay = on;
     }
 
+    /// Render for a premultiplied-alpha swapchain: areas the scene doesn't paint stay transparent. Takes effect
+    /// with a full redraw.
+    pub fn set_transparent(&mut self, on: bool) {
+        if self.transparent != on {
+            self.transparent = on;
+            // Cached tiles were rasterized against the old background
+            if let Some(tiles) = &mut self.tiles {
+                tiles.invalidate(None);
+            }
+            self.invalidate();
+        }
+    }
+
+    pub fn is_transparent(&self) -> bool {
+        self.transparent
+    }
+
+    /// Limit the next frame to these rectangles (scene units), or repaint everything for `None`.
+    /// Anything outside them must be unchanged since the previous frame.
+    pub fn set_damage(&mut self, damage: Option<&[Rect]>) {
+        self.damage = damage.map(|rects| rects.to_vec());
+    }
+
+    /// Force the next frame to repaint (and present) the whole target, e.g. after a failed present.
+    pub fn invalidate(&mut self) {
+        self.needs_full_redraw = true;
+    }
+
+    /// Backbuffer pixels drawn by the last frame, to pass to `Present1`. `None` means present the whole frame.
+    pub fn dirty_rects(&self) -> Option<&[RECT]> {
+        self.dirty_rects.as_deref()
+    }
+
+    /// Switch tiled rendering on or off. While on, scenes are recorded in content coordinates (no scroll
+    /// applied) and each frame must be planned with [`plan_tiled_frame`](Self::plan_tiled_frame).
+    pub fn set_tiled(&mut self, on: bool) {
+        if on == self.tiles.is_some() {
+            return;
+        }
+        let tile_budget = self.memory_budget / 2;
+        self.tiles = on.then(|| {
+            let mut tiles = TileCache::new();
+            tiles.set_budget(tile_budget);
+            tiles
+        });
+        self.tile_frame = None;
+        self.tiled_origin = None;
+        self.needs_full_redraw = true;
+    }
+
+    pub fn is_tiled(&self) -> bool {
+        self.tiles.is_some()
+    }
+
+    /// Upper bound on tile memory; least recently used tiles outside the view are released beyond it.
+    pub fn set_tile_budget(&mut self, bytes: usize) {
+        if let Some(tiles) = &mut self.tiles {
+            tiles.set_budget(bytes);
+        }
+    }
+
+    pub fn tile_bytes(&self) -> usize {
+        self.tiles.as_ref().map_or(0, |t| t.bytes())
+    }
+
+    /// Content origin shown by the last tiled frame, if any
+    pub fn tiled_origin(&self) -> Option<(f64, f64)> {
+        self.tiled_origin
+    }
+
+    /// Prepare a tiled frame showing `view` (w, h scene units) at content `origin` of a `content` (w, h) large
+    /// document: drop tiles touched by `damage` (content coordinates, `None` for everything) and return the
+    /// content rects the next scene must cover, i.e. the tiles that still have to be rasterized. Empty when the
+    /// frame only recomposites.
+    pub fn plan_tiled_frame(
+        &mut self,
+        origin: (f64, f64),
+        view: (f64, f64),
+        content: (f64, f64),
+        damage: Option<&[Rect]>,
+    ) -> Vec<Rect> {
+        let tile_bytes = {
+            let (w, h) = self.tile_pixel_size();
+            w as usize * h as usize * 4
+        };
+        let Some(tiles) = &mut self.tiles else {
+            return Vec::new();
+        };
+        tiles.invalidate(damage);
+        let rects = tiles.plan(origin, view, content, tile_bytes);
+        self.tile_frame = Some(origin);
+        rects
+    }
+
+    fn tile_pixel_size(&self) -> (u32, u32) {
+        let (mut dpi_x, mut dpi_y) = (96.0f32, 96.0f32);
+        if let Some(ctx) = &self.d2d_ctx {
+            unsafe { ctx.GetDpi(&mut dpi_x, &mut dpi_y) };
+        }
+        (
+            (TILE_SIZE * dpi_x as f64 / 96.0).ceil() as u32,
+            (TILE_SIZE * dpi_y as f64 / 96.0).ceil() as u32,
+        )
+    }
+
+    /// Cap on cached device resources. When tiled, tiles may use up to half of it.
+    pub fn set_memory_budget(&mut self, bytes: usize) {
+        self.memory_budget = bytes;
+        if let Some(tiles) = &mut self.tiles {
+            tiles.set_budget(bytes / 2);
+        }
+        self.enforce_memory_budget();
+    }
+
+    /// Bytes currently held by the resource caches and tiles
+    pub fn memory_usage(&self) -> usize {
+        self.image_cache.bytes()
+            + self.gradient_cache.bytes()
+            + self.shadow_cache.bytes()
+            + self.font_face_cache.bytes()
+            + self.glyph_outline_cache.bytes()
+            + self.tile_bytes()
+    }
+
+    /// Release every cached resource (they are recreated on demand) and let the driver free its internal
+    /// allocations, e.g. when the app is hidden or suspended. The frame on screen is not affected.
+    pub fn trim(&mut self) {
+        let before = self.memory_usage();
+        self.image_cache.clear();
+        self.images.clear();
+        self.gradient_cache.clear();
+        self.shadow_cache.clear();
+        self.font_face_cache.clear();
+        self.glyph_outline_cache.clear();
+        self.geometry_cache.clear();
+        if let Some(tiles) = &mut self.tiles {
+            tiles.invalidate(None);
+        }
+        // No ClearState first: the immediate context is shared with the host, which may have state bound on it
+        if let Some(dxgi) = self
+            .d3d_device
+            .as_ref()
+            .and_then(|device| device.cast::<IDXGIDevice3>().ok())
+        {
+            unsafe { dxgi.Trim() };
+        }
+        debug_log_d2d(&format!("trim: released {} KB", before / 1024));
+    }
+
+    /// Called from a rayon thread whenever an image finishes preparing off-thread; the host should schedule a
+    /// frame and pass [`take_image_damage`](Self::take_image_damage) on as damage.
+    pub fn set_image_waker(&mut self, waker: Option<Arc<dyn Fn() + Send + Sync>>) {
+        self.images.set_waker(waker);
+    }
+
+    /// Placeholders (scene units) whose image has finished preparing since the last call. They must be repainted
+    /// (added to the next frame's damage, or its tiles invalidated) for the image to show.
+    pub fn take_image_damage(&mut self) -> Vec<Rect> {
+        self.images.take_damage(self.frame_index)
+    }
+
+    /// Whether prepared images are waiting for a frame to show them
+    pub fn has_pending_images(&self) -> bool {
+        self.images.has_pending()
+    }
+
+    /// Whether a frame failed because the D3D device was removed or reset (cleared by the call). The renderer must
+    /// then be given a swapchain on a new device, after [`release_device`](Self::release_device).
+    pub fn take_device_lost(&mut self) -> bool {
+        std::mem::take(&mut self.device_lost)
+    }
+
+    /// Drop everything tied to the current D3D device (swapchain, D2D device/context, bitmaps, brushes, geometry
+    /// realizations, tiles) so the next `set_swapchain` rebuilds on whatever device the new swapchain uses.
+    /// DirectWrite objects are device independent and kept.
+    pub fn release_device(&mut self) {
+        self.release_backbuffer_resources();
+        self.image_cache.clear();
+        self.gradient_cache.clear();
+        self.shadow_cache.clear();
+        self.geometry_cache.clear();
+        self.glyph_outline_cache.clear();
+        if let Some(tiles) = &mut self.tiles {
+            tiles.invalidate(None);
+        }
+        self.tile_frame = None;
+        self.tiled_origin = None;
+        self.gaussian_blur_effect = None;
+        self.d2d_ctx = None;
+        self.d2d_device = None;
+        self.d2d_factory = None;
+        self.d3d_device = None;
+        self.swapchain = None;
+        self.active = false;
+        self.needs_full_redraw = true;
+        self.dirty_rects = None;
+        self.recent_damage.clear();
+        debug_log_d2d("release_device: device resources dropped");
+    }
+
+    fn check_end_draw(&mut self, what: &str, res: windows::core::Result<()>) {
+        let Err(e) = res else {
+            vlog!("{}: EndDraw ok", what);
+            return;
+        };
+        debug_log_d2d(&format!("{}: EndDraw error {:?}", what, e));
+        if e.code() == D2DERR_RECREATE_TARGET || e.code() == DXGI_ERROR_DEVICE_REMOVED || e.code() == DXGI_ERROR_DEVICE_RESET {
+            self.device_lost = true;
+        }
+    }
+
+    /// Evict least recently used resources, across all caches, until they fit the budget. Entries used by the
+    /// current frame are kept even if that leaves the caches over budget.
+    fn enforce_memory_budget(&mut self) {
+        let budget = if self.tiles.is_some() { self.memory_budget - self.memory_budget / 2 } else { self.memory_budget };
+        let mut bytes = self.memory_usage() - self.tile_bytes();
+        let mut evicted = 0u32;
+        while bytes > budget {
+            let oldest = [
+                self.image_cache.oldest(),
+                self.gradient_cache.oldest(),
+                self.shadow_cache.oldest(),
+                self.font_face_cache.oldest(),
+                self.glyph_outline_cache.oldest(),
+            ];
+            let Some((idx, last_used)) = oldest
+                .iter()
+                .enumerate()
+                .filter_map(|(i, t)| t.map(|t| (i, t)))
+                .min_by_key(|(_, t)| *t)
+            else {
+                break;
+            };
+            if last_used >= self.frame_index {
+                break;
+            }
+            bytes -= match idx {
+                0 => self.image_cache.pop_oldest(),
+                1 => self.gradient_cache.pop_oldest(),
+                2 => self.shadow_cache.pop_oldest(),
+                3 => self.font_face_cache.pop_oldest(),
+                _ => self.glyph_outline_cache.pop_oldest(),
+            };
+            evicted += 1;
+        }
+        if evicted > 0 {
+            vlog!("memory budget: evicted {} resources, {} KB cached", evicted, bytes / 1024);
+        }
+    }
+
     pub fn set_swapchain(&mut self, sc: IDXGISwapChain1, width: u32, height: u32) {
         self.width = width.max(1);
         self.height = height.max(1);
+        let desc = unsafe { sc.GetDesc1() }.ok();
+        self.partial_present_ok =
+            desc.is_some_and(|desc| desc.SwapEffect == DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL);
+        self.buffer_count = desc.map_or(2, |desc| desc.BufferCount.max(1) as usize);
+        self.recent_damage.clear();
+        self.needs_full_redraw = true;
         self.swapchain = Some(sc);
         if self.d3d_device.is_none() {
             self.init_devices_from_swapchain();
@@ -693,46 +1363,7 @@ impl D2DWindowRenderer {
                                             DWRITE_FACTORY_TYPE_SHARED,
                                         ) {
                                             self.dwrite_factory = Some(dwf.clone());
-                                            // Create a default font face (Segoe UI) for glyph runs.
-                                            let mut collection: Option<IDWriteFontCollection> =
-                                                None;
-                                            if dwf
-                                                .GetSystemFontCollection(&mut collection, false)
-                                                .is_ok()
-                                            {
-                                                if let Some(collection) = collection {
-                                                    let mut idx = 0u32;
-                                                    let mut exists = false.into();
-                                                    if collection
-                                                        .FindFamilyName(
-                                                            windows::core::w!("Segoe UI"),
-                                                            &mut idx,
-                                                            &mut exists,
-                                                        )
-                                                        .is_ok()
-                                                        && exists.as_bool()
-                                                    {
-                                                        if let Ok(family) =
-                                                            collection.GetFontFamily(idx)
-                                                        {
-                                                            if let Ok(font) = family
-                                                                .GetFirstMatchingFont(
-                                                                    DWRITE_FONT_WEIGHT_NORMAL,
-                                                                    DWRITE_FONT_STRETCH_NORMAL,
-                                                                    DWRITE_FONT_STYLE_NORMAL,
-                                                                )
-                                                            {
-                                                                if let Ok(face) =
-                                                                    font.CreateFontFace()
-                                                                {
-                                                                    self.dwrite_font_face =
-                                                                        Some(face);
-                                                                }
-                                                            }
-                                                        }
-                                                    }
-                                                }
-                                            }
+                                            self.dwrite_font_face = default_font_face(&dwf);
                                         }
                                     }
                                 }
@@ -833,7 +1464,115 @@ impl D2DWindowRenderer {
         ok
     }
 
-    fn playback(&mut self, target: &ID2D1Bitmap1) {
+    /// Resolve this frame's damage into a D2D clip (DIPs) and the matching backbuffer dirty rects: the damage of
+    /// this frame plus that of the frames presented since the backbuffer was last on screen.
+    /// Returns None (and clears `dirty_rects`) when the whole target must be drawn.
+    fn take_damage_clip(&mut self) -> Option<Vec<D2D_RECT_F>> {
+        let damage = self.damage.take();
+        let full = self.needs_full_redraw
+            || !self.partial_present_ok
+            || self.show_debug_overlay
+            || self.test_pattern;
+        self.needs_full_redraw = false;
+        self.dirty_rects = None;
+        let damage = match damage {
+            Some(damage) if !full => damage,
+            _ => {
+                self.record_frame_damage(None);
+                return None;
+            }
+        };
+        // Scene units are DIPs; the backbuffer is in pixels
+        let (mut dpi_x, mut dpi_y) = (96.0f32, 96.0f32);
+        if let Some(ctx) = &self.d2d_ctx {
+            unsafe { ctx.GetDpi(&mut dpi_x, &mut dpi_y) };
+        }
+        let (sx, sy) = (dpi_x as f64 / 96.0, dpi_y as f64 / 96.0);
+        let mut pixels = Vec::with_capacity(damage.len());
+        for r in damage {
+            // Snap outward so antialiased edges are fully repainted, then clamp to the target
+            let left = ((r.x0 * sx).floor() as i32).clamp(0, self.width as i32);
+            let top = ((r.y0 * sy).floor() as i32).clamp(0, self.height as i32);
+            let right = ((r.x1 * sx).ceil() as i32).clamp(0, self.width as i32);
+            let bottom = ((r.y1 * sy).ceil() as i32).clamp(0, self.height as i32);
+            if right <= left || bottom <= top {
+                continue;
+            }
+            pixels.push(RECT { left, top, right, bottom });
+        }
+        // Present1 treats zero dirty rects as "whole frame"; keep both sides consistent
+        if pixels.is_empty() {
+            self.record_frame_damage(None);
+            return None;
+        }
+        // Flip model: this backbuffer still holds the frame from `buffer_count` presents ago
+        let stale = self.buffer_count.saturating_sub(1);
+        let mut redraw = (self.recent_damage.len() >= stale).then(|| pixels.clone());
+        for frame in &self.recent_damage {
+            match (frame, &mut redraw) {
+                (Some(frame), Some(redraw)) => redraw.extend_from_slice(frame),
+                _ => redraw = None,
+            }
+        }
+        self.record_frame_damage(Some(pixels));
+        let redraw = redraw?;
+        let clip = redraw
+            .iter()
+            .map(|r| D2D_RECT_F {
+                left: (r.left as f64 / sx) as f32,
+                top: (r.top as f64 / sy) as f32,
+                right: (r.right as f64 / sx) as f32,
+                bottom: (r.bottom as f64 / sy) as f32,
+            })
+            .collect();
+        self.dirty_rects = Some(redraw);
+        Some(clip)
+    }
+
+    /// Remember what this frame changed (None: everything) for the partial frames drawn into the same buffer later
+    fn record_frame_damage(&mut self, pixels: Option<Vec<RECT>>) {
+        self.recent_damage.push_back(pixels);
+        while self.recent_damage.len() > self.buffer_count.saturating_sub(1) {
+            self.recent_damage.pop_front();
+        }
+    }
+
+    /// Push a clip restricting drawing to `clip`. Returns whether a layer (`Some(true)`) or an axis-aligned
+    /// clip (`Some(false)`) was pushed, so the caller can pop the matching kind.
+    unsafe fn push_damage_clip(&self, ctx: &ID2D1DeviceContext, clip: &[D2D_RECT_F]) -> Option<bool> {
+        if let [rect] = clip {
+            ctx.PushAxisAlignedClip(rect, D2D1_ANTIALIAS_MODE_ALIASED);
+            return Some(false);
+        }
+        let factory = self.d2d_factory.as_ref()?;
+        let geoms: Vec<Option<ID2D1Geometry>> = clip
+            .iter()
+            .filter_map(|r| factory.CreateRectangleGeometry(r).ok())
+            .map(|g| g.cast::<ID2D1Geometry>().ok())
+            .collect();
+        let group = factory.CreateGeometryGroup(D2D1_FILL_MODE_WINDING, &geoms).ok()?;
+        let params = D2D1_LAYER_PARAMETERS1 {
+            contentBounds: D2D_RECT_F {
+                left: f32::MIN,
+                top: f32::MIN,
+                right: f32::MAX,
+                bottom: f32::MAX,
+            },
+            geometricMask: std::mem::ManuallyDrop::new(group.cast::<ID2D1Geometry>().ok()),
+            maskAntialiasMode: D2D1_ANTIALIAS_MODE_ALIASED,
+            maskTransform: windows::Foundation::Numerics::Matrix3x2::identity(),
+            opacity: 1.0,
+            opacityBrush: std::mem::ManuallyDrop::new(None),
+            layerOptions: D2D1_LAYER_OPTIONS1_NONE,
+        };
+        ctx.PushLayer(&params, None::<&ID2D1Layer>);
+        let _ = std::mem::ManuallyDrop::into_inner(params.geometricMask);
+        Some(true)
+    }
+
+    /// Replay `commands` into `target`. `clip` limits a backbuffer frame to the damaged rects; `tile` instead
+    /// rasterizes the given content rect of a tiled scene (no overlay or test pattern).
+    fn playback(&mut self, target: &ID2D1Bitmap1, commands: &[Command], clip: Option<&[D2D_RECT_F]>, tile: Option<Rect>) {
         let t0 = Instant::now();
         let ctx = match &self.d2d_ctx {
             Some(ctx) => ctx.clone(),
@@ -853,10 +1592,11 @@ impl D2DWindowRenderer {
             let _ = ctx.SetTarget(target);
             // Configure antialiasing + ClearType after binding target (Step C)
             let _ = ctx.SetAntialiasMode(D2D1_ANTIALIAS_MODE_PER_PRIMITIVE);
-            let _ = ctx.SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE_CLEARTYPE);
+            let text_aa = if self.transparent { D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE } else { D2D1_TEXT_ANTIALIAS_MODE_CLEARTYPE };
+            let _ = ctx.SetTextAntialiasMode(text_aa);
             let actual_mode = ctx.GetTextAntialiasMode();
-            if actual_mode != D2D1_TEXT_ANTIALIAS_MODE_CLEARTYPE {
-                debug_log_d2d(&format!("playback: requested CLEARTYPE but got {:?}", actual_mode));
+            if actual_mode != text_aa {
+                debug_log_d2d(&format!("playback: requested {:?} but got {:?}", text_aa, actual_mode));
             }
             // Clear: previously we filled with transparent which caused full window transparency when scene content lacked opaque background.
             // Use an opaque fallback (white) so something is always visible; later we can sample actual page background color.
@@ -867,15 +1607,47 @@ impl D2DWindowRenderer {
                 right: size.width,
                 bottom: size.height,
             };
-            let fallback_bg_brush = self.create_solid_brush(Color::WHITE); // TODO: replace with document root background
-            let _ = ctx.FillRectangle(&full, &fallback_bg_brush);
+            // Transparent frames erase what they redraw. Done before the damage clip is pushed: a multi-rect clip
+            // is a layer, which composites over the target and so can't erase it.
+            let clear = D2D1_COLOR_F { r: 0.0, g: 0.0, b: 0.0, a: 0.0 };
+            if self.transparent {
+                for r in clip.unwrap_or(&[]) {
+                    ctx.PushAxisAlignedClip(r, D2D1_ANTIALIAS_MODE_ALIASED);
+                    ctx.Clear(Some(&clear));
+                    ctx.PopAxisAlignedClip();
+                }
+            }
+            // Partial frames only touch the damaged rects; everything else keeps the previous frame
+            let damage_layer = clip.and_then(|clip| self.push_damage_clip(&ctx, clip));
+            let clip = if damage_layer.is_some() {
+                clip
+            } else {
+                // No clip could be pushed: draw (and present) the whole frame
+                self.dirty_rects = None;
+                None
+            };
+            if self.transparent {
+                if clip.is_none() {
+                    ctx.Clear(Some(&clear));
+                }
+            } else {
+                let fallback_bg_brush = self.create_solid_brush(Color::WHITE); // TODO: replace with document root background
+                match clip {
+                    Some(clip) => {
+                        for r in clip {
+                            let _ = ctx.FillRectangle(r, &fallback_bg_brush);
+                        }
+                    }
+                    None => {
+                        let _ = ctx.FillRectangle(&full, &fallback_bg_brush);
+                    }
+                }
+            }
             vlog!("fallback bg {}x{}", size.width as u32, size.height as u32);
             // (Removed always-on debug rect; keep codebase clean. Use VERBOSE logs for diagnostics.)
             // Reset per-frame debug counters
             self.debug_shadow_logs = 0;
 
-            // Collect commands to avoid borrow checker issues
-            let commands = std::mem::take(&mut self.scene.commands);
             let command_count = commands.len();
             self.last_command_count = command_count as u32;
             if command_count == 0 {
@@ -897,7 +1669,7 @@ impl D2DWindowRenderer {
             }
 
             // Diagnostic test pattern if no commands (placeholder frame visibility)
-            if command_count == 0 && self.test_pattern {
+            if command_count == 0 && self.test_pattern && tile.is_none() {
                 let size = target.GetSize();
                 let hw = size.width * 0.5;
                 let hh = size.height * 0.5;
@@ -945,6 +1717,21 @@ impl D2DWindowRenderer {
                 }
                 debug_log_d2d("playback: drew test pattern (placeholder)");
             }
+            // Geometry realizations need ID2D1DeviceContext1 (Windows 8.1+); without it cached geometry is drawn directly
+            let ctx1 = ctx.cast::<ID2D1DeviceContext1>().ok();
+            self.frame_index += 1;
+            self.upload_bytes = 0;
+            // A tile sees the scene through its own origin
+            self.scene_offset = tile.map_or((0.0, 0.0), |t| (-t.x0, -t.y0));
+            ctx.SetTransform(&translation(self.scene_offset.0, self.scene_offset.1));
+            let outside_tile = |bounds: &D2D_RECT_F, pad: f32| {
+                tile.is_some_and(|t| {
+                    bounds.right + pad < t.x0 as f32
+                        || bounds.left - pad > t.x1 as f32
+                        || bounds.bottom + pad < t.y0 as f32
+                        || bounds.top - pad > t.y1 as f32
+                })
+            };
             // Playback counters
             let mut fill_path_count = 0u32;
             let mut stroke_path_count = 0u32;
@@ -976,7 +1763,7 @@ impl D2DWindowRenderer {
                     }
                 }
             };
-            for (cmd_index, cmd) in commands.into_iter().enumerate() {
+            for (cmd_index, cmd) in commands.iter().enumerate() {
                 // max command limit feature removed (kept simpler playback path)
                 vlog!(
                     "cmd {} {}",
@@ -998,22 +1785,30 @@ impl D2DWindowRenderer {
                 match cmd {
                     Command::FillPath { path, brush } => {
                         fill_path_count += 1;
-                        if let RecordedBrush::Image(img) = &brush {
-                            // Build geometry to honor any complex shape / potential future rounded corners.
-                            if let Some(geom) = self.build_path_geometry(&path) {
-                                // Bounds give target box (CSS layout size already applied in path coordinates).
-                                let bounds = geom.GetBounds(None).unwrap_or(D2D_RECT_F{ left:0.0, top:0.0, right:0.0, bottom:0.0 });
+                        if path_bounds(path).is_some_and(|b| outside_tile(&b, 1.0)) {
+                            continue;
+                        }
+                        if let RecordedBrush::Image(img) = brush {
+                            // Bounds give target box (CSS layout size already applied in path coordinates).
+                            if let Some(bounds) = path_bounds(&path) {
                                 let w = bounds.right - bounds.left;
                                 let h = bounds.bottom - bounds.top;
                                 if w > 0.5 && h > 0.5 {
-                                    let bitmap = self.get_or_create_image_bitmap(img);
                                     // Optional clip to geometry (handles non-rect paths); keep simple axis clip when rectangular.
                                     // Detect rectangular by comparing path bbox to layout; if not exact we can push clip.
                                     let dest = bounds; // scale bitmap to fit dest
-                                    ctx.DrawBitmap(&bitmap, Some(&dest), img.alpha, D2D1_INTERPOLATION_MODE_LINEAR, None, None);
+                                    match self.get_or_create_image_bitmap(img, &dest) {
+                                        Some(bitmap) => ctx.DrawBitmap(&bitmap, Some(&dest), img.alpha, D2D1_INTERPOLATION_MODE_LINEAR, None, None),
+                                        None => {
+                                            // Still being prepared off-thread
+                                            let brush = self.create_solid_brush(IMAGE_PLACEHOLDER_COLOR);
+                                            ctx.FillRectangle(&dest, &brush);
+                                        }
+                                    }
                                 }
                             }
-                        } else if let Some(geom) = self.build_path_geometry(&path) {
+                        } else if let Some(bounds) = path_bounds(&path) {
+                            let solid = matches!(brush, RecordedBrush::Solid(_));
                             let brush_obj = self.get_or_create_brush(&brush);
                             if fill_path_count <= 8 {
                                 if let Ok(sol) = brush_obj.cast::<ID2D1SolidColorBrush>() {
@@ -1023,15 +1818,16 @@ impl D2DWindowRenderer {
                                     vlog!("FillPath idx={} cmd={} (non-solid)", fill_path_count, cmd_index);
                                 }
                             }
-                            // Attempt rectangle snapping: if geometry bounds form an axis-aligned rect very close to integer edges, snap to avoid half-pixel fill blur.
-                            let bounds = geom.GetBounds(None).unwrap_or(D2D_RECT_F{ left:0.0, top:0.0, right:0.0, bottom:0.0 });
+                            // Attempt rectangle snapping: if the path forms an axis-aligned rect very close to integer edges, snap to avoid half-pixel fill blur.
+                            // Only pure line paths qualify; anything with curves goes through the geometry cache.
+                            let is_polyline = path.iter().all(|el| matches!(el, PathEl::MoveTo(_) | PathEl::LineTo(_) | PathEl::ClosePath));
                             let mut snapped = false;
                             let l_round = bounds.left.round();
                             let t_round = bounds.top.round();
                             let r_round = bounds.right.round();
                             let b_round = bounds.bottom.round();
                             let eps = 0.01; // tolerance in px
-                            if (bounds.left - l_round).abs() < eps && (bounds.top - t_round).abs() < eps && (bounds.right - r_round).abs() < eps && (bounds.bottom - b_round).abs() < eps {
+                            if is_polyline && (bounds.left - l_round).abs() < eps && (bounds.top - t_round).abs() < eps && (bounds.right - r_round).abs() < eps && (bounds.bottom - b_round).abs() < eps {
                                 // Only snap if width/height are >= 1 to avoid collapsing hairlines unexpectedly
                                 if (r_round - l_round) >= 1.0 && (b_round - t_round) >= 1.0 {
                                     let rect = D2D_RECT_F { left: l_round, top: t_round, right: r_round, bottom: b_round };
@@ -1039,66 +1835,48 @@ impl D2DWindowRenderer {
                                     snapped = true;
                                 }
                             }
-                            if !snapped { let _ = ctx.FillGeometry(&geom, &brush_obj, None); }
+                            if !snapped { self.draw_cached_path(&ctx, ctx1.as_ref(), &path, (0.0, 0.0), &brush_obj, solid, None); }
                         }
                     }
                     Command::StrokePath { path, brush, width } => {
+                        let width = *width;
                         stroke_path_count += 1;
-                        if let Some(geom) = self.build_path_geometry(&path) {
-                            let brush = self.get_or_create_brush(&brush);
-                            // Stroke rectangle snapping heuristic: shift geometry by +/-0.5 when beneficial for crisp pixel alignment.
-                            let mut xs: Vec<f64> = Vec::new();
-                            let mut ys: Vec<f64> = Vec::new();
-                            for el in &path { if let PathEl::MoveTo(p) | PathEl::LineTo(p) = el { xs.push(p.x); ys.push(p.y); } }
-                            let mut uniq_x: Vec<f64> = Vec::new();
-                            let mut uniq_y: Vec<f64> = Vec::new();
-                            let tol = 0.01;
-                            for x in xs { if !uniq_x.iter().any(|u| (u - x).abs() < tol) { uniq_x.push(x); } }
-                            for y in ys { if !uniq_y.iter().any(|u| (u - y).abs() < tol) { uniq_y.push(y); } }
-                            let mut dx_shift = 0.0f32; let mut dy_shift = 0.0f32;
-                            if uniq_x.len() == 2 && uniq_y.len() == 2 && width <= 4.0 {
-                                let near_int = (width.round() - width).abs() < 0.01;
-                                if near_int {
-                                    let w_int = width.round() as i32;
-                                    let norm_frac = |v: f64| { let f = v.fract(); if (f - 1.0).abs() < 1e-6 { 0.0 } else { f } };
-                                    let fx = norm_frac(uniq_x[0]);
-                                    let fy = norm_frac(uniq_y[0]);
-                                    if w_int % 2 == 1 { // odd: center at .5 if currently near int
-                                        if fx < 0.25 || fx > 0.75 { dx_shift = 0.5; }
-                                        if fy < 0.25 || fy > 0.75 { dy_shift = 0.5; }
-                                    } else { // even: center at integer if currently near .5
-                                        if (fx - 0.5).abs() < 0.25 { dx_shift = -0.5; }
-                                        if (fy - 0.5).abs() < 0.25 { dy_shift = -0.5; }
-                                    }
-                                }
-                            }
-                            if dx_shift != 0.0 || dy_shift != 0.0 {
-                                // Rebuild shifted geometry (avoid requiring matrix type definition differences across win32 metadata versions)
-                                let mut shifted: Vec<PathEl> = Vec::with_capacity(path.len());
-                                for el in &path {
-                                    match el {
-                                        PathEl::MoveTo(p) => shifted.push(PathEl::MoveTo(kurbo::Point { x: p.x + dx_shift as f64, y: p.y + dy_shift as f64 })),
-                                        PathEl::LineTo(p) => shifted.push(PathEl::LineTo(kurbo::Point { x: p.x + dx_shift as f64, y: p.y + dy_shift as f64 })),
-                                        PathEl::QuadTo(p1, p2) => shifted.push(PathEl::QuadTo(
-                                            kurbo::Point { x: p1.x + dx_shift as f64, y: p1.y + dy_shift as f64 },
-                                            kurbo::Point { x: p2.x + dx_shift as f64, y: p2.y + dy_shift as f64 },
-                                        )),
-                                        PathEl::CurveTo(p1, p2, p3) => shifted.push(PathEl::CurveTo(
-                                            kurbo::Point { x: p1.x + dx_shift as f64, y: p1.y + dy_shift as f64 },
-                                            kurbo::Point { x: p2.x + dx_shift as f64, y: p2.y + dy_shift as f64 },
-                                            kurbo::Point { x: p3.x + dx_shift as f64, y: p3.y + dy_shift as f64 },
-                                        )),
-                                        PathEl::ClosePath => shifted.push(PathEl::ClosePath),
-                                    }
-                                }
-                                if let Some(shifted_geom) = self.build_path_geometry(&shifted) {
-                                    vlog!("StrokePath snap dx={:.2} dy={:.2} w={:.2}", dx_shift, dy_shift, width);
-                                    let _ = ctx.DrawGeometry(&shifted_geom, &brush, width as f32, None);
-                                    continue;
+                        if path_bounds(path).is_some_and(|b| outside_tile(&b, width + 1.0)) {
+                            continue;
+                        }
+                        let solid = matches!(brush, RecordedBrush::Solid(_));
+                        let brush = self.get_or_create_brush(&brush);
+                        // Stroke rectangle snapping heuristic: shift geometry by +/-0.5 when beneficial for crisp pixel alignment.
+                        let mut xs: Vec<f64> = Vec::new();
+                        let mut ys: Vec<f64> = Vec::new();
+                        for el in path.iter() { if let PathEl::MoveTo(p) | PathEl::LineTo(p) = el { xs.push(p.x); ys.push(p.y); } }
+                        let mut uniq_x: Vec<f64> = Vec::new();
+                        let mut uniq_y: Vec<f64> = Vec::new();
+                        let tol = 0.01;
+                        for x in xs { if !uniq_x.iter().any(|u| (u - x).abs() < tol) { uniq_x.push(x); } }
+                        for y in ys { if !uniq_y.iter().any(|u| (u - y).abs() < tol) { uniq_y.push(y); } }
+                        let mut dx_shift = 0.0f32; let mut dy_shift = 0.0f32;
+                        if uniq_x.len() == 2 && uniq_y.len() == 2 && width <= 4.0 {
+                            let near_int = (width.round() - width).abs() < 0.01;
+                            if near_int {
+                                let w_int = width.round() as i32;
+                                let norm_frac = |v: f64| { let f = v.fract(); if (f - 1.0).abs() < 1e-6 { 0.0 } else { f } };
+                                let fx = norm_frac(uniq_x[0]);
+                                let fy = norm_frac(uniq_y[0]);
+                                if w_int % 2 == 1 { // odd: center at .5 if currently near int
+                                    if fx < 0.25 || fx > 0.75 { dx_shift = 0.5; }
+                                    if fy < 0.25 || fy > 0.75 { dy_shift = 0.5; }
+                                } else { // even: center at integer if currently near .5
+                                    if (fx - 0.5).abs() < 0.25 { dx_shift = -0.5; }
+                                    if (fy - 0.5).abs() < 0.25 { dy_shift = -0.5; }
                                 }
                             }
-                            let _ = ctx.DrawGeometry(&geom, &brush, width as f32, None);
                         }
+                        if dx_shift != 0.0 || dy_shift != 0.0 {
+                            vlog!("StrokePath snap dx={:.2} dy={:.2} w={:.2}", dx_shift, dy_shift, width);
+                        }
+                        // The snap shift is just part of the replay translation; the cached geometry is shared
+                        self.draw_cached_path(&ctx, ctx1.as_ref(), &path, (dx_shift as f64, dy_shift as f64), &brush, solid, Some(width as f32));
                     }
                     Command::PushLayer { rect } => {
                         if disable_clips {
@@ -1143,6 +1921,7 @@ impl D2DWindowRenderer {
                         std_dev,
                         inset,
                     } => {
+                        let (rect, color, radius, std_dev, inset) = (*rect, *color, *radius, *std_dev, *inset);
                         // Allow disabling shadows for isolation (BLITZ_DISABLE_SHADOWS=1)
                         if std::env::var("BLITZ_DISABLE_SHADOWS")
                             .map(|v| v == "1" || v.eq_ignore_ascii_case("true"))
@@ -1153,6 +1932,11 @@ impl D2DWindowRenderer {
                         if inset && disable_inset_shadows {
                             continue;
                         }
+                        let reach = (radius + std_dev * 3.0) as f32 + 1.0;
+                        let shadow_bounds = D2D_RECT_F { left: rect.x0 as f32, top: rect.y0 as f32, right: rect.x1 as f32, bottom: rect.y1 as f32 };
+                        if outside_tile(&shadow_bounds, reach) {
+                            continue;
+                        }
                         if self.debug_shadow_logs < 8 {
                             vlog!(
                                 "BoxShadow{} rect=({}, {}, {}, {}) r={} sd={} a={:.3}",
@@ -1185,6 +1969,7 @@ impl D2DWindowRenderer {
                         font,
                         var_coords: _,
                     } => {
+                        let (origin, size, style) = (*origin, *size, style.clone());
                         if disable_text {
                             continue;
                         }
@@ -1201,10 +1986,12 @@ impl D2DWindowRenderer {
                                     }
                                 };
                                 let brush = self.create_solid_brush(color);
-                                if let Some(stroke_width) = stroke_width_opt {
-                                    if let Some(geom) = self.build_glyph_outline_geometry(&face, size, &glyph_indices, &advances) {
-                                        let _ = ctx.DrawGeometry(&geom, &brush, stroke_width, None);
-                                        continue; // stroke done
+                                let snapped_y = snap_baseline(origin.1);
+                                let origin_pt = D2D_POINT_2F { x: origin.0.round(), y: snapped_y };
+                                if stroke_width_opt.is_some() || size >= LARGE_GLYPH_EM_SIZE {
+                                    let key = glyph_outline_key(&font, size, &glyph_indices, &advances);
+                                    if self.draw_cached_glyph_outline(&ctx, ctx1.as_ref(), key, &font, &face, size, &glyph_indices, &advances, origin_pt, &brush, stroke_width_opt) {
+                                        continue;
                                     }
                                     // fall through: outline failed, use glyph run fill
                                 }
@@ -1218,8 +2005,6 @@ impl D2DWindowRenderer {
                                     isSideways: false.into(),
                                     bidiLevel: 0,
                                 };
-                                let snapped_y = snap_baseline(origin.1);
-                                let origin_pt = D2D_POINT_2F { x: origin.0.round(), y: snapped_y };
                                 if (origin.1 - snapped_y).abs() > 0.001 { vlog!("baseline snap mode={} in={:.3} out={:.3}", baseline_mode, origin.1, snapped_y); }
                                 let measuring = if use_gdi_for_small && size <= 12.5 { DWRITE_MEASURING_MODE_GDI_CLASSIC } else { DWRITE_MEASURING_MODE_NATURAL };
                                 if use_gdi_for_small && size <= 12.5 { vlog!("GlyphRun small-font GDI measuring size={:.2}", size); }
@@ -1244,18 +2029,105 @@ impl D2DWindowRenderer {
             );
             // If no commands, fallback bg already drawn earlier.
             // Transform: currently implicit identity (no cumulative transform stack applied here).
+            self.evict_idle_geometry();
+            self.images.evict_idle_ids(self.frame_index);
+            self.scene_offset = (0.0, 0.0);
+            ctx.SetTransform(&windows::Foundation::Numerics::Matrix3x2::identity());
+            match damage_layer {
+                Some(true) => ctx.PopLayer(),
+                Some(false) => ctx.PopAxisAlignedClip(),
+                None => {}
+            }
             // Draw overlay before EndDraw so it is visible
-            if self.show_debug_overlay {
+            if self.show_debug_overlay && tile.is_none() {
                 self.draw_debug_overlay(&ctx);
             }
             let end_res = ctx.EndDraw(None, None);
-            if let Err(e) = end_res {
-                debug_log_d2d(&format!("EndDraw error {:?}", e));
+            self.check_end_draw("playback", end_res);
+        }
+        self.playback_ms = t0.elapsed().as_secs_f32() * 1000.0;
+    }
+
+    /// Tiled frame: rasterize the tiles planned for `origin`, then composite the visible ones into the
+    /// backbuffer. Always presents the whole frame.
+    fn render_tiles(&mut self, commands: &[Command], origin: (f64, f64)) {
+        let Some(ctx) = self.d2d_ctx.clone() else {
+            return;
+        };
+        let pending: Vec<TileKey> = self.tiles.as_ref().map_or(Vec::new(), |t| t.pending().to_vec());
+        let (tile_w, tile_h) = self.tile_pixel_size();
+        let t0 = Instant::now();
+        unsafe {
+            let (mut dpi_x, mut dpi_y) = (96.0f32, 96.0f32);
+            ctx.GetDpi(&mut dpi_x, &mut dpi_y);
+            let props = D2D1_BITMAP_PROPERTIES1 {
+                pixelFormat: D2D1_PIXEL_FORMAT { format: DXGI_FORMAT_B8G8R8A8_UNORM, alphaMode: D2D1_ALPHA_MODE_PREMULTIPLIED },
+                dpiX: dpi_x,
+                dpiY: dpi_y,
+                bitmapOptions: D2D1_BITMAP_OPTIONS_TARGET,
+                colorContext: std::mem::ManuallyDrop::new(None),
+            };
+            for key in pending {
+                let bitmap = match ctx.CreateBitmap(D2D_SIZE_U { width: tile_w, height: tile_h }, None, 0, &props) {
+                    Ok(b) => b,
+                    Err(e) => {
+                        debug_log_d2d(&format!("render_tiles: CreateBitmap failed {:?}", e));
+                        break;
+                    }
+                };
+                self.playback(&bitmap, commands, None, Some(tiles::tile_rect(key)));
+                if let Some(tiles) = &mut self.tiles {
+                    tiles.insert(key, bitmap, tile_w as usize * tile_h as usize * 4);
+                }
+            }
+        }
+        let raster_ms = t0.elapsed().as_secs_f32() * 1000.0;
+        let Some(target) = self.backbuffer_bitmap.clone() else {
+            return;
+        };
+        self.needs_full_redraw = false;
+        self.dirty_rects = None;
+        self.record_frame_damage(None);
+        unsafe {
+            ctx.BeginDraw();
+            let _ = ctx.SetTarget(&target);
+            let size = target.GetSize();
+            let full = D2D_RECT_F { left: 0.0, top: 0.0, right: size.width, bottom: size.height };
+            if self.transparent {
+                ctx.Clear(Some(&D2D1_COLOR_F { r: 0.0, g: 0.0, b: 0.0, a: 0.0 }));
             } else {
-                vlog!("EndDraw ok");
+                let fallback_bg_brush = self.create_solid_brush(Color::WHITE);
+                let _ = ctx.FillRectangle(&full, &fallback_bg_brush);
+            }
+            // Composite on whole device pixels so tiles are copied, not resampled
+            let (sx, sy) = dpi_scale(&ctx);
+            let origin = ((origin.0 * sx).round() / sx, (origin.1 * sy).round() / sy);
+            let mut drawn = 0u32;
+            if let Some(tiles) = &self.tiles {
+                for (key, bitmap) in tiles.visible_tiles() {
+                    let r = tiles::tile_rect(key);
+                    let dest = D2D_RECT_F {
+                        left: (r.x0 - origin.0) as f32,
+                        top: (r.y0 - origin.1) as f32,
+                        right: (r.x1 - origin.0) as f32,
+                        bottom: (r.y1 - origin.1) as f32,
+                    };
+                    let _ = ctx.DrawBitmap(bitmap, Some(&dest), 1.0, D2D1_INTERPOLATION_MODE_NEAREST_NEIGHBOR, None, None);
+                    drawn += 1;
+                }
             }
+            if self.show_debug_overlay {
+                self.draw_debug_overlay(&ctx);
+            }
+            let end_res = ctx.EndDraw(None, None);
+            self.check_end_draw("render_tiles", end_res);
+            vlog!("tiles: composited {} at ({:.1}, {:.1})", drawn, origin.0, origin.1);
         }
-        self.playback_ms = t0.elapsed().as_secs_f32() * 1000.0;
+        if let Some(tiles) = &mut self.tiles {
+            tiles.evict();
+        }
+        self.tiled_origin = Some(origin);
+        self.playback_ms = raster_ms;
     }
 
     fn ensure_text_format(&mut self) {
@@ -1449,52 +2321,109 @@ impl D2DWindowRenderer {
 
     // Resolve (and cache) a font face for the provided key using DirectWrite system collection.
     fn get_or_create_font_face(&mut self, key: &FontKey) -> Option<IDWriteFontFace> {
-        if let Some(face) = self.font_face_cache.get(key) {
-            return Some(face.clone());
+        if let Some(face) = self.font_face_cache.get(key, self.frame_index) {
+            return face;
         }
         let factory = self.dwrite_factory.clone()?;
-        unsafe {
-            let mut collection_opt: Option<IDWriteFontCollection> = None;
-            if factory
-                .GetSystemFontCollection(&mut collection_opt, false)
-                .is_ok()
-            {
-                if let Some(collection) = collection_opt {
-                    let mut idx = 0u32;
-                    let mut exists = false.into();
-                    if collection
-                        .FindFamilyName(
-                            &windows::core::HSTRING::from(&key.family),
-                            &mut idx,
-                            &mut exists,
-                        )
-                        .is_ok()
-                        && exists.as_bool()
-                    {
-                        if let Ok(family) = collection.GetFontFamily(idx) {
-                            let weight = DWRITE_FONT_WEIGHT(key.weight as i32);
-                            // Map stretch (1..=9) directly; default normal (5)
-                            let stretch = DWRITE_FONT_STRETCH(key.stretch as i32);
-                            let style = if key.italic {
-                                DWRITE_FONT_STYLE_ITALIC
-                            } else {
-                                DWRITE_FONT_STYLE_NORMAL
-                            };
-                            if let Ok(font) = family.GetFirstMatchingFont(weight, stretch, style) {
-                                if let Ok(face) = font.CreateFontFace() {
-                                    self.font_face_cache.insert(key.clone(), face.clone());
-                                    return Some(face);
-                                }
-                            }
-                        }
-                    }
+        // Another renderer (or this one, before evicting it) may already have resolved this face
+        let face = {
+            let mut shared = SHARED_FONT_FACES.lock().unwrap();
+            match shared.get(key) {
+                Some(face) => face.0.clone(),
+                None => {
+                    let face = unsafe { system_font_face(&factory, key) };
+                    shared.insert(key.clone(), SharedFontFace(face.clone()));
+                    face
                 }
             }
+        };
+        let bytes = if face.is_some() { FONT_FACE_BYTES } else { 0 };
+        self.font_face_cache
+            .insert(key.clone(), face.clone(), bytes, self.frame_index);
+        face
+    }
+
+    /// Fill (`stroke == None`) or stroke a glyph run at `origin` from its cached outline, realized for runs drawn
+    /// in more than one frame. Returns false if the outline couldn't be built.
+    unsafe fn draw_cached_glyph_outline(
+        &mut self,
+        ctx: &ID2D1DeviceContext,
+        ctx1: Option<&ID2D1DeviceContext1>,
+        key: u64,
+        font: &FontKey,
+        face: &IDWriteFontFace,
+        size: f32,
+        glyph_indices: &[u16],
+        advances: &[f32],
+        origin: D2D_POINT_2F,
+        brush: &ID2D1SolidColorBrush,
+        stroke: Option<f32>,
+    ) -> bool {
+        let frame = self.frame_index;
+        // A different run under the same hash is rebuilt and takes the entry over
+        let hit = self
+            .glyph_outline_cache
+            .get_mut(&key, frame)
+            .is_some_and(|e| e.is_run(font, size, glyph_indices, advances));
+        if !hit {
+            let Some(geom) = self.build_glyph_outline_geometry(face, size, glyph_indices, advances) else {
+                return false;
+            };
+            let outline = CachedGlyphOutline {
+                geom,
+                font: font.clone(),
+                size: size.to_bits(),
+                glyph_indices: glyph_indices.into(),
+                advances: advances.iter().map(|a| a.to_bits()).collect(),
+                fill: None,
+                stroke: None,
+                uses: 0,
+                last_frame: 0,
+            };
+            self.glyph_outline_cache.insert(key, outline, glyph_indices.len() * GLYPH_OUTLINE_BYTES_PER_GLYPH, frame);
         }
-        None
+        let Some(entry) = self.glyph_outline_cache.get_mut(&key, frame) else {
+            return false;
+        };
+        if entry.last_frame != frame {
+            entry.uses = entry.uses.saturating_add(1);
+            entry.last_frame = frame;
+        }
+        let mut realization = None;
+        if let Some(ctx1) = ctx1.filter(|_| entry.uses >= 2) {
+            let (mut dpi_x, mut dpi_y) = (96.0f32, 96.0f32);
+            ctx.GetDpi(&mut dpi_x, &mut dpi_y);
+            let tolerance = D2D1_DEFAULT_FLATTENING_TOLERANCE / (dpi_x.max(dpi_y) / 96.0).max(1.0);
+            realization = match stroke {
+                Some(width) => {
+                    if entry.stroke.as_ref().map_or(true, |(w, _)| *w != width.to_bits()) {
+                        entry.stroke = ctx1
+                            .CreateStrokedGeometryRealization(&entry.geom, tolerance, width, None)
+                            .ok()
+                            .map(|r| (width.to_bits(), r));
+                    }
+                    entry.stroke.as_ref().map(|(_, r)| r.clone())
+                }
+                None => {
+                    if entry.fill.is_none() {
+                        entry.fill = ctx1.CreateFilledGeometryRealization(&entry.geom, tolerance).ok();
+                    }
+                    entry.fill.clone()
+                }
+            };
+        }
+        let base = self.scene_offset;
+        ctx.SetTransform(&translation(origin.x as f64 + base.0, origin.y as f64 + base.1));
+        match (realization, ctx1, stroke) {
+            (Some(r), Some(ctx1), _) => ctx1.DrawGeometryRealization(&r, brush),
+            (_, _, Some(width)) => ctx.DrawGeometry(&entry.geom, brush, width, None),
+            (_, _, None) => ctx.FillGeometry(&entry.geom, brush, None),
+        }
+        ctx.SetTransform(&translation(base.0, base.1));
+        true
     }
 
-    // Build outline geometry for glyph run; returns a path geometry or None on failure.
+    // Build outline geometry for glyph run (baseline origin at 0,0); returns a path geometry or None on failure.
     fn build_glyph_outline_geometry(
         &self,
         face: &IDWriteFontFace,
@@ -1566,8 +2495,8 @@ impl D2DWindowRenderer {
                 .hash(&mut hasher);
         }
         let key = hasher.finish();
-        if let Some(b) = self.gradient_cache.get(&key) {
-            return b.clone();
+        if let Some(b) = self.gradient_cache.get(&key, self.frame_index) {
+            return b;
         }
         let ctx = self.d2d_ctx.as_ref().unwrap();
         unsafe {
@@ -1650,42 +2579,153 @@ impl D2DWindowRenderer {
                         .unwrap()
                 }
             };
-            self.gradient_cache.insert(key, brush.clone());
+            self.gradient_cache.insert(key, brush.clone(), GRADIENT_BRUSH_BYTES, self.frame_index);
             brush
         }
     }
 
-    fn get_or_create_image_bitmap(&mut self, img: &RecordedImage) -> ID2D1Bitmap {
-        use std::hash::{Hash, Hasher};
-        let mut hasher = rustc_hash::FxHasher::default();
-        (img.width, img.height, img.alpha.to_bits()).hash(&mut hasher);
-        for b in img.data.iter().take(32) { b.hash(&mut hasher); }
-        let key = hasher.finish();
-        if let Some(existing) = self.image_cache.get(&key) { return existing.clone(); }
-        let ctx = self.d2d_ctx.as_ref().unwrap();
-        // Prepare premultiplied RGBA copy (Direct2D expects premultiplied alpha when using PREMULTIPLIED mode)
-        let mut premul: Vec<u8> = img.data.clone();
-        for px in premul.chunks_exact_mut(4) {
-            let a = px[3] as u16; // 0..255
-            if a < 255 { // only adjust when needed
-                px[0] = ((px[0] as u16 * a + 127) / 255) as u8;
-                px[1] = ((px[1] as u16 * a + 127) / 255) as u8;
-                px[2] = ((px[2] as u16 * a + 127) / 255) as u8;
+    /// The bitmap for `img` drawn into `dest` (scene units), at the smallest downscale level that still covers
+    /// `dest`. Pixels are prepared on the rayon pool the first time; until they are ready (or while this frame's
+    /// upload budget is spent) another level of the same image is returned if one is cached, else `None`.
+    fn get_or_create_image_bitmap(&mut self, img: &RecordedImage, dest: &D2D_RECT_F) -> Option<ID2D1Bitmap> {
+        let size = (img.width, img.height);
+        let target = ((dest.right - dest.left) as f64, (dest.bottom - dest.top) as f64);
+        let id = self.images.identity(&img.data, size, self.frame_index);
+        let key: ImageKey = (id, images::downscale_level(size, target));
+        if let Some(existing) = self.image_cache.get(&image_cache_key(key), self.frame_index) { return Some(existing); }
+        let dest_rect = Rect::new(dest.left as f64, dest.top as f64, dest.right as f64, dest.bottom as f64);
+        if let Some(prepared) = self.images.prepare(key, &img.data, size, dest_rect, self.frame_index) {
+            let bytes = prepared.pixels.len();
+            // Always take at least one image per frame so a single huge image can't starve
+            if self.upload_bytes == 0 || self.upload_bytes + bytes <= UPLOAD_BUDGET_BYTES {
+                self.upload_bytes += bytes;
+                if let Some(bitmap) = self.upload_image(&prepared) {
+                    self.image_cache.insert(image_cache_key(key), bitmap.clone(), bytes, self.frame_index);
+                    return Some(bitmap);
+                }
+            } else {
+                self.images.defer(key, prepared, dest_rect, self.frame_index);
             }
         }
+        // Any other level of the same image is a better placeholder than a blank box
+        (0..=images::MAX_DOWNSCALE_LEVEL)
+            .filter(|level| *level != key.1)
+            .find_map(|level| self.image_cache.get(&image_cache_key((key.0, level)), self.frame_index))
+    }
+
+    fn upload_image(&self, prepared: &images::PreparedImage) -> Option<ID2D1Bitmap> {
+        let ctx = self.d2d_ctx.as_ref()?;
         unsafe {
             let pf = D2D1_PIXEL_FORMAT { format: DXGI_FORMAT_R8G8B8A8_UNORM, alphaMode: D2D1_ALPHA_MODE_PREMULTIPLIED };
             let bp = D2D1_BITMAP_PROPERTIES1 { pixelFormat: pf, dpiX: 96.0, dpiY: 96.0, bitmapOptions: D2D1_BITMAP_OPTIONS_NONE, colorContext: std::mem::ManuallyDrop::new(None) };
-            let pitch = (img.width * 4) as u32;
-            let bitmap = ctx.CreateBitmap(
-                D2D_SIZE_U { width: img.width, height: img.height },
-                Some(premul.as_ptr() as *const _),
+            let pitch = prepared.width * 4;
+            match ctx.CreateBitmap(
+                D2D_SIZE_U { width: prepared.width, height: prepared.height },
+                Some(prepared.pixels.as_ptr() as *const _),
                 pitch,
                 &bp,
-            ).unwrap();
-            self.image_cache.insert(key, bitmap.clone().into());
-            bitmap.into()
+            ) {
+                Ok(bitmap) => Some(bitmap.into()),
+                Err(e) => {
+                    debug_log_d2d(&format!("upload_image: CreateBitmap {}x{} failed: {:?}", prepared.width, prepared.height, e));
+                    None
+                }
+            }
+        }
+    }
+
+    /// Fill (`stroke == None`) or stroke `path` offset by `shift`, reusing cached geometry. Solid brushes
+    /// draw a cached realization under a translation; other brushes keep world-space brush coordinates by drawing
+    /// a translated wrapper of the cached geometry instead.
+    unsafe fn draw_cached_path(
+        &mut self,
+        ctx: &ID2D1DeviceContext,
+        ctx1: Option<&ID2D1DeviceContext1>,
+        path: &[PathEl],
+        shift: (f64, f64),
+        brush: &ID2D1Brush,
+        solid: bool,
+        stroke: Option<f32>,
+    ) {
+        let Some((key, origin)) = path_cache_key(path, &mut self.path_shape) else {
+            return;
+        };
+        // A different path under the same hash is rebuilt and takes the entry over
+        if !self.geometry_cache.get(&key).is_some_and(|e| *e.shape == *self.path_shape) {
+            let to_local = Affine::translate(-origin.to_vec2());
+            let local: Vec<PathEl> = path.iter().map(|el| to_local * *el).collect();
+            let Some(geom) = self.build_path_geometry(&local) else {
+                return;
+            };
+            let shape = self.path_shape.as_slice().into();
+            self.geometry_cache.insert(key, CachedPath { geom, shape, fill: None, stroke: None, uses: 0, last_frame: 0 });
+        }
+        let factory = self.d2d_factory.clone();
+        let frame = self.frame_index;
+        let Some(entry) = self.geometry_cache.get_mut(&key) else {
+            return;
+        };
+        if entry.last_frame != frame {
+            entry.uses = entry.uses.saturating_add(1);
+            entry.last_frame = frame;
+        }
+        let base = self.scene_offset;
+        let (x, y) = (origin.x + shift.0, origin.y + shift.1);
+        if !solid {
+            let Some(factory) = factory else {
+                return;
+            };
+            // Drawn under the context's translation(base) like the rest of the scene, so base stays out of it
+            if let Ok(moved) = factory.CreateTransformedGeometry(&entry.geom, &translation(x, y)) {
+                match stroke {
+                    Some(width) => ctx.DrawGeometry(&moved, brush, width, None),
+                    None => ctx.FillGeometry(&moved, brush, None),
+                }
+            }
+            return;
+        }
+        // Realize only paths seen in more than one frame; one-off shapes aren't worth the tessellation
+        let mut realization = None;
+        if let Some(ctx1) = ctx1.filter(|_| entry.uses >= 2) {
+            let (mut dpi_x, mut dpi_y) = (96.0f32, 96.0f32);
+            ctx.GetDpi(&mut dpi_x, &mut dpi_y);
+            let tolerance = D2D1_DEFAULT_FLATTENING_TOLERANCE / (dpi_x.max(dpi_y) / 96.0).max(1.0);
+            realization = match stroke {
+                Some(width) => {
+                    if entry.stroke.as_ref().map_or(true, |(w, _)| *w != width.to_bits()) {
+                        entry.stroke = ctx1
+                            .CreateStrokedGeometryRealization(&entry.geom, tolerance, width, None)
+                            .ok()
+                            .map(|r| (width.to_bits(), r));
+                    }
+                    entry.stroke.as_ref().map(|(_, r)| r.clone())
+                }
+                None => {
+                    if entry.fill.is_none() {
+                        entry.fill = ctx1.CreateFilledGeometryRealization(&entry.geom, tolerance).ok();
+                    }
+                    entry.fill.clone()
+                }
+            };
         }
+        ctx.SetTransform(&translation(x + base.0, y + base.1));
+        match (realization, ctx1, stroke) {
+            (Some(r), Some(ctx1), _) => ctx1.DrawGeometryRealization(&r, brush),
+            (_, _, Some(width)) => ctx.DrawGeometry(&entry.geom, brush, width, None),
+            (_, _, None) => ctx.FillGeometry(&entry.geom, brush, None),
+        }
+        ctx.SetTransform(&translation(base.0, base.1));
+    }
+
+    /// Drop cached geometry that hasn't been drawn recently, once the cache has grown past its soft limit.
+    fn evict_idle_geometry(&mut self) {
+        if self.geometry_cache.len() <= GEOMETRY_CACHE_SOFT_LIMIT {
+            return;
+        }
+        let frame = self.frame_index;
+        self.geometry_cache
+            .retain(|_, e| frame.saturating_sub(e.last_frame) < GEOMETRY_CACHE_MAX_IDLE_FRAMES);
+        vlog!("geometry cache evicted to {}", self.geometry_cache.len());
     }
 
     // Removed legacy text_format_cache based path; glyph runs now used directly.
@@ -1750,8 +2790,8 @@ impl D2DWindowRenderer {
         let corner_radius = radius.max(0.0);
         let pad = (std_dev * 2.5).ceil().max(1.0);
         let key = ShadowKey::new(&rect, corner_radius, std_dev, color);
-        if let Some(bmp) = self.shadow_cache.get(&key) {
-            self.blit_cached_shadow(ctx, bmp, &rect, pad as f32);
+        if let Some(bmp) = self.shadow_cache.get(&key, self.frame_index) {
+            self.blit_cached_shadow(ctx, &bmp, &rect, pad as f32);
             return;
         }
         let ow = (rect.width() + pad * 2.0).ceil().max(1.0) as u32;
@@ -2056,17 +3096,12 @@ impl D2DWindowRenderer {
     }
 
     fn insert_shadow_cache(&mut self, key: ShadowKey, bmp: ID2D1Bitmap1) {
-        const MAX_SHADOWS: usize = 64;
-        if self.shadow_cache.contains_key(&key) {
+        if self.shadow_cache.contains(&key) {
             return;
         }
-        if self.shadow_cache_order.len() >= MAX_SHADOWS {
-            if let Some(old) = self.shadow_cache_order.pop_front() {
-                self.shadow_cache.remove(&old);
-            }
-        }
-        self.shadow_cache_order.push_back(key);
-        self.shadow_cache.insert(key, bmp);
+        let size = unsafe { bmp.GetPixelSize() };
+        let bytes = size.width as usize * size.height as usize * 4;
+        self.shadow_cache.insert(key, bmp, bytes, self.frame_index);
     }
 }
 
@@ -2148,10 +3183,21 @@ impl WindowRenderer for D2DWindowRenderer {
                             return;
                         }
                     }
-                    if let Some(bmp) = self.backbuffer_bitmap.take() {
-                        self.playback(&bmp);
-                        self.backbuffer_bitmap = Some(bmp);
+                    if need_new {
+                        self.needs_full_redraw = true;
+                    }
+                    let commands = std::mem::take(&mut self.scene.commands);
+                    if let Some(origin) = self.tile_frame.take().filter(|_| self.tiles.is_some()) {
+                        self.damage = None;
+                        self.render_tiles(&commands, origin);
+                    } else {
+                        let clip = self.take_damage_clip();
+                        if let Some(bmp) = self.backbuffer_bitmap.take() {
+                            self.playback(&bmp, &commands, clip.as_deref(), None);
+                            self.backbuffer_bitmap = Some(bmp);
+                        }
                     }
+                    self.enforce_memory_budget();
                 }
             }
         }
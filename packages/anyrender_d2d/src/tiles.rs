@@ -0,0 +1,308 @@
+//! Tile bookkeeping for tiled rendering.
+//!
+//! In tiled mode the scene is recorded in content (document) coordinates and rasterized into fixed-size tiles
+//! that stay valid until damage touches them; each frame only missing tiles are rasterized and the visible ones
+//! are composited into the backbuffer at the current scroll origin. This module owns the grid, the byte budget
+//! (LRU eviction) and the choice of which tiles to rasterize ahead in the scroll direction; the D2D work lives
+//! in the renderer.
+
+use kurbo::Rect;
+use rustc_hash::FxHashMap;
+use windows::Win32::Graphics::Direct2D::ID2D1Bitmap1;
+
+/// Tile edge length in scene units (DIPs)
+pub(crate) const TILE_SIZE: f64 = 512.0;
+/// Default tile memory budget
+pub(crate) const DEFAULT_TILE_BUDGET_BYTES: usize = 64 * 1024 * 1024;
+
+pub(crate) type TileKey = (i32, i32);
+
+struct Tile<B> {
+    bitmap: B,
+    bytes: usize,
+    last_used: u64,
+}
+
+/// Generic over the tile bitmap so the bookkeeping can be tested without a device
+pub(crate) struct TileCache<B = ID2D1Bitmap1> {
+    tiles: FxHashMap<TileKey, Tile<B>>,
+    budget: usize,
+    bytes: usize,
+    frame: u64,
+    /// Content origin of the last planned frame (for the scroll direction)
+    last_origin: Option<(f64, f64)>,
+    /// Visible tiles of the planned frame, in draw order
+    visible: Vec<TileKey>,
+    /// Tiles to rasterize this frame (missing visible tiles first, then prefetch)
+    pending: Vec<TileKey>,
+}
+
+pub(crate) fn tile_rect(key: TileKey) -> Rect {
+    let x = key.0 as f64 * TILE_SIZE;
+    let y = key.1 as f64 * TILE_SIZE;
+    Rect::new(x, y, x + TILE_SIZE, y + TILE_SIZE)
+}
+
+fn tiles_in(rect: Rect) -> impl Iterator<Item = TileKey> {
+    let x0 = (rect.x0 / TILE_SIZE).floor() as i32;
+    let y0 = (rect.y0 / TILE_SIZE).floor() as i32;
+    let x1 = (rect.x1 / TILE_SIZE).ceil() as i32;
+    let y1 = (rect.y1 / TILE_SIZE).ceil() as i32;
+    (y0..y1).flat_map(move |y| (x0..x1).map(move |x| (x, y)))
+}
+
+impl<B> TileCache<B> {
+    pub(crate) fn new() -> Self {
+        Self {
+            tiles: FxHashMap::default(),
+            budget: DEFAULT_TILE_BUDGET_BYTES,
+            bytes: 0,
+            frame: 0,
+            last_origin: None,
+            visible: Vec::new(),
+            pending: Vec::new(),
+        }
+    }
+
+    pub(crate) fn set_budget(&mut self, bytes: usize) {
+        self.budget = bytes;
+        self.evict();
+    }
+
+    pub(crate) fn bytes(&self) -> usize {
+        self.bytes
+    }
+
+    /// Drop tiles touched by `damage` (content coordinates); `None` drops everything.
+    pub(crate) fn invalidate(&mut self, damage: Option<&[Rect]>) {
+        match damage {
+            None => {
+                self.tiles.clear();
+                self.bytes = 0;
+            }
+            Some(rects) => {
+                for rect in rects {
+                    for key in tiles_in(*rect) {
+                        if let Some(tile) = self.tiles.remove(&key) {
+                            self.bytes -= tile.bytes;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /// Plan a frame showing `view` (w, h) at content `origin` of a document `content` (w, h) large. Returns the
+    /// content rects the scene must cover: visible tiles that aren't cached, plus one row ahead in the scroll
+    /// direction when the budget allows and the row is still inside the document.
+    pub(crate) fn plan(
+        &mut self,
+        origin: (f64, f64),
+        view: (f64, f64),
+        content: (f64, f64),
+        tile_bytes: usize,
+    ) -> Vec<Rect> {
+        self.frame += 1;
+        let visible_rect = Rect::new(origin.0, origin.1, origin.0 + view.0, origin.1 + view.1);
+        self.visible = tiles_in(visible_rect)
+            .filter(|k| k.1 >= 0 && k.0 >= 0)
+            .collect();
+        self.pending = self
+            .visible
+            .iter()
+            .copied()
+            .filter(|k| !self.tiles.contains_key(k))
+            .collect();
+
+        // Rasterize ahead while scrolling, one row at a time and only within budget
+        let dy = self.last_origin.map_or(0.0, |last| origin.1 - last.1);
+        self.last_origin = Some(origin);
+        if dy != 0.0 && !self.visible.is_empty() {
+            let rows = self.visible.iter().map(|k| k.1);
+            let row = if dy > 0.0 {
+                rows.max().unwrap_or(0) + 1
+            } else {
+                rows.min().unwrap_or(0) - 1
+            };
+            let c0 = self.visible.iter().map(|k| k.0).min().unwrap_or(0);
+            let c1 = self.visible.iter().map(|k| k.0).max().unwrap_or(0);
+            let needed = (self.visible.len() + (c1 - c0 + 1) as usize) * tile_bytes;
+            if row >= 0 && (row as f64) * TILE_SIZE < content.1 && needed <= self.budget {
+                self.pending.extend(
+                    (c0..=c1)
+                        .map(|c| (c, row))
+                        .filter(|k| !self.tiles.contains_key(k)),
+                );
+            }
+        }
+
+        for key in &self.visible {
+            if let Some(tile) = self.tiles.get_mut(key) {
+                tile.last_used = self.frame;
+            }
+        }
+        self.pending.iter().map(|k| tile_rect(*k)).collect()
+    }
+
+    pub(crate) fn pending(&self) -> &[TileKey] {
+        &self.pending
+    }
+
+    pub(crate) fn insert(&mut self, key: TileKey, bitmap: B, bytes: usize) {
+        if let Some(old) = self.tiles.insert(
+            key,
+            Tile {
+                bitmap,
+                bytes,
+                last_used: self.frame,
+            },
+        ) {
+            self.bytes -= old.bytes;
+        }
+        self.bytes += bytes;
+    }
+
+    /// Visible tiles with their bitmaps (missing ones skipped), for compositing
+    pub(crate) fn visible_tiles(&self) -> impl Iterator<Item = (TileKey, &B)> {
+        self.visible
+            .iter()
+            .filter_map(|k| self.tiles.get(k).map(|t| (*k, &t.bitmap)))
+    }
+
+    /// Evict least recently used tiles until within budget. Tiles visible this frame are never evicted.
+    pub(crate) fn evict(&mut self) {
+        while self.bytes > self.budget {
+            let victim = self
+                .tiles
+                .iter()
+                .filter(|(_, t)| t.last_used != self.frame)
+                .min_by_key(|(_, t)| t.last_used)
+                .map(|(k, _)| *k);
+            let Some(key) = victim else { break };
+            if let Some(tile) = self.tiles.remove(&key) {
+                self.bytes -= tile.bytes;
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::{TILE_SIZE, TileCache, TileKey};
+    use kurbo::Rect;
+
+    const TILE_BYTES: usize = 100;
+    // A 1000 x 900 view over a 1000 x 3000 document: two columns, two rows of tiles visible from the top
+    const VIEW: (f64, f64) = (1000.0, 900.0);
+    const DOC: (f64, f64) = (1000.0, 3000.0);
+
+    fn planned(cache: &TileCache<()>) -> Vec<TileKey> {
+        let mut keys = cache.pending().to_vec();
+        keys.sort();
+        keys
+    }
+
+    fn fill(cache: &mut TileCache<()>) {
+        for key in cache.pending().to_vec() {
+            cache.insert(key, (), TILE_BYTES);
+        }
+    }
+
+    #[test]
+    fn plan_asks_only_for_missing_visible_tiles() {
+        let mut cache = TileCache::new();
+        let rects = cache.plan((0.0, 0.0), VIEW, DOC, TILE_BYTES);
+        assert_eq!(planned(&cache), vec![(0, 0), (0, 1), (1, 0), (1, 1)]);
+        assert!(rects.contains(&Rect::new(
+            TILE_SIZE,
+            TILE_SIZE,
+            2.0 * TILE_SIZE,
+            2.0 * TILE_SIZE
+        )));
+        fill(&mut cache);
+        assert_eq!(cache.bytes(), 4 * TILE_BYTES);
+
+        // Same origin again: everything is cached, the frame only recomposites
+        assert!(cache.plan((0.0, 0.0), VIEW, DOC, TILE_BYTES).is_empty());
+        assert_eq!(cache.visible_tiles().count(), 4);
+    }
+
+    #[test]
+    fn invalidate_drops_touched_tiles() {
+        let mut cache = TileCache::new();
+        cache.plan((0.0, 0.0), VIEW, DOC, TILE_BYTES);
+        fill(&mut cache);
+
+        cache.invalidate(Some(&[Rect::new(600.0, 10.0, 610.0, 20.0)]));
+        assert_eq!(cache.bytes(), 3 * TILE_BYTES);
+        cache.plan((0.0, 0.0), VIEW, DOC, TILE_BYTES);
+        assert_eq!(planned(&cache), vec![(1, 0)]);
+        fill(&mut cache);
+
+        cache.invalidate(None);
+        assert_eq!(cache.bytes(), 0);
+        cache.plan((0.0, 0.0), VIEW, DOC, TILE_BYTES);
+        assert_eq!(planned(&cache).len(), 4);
+    }
+
+    #[test]
+    fn evict_drops_least_recently_used_but_never_current_tiles() {
+        let mut cache = TileCache::new();
+        cache.plan((0.0, 0.0), VIEW, DOC, TILE_BYTES);
+        fill(&mut cache);
+        // Scroll down two rows: rows 2-3 become visible and row 4 is prefetched, rows 0-1 are only cached
+        cache.plan((0.0, 2.0 * TILE_SIZE), VIEW, DOC, TILE_BYTES);
+        assert_eq!(planned(&cache).len(), 6);
+        fill(&mut cache);
+        assert_eq!(cache.bytes(), 10 * TILE_BYTES);
+
+        // Over budget by two tiles: two of the cached rows 0-1 go, nothing of this frame
+        cache.set_budget(8 * TILE_BYTES);
+        assert_eq!(cache.bytes(), 8 * TILE_BYTES);
+        assert_eq!(cache.visible_tiles().count(), 4);
+
+        // A budget below this frame's tiles keeps them anyway
+        cache.set_budget(TILE_BYTES);
+        assert_eq!(cache.bytes(), 6 * TILE_BYTES);
+        assert_eq!(cache.visible_tiles().count(), 4);
+    }
+
+    #[test]
+    fn prefetch_stays_inside_the_document() {
+        let mut cache = TileCache::new();
+        cache.plan((0.0, 0.0), VIEW, DOC, TILE_BYTES);
+        fill(&mut cache);
+        // Scrolling down prefetches the row below the view
+        cache.plan((0.0, 100.0), VIEW, DOC, TILE_BYTES);
+        assert_eq!(planned(&cache), vec![(0, 2), (1, 2)]);
+        fill(&mut cache);
+
+        // At the bottom of the document (rows 0-5) there is no row below to prefetch
+        let bottom = DOC.1 - VIEW.1;
+        cache.plan((0.0, bottom - 10.0), VIEW, DOC, TILE_BYTES);
+        fill(&mut cache);
+        cache.plan((0.0, bottom), VIEW, DOC, TILE_BYTES);
+        assert!(
+            planned(&cache)
+                .iter()
+                .all(|k| (k.1 as f64) * TILE_SIZE < DOC.1)
+        );
+
+        // Nor above the top when scrolling back up
+        cache.plan((0.0, 0.0), VIEW, DOC, TILE_BYTES);
+        fill(&mut cache);
+        cache.plan((0.0, 0.0), VIEW, DOC, TILE_BYTES);
+        assert!(planned(&cache).is_empty());
+    }
+
+    #[test]
+    fn prefetch_needs_budget_for_the_row() {
+        let mut cache = TileCache::new();
+        cache.set_budget(5 * TILE_BYTES);
+        cache.plan((0.0, 0.0), VIEW, DOC, TILE_BYTES);
+        fill(&mut cache);
+        // Four visible tiles plus a two-tile row would exceed the budget
+        cache.plan((0.0, 100.0), VIEW, DOC, TILE_BYTES);
+        assert!(planned(&cache).is_empty());
+    }
+}
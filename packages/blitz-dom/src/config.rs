@@ -26,4 +26,10 @@ pub struct DocumentConfig {
     pub html_parser_provider: Option<Arc<dyn HtmlParserProvider>>,
     /// Parley `FontContext`
     pub font_ctx: Option<FontContext>,
+    /// How far (CSS px) beyond the viewport deferred images are fetched. Defaults to
+    /// [`DEFAULT_LAZY_IMAGE_MARGIN`](crate::DEFAULT_LAZY_IMAGE_MARGIN).
+    pub lazy_image_margin: Option<f64>,
+    /// Defer fetching images not marked `loading=eager` until layout puts them near the viewport. Off by default:
+    /// every image is fetched as soon as it is inserted.
+    pub lazy_images: bool,
 }
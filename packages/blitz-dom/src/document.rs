@@ -1,9 +1,13 @@
 use crate::events::handle_dom_event;
 use crate::font_metrics::BlitzFontMetricsProvider;
-use crate::layout::construct::collect_layout_children;
+use crate::layout::construct::{
+    build_inline_layouts, collect_layout_children, install_inline_layout,
+};
 use crate::mutator::ViewportMut;
 use crate::net::{Resource, StylesheetLoader};
 use crate::node::{ImageData, NodeFlags, RasterImageData, SpecialElementData, Status, TextBrush};
+use crate::paint_damage::DamageTracker;
+use crate::shared_styles::{ua_lock, user_agent_stylesheet};
 use crate::stylo_to_cursor_icon::stylo_to_cursor_icon;
 use crate::traversal::TreeTraverser;
 use crate::url::DocumentUrl;
@@ -110,6 +114,16 @@ pub struct BaseDocument {
     pub(crate) font_ctx: Arc<Mutex<parley::FontContext>>,
     /// A Parley layout context
     pub(crate) layout_ctx: parley::LayoutContext<TextBrush>,
+    /// Bumped whenever a font is added to `font_ctx`, so text shaped before is shaped again
+    pub(crate) font_generation: u64,
+
+    // Image loading (image_loading.rs)
+    /// `<img>` nodes whose fetch waits for them to come near the viewport
+    pub(crate) deferred_images: Vec<usize>,
+    /// How far (CSS px) beyond the viewport deferred images are fetched
+    pub(crate) lazy_image_margin: f64,
+    /// Defer images (other than `loading=eager` ones) until they are near the viewport
+    pub(crate) lazy_images: bool,
 
     /// The node which is currently hovered (if any)
     pub(crate) hover_node_id: Option<usize>,
@@ -128,11 +142,13 @@ pub struct BaseDocument {
     pub(crate) nodes_to_stylesheet: BTreeMap<usize, DocumentStyleSheet>,
     /// Stylesheets added by the useragent
     /// where the key is the hashed CSS
-    pub(crate) ua_stylesheets: HashMap<String, DocumentStyleSheet>,
+    pub(crate) ua_stylesheets: HashMap<Arc<str>, DocumentStyleSheet>,
     /// Map from form control node ID's to their associated forms node ID's
     pub(crate) controls_to_form: HashMap<usize, usize>,
     /// Set of changed nodes for updating the accessibility tree
     pub(crate) changed_nodes: HashSet<usize>,
+    /// What changed on screen since the last painted frame
+    pub(crate) paint_damage: DamageTracker,
 
     // Service providers
     /// Network provider. Can be used to fetch assets.
@@ -166,6 +182,17 @@ pub(crate) fn make_device(viewport: &Viewport, font_ctx: Arc<Mutex<FontContext>>
     )
 }
 
+/// The [`FontContext`] a document gets when its config doesn't supply one: the system fonts plus the bullet font
+/// used for list markers. Building it enumerates the system fonts, so embedders creating several documents can
+/// build one ahead of time (or on another thread) and pass clones through [`DocumentConfig::font_ctx`].
+pub fn default_font_context() -> FontContext {
+    let mut font_ctx = FontContext::default();
+    font_ctx
+        .collection
+        .register_fonts(Blob::new(Arc::new(crate::BULLET_FONT) as _), None);
+    font_ctx
+}
+
 impl BaseDocument {
     /// Create a new (empty) [`BaseDocument`] with the specified configuration
     pub fn new(config: DocumentConfig) -> Self {
@@ -173,13 +200,7 @@ impl BaseDocument {
 
         let id = ID_GENERATOR.fetch_add(1, Ordering::SeqCst);
 
-        let font_ctx = config.font_ctx.unwrap_or_else(|| {
-            let mut font_ctx = FontContext::default();
-            font_ctx
-                .collection
-                .register_fonts(Blob::new(Arc::new(crate::BULLET_FONT) as _), None);
-            font_ctx
-        });
+        let font_ctx = config.font_ctx.unwrap_or_else(default_font_context);
         let font_ctx = Arc::new(Mutex::new(font_ctx));
 
         let viewport = config.viewport.unwrap_or_default();
@@ -230,6 +251,13 @@ impl BaseDocument {
             nodes_to_stylesheet: BTreeMap::new(),
             font_ctx,
             layout_ctx: parley::LayoutContext::new(),
+            font_generation: 0,
+            deferred_images: Vec::new(),
+            lazy_image_margin: config
+                .lazy_image_margin
+                .unwrap_or(crate::image_loading::DEFAULT_LAZY_IMAGE_MARGIN)
+                .max(0.0),
+            lazy_images: config.lazy_images,
 
             hover_node_id: None,
             focus_node_id: None,
@@ -237,6 +265,7 @@ impl BaseDocument {
             mousedown_node_id: None,
             is_animating: false,
             changed_nodes: HashSet::new(),
+            paint_damage: DamageTracker::default(),
             controls_to_form: HashMap::new(),
             net_provider,
             navigation_provider,
@@ -313,7 +342,8 @@ impl BaseDocument {
         let mut mutator = DocumentMutator::new(self);
         for id in stylesheets { mutator.load_linked_stylesheet(id); }
         for id in images { mutator.load_image(id); }
-        // Flush not strictly required for these operations (they schedule fetches immediately)
+        // Flush not strictly required for these operations (stylesheets are fetched immediately, images once
+        // the next resolve finds them near the viewport)
     }
 
     /// Set the Document's navigation provider
@@ -336,6 +366,11 @@ impl BaseDocument {
         self.url = DocumentUrl::from(Url::parse(url).unwrap());
     }
 
+    /// The base url linked resources are resolved against
+    pub fn base_url(&self) -> &str {
+        self.url.as_str()
+    }
+
     pub fn guard(&self) -> &SharedRwLock {
         &self.guard
     }
@@ -568,14 +603,16 @@ impl BaseDocument {
 
     pub fn remove_user_agent_stylesheet(&mut self, contents: &str) {
         if let Some(sheet) = self.ua_stylesheets.remove(contents) {
-            self.stylist.remove_stylesheet(sheet, &self.guard.read());
+            self.stylist.remove_stylesheet(sheet, &ua_lock().read());
         }
     }
 
+    /// Add a user-agent stylesheet. It is parsed once per process and shared with every other document that adds
+    /// the same CSS (see shared_styles.rs).
     pub fn add_user_agent_stylesheet(&mut self, css: &str) {
-        let sheet = self.make_stylesheet(css, Origin::UserAgent);
-        self.ua_stylesheets.insert(css.to_string(), sheet.clone());
-        self.stylist.append_stylesheet(sheet, &self.guard.read());
+        let (key, sheet) = user_agent_stylesheet(css);
+        self.ua_stylesheets.insert(key, sheet.clone());
+        self.stylist.append_stylesheet(sheet, &ua_lock().read());
     }
 
     pub fn make_stylesheet(&self, css: impl AsRef<str>, origin: Origin) -> DocumentStyleSheet {
@@ -634,8 +671,10 @@ impl BaseDocument {
         match resource {
             Resource::Css(node_id, css) => {
                 self.add_stylesheet_for_node(css, node_id);
+                self.invalidate_paint();
             }
             Resource::Image(node_id, kind, width, height, image_data) => {
+                self.damage_node(node_id);
                 let node = self.get_node_mut(node_id).unwrap();
 
                 match kind {
@@ -662,6 +701,7 @@ impl BaseDocument {
             }
             #[cfg(feature = "svg")]
             Resource::Svg(node_id, kind, tree) => {
+                self.damage_node(node_id);
                 let node = self.get_node_mut(node_id).unwrap();
 
                 match kind {
@@ -691,6 +731,9 @@ impl BaseDocument {
                     .unwrap()
                     .collection
                     .register_fonts(Blob::new(Arc::new(bytes)) as _, None);
+                self.font_generation += 1;
+                // Glyphs may change everywhere without any box moving
+                self.invalidate_paint();
             }
             Resource::None => {
                 // Do nothing
@@ -821,6 +864,9 @@ impl BaseDocument {
         self.resolve_layout();
 
         timer.record_time("layout");
+
+        // Request the deferred images that layout (or scrolling since the last resolve) put near the viewport
+        self.load_images_near_viewport();
         timer.print_times("Resolve: ");
     }
 
@@ -994,10 +1040,9 @@ impl BaseDocument {
     /// Update the device and reset the stylist to process the new size
     pub fn set_stylist_device(&mut self, device: Device) {
         let origins = {
-            let guard = &self.guard;
             let guards = StylesheetGuards {
-                author: &guard.read(),
-                ua_or_user: &guard.read(),
+                author: &self.guard.read(),
+                ua_or_user: &ua_lock().read(),
             };
             self.stylist.set_device(device, &guards)
         };
@@ -1009,24 +1054,56 @@ impl BaseDocument {
     }
 
     /// Ensure that the layout_children field is populated for all nodes
+    ///
+    /// Inline roots are set aside as they are found and their inline layouts built a batch at a time (in parallel
+    /// when there is a layout thread pool); their inline boxes are then resolved in turn, which can find the next
+    /// batch.
     pub fn resolve_layout_children(&mut self) {
-        resolve_layout_children_recursive(self, self.root_node().id);
+        let mut inline_roots = Vec::new();
+        resolve_layout_children_recursive(self, self.root_node().id, &mut inline_roots);
+
+        while !inline_roots.is_empty() {
+            let layouts = build_inline_layouts(self, &inline_roots);
+            let mut next_inline_roots = Vec::new();
+            for (node_id, layout) in inline_roots.into_iter().zip(layouts) {
+                let layout_children = install_inline_layout(self, node_id, layout);
+                set_layout_children(self, node_id, layout_children, &mut next_inline_roots);
+            }
+            inline_roots = next_inline_roots;
+        }
 
-        fn resolve_layout_children_recursive(doc: &mut BaseDocument, node_id: usize) {
+        fn resolve_layout_children_recursive(
+            doc: &mut BaseDocument,
+            node_id: usize,
+            inline_roots: &mut Vec<usize>,
+        ) {
             // if doc.nodes[node_id].layout_children.borrow().is_none() {
             let mut layout_children = Vec::new();
             let mut anonymous_block: Option<usize> = None;
             collect_layout_children(doc, node_id, &mut layout_children, &mut anonymous_block);
 
+            if doc.nodes[node_id].flags.is_inline_root() {
+                inline_roots.push(node_id);
+                return;
+            }
+            set_layout_children(doc, node_id, layout_children, inline_roots);
+            // }
+        }
+
+        fn set_layout_children(
+            doc: &mut BaseDocument,
+            node_id: usize,
+            layout_children: Vec<usize>,
+            inline_roots: &mut Vec<usize>,
+        ) {
             // Recurse into newly collected layout children
             for child_id in layout_children.iter().copied() {
-                resolve_layout_children_recursive(doc, child_id);
+                resolve_layout_children_recursive(doc, child_id, inline_roots);
                 doc.nodes[child_id].layout_parent.set(Some(node_id));
             }
 
             *doc.nodes[node_id].layout_children.borrow_mut() = Some(layout_children.clone());
             *doc.nodes[node_id].paint_children.borrow_mut() = Some(layout_children);
-            // }
         }
     }
 
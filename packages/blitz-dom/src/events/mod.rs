@@ -19,6 +19,19 @@ pub(crate) fn handle_dom_event<F: FnMut(DomEvent)>(
 ) {
     let target_node_id = event.target;
 
+    // Default actions below edit text, move carets and selections, and toggle form controls, none of which
+    // shows up in style or layout. Report the nodes they can touch so the next frame repaints them.
+    let focus_before = doc.focus_node_id;
+    match &event.data {
+        DomEventData::MouseDown(_)
+        | DomEventData::MouseUp(_)
+        | DomEventData::KeyDown(_)
+        | DomEventData::Ime(_) => doc.damage_node(target_node_id),
+        // Clicks can update other controls (labels, radio groups) or navigate
+        DomEventData::Click(_) => doc.invalidate_paint(),
+        _ => {}
+    }
+
     match &event.data {
         DomEventData::MouseMove(mouse_event) => {
             let changed = handle_mousemove(
@@ -57,4 +70,12 @@ pub(crate) fn handle_dom_event<F: FnMut(DomEvent)>(
             // Do nothing (no default action)
         }
     }
+
+    // Keys and IME edit the focussed node; a focus change repaints both the old and new one
+    let focus_after = doc.focus_node_id;
+    if focus_before != focus_after || !matches!(event.data, DomEventData::MouseMove(_)) {
+        for id in [focus_before, focus_after].into_iter().flatten() {
+            doc.damage_node(id);
+        }
+    }
 }
@@ -54,6 +54,7 @@ pub(crate) fn handle_mousemove(
             .driver(&mut doc.font_ctx.lock().unwrap(), &mut doc.layout_ctx)
             .extend_selection_to_point(x as f32, y as f32);
 
+        doc.damage_node(target);
         changed = true;
     }
 
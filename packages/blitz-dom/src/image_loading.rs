@@ -0,0 +1,135 @@
+//! Viewport-driven image loading.
+//!
+//! Inserting an `<img>` (or setting its `src`) fetches it straight away, so a long page pays for the bandwidth,
+//! decoding and GPU memory of every image before its first frame. With lazy images enabled
+//! ([`BaseDocument::set_lazy_images`], or [`DocumentConfig::lazy_images`](crate::DocumentConfig::lazy_images)) an
+//! image is only recorded as deferred instead, and each [`BaseDocument::resolve`] requests the deferred images
+//! whose layout box has come within the lazy-image margin of the viewport, nearest first: those inside the
+//! viewport at normal priority, the rest at [`Priority::Low`] so a host can queue them behind stylesheets, fonts
+//! and visible images. Scrolling the viewport or an inner scroller brings more images into the margin by the next
+//! resolve.
+//!
+//! Lazy images are off by default, so embedders that fetch everything before their first resolve (screenshots,
+//! tests) still see every image. When enabled, `loading=eager` images are still fetched immediately, and deferred
+//! images that are never laid out (inside `display: none`) are never fetched.
+
+use crate::BaseDocument;
+use crate::net::ImageHandler;
+use crate::util::ImageType;
+use blitz_traits::net::{Destination, Priority, Request};
+use markup5ever::local_name;
+use peniko::kurbo::Rect;
+
+/// Default lazy-image margin in CSS px: about a screen and a half beyond each edge of a typical viewport
+pub const DEFAULT_LAZY_IMAGE_MARGIN: f64 = 1250.0;
+
+impl BaseDocument {
+    /// Set how far (CSS px) beyond the viewport deferred images are fetched ahead of scrolling into view
+    pub fn set_lazy_image_margin(&mut self, margin: f64) {
+        self.lazy_image_margin = margin.max(0.0);
+    }
+
+    /// Defer images not marked `loading=eager` until they are near the viewport (applies to images inserted or
+    /// changed from now on)
+    pub fn set_lazy_images(&mut self, lazy: bool) {
+        self.lazy_images = lazy;
+    }
+
+    /// Number of images waiting to come near the viewport
+    pub fn deferred_image_count(&self) -> usize {
+        self.deferred_images.len()
+    }
+
+    /// Record an image to fetch once it is near the viewport. Returns false if it should be fetched now.
+    pub(crate) fn defer_image(&mut self, node_id: usize) -> bool {
+        if !self.lazy_images {
+            return false;
+        }
+        let eager = self.nodes[node_id].element_data().is_some_and(|el| {
+            el.attrs.iter().any(|attr| {
+                &*attr.name.local == "loading" && attr.value.eq_ignore_ascii_case("eager")
+            })
+        });
+        if eager {
+            return false;
+        }
+        if !self.deferred_images.contains(&node_id) {
+            self.deferred_images.push(node_id);
+        }
+        true
+    }
+
+    pub(crate) fn fetch_image(&self, node_id: usize, priority: Priority) {
+        let node = &self.nodes[node_id];
+        if !node.is_element_with_tag_name(&local_name!("img")) {
+            return;
+        }
+        let Some(raw_src) = node.attr(local_name!("src")) else {
+            return;
+        };
+        if raw_src.is_empty() {
+            return;
+        }
+        let src = self.resolve_url(raw_src);
+        self.net_provider.fetch(
+            self.id(),
+            Request::get(src)
+                .with_destination(Destination::Image)
+                .with_priority(priority),
+            Box::new(ImageHandler::new(node_id, ImageType::Image)),
+        );
+    }
+
+    /// Fetch the deferred images laid out within the lazy-image margin of the viewport (runs after layout)
+    pub(crate) fn load_images_near_viewport(&mut self) {
+        if self.deferred_images.is_empty() {
+            return;
+        }
+        let scale = self.viewport.scale_f64();
+        let (width, height) = self.viewport.window_size;
+        let view = Rect::new(
+            self.viewport_scroll.x,
+            self.viewport_scroll.y,
+            self.viewport_scroll.x + width as f64 / scale,
+            self.viewport_scroll.y + height as f64 / scale,
+        );
+        let margin = self.lazy_image_margin;
+        let nodes = &self.nodes;
+        let mut due = Vec::new();
+        self.deferred_images.retain(|&id| {
+            let Some(node) = nodes.get(id) else {
+                return false;
+            };
+            if !node.flags.is_in_document() || !node.is_element_with_tag_name(&local_name!("img")) {
+                return false;
+            }
+            // Not laid out yet, or not at all
+            if node.layout_parent.get().is_none() {
+                return true;
+            }
+            let pos = node.absolute_position(0.0, 0.0);
+            let size = node.final_layout.size;
+            let (x0, y0) = (pos.x as f64, pos.y as f64);
+            let (x1, y1) = (x0 + size.width as f64, y0 + size.height as f64);
+            // Distance from the viewport along the farther axis; 0 when they touch. Images not sized yet are
+            // empty boxes, hence the inclusive edges.
+            let dx = (view.x0 - x1).max(x0 - view.x1).max(0.0);
+            let dy = (view.y0 - y1).max(y0 - view.y1).max(0.0);
+            let distance = dx.max(dy);
+            if distance > margin {
+                return true;
+            }
+            due.push((distance, id));
+            false
+        });
+        due.sort_by(|a, b| a.0.total_cmp(&b.0));
+        for (distance, id) in due {
+            let priority = if distance > 0.0 {
+                Priority::Low
+            } else {
+                Priority::Auto
+            };
+            self.fetch_image(id, priority);
+        }
+    }
+}
@@ -1,11 +1,17 @@
 use core::str;
-use std::sync::Arc;
+use std::cell::RefCell;
+use std::hash::{DefaultHasher, Hash, Hasher};
+use std::sync::{Arc, Mutex, Weak};
 
 use markup5ever::{QualName, local_name, ns};
-use parley::{InlineBox, StyleProperty, TreeBuilder, WhiteSpaceCollapse};
+use parley::{
+    FontContext, InlineBox, LayoutContext, StyleProperty, TreeBuilder, WhiteSpaceCollapse,
+};
 use slab::Slab;
 use style::{
     data::ElementData as StyloElementData,
+    properties::ComputedValues,
+    servo_arc::Arc as ServoArc,
     shared_lock::StylesheetGuards,
     values::{
         computed::{Content, ContentItem, Display},
@@ -56,9 +62,10 @@ pub(crate) fn collect_layout_children(
     doc.nodes[container_node_id]
         .flags
         .reset_construction_flags();
-    if let Some(element_data) = doc.nodes[container_node_id].element_data_mut() {
-        element_data.take_inline_layout();
-    }
+    // Kept if the node is still an inline root, for `build_inline_layouts` to reuse its shaping
+    let previous_inline_layout = doc.nodes[container_node_id]
+        .element_data_mut()
+        .and_then(|element_data| element_data.take_inline_layout());
 
     flush_pseudo_elements(doc, container_node_id);
 
@@ -189,23 +196,14 @@ pub(crate) fn collect_layout_children(
             }
 
             // TODO: fix display:contents
+            // The inline layout itself is built later, together with the pass's other inline roots (see
+            // `build_inline_layouts`); its inline boxes become the layout children then.
             if all_inline {
-                let (inline_layout, ilayout_children) = build_inline_layout(doc, container_node_id);
-                doc.nodes[container_node_id]
-                    .flags
-                    .insert(NodeFlags::IS_INLINE_ROOT);
-                doc.nodes[container_node_id]
-                    .data
-                    .downcast_element_mut()
-                    .unwrap()
-                    .inline_layout_data = Some(Box::new(inline_layout));
-                if let Some(before) = doc.nodes[container_node_id].before {
-                    layout_children.push(before);
-                }
-                layout_children.extend_from_slice(&ilayout_children);
-                if let Some(after) = doc.nodes[container_node_id].after {
-                    layout_children.push(after);
-                }
+                flush_inline_pseudos_recursive(doc, container_node_id);
+                let node = &mut doc.nodes[container_node_id];
+                node.flags.insert(NodeFlags::IS_INLINE_ROOT);
+                node.data.downcast_element_mut().unwrap().inline_layout_data =
+                    previous_inline_layout;
                 return;
             }
 
@@ -437,8 +435,12 @@ fn collect_complex_layout_children(
 
                 // Set style data
                 let parent_style = doc.nodes[container_node_id].primary_styles().unwrap();
-                let read_guard = doc.guard.read();
-                let guards = StylesheetGuards::same(&read_guard);
+                let author_guard = doc.guard.read();
+                let ua_guard = crate::shared_styles::ua_lock().read();
+                let guards = StylesheetGuards {
+                    author: &author_guard,
+                    ua_or_user: &ua_guard,
+                };
                 let style = doc.stylist.style_for_anonymous::<&Node>(
                     &guards,
                     &PseudoElement::ServoAnonymousBox,
@@ -519,21 +521,374 @@ fn create_checkbox_input(doc: &mut BaseDocument, input_element_id: usize) {
     }
 }
 
-pub(crate) fn build_inline_layout(
+// Inline roots a construction pass must find before they are shaped in parallel (fewer are shaped in place)
+const MIN_PARALLEL_INLINE_ROOTS: usize = 4;
+
+// The nodes, shared with the threads shaping inline roots. `Node` isn't `Sync` because of its layout
+// bookkeeping cells; while a batch is being built no node is otherwise touched, and each builder only writes the
+// `layout_parent` of nodes inside its own inline root (every node belongs to at most one).
+struct SharedNodes<'a>(&'a Slab<Node>);
+// SAFETY: see above
+unsafe impl Sync for SharedNodes<'_> {}
+
+impl SharedNodes<'_> {
+    fn get(&self) -> &Slab<Node> {
+        self.0
+    }
+}
+
+/// What a layout pool thread shapes with, kept from one construction pass to the next so its font caches stay
+/// warm: a clone of a document's font context, replaced once a different context or a new font generation (web
+/// fonts were added) comes along.
+struct PoolShapingContext {
+    // Held weakly so the clone doesn't keep the document's context alive, while its allocation can't be reused
+    // by another context and mistaken for this one
+    source: Weak<Mutex<FontContext>>,
+    font_generation: u64,
+    font_ctx: FontContext,
+    layout_ctx: LayoutContext<TextBrush>,
+}
+
+thread_local! {
+    static POOL_SHAPING_CONTEXT: RefCell<Option<PoolShapingContext>> = const { RefCell::new(None) };
+}
+
+/// Run `shape` with this thread's [`PoolShapingContext`], cloning `source` first if the one it has is stale
+fn with_pool_shaping_context<R>(
+    source: &Arc<Mutex<FontContext>>,
+    font_generation: u64,
+    shape: impl FnOnce(&mut FontContext, &mut LayoutContext<TextBrush>) -> R,
+) -> R {
+    POOL_SHAPING_CONTEXT.with_borrow_mut(|slot| {
+        let current = slot.as_ref().is_some_and(|ctx| {
+            ctx.font_generation == font_generation && ctx.source.as_ptr() == Arc::as_ptr(source)
+        });
+        if !current {
+            *slot = Some(PoolShapingContext {
+                source: Arc::downgrade(source),
+                font_generation,
+                font_ctx: source.lock().unwrap().clone(),
+                layout_ctx: LayoutContext::new(),
+            });
+        }
+        let ctx = slot.as_mut().unwrap();
+        shape(&mut ctx.font_ctx, &mut ctx.layout_ctx)
+    })
+}
+
+/// Build the inline layouts (text and inline boxes, shaped) of inline roots left by `collect_layout_children`,
+/// in order, keeping the previous layout of each root whose text and styles haven't changed. Uses the layout thread pool when there is one and enough roots to share out, each pool thread shaping with
+/// its own long-lived clone of the document's font context.
+pub(crate) fn build_inline_layouts(
+    doc: &mut BaseDocument,
+    inline_roots: &[usize],
+) -> Vec<(TextLayout, Vec<usize>)> {
+    let _shape_guard = blitz_metrics::start_phase("shape");
+    let scale = doc.viewport.scale();
+    let font_generation = doc.font_generation;
+    let previous: Vec<Option<Box<TextLayout>>> = inline_roots
+        .iter()
+        .map(|&id| {
+            doc.nodes[id]
+                .element_data_mut()
+                .and_then(|el| el.take_inline_layout())
+        })
+        .collect();
+    let pool = crate::layout_threads::layout_pool()
+        .filter(|_| inline_roots.len() >= MIN_PARALLEL_INLINE_ROOTS);
+    let Some(pool) = pool else {
+        let mut font_ctx = doc.font_ctx.lock().unwrap();
+        return inline_roots
+            .iter()
+            .zip(previous)
+            .map(|(&id, previous)| {
+                build_inline_layout(
+                    &doc.nodes,
+                    scale,
+                    font_generation,
+                    &mut font_ctx,
+                    &mut doc.layout_ctx,
+                    id,
+                    previous,
+                )
+            })
+            .collect();
+    };
+
+    use rayon::prelude::*;
+    let source = &doc.font_ctx;
+    let nodes = SharedNodes(&doc.nodes);
+    pool.install(|| {
+        inline_roots
+            .par_iter()
+            .zip(previous)
+            .map(|(&id, previous)| {
+                let nodes = nodes.get();
+                with_pool_shaping_context(source, font_generation, |font_ctx, layout_ctx| {
+                    build_inline_layout(
+                        nodes,
+                        scale,
+                        font_generation,
+                        font_ctx,
+                        layout_ctx,
+                        id,
+                        previous,
+                    )
+                })
+            })
+            .collect()
+    })
+}
+
+/// Store an inline root's built layout and return its layout children
+pub(crate) fn install_inline_layout(
     doc: &mut BaseDocument,
+    inline_root_id: usize,
+    (inline_layout, ilayout_children): (TextLayout, Vec<usize>),
+) -> Vec<usize> {
+    let node = &mut doc.nodes[inline_root_id];
+    node.data.downcast_element_mut().unwrap().inline_layout_data = Some(Box::new(inline_layout));
+    let mut layout_children = Vec::with_capacity(ilayout_children.len() + 2);
+    layout_children.extend(node.before);
+    layout_children.extend(ilayout_children);
+    layout_children.extend(node.after);
+    layout_children
+}
+
+fn flush_inline_pseudos_recursive(doc: &mut BaseDocument, node_id: usize) {
+    doc.iter_children_mut(node_id, |child_id, doc| {
+        flush_pseudo_elements(doc, child_id);
+        let display = doc.nodes[node_id]
+            .display_style()
+            .unwrap_or(Display::inline());
+        let do_recurse = match (display.outside(), display.inside()) {
+            (DisplayOutside::None, DisplayInside::Contents) => true,
+            (DisplayOutside::Inline, DisplayInside::Flow) => true,
+            (_, _) => false,
+        };
+        if do_recurse {
+            flush_inline_pseudos_recursive(doc, child_id);
+        }
+    });
+}
+
+// Receives an inline formatting context's contents, in order, from `push_inline_contents`: the parley tree builder
+// that shapes them, or the `ShapingKeyBuilder` deciding whether the previous shaping can be kept.
+trait InlineSink {
+    fn set_white_space_mode(&mut self, mode: WhiteSpaceCollapse);
+    fn push_text(&mut self, text: &str);
+    fn push_inline_box(&mut self, node_id: usize);
+    fn push_line_break(&mut self, collapse_mode: WhiteSpaceCollapse);
+    fn push_element_span(&mut self, node: &Node, root_line_height: f32);
+    fn pop_style_span(&mut self);
+}
+
+impl InlineSink for TreeBuilder<'_, TextBrush> {
+    fn set_white_space_mode(&mut self, mode: WhiteSpaceCollapse) {
+        TreeBuilder::set_white_space_mode(self, mode);
+    }
+
+    fn push_text(&mut self, text: &str) {
+        TreeBuilder::push_text(self, text);
+    }
+
+    fn push_inline_box(&mut self, node_id: usize) {
+        TreeBuilder::push_inline_box(
+            self,
+            InlineBox {
+                id: node_id as u64,
+                // Overridden by push_inline_box method
+                index: 0,
+                // Width and height are set during layout
+                width: 0.0,
+                height: 0.0,
+            },
+        );
+    }
+
+    fn push_line_break(&mut self, collapse_mode: WhiteSpaceCollapse) {
+        // TODO: update span id for br spans
+        self.push_style_modification_span(&[]);
+        TreeBuilder::set_white_space_mode(self, WhiteSpaceCollapse::Preserve);
+        TreeBuilder::push_text(self, "\n");
+        TreeBuilder::pop_style_span(self);
+        TreeBuilder::set_white_space_mode(self, collapse_mode);
+    }
+
+    fn push_element_span(&mut self, node: &Node, root_line_height: f32) {
+        let mut style = node
+            .primary_styles()
+            .map(|s| stylo_to_parley::style(node.id, &s))
+            .unwrap_or_default();
+
+        // dbg!(&style);
+
+        // style.brush = peniko::Brush::Solid(peniko::Color::WHITE);
+
+        let font_size = style.font_size;
+
+        // Floor the line-height of the span by the line-height of the inline context
+        // See https://www.w3.org/TR/CSS21/visudet.html#line-height
+        style.line_height = parley::LineHeight::Absolute(
+            resolve_line_height(style.line_height, font_size).max(root_line_height),
+        );
+
+        // dbg!(node_id);
+        // dbg!(&style);
+
+        self.push_style_span(style);
+    }
+
+    fn pop_style_span(&mut self) {
+        TreeBuilder::pop_style_span(self);
+    }
+}
+
+/// What an inline layout was shaped from: the computed styles of the nodes it was built from, plus a hash of
+/// everything else (text, structure, node ids, scale, the document's fonts). The styles are held rather than
+/// hashed, so they compare by identity without a freed style's address being reused by a different one.
+pub(crate) struct ShapingKey {
+    styles: Vec<ServoArc<ComputedValues>>,
+    hash: u64,
+}
+
+impl PartialEq for ShapingKey {
+    fn eq(&self, other: &Self) -> bool {
+        self.hash == other.hash
+            && self.styles.len() == other.styles.len()
+            && self
+                .styles
+                .iter()
+                .zip(&other.styles)
+                .all(|(a, b)| ServoArc::ptr_eq(a, b))
+    }
+}
+
+#[derive(Default)]
+struct ShapingKeyBuilder {
+    styles: Vec<ServoArc<ComputedValues>>,
+    hasher: DefaultHasher,
+}
+
+impl ShapingKeyBuilder {
+    fn push_style_of(&mut self, node: &Node) {
+        let style = node
+            .stylo_element_data
+            .borrow()
+            .as_ref()
+            .and_then(|d| d.styles.get_primary().cloned());
+        self.hasher.write_u8(style.is_some() as u8);
+        self.styles.extend(style);
+    }
+
+    fn finish(self) -> ShapingKey {
+        ShapingKey {
+            styles: self.styles,
+            hash: self.hasher.finish(),
+        }
+    }
+}
+
+impl InlineSink for ShapingKeyBuilder {
+    fn set_white_space_mode(&mut self, mode: WhiteSpaceCollapse) {
+        (0u8, mode as u8).hash(&mut self.hasher);
+    }
+
+    fn push_text(&mut self, text: &str) {
+        1u8.hash(&mut self.hasher);
+        text.hash(&mut self.hasher);
+    }
+
+    fn push_inline_box(&mut self, node_id: usize) {
+        (2u8, node_id).hash(&mut self.hasher);
+    }
+
+    fn push_line_break(&mut self, collapse_mode: WhiteSpaceCollapse) {
+        (3u8, collapse_mode as u8).hash(&mut self.hasher);
+    }
+
+    fn push_element_span(&mut self, node: &Node, _root_line_height: f32) {
+        (4u8, node.id).hash(&mut self.hasher);
+        self.push_style_of(node);
+    }
+
+    fn pop_style_span(&mut self) {
+        5u8.hash(&mut self.hasher);
+    }
+}
+
+// The inline root's own style, or its parent's if it has none
+fn inline_root_style(nodes: &Slab<Node>, root_node: &Node) -> Option<usize> {
+    if root_node.primary_styles().is_some() {
+        return Some(root_node.id);
+    }
+    root_node
+        .parent
+        .filter(|parent_id| nodes[*parent_id].primary_styles().is_some())
+}
+
+fn shaping_key(
+    nodes: &Slab<Node>,
+    scale: f32,
+    font_generation: u64,
+    inline_context_root_node_id: usize,
+) -> ShapingKey {
+    let root_node = &nodes[inline_context_root_node_id];
+    let mut key = ShapingKeyBuilder::default();
+    (
+        scale.to_bits(),
+        font_generation,
+        inline_context_root_node_id,
+    )
+        .hash(&mut key.hasher);
+    if let Some(style_id) = inline_root_style(nodes, root_node) {
+        key.push_style_of(&nodes[style_id]);
+    }
+    let collapse_mode = inline_root_style(nodes, root_node)
+        .and_then(|id| nodes[id].primary_styles())
+        .map(|s| stylo_to_parley::white_space_collapse(s.get_inherited_text().white_space_collapse))
+        .unwrap_or(WhiteSpaceCollapse::Collapse);
+    push_inline_contents(
+        &mut key,
+        nodes,
+        inline_context_root_node_id,
+        collapse_mode,
+        0.0,
+    );
+    key.finish()
+}
+
+fn inline_box_ids(layout: &parley::layout::Layout<TextBrush>) -> Vec<usize> {
+    layout
+        .inline_boxes()
+        .iter()
+        .map(|ibox| ibox.id as usize)
+        .collect()
+}
+
+/// Build an inline root's layout, or keep `previous` (its last layout) if nothing it was shaped from changed:
+/// then only line breaking runs again, at layout time.
+fn build_inline_layout(
+    nodes: &Slab<Node>,
+    scale: f32,
+    font_generation: u64,
+    font_ctx: &mut FontContext,
+    layout_ctx: &mut LayoutContext<TextBrush>,
     inline_context_root_node_id: usize,
+    previous: Option<Box<TextLayout>>,
 ) -> (TextLayout, Vec<usize>) {
     // println!("Inline context {}", inline_context_root_node_id);
 
-    flush_inline_pseudos_recursive(doc, inline_context_root_node_id);
+    let shaping_key = shaping_key(nodes, scale, font_generation, inline_context_root_node_id);
+    if let Some(previous) = previous.filter(|p| p.shaping_key == shaping_key) {
+        let layout_children = inline_box_ids(&previous.layout);
+        return (*previous, layout_children);
+    }
 
     // Get the inline context's root node's text styles
-    let root_node = &doc.nodes[inline_context_root_node_id];
-    let root_node_style = root_node.primary_styles().or_else(|| {
-        root_node
-            .parent
-            .and_then(|parent_id| doc.nodes[parent_id].primary_styles())
-    });
+    let root_node = &nodes[inline_context_root_node_id];
+    let root_node_style =
+        inline_root_style(nodes, root_node).and_then(|id| nodes[id].primary_styles());
 
     let parley_style = root_node_style
         .as_ref()
@@ -545,17 +900,45 @@ pub(crate) fn build_inline_layout(
     let root_line_height = resolve_line_height(parley_style.line_height, parley_style.font_size);
 
     // Create a parley tree builder
-    let mut font_ctx = doc.font_ctx.lock().unwrap();
-    let mut builder =
-        doc.layout_ctx
-            .tree_builder(&mut font_ctx, doc.viewport.scale(), true, &parley_style);
+    let mut builder = layout_ctx.tree_builder(font_ctx, scale, true, &parley_style);
 
     // Set whitespace collapsing mode
     let collapse_mode = root_node_style
         .map(|s| s.get_inherited_text().white_space_collapse)
         .map(stylo_to_parley::white_space_collapse)
         .unwrap_or(WhiteSpaceCollapse::Collapse);
-    builder.set_white_space_mode(collapse_mode);
+    push_inline_contents(
+        &mut builder,
+        nodes,
+        inline_context_root_node_id,
+        collapse_mode,
+        root_line_height,
+    );
+
+    let (layout, text) = builder.build();
+
+    // Obtain layout children for the inline layout
+    let layout_children = inline_box_ids(&layout);
+
+    (
+        TextLayout {
+            text,
+            layout,
+            shaping_key,
+        },
+        layout_children,
+    )
+}
+
+fn push_inline_contents(
+    sink: &mut impl InlineSink,
+    nodes: &Slab<Node>,
+    inline_context_root_node_id: usize,
+    collapse_mode: WhiteSpaceCollapse,
+    root_line_height: f32,
+) {
+    let root_node = &nodes[inline_context_root_node_id];
+    sink.set_white_space_mode(collapse_mode);
 
     // Render position-inside list items
     if let Some(ListItemLayout {
@@ -566,15 +949,15 @@ pub(crate) fn build_inline_layout(
         .and_then(|el| el.list_item_data.as_deref())
     {
         match marker {
-            Marker::Char(char) => builder.push_text(&format!("{char} ")),
-            Marker::String(str) => builder.push_text(str),
+            Marker::Char(char) => sink.push_text(&format!("{char} ")),
+            Marker::String(str) => sink.push_text(str),
         }
     };
 
     if let Some(before_id) = root_node.before {
         build_inline_layout_recursive(
-            &mut builder,
-            &doc.nodes,
+            sink,
+            nodes,
             inline_context_root_node_id,
             before_id,
             collapse_mode,
@@ -583,8 +966,8 @@ pub(crate) fn build_inline_layout(
     }
     for child_id in root_node.children.iter().copied() {
         build_inline_layout_recursive(
-            &mut builder,
-            &doc.nodes,
+            sink,
+            nodes,
             inline_context_root_node_id,
             child_id,
             collapse_mode,
@@ -593,191 +976,259 @@ pub(crate) fn build_inline_layout(
     }
     if let Some(after_id) = root_node.after {
         build_inline_layout_recursive(
-            &mut builder,
-            &doc.nodes,
+            sink,
+            nodes,
             inline_context_root_node_id,
             after_id,
             collapse_mode,
             root_line_height,
         );
     }
+}
 
-    let (layout, text) = builder.build();
+fn build_inline_layout_recursive(
+    sink: &mut impl InlineSink,
+    nodes: &Slab<Node>,
+    parent_id: usize,
+    node_id: usize,
+    collapse_mode: WhiteSpaceCollapse,
+    root_line_height: f32,
+) {
+    let node = &nodes[node_id];
 
-    // Obtain layout children for the inline layout
-    let layout_children: Vec<usize> = layout
-        .inline_boxes()
-        .iter()
-        .map(|ibox| ibox.id as usize)
-        .collect();
+    // Set layout_parent for node.
+    node.layout_parent.set(Some(parent_id));
 
-    return (TextLayout { text, layout }, layout_children);
-
-    fn flush_inline_pseudos_recursive(doc: &mut BaseDocument, node_id: usize) {
-        doc.iter_children_mut(node_id, |child_id, doc| {
-            flush_pseudo_elements(doc, child_id);
-            let display = doc.nodes[node_id]
-                .display_style()
-                .unwrap_or(Display::inline());
-            let do_recurse = match (display.outside(), display.inside()) {
-                (DisplayOutside::None, DisplayInside::Contents) => true,
-                (DisplayOutside::Inline, DisplayInside::Flow) => true,
-                (_, _) => false,
-            };
-            if do_recurse {
-                flush_inline_pseudos_recursive(doc, child_id);
+    // Set whitespace collapsing mode
+    let collapse_mode = node
+        .primary_styles()
+        .map(|s| s.get_inherited_text().white_space_collapse)
+        .map(stylo_to_parley::white_space_collapse)
+        .unwrap_or(collapse_mode);
+    sink.set_white_space_mode(collapse_mode);
+
+    match &node.data {
+        NodeData::Element(element_data) | NodeData::AnonymousBlock(element_data) => {
+            // if the input type is hidden, hide it
+            if *element_data.name.local == *"input" {
+                if let Some("hidden") = element_data.attr(local_name!("type")) {
+                    return;
+                }
             }
-        });
-    }
-
-    fn build_inline_layout_recursive(
-        builder: &mut TreeBuilder<TextBrush>,
-        nodes: &Slab<Node>,
-        parent_id: usize,
-        node_id: usize,
-        collapse_mode: WhiteSpaceCollapse,
-        root_line_height: f32,
-    ) {
-        let node = &nodes[node_id];
-
-        // Set layout_parent for node.
-        node.layout_parent.set(Some(parent_id));
 
-        // Set whitespace collapsing mode
-        let collapse_mode = node
-            .primary_styles()
-            .map(|s| s.get_inherited_text().white_space_collapse)
-            .map(stylo_to_parley::white_space_collapse)
-            .unwrap_or(collapse_mode);
-        builder.set_white_space_mode(collapse_mode);
-
-        match &node.data {
-            NodeData::Element(element_data) | NodeData::AnonymousBlock(element_data) => {
-                // if the input type is hidden, hide it
-                if *element_data.name.local == *"input" {
-                    if let Some("hidden") = element_data.attr(local_name!("type")) {
-                        return;
+            let display = node.display_style().unwrap_or(Display::inline());
+
+            match (display.outside(), display.inside()) {
+                (DisplayOutside::None, DisplayInside::None) => {}
+                (DisplayOutside::None, DisplayInside::Contents) => {
+                    for child_id in node.children.iter().copied() {
+                        build_inline_layout_recursive(
+                            sink,
+                            nodes,
+                            parent_id,
+                            child_id,
+                            collapse_mode,
+                            root_line_height,
+                        );
                     }
                 }
+                (DisplayOutside::Inline, DisplayInside::Flow) => {
+                    let tag_name = &element_data.name.local;
+
+                    if *tag_name == local_name!("img")
+                        || *tag_name == local_name!("svg")
+                        || *tag_name == local_name!("input")
+                        || *tag_name == local_name!("textarea")
+                        || *tag_name == local_name!("button")
+                    {
+                        sink.push_inline_box(node_id);
+                    } else if *tag_name == local_name!("br") {
+                        sink.push_line_break(collapse_mode);
+                    } else {
+                        sink.push_element_span(node, root_line_height);
+
+                        if let Some(before_id) = node.before {
+                            build_inline_layout_recursive(
+                                sink,
+                                nodes,
+                                node_id,
+                                before_id,
+                                collapse_mode,
+                                root_line_height,
+                            );
+                        }
 
-                let display = node.display_style().unwrap_or(Display::inline());
-
-                match (display.outside(), display.inside()) {
-                    (DisplayOutside::None, DisplayInside::None) => {}
-                    (DisplayOutside::None, DisplayInside::Contents) => {
                         for child_id in node.children.iter().copied() {
                             build_inline_layout_recursive(
-                                builder,
+                                sink,
                                 nodes,
-                                parent_id,
+                                node_id,
                                 child_id,
                                 collapse_mode,
                                 root_line_height,
                             );
                         }
-                    }
-                    (DisplayOutside::Inline, DisplayInside::Flow) => {
-                        let tag_name = &element_data.name.local;
-
-                        if *tag_name == local_name!("img")
-                            || *tag_name == local_name!("svg")
-                            || *tag_name == local_name!("input")
-                            || *tag_name == local_name!("textarea")
-                            || *tag_name == local_name!("button")
-                        {
-                            builder.push_inline_box(InlineBox {
-                                id: node_id as u64,
-                                // Overridden by push_inline_box method
-                                index: 0,
-                                // Width and height are set during layout
-                                width: 0.0,
-                                height: 0.0,
-                            });
-                        } else if *tag_name == local_name!("br") {
-                            // TODO: update span id for br spans
-                            builder.push_style_modification_span(&[]);
-                            builder.set_white_space_mode(WhiteSpaceCollapse::Preserve);
-                            builder.push_text("\n");
-                            builder.pop_style_span();
-                            builder.set_white_space_mode(collapse_mode);
-                        } else {
-                            let mut style = node
-                                .primary_styles()
-                                .map(|s| stylo_to_parley::style(node.id, &s))
-                                .unwrap_or_default();
-
-                            // dbg!(&style);
-
-                            // style.brush = peniko::Brush::Solid(peniko::Color::WHITE);
-
-                            let font_size = style.font_size;
-
-                            // Floor the line-height of the span by the line-height of the inline context
-                            // See https://www.w3.org/TR/CSS21/visudet.html#line-height
-                            style.line_height = parley::LineHeight::Absolute(
-                                resolve_line_height(style.line_height, font_size)
-                                    .max(root_line_height),
+                        if let Some(after_id) = node.after {
+                            build_inline_layout_recursive(
+                                sink,
+                                nodes,
+                                node_id,
+                                after_id,
+                                collapse_mode,
+                                root_line_height,
                             );
+                        }
 
-                            // dbg!(node_id);
-                            // dbg!(&style);
+                        sink.pop_style_span();
+                    }
+                }
+                // Inline box
+                (_, _) => {
+                    sink.push_inline_box(node_id);
+                }
+            };
+        }
+        NodeData::Text(data) => {
+            // dbg!(&data.content);
+            sink.push_text(&data.content);
+        }
+        NodeData::Comment => {}
+        NodeData::Document => unreachable!(),
+    }
+}
 
-                            builder.push_style_span(style);
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{Attribute, DocumentConfig};
+    use blitz_traits::shell::{ColorScheme, Viewport};
+    use markup5ever::LocalName;
 
-                            if let Some(before_id) = node.before {
-                                build_inline_layout_recursive(
-                                    builder,
-                                    nodes,
-                                    node_id,
-                                    before_id,
-                                    collapse_mode,
-                                    root_line_height,
-                                );
-                            }
+    /// Written over a stored layout's text: still there after a resolve means the layout was kept, not reshaped
+    const MARK: &str = "kept";
 
-                            for child_id in node.children.iter().copied() {
-                                build_inline_layout_recursive(
-                                    builder,
-                                    nodes,
-                                    node_id,
-                                    child_id,
-                                    collapse_mode,
-                                    root_line_height,
-                                );
-                            }
-                            if let Some(after_id) = node.after {
-                                build_inline_layout_recursive(
-                                    builder,
-                                    nodes,
-                                    node_id,
-                                    after_id,
-                                    collapse_mode,
-                                    root_line_height,
-                                );
-                            }
+    fn qual(name: LocalName) -> QualName {
+        QualName::new(None, ns!(html), name)
+    }
 
-                            builder.pop_style_span();
-                        }
-                    }
-                    // Inline box
-                    (_, _) => {
-                        builder.push_inline_box(InlineBox {
-                            id: node_id as u64,
-                            // Overridden by push_inline_box method
-                            index: 0,
-                            // Width and height are set during layout
-                            width: 0.0,
-                            height: 0.0,
-                        });
-                    }
-                };
-            }
-            NodeData::Text(data) => {
-                // dbg!(&data.content);
-                builder.push_text(&data.content);
-            }
-            NodeData::Comment => {}
-            NodeData::Document => unreachable!(),
-        }
+    fn style(value: &str) -> Vec<Attribute> {
+        vec![Attribute {
+            name: qual(local_name!("style")),
+            value: value.to_string(),
+        }]
+    }
+
+    /// html > body > an 800px div > a p holding some text and two 300px inline blocks, resolved at 800x600.
+    /// Returns the div, the p (the inline root) and its text node.
+    fn paragraph() -> (BaseDocument, usize, usize, usize) {
+        let mut doc = BaseDocument::new(DocumentConfig::default());
+        let root = doc.root_node().id;
+        let mut mutr = doc.mutate();
+        let text = mutr.create_text_node("Hello");
+        let blocks = [(); 2].map(|_| {
+            mutr.create_element(
+                qual(local_name!("span")),
+                style("display: inline-block; width: 300px; height: 10px"),
+            )
+        });
+        let p = mutr.create_element(qual(local_name!("p")), Vec::new());
+        let div = mutr.create_element(qual(local_name!("div")), style("width: 800px"));
+        let body = mutr.create_element(qual(local_name!("body")), style("margin: 0"));
+        let html = mutr.create_element(qual(local_name!("html")), Vec::new());
+        mutr.append_children(p, &[text]);
+        mutr.append_children(p, &blocks);
+        mutr.append_children(div, &[p]);
+        mutr.append_children(body, &[div]);
+        mutr.append_children(html, &[body]);
+        mutr.append_children(root, &[html]);
+        drop(mutr);
+        doc.set_viewport(Viewport::new(800, 600, 1.0, ColorScheme::Light));
+        doc.resolve();
+        (doc, div, p, text)
+    }
+
+    fn text_layout(doc: &BaseDocument, id: usize) -> &TextLayout {
+        doc.nodes[id]
+            .element_data()
+            .and_then(|el| el.inline_layout_data.as_deref())
+            .unwrap()
+    }
+
+    fn mark(doc: &mut BaseDocument, id: usize) {
+        let el = doc.nodes[id].element_data_mut().unwrap();
+        el.inline_layout_data.as_mut().unwrap().text = MARK.to_string();
+    }
+
+    /// Run `build_inline_layout` on `id` against its stored layout, as the construct pass would
+    fn rebuild(doc: &mut BaseDocument, id: usize, font_generation: u64) -> TextLayout {
+        let previous = doc.nodes[id]
+            .element_data_mut()
+            .unwrap()
+            .take_inline_layout();
+        let mut font_ctx = doc.font_ctx.lock().unwrap();
+        let scale = doc.viewport.scale();
+        build_inline_layout(
+            &doc.nodes,
+            scale,
+            font_generation,
+            &mut font_ctx,
+            &mut doc.layout_ctx,
+            id,
+            previous,
+        )
+        .0
+    }
+
+    #[test]
+    fn width_change_keeps_shaping_and_rebreaks_lines() {
+        let (mut doc, div, p, _) = paragraph();
+        let wide_lines = text_layout(&doc, p).layout.lines().count();
+        mark(&mut doc, p);
+
+        doc.mutate()
+            .set_attribute(div, qual(local_name!("style")), "width: 400px");
+        doc.resolve();
+
+        let layout = text_layout(&doc, p);
+        assert_eq!(layout.text, MARK);
+        assert_eq!(wide_lines, 1);
+        assert!(layout.layout.lines().count() > wide_lines);
+    }
+
+    #[test]
+    fn text_edit_reshapes() {
+        let (mut doc, _, p, text) = paragraph();
+        mark(&mut doc, p);
+
+        doc.mutate().set_node_text(text, "Goodbye");
+        doc.resolve();
+
+        assert!(text_layout(&doc, p).text.contains("Goodbye"));
+    }
+
+    #[test]
+    fn style_change_reshapes() {
+        let (mut doc, _, p, _) = paragraph();
+        mark(&mut doc, p);
+
+        doc.mutate()
+            .set_attribute(p, qual(local_name!("style")), "font-size: 24px");
+        doc.resolve();
+
+        assert!(text_layout(&doc, p).text.contains("Hello"));
+    }
+
+    #[test]
+    fn font_load_reshapes() {
+        let (mut doc, _, p, _) = paragraph();
+        let font_generation = doc.font_generation;
+
+        mark(&mut doc, p);
+        let kept = rebuild(&mut doc, p, font_generation);
+        assert_eq!(kept.text, MARK);
+        doc.nodes[p].element_data_mut().unwrap().inline_layout_data = Some(Box::new(kept));
+
+        let reshaped = rebuild(&mut doc, p, font_generation + 1);
+        assert!(reshaped.text.contains("Hello"));
     }
 }
@@ -1,5 +1,5 @@
 use crate::{BaseDocument, net::ImageHandler, node::BackgroundImageData, util::ImageType};
-use blitz_traits::net::Request;
+use blitz_traits::net::{Destination, Request};
 use style::properties::generated::longhands::position::computed_value::T as Position;
 use style::servo::url::ComputedUrl;
 use style::values::generics::image::Image as StyloImage;
@@ -52,7 +52,7 @@ impl BaseDocument {
 
                             self.net_provider.fetch(
                                 doc_id,
-                                Request::get((**new_url).clone()),
+                                Request::get((**new_url).clone()).with_destination(Destination::Image),
                                 Box::new(ImageHandler::new(node_id, ImageType::Background(idx))),
                             );
 
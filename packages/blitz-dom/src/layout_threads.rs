@@ -0,0 +1,62 @@
+//! Process-wide layout worker threads.
+//!
+//! One rayon pool, shared by every document, runs the parallel parts of [`BaseDocument::resolve`]: Stylo's style
+//! traversal, and the shaping of inline formatting contexts found by a construction pass. Resolving uses it only
+//! once [`set_layout_threads`] has asked for more than one thread; until then everything runs on the calling
+//! thread, as before.
+//!
+//! [`BaseDocument::resolve`]: crate::BaseDocument::resolve
+
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::{Arc, RwLock};
+
+use rayon::ThreadPool;
+
+/// Thread count used for `set_layout_threads(0)`. Style traversal stops scaling well past a handful of threads.
+const MAX_AUTO_THREADS: usize = 6;
+/// The traversal recurses per DOM level on whichever thread picks up a subtree, so workers get main-thread sized
+/// stacks rather than rayon's default.
+const WORKER_STACK_SIZE: usize = 4 * 1024 * 1024;
+
+static POOL: RwLock<Option<Arc<ThreadPool>>> = RwLock::new(None);
+static THREADS: AtomicUsize = AtomicUsize::new(1);
+
+/// Set the number of threads used to resolve documents: 1 keeps everything on the calling thread (the default),
+/// 0 picks a count for this machine. Takes effect from the next resolve; a resolve already running keeps the pool
+/// it started with.
+pub fn set_layout_threads(count: usize) {
+    let count = match count {
+        0 => std::thread::available_parallelism()
+            .map_or(1, |n| n.get() * 3 / 4)
+            .clamp(1, MAX_AUTO_THREADS),
+        n => n,
+    };
+    let mut pool = POOL.write().unwrap();
+    if count == THREADS.load(Ordering::Relaxed) {
+        return;
+    }
+    *pool = if count > 1 {
+        rayon::ThreadPoolBuilder::new()
+            .num_threads(count)
+            .thread_name(|i| format!("blitz-layout-{i}"))
+            .stack_size(WORKER_STACK_SIZE)
+            .start_handler(|_| style::thread_state::initialize_layout_worker_thread())
+            .build()
+            .map(Arc::new)
+            .ok()
+    } else {
+        None
+    };
+    // A pool that failed to build leaves resolving single-threaded
+    let threads = if pool.is_some() { count } else { 1 };
+    THREADS.store(threads, Ordering::Relaxed);
+}
+
+/// Threads used to resolve documents (1 when single-threaded)
+pub fn layout_threads() -> usize {
+    THREADS.load(Ordering::Relaxed)
+}
+
+pub(crate) fn layout_pool() -> Option<Arc<ThreadPool>> {
+    POOL.read().unwrap().clone()
+}
@@ -43,10 +43,18 @@ mod events;
 mod font_metrics;
 mod form;
 mod html;
+/// Viewport-driven image loading
+mod image_loading;
 /// Integration of taffy and the DOM.
 mod layout;
+/// Worker threads for parallel style traversal and shaping
+mod layout_threads;
 mod mutator;
+/// Per-frame repaint damage tracking
+mod paint_damage;
 mod query_selector;
+/// User-agent stylesheets parsed once per process
+mod shared_styles;
 /// Implementations that interact with servo's style engine
 mod stylo;
 mod stylo_to_cursor_icon;
@@ -61,12 +69,16 @@ pub mod util;
 mod accessibility;
 
 pub use config::DocumentConfig;
-pub use document::{BaseDocument, Document};
+pub use document::{BaseDocument, Document, default_font_context};
+pub use image_loading::DEFAULT_LAZY_IMAGE_MARGIN;
+pub use layout_threads::{layout_threads, set_layout_threads};
 pub use markup5ever::{
     LocalName, Namespace, NamespaceStaticSet, Prefix, PrefixStaticSet, QualName, local_name,
     namespace_prefix, namespace_url, ns,
 };
 pub use mutator::DocumentMutator;
+pub use paint_damage::PaintDamage;
+pub use shared_styles::{preparse_user_agent_stylesheet, shared_user_agent_stylesheet_count};
 pub use node::{Attribute, ElementData, Node, NodeData, TextNodeData};
 pub use parley::FontContext;
 pub use style::Atom;
@@ -3,13 +3,12 @@ use std::mem;
 use std::ops::{Deref, DerefMut};
 
 use crate::document::make_device;
-use crate::net::{CssHandler, ImageHandler};
+use crate::net::CssHandler;
 use crate::node::{CanvasData, NodeFlags, SpecialElementData};
-use crate::util::ImageType;
 use crate::{
     Attribute, BaseDocument, ElementData, Node, NodeData, QualName, local_name, qual_name,
 };
-use blitz_traits::net::Request;
+use blitz_traits::net::{Destination, Priority, Request};
 use blitz_traits::shell::Viewport;
 use style::invalidation::element::restyle_hints::RestyleHint;
 use style::stylesheets::OriginSet;
@@ -166,6 +165,9 @@ impl DocumentMutator<'_> {
         match self.doc.nodes[node_id].text_data_mut() {
             Some(data) => {
                 data.content += text;
+                if let Some(parent_id) = self.doc.nodes[node_id].parent {
+                    self.doc.damage_node(parent_id);
+                }
                 Ok(())
             }
             None => Err(AppendTextErr::NotTextNode),
@@ -192,6 +194,7 @@ impl DocumentMutator<'_> {
 
     pub fn set_attribute(&mut self, node_id: usize, name: QualName, value: &str) {
         self.doc.snapshot_node(node_id);
+        self.doc.damage_node(node_id);
 
         let node = &mut self.doc.nodes[node_id];
         if let Some(data) = &mut *node.stylo_element_data.borrow_mut() {
@@ -241,6 +244,7 @@ impl DocumentMutator<'_> {
 
     pub fn clear_attribute(&mut self, node_id: usize, name: QualName) {
         self.doc.snapshot_node(node_id);
+        self.doc.damage_node(node_id);
 
         let node = &mut self.doc.nodes[node_id];
 
@@ -418,6 +422,152 @@ impl DocumentMutator<'_> {
     }
 }
 
+// Patching methods: make a subtree match the corresponding subtree of another (freshly parsed) document
+// while keeping every node that is still compatible, so their style data (and any loaded resources)
+// survive and only the differences are restyled.
+impl DocumentMutator<'_> {
+    /// Mutate the children of `node_id` to match the children of `source_id` in `source`.
+    /// Returns the number of mutations applied.
+    pub fn patch_children_from(
+        &mut self,
+        node_id: usize,
+        source: &BaseDocument,
+        source_id: usize,
+    ) -> usize {
+        // Anonymous blocks are layout-only and never part of the source tree
+        let old: Vec<usize> = self.doc.nodes[node_id]
+            .children
+            .iter()
+            .copied()
+            .filter(|id| !matches!(self.doc.nodes[*id].data, NodeData::AnonymousBlock(_)))
+            .collect();
+        let new = &source.nodes[source_id].children;
+        let mut changes = 0;
+
+        // Patch the compatible prefix and suffix in place
+        let mut start = 0;
+        while start < old.len()
+            && start < new.len()
+            && nodes_compatible(&self.doc.nodes[old[start]], &source.nodes[new[start]])
+        {
+            changes += self.patch_node_from(old[start], source, new[start]);
+            start += 1;
+        }
+        let (mut old_end, mut new_end) = (old.len(), new.len());
+        while old_end > start
+            && new_end > start
+            && nodes_compatible(
+                &self.doc.nodes[old[old_end - 1]],
+                &source.nodes[new[new_end - 1]],
+            )
+        {
+            changes += self.patch_node_from(old[old_end - 1], source, new[new_end - 1]);
+            old_end -= 1;
+            new_end -= 1;
+        }
+
+        // Replace whatever differs in between
+        if start < old_end || start < new_end {
+            let imported: Vec<usize> = new[start..new_end]
+                .iter()
+                .map(|&id| self.import_node_from(source, id))
+                .collect();
+            if !imported.is_empty() {
+                match old.get(old_end) {
+                    Some(&anchor) => self.insert_nodes_before(anchor, &imported),
+                    None => self.append_children(node_id, &imported),
+                }
+            }
+            for &id in &old[start..old_end] {
+                self.remove_and_drop_node(id);
+            }
+            changes += (old_end - start) + imported.len();
+
+            // Sibling-sensitive selectors (:nth-child, +, ~) may match differently now
+            self.doc.nodes[node_id].set_restyle_hint(RestyleHint::restyle_subtree());
+        }
+
+        changes
+    }
+
+    /// Patch a single node (known to be compatible with `source_id`) and its subtree
+    fn patch_node_from(
+        &mut self,
+        node_id: usize,
+        source: &BaseDocument,
+        source_id: usize,
+    ) -> usize {
+        match &source.nodes[source_id].data {
+            NodeData::Text(new_text) => {
+                let changed = self.doc.nodes[node_id]
+                    .text_data()
+                    .is_some_and(|old_text| old_text.content != new_text.content);
+                if changed {
+                    self.set_node_text(node_id, &new_text.content);
+                }
+                changed as usize
+            }
+            NodeData::Element(new_elem) => {
+                let old_attrs = match &self.doc.nodes[node_id].data {
+                    NodeData::Element(old_elem) => old_elem.attrs.to_vec(),
+                    _ => return 0,
+                };
+                let mut changes = 0;
+                for attr in new_elem.attrs.iter() {
+                    let unchanged = old_attrs
+                        .iter()
+                        .any(|old| old.name == attr.name && old.value == attr.value);
+                    if !unchanged {
+                        self.set_attribute(node_id, attr.name.clone(), &attr.value);
+                        changes += 1;
+                    }
+                }
+                for old in old_attrs.iter() {
+                    if !new_elem.attrs.iter().any(|attr| attr.name == old.name) {
+                        self.clear_attribute(node_id, old.name.clone());
+                        changes += 1;
+                    }
+                }
+                changes + self.patch_children_from(node_id, source, source_id)
+            }
+            _ => 0,
+        }
+    }
+
+    /// Create a detached copy of a node (and its subtree) from another document
+    fn import_node_from(&mut self, source: &BaseDocument, source_id: usize) -> usize {
+        let source_node = &source.nodes[source_id];
+        let id = match &source_node.data {
+            NodeData::Element(elem) => self.create_element(elem.name.clone(), elem.attrs.to_vec()),
+            NodeData::Text(text) => self.create_text_node(&text.content),
+            _ => self.create_comment_node(),
+        };
+        let children: Vec<usize> = source_node
+            .children
+            .iter()
+            .map(|&child_id| self.import_node_from(source, child_id))
+            .collect();
+        self.append_children(id, &children);
+        id
+    }
+}
+
+/// Whether `old` can be patched into `new` rather than replaced. Elements must agree on tag name and on
+/// the attributes that select per-node special data (input type, stylesheet href) or identity (id).
+fn nodes_compatible(old: &Node, new: &Node) -> bool {
+    match (&old.data, &new.data) {
+        (NodeData::Text(_), NodeData::Text(_)) | (NodeData::Comment, NodeData::Comment) => true,
+        (NodeData::Element(a), NodeData::Element(b)) => {
+            a.name == b.name
+                && a.attr(local_name!("id")) == b.attr(local_name!("id"))
+                && a.attr(local_name!("type")) == b.attr(local_name!("type"))
+                && (a.name.local != local_name!("link")
+                    || a.attr(local_name!("href")) == b.attr(local_name!("href")))
+        }
+        _ => false,
+    }
+}
+
 impl<'doc> DocumentMutator<'doc> {
     pub fn flush(&mut self) {
         if self.recompute_is_animating {
@@ -533,6 +683,11 @@ impl<'doc> DocumentMutator<'doc> {
                 return;
             };
 
+            // A removed image must not be fetched later (under its id, or a new node that reuses the id)
+            if element.name.local == local_name!("img") {
+                doc.deferred_images.retain(|&id| id != node_id);
+            }
+
             match &element.special_data {
                 SpecialElementData::Stylesheet(_) => self
                     .eager_op_queue
@@ -558,6 +713,9 @@ impl<'doc> DocumentMutator<'doc> {
             return;
         };
 
+        // Child list or text changed: repaint wherever this node ends up (and wherever it was)
+        self.doc.damage_node(node_id);
+
         let Some(tag_name) = self.doc.nodes[node_id]
             .data
             .downcast_element()
@@ -591,7 +749,7 @@ impl<'doc> DocumentMutator<'doc> {
         let url = self.doc.resolve_url(href);
         self.doc.net_provider.fetch(
             self.doc.id(),
-            Request::get(url.clone()),
+            Request::get(url.clone()).with_destination(Destination::Style),
             Box::new(CssHandler {
                 node: target_id,
                 source_url: url,
@@ -620,16 +778,9 @@ impl<'doc> DocumentMutator<'doc> {
     }
 
     pub(crate) fn load_image(&mut self, target_id: usize) {
-        let node = &self.doc.nodes[target_id];
-        if let Some(raw_src) = node.attr(local_name!("src")) {
-            if !raw_src.is_empty() {
-                let src = self.doc.resolve_url(raw_src);
-                self.doc.net_provider.fetch(
-                    self.doc.id(),
-                    Request::get(src),
-                    Box::new(ImageHandler::new(target_id, ImageType::Image)),
-                );
-            }
+        // Most images wait until layout puts them near the viewport (see image_loading.rs)
+        if !self.doc.defer_image(target_id) {
+            self.doc.fetch_image(target_id, Priority::Auto);
         }
     }
 
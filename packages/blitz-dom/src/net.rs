@@ -16,7 +16,7 @@ use style::{
     values::{CssUrl, SourceLocation},
 };
 
-use blitz_traits::net::{Bytes, NetHandler, Request, SharedCallback, SharedProvider};
+use blitz_traits::net::{Bytes, Destination, NetHandler, Request, SharedCallback, SharedProvider};
 
 use url::Url;
 
@@ -122,7 +122,7 @@ impl ServoStylesheetLoader for StylesheetLoader {
         let url = import.url.url().unwrap();
         self.1.fetch(
             self.0,
-            Request::get(url.as_ref().clone()),
+            Request::get(url.as_ref().clone()).with_destination(Destination::Style),
             Box::new(StylesheetLoaderInner {
                 url: url.clone(),
                 loader: self.clone(),
@@ -296,7 +296,11 @@ fn fetch_font_face(
                 return;
             }
             let url = url_source.url.url().unwrap().as_ref().clone();
-            network_provider.fetch(doc_id, Request::get(url), Box::new(FontFaceHandler(format)))
+            network_provider.fetch(
+                doc_id,
+                Request::get(url).with_destination(Destination::Font),
+                Box::new(FontFaceHandler(format)),
+            )
         });
 }
 
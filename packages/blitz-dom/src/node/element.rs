@@ -19,6 +19,7 @@ use style_traits::ParsingMode;
 use url::Url;
 
 use super::{Attribute, Attributes};
+use crate::layout::construct::ShapingKey;
 use crate::layout::table::TableContext;
 
 #[derive(Debug, Clone)]
@@ -580,6 +581,8 @@ impl TextBrush {
 pub struct TextLayout {
     pub text: String,
     pub layout: parley::layout::Layout<TextBrush>,
+    /// What `layout` was shaped from; a rebuild with the same key keeps it
+    pub(crate) shaping_key: ShapingKey,
 }
 
 impl std::fmt::Debug for TextLayout {
@@ -9,14 +9,14 @@ use selectors::matching::ElementSelectorFlags;
 use slab::Slab;
 use std::cell::{Cell, RefCell};
 use std::fmt::Write;
-use std::sync::atomic::AtomicBool;
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
 use style::Atom;
 use style::invalidation::element::restyle_hints::RestyleHint;
 use style::properties::ComputedValues;
 use style::properties::generated::longhands::position::computed_value::T as Position;
 use style::selector_parser::PseudoElement;
 use style::stylesheets::UrlExtraData;
-use style::values::computed::Display;
+use style::values::computed::{Display, Overflow};
 use style::values::specified::box_::{DisplayInside, DisplayOutside};
 use style::{data::ElementData as StyloElementData, shared_lock::SharedRwLock};
 use style_dom::ElementState;
@@ -96,7 +96,8 @@ pub struct Node {
     // This little bundle of joy is our style data from stylo and a lock guard that allows access to it
     // TODO: See if guard can be hoisted to a higher level
     pub stylo_element_data: AtomicRefCell<Option<StyloElementData>>,
-    pub selector_flags: AtomicRefCell<ElementSelectorFlags>,
+    /// [`ElementSelectorFlags`] bits, set by style traversal (possibly from several threads at once)
+    pub selector_flags: AtomicUsize,
     pub guard: SharedRwLock,
     pub element_state: ElementState,
 
@@ -136,7 +137,7 @@ impl Node {
             data,
 
             stylo_element_data: Default::default(),
-            selector_flags: AtomicRefCell::new(ElementSelectorFlags::empty()),
+            selector_flags: AtomicUsize::new(0),
             guard,
             element_state: ElementState::empty(),
 
@@ -387,6 +388,10 @@ impl TextNodeData {
 // }
 
 impl Node {
+    pub fn selector_flags(&self) -> ElementSelectorFlags {
+        ElementSelectorFlags::from_bits_retain(self.selector_flags.load(Ordering::Relaxed) as _)
+    }
+
     pub fn tree(&self) -> &Slab<Node> {
         unsafe { &*self.tree }
     }
@@ -655,6 +660,33 @@ impl Node {
             .unwrap_or(0)
     }
 
+    /// Conservative bounds of what this node paints itself (background, border, outline, outset box shadows,
+    /// overflowing text), relative to its border-box origin, in CSS pixels. Descendants are not included.
+    pub fn paint_bounds(&self) -> kurbo::Rect {
+        let layout = &self.unrounded_layout;
+        let mut rect = kurbo::Rect::new(0.0, 0.0, layout.size.width as f64, layout.size.height as f64);
+        if let Some(style) = self.primary_styles() {
+            let clips = !matches!(style.get_box().overflow_x, Overflow::Visible)
+                || !matches!(style.get_box().overflow_y, Overflow::Visible);
+            if !clips {
+                let content = layout.content_size;
+                rect = rect.union(kurbo::Rect::new(0.0, 0.0, content.width as f64, content.height as f64));
+            }
+
+            let outline = style.get_outline();
+            let mut outset = outline.outline_width.to_f64_px() + (outline.outline_offset.px() as f64).max(0.0);
+            for shadow in style.get_effects().box_shadow.0.iter().filter(|s| !s.inset) {
+                let offset = (shadow.base.horizontal.px().abs()).max(shadow.base.vertical.px().abs()) as f64;
+                // A gaussian blur fades out well within two blur radii
+                let extent = offset + 2.0 * shadow.base.blur.px() as f64 + (shadow.spread.px() as f64).max(0.0);
+                outset = outset.max(extent);
+            }
+            rect = rect.inflate(outset, outset);
+        }
+        // Antialiased edges
+        rect.inflate(1.0, 1.0)
+    }
+
     /// Takes an (x, y) position (relative to the *parent's* top-left corner) and returns:
     ///    - None if the position is outside of this node's bounds
     ///    - Some(HitResult) if the position is within the node but doesn't match any children
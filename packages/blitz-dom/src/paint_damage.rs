@@ -0,0 +1,443 @@
+//! Per-frame repaint damage.
+//!
+//! After resolving, a shell can ask the document which parts of the viewport may look different from the last
+//! frame it painted ([`BaseDocument::take_paint_damage`]) and repaint/present only those. Damage is found by
+//! diffing a small record of every painted box (its on-screen paint bounds, computed style and scroll offset)
+//! against the previous frame, plus nodes whose content changed without a style or geometry change (text
+//! edits, image loads, child list changes) which are reported through [`BaseDocument::damage_node`].
+
+use crate::BaseDocument;
+use peniko::kurbo::{Point, Rect};
+use style::properties::ComputedValues;
+use style::servo_arc::Arc as ServoArc;
+
+/// Beyond this many rectangles damage is merged (DXGI and D2D clips both get slower with many small regions)
+const MAX_DAMAGE_RECTS: usize = 8;
+/// Partial damage covering more than this fraction of the viewport is reported as full
+const FULL_DAMAGE_AREA_RATIO: f64 = 0.6;
+
+/// The parts of the viewport that need repainting, in CSS pixels relative to the viewport's top-left corner
+#[derive(Debug, Clone, PartialEq)]
+pub enum PaintDamage {
+    /// Everything (first frame, viewport size or scroll change, font loads, animations, ...)
+    Full,
+    /// Only these rectangles. Empty when nothing visible changed.
+    Partial(Vec<Rect>),
+}
+
+impl PaintDamage {
+    /// Whether the previous frame is still up to date
+    pub fn is_empty(&self) -> bool {
+        matches!(self, PaintDamage::Partial(rects) if rects.is_empty())
+    }
+
+    /// The damaged rectangles, or `None` for full damage
+    pub fn rects(&self) -> Option<&[Rect]> {
+        match self {
+            PaintDamage::Full => None,
+            PaintDamage::Partial(rects) => Some(rects),
+        }
+    }
+}
+
+#[derive(Clone)]
+struct PaintRecord {
+    bounds: Rect,
+    // Held (not just compared by address) so a freed style can't be mistaken for a new one at the same address
+    style: Option<ServoArc<ComputedValues>>,
+    scroll: Point,
+}
+
+impl PaintRecord {
+    fn same_as(&self, other: &PaintRecord) -> bool {
+        self.bounds == other.bounds && self.scroll == other.scroll && same_style(&self.style, &other.style)
+    }
+}
+
+// Restyled elements get a new style even if nothing changed, so this over-reports (a restyled subtree counts
+// as damaged) but never misses a change
+fn same_style(a: &Option<ServoArc<ComputedValues>>, b: &Option<ServoArc<ComputedValues>>) -> bool {
+    match (a, b) {
+        (Some(a), Some(b)) => ServoArc::ptr_eq(a, b),
+        (None, None) => true,
+        _ => false,
+    }
+}
+
+pub(crate) struct DamageTracker {
+    full: bool,
+    /// Nodes reported through `damage_node` since the last frame
+    nodes: Vec<usize>,
+    /// Last painted frame, indexed by node id
+    records: Vec<Option<PaintRecord>>,
+    viewport: (u32, u32, f32),
+    scroll: Point,
+}
+
+impl Default for DamageTracker {
+    fn default() -> Self {
+        Self {
+            full: true,
+            nodes: Vec::new(),
+            records: Vec::new(),
+            viewport: (0, 0, 0.0),
+            scroll: Point::ZERO,
+        }
+    }
+}
+
+impl BaseDocument {
+    /// Repaint everything on the next frame
+    pub fn invalidate_paint(&mut self) {
+        self.paint_damage.full = true;
+    }
+
+    /// Report that a node's painted content changed in a way its style and layout don't reflect
+    pub fn damage_node(&mut self, node_id: usize) {
+        if !self.paint_damage.full {
+            self.paint_damage.nodes.push(node_id);
+        }
+    }
+
+    /// Damage since the previous call. Call after [`resolve`](Self::resolve), once per painted frame; the
+    /// current state becomes the baseline for the next frame.
+    pub fn take_paint_damage(&mut self) -> PaintDamage {
+        let (width, height) = self.viewport.window_size;
+        let scale = self.viewport.scale() as f64;
+        self.take_paint_damage_within(width as f64 / scale, height as f64 / scale)
+    }
+
+    /// Like [`take_paint_damage`](Self::take_paint_damage), for a painted surface of `width` x `height` CSS px
+    /// anchored at the viewport origin instead of exactly the viewport, e.g. an over-sized scroll raster.
+    pub fn take_paint_damage_within(&mut self, width: f64, height: f64) -> PaintDamage {
+        let viewport = (
+            self.viewport.window_size.0,
+            self.viewport.window_size.1,
+            self.viewport.scale(),
+        );
+        let mut full = self.paint_damage.full
+            || self.paint_damage.viewport != viewport
+            || self.paint_damage.scroll != self.viewport_scroll
+            || self.is_animating
+            || self.devtool_settings.show_layout
+            || self.devtool_settings.highlight_hover;
+        let prev = std::mem::take(&mut self.paint_damage.records);
+        let reported = std::mem::take(&mut self.paint_damage.nodes);
+
+        let mut records: Vec<Option<PaintRecord>> = vec![None; self.nodes.capacity()];
+        let root_id = self.root_element().id;
+        let origin = Point::new(-self.viewport_scroll.x, -self.viewport_scroll.y);
+        // Transformed boxes don't paint where their layout says; give up on partial damage for them
+        let transformed = self.record_paint_subtree(root_id, origin, &mut records);
+        full |= transformed;
+
+        // The canvas background comes from <html> or <body> and covers the whole viewport
+        if !full {
+            let root = &self.nodes[root_id];
+            full = std::iter::once(root_id)
+                .chain(root.children.iter().copied())
+                .any(|id| match (prev.get(id).and_then(Option::as_ref), records.get(id).and_then(Option::as_ref)) {
+                    (Some(old), Some(new)) => !same_style(&old.style, &new.style),
+                    (None, None) => false,
+                    _ => true,
+                });
+        }
+
+        let mut rects = Vec::new();
+        if !full {
+            let len = prev.len().max(records.len());
+            for id in 0..len {
+                let old = prev.get(id).and_then(Option::as_ref);
+                let new = records.get(id).and_then(Option::as_ref);
+                match (old, new) {
+                    (Some(old), Some(new)) if !old.same_as(new) => {
+                        rects.push(old.bounds);
+                        rects.push(new.bounds);
+                    }
+                    (Some(old), None) => rects.push(old.bounds),
+                    (None, Some(new)) => rects.push(new.bounds),
+                    _ => {}
+                }
+            }
+            for id in reported {
+                rects.extend(prev.get(id).and_then(Option::as_ref).map(|r| r.bounds));
+                rects.extend(records.get(id).and_then(Option::as_ref).map(|r| r.bounds));
+            }
+        }
+
+        self.paint_damage = DamageTracker {
+            full: false,
+            nodes: Vec::new(),
+            records,
+            viewport,
+            scroll: self.viewport_scroll,
+        };
+
+        if full {
+            return PaintDamage::Full;
+        }
+        simplify_damage(rects, Rect::new(0.0, 0.0, width, height))
+    }
+
+    /// Record `node_id` and everything it paints below it, mirroring the paint traversal's positioning.
+    /// Returns whether any box in the subtree has a CSS transform.
+    fn record_paint_subtree(&self, node_id: usize, location: Point, records: &mut [Option<PaintRecord>]) -> bool {
+        let node = &self.nodes[node_id];
+        let style = node
+            .stylo_element_data
+            .borrow()
+            .as_ref()
+            .and_then(|data| data.styles.get_primary().cloned());
+        let mut transformed = style
+            .as_ref()
+            .is_some_and(|s| !s.get_box().transform.0.is_empty());
+
+        let layout = &node.unrounded_layout;
+        let position = Point::new(
+            location.x + layout.location.x as f64,
+            location.y + layout.location.y as f64,
+        );
+        let bounds = node.paint_bounds() + position.to_vec2();
+        let record = PaintRecord {
+            bounds,
+            style,
+            scroll: node.scroll_offset,
+        };
+
+        // Inline descendants (spans, links, ...) paint as part of this node's inline layout; their style
+        // changes damage the whole inline root
+        if node.flags.is_inline_root() {
+            let mut stack: Vec<usize> = node.children.clone();
+            while let Some(id) = stack.pop() {
+                let child = &self.nodes[id];
+                if let Some(style) = child
+                    .stylo_element_data
+                    .borrow()
+                    .as_ref()
+                    .and_then(|data| data.styles.get_primary().cloned())
+                {
+                    transformed |= !style.get_box().transform.0.is_empty();
+                    records[id] = Some(PaintRecord {
+                        bounds,
+                        style: Some(style),
+                        scroll: child.scroll_offset,
+                    });
+                }
+                stack.extend(child.children.iter().copied());
+            }
+        }
+        records[node_id] = Some(record);
+
+        let child_location = Point::new(
+            position.x - node.scroll_offset.x,
+            position.y - node.scroll_offset.y,
+        );
+        // Paint children (including inline boxes) overwrite any inline-descendant record above
+        if let Some(children) = &*node.paint_children.borrow() {
+            for &child_id in children {
+                transformed |= self.record_paint_subtree(child_id, child_location, records);
+            }
+        }
+        transformed
+    }
+}
+
+/// Clip to the viewport, drop empty rects, merge overlapping ones and bound the count. Falls back to full
+/// damage when the result covers most of the viewport anyway.
+fn simplify_damage(rects: Vec<Rect>, view: Rect) -> PaintDamage {
+    let mut out: Vec<Rect> = Vec::with_capacity(rects.len());
+    for rect in rects {
+        let rect = rect.intersect(view).expand();
+        if rect.is_zero_area() {
+            continue;
+        }
+        // Absorb anything this overlaps (repeat: the grown rect may now overlap others)
+        let mut rect = rect;
+        while let Some(idx) = out.iter().position(|r| !r.intersect(rect).is_zero_area()) {
+            rect = rect.union(out.swap_remove(idx));
+        }
+        out.push(rect);
+    }
+    while out.len() > MAX_DAMAGE_RECTS {
+        // Merge the pair whose union wastes the least area
+        let mut best = (0, 1, f64::INFINITY);
+        for i in 0..out.len() {
+            for j in (i + 1)..out.len() {
+                let waste = out[i].union(out[j]).area() - out[i].area() - out[j].area();
+                if waste < best.2 {
+                    best = (i, j, waste);
+                }
+            }
+        }
+        let merged = out[best.0].union(out.swap_remove(best.1));
+        out[best.0] = merged;
+    }
+    let area: f64 = out.iter().map(|r| r.area()).sum();
+    if area > view.area() * FULL_DAMAGE_AREA_RATIO {
+        return PaintDamage::Full;
+    }
+    PaintDamage::Partial(out)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{Attribute, DocumentConfig};
+    use blitz_traits::shell::{ColorScheme, Viewport};
+    use markup5ever::{LocalName, QualName, local_name, ns};
+
+    const VIEW: Rect = Rect::new(0.0, 0.0, 800.0, 600.0);
+
+    fn rect(x0: f64, y0: f64, x1: f64, y1: f64) -> Rect {
+        Rect::new(x0, y0, x1, y1)
+    }
+
+    fn qual(name: LocalName) -> QualName {
+        QualName::new(None, ns!(html), name)
+    }
+
+    /// html > body > three stacked 800x50 divs, resolved at 800x600. Returns the divs.
+    fn stacked_divs() -> (BaseDocument, [usize; 3]) {
+        let mut doc = BaseDocument::new(DocumentConfig::default());
+        let root = doc.root_node().id;
+        let mut mutr = doc.mutate();
+        let style = |value: &str| {
+            vec![Attribute {
+                name: qual(local_name!("style")),
+                value: value.to_string(),
+            }]
+        };
+        let divs =
+            [(); 3].map(|_| mutr.create_element(qual(local_name!("div")), style("height: 50px")));
+        let body = mutr.create_element(qual(local_name!("body")), style("margin: 0"));
+        let html = mutr.create_element(qual(local_name!("html")), Vec::new());
+        mutr.append_children(body, &divs);
+        mutr.append_children(html, &[body]);
+        mutr.append_children(root, &[html]);
+        drop(mutr);
+        doc.set_viewport(Viewport::new(800, 600, 1.0, ColorScheme::Light));
+        doc.resolve();
+        (doc, divs)
+    }
+
+    /// Stacked divs with their first frame already taken
+    fn painted() -> (BaseDocument, [usize; 3]) {
+        let (mut doc, divs) = stacked_divs();
+        assert_eq!(doc.take_paint_damage(), PaintDamage::Full);
+        (doc, divs)
+    }
+
+    #[test]
+    fn overlapping_rects_merge() {
+        let damage = simplify_damage(
+            vec![
+                rect(0.0, 0.0, 100.0, 100.0),
+                rect(300.0, 300.0, 350.0, 350.0),
+                rect(50.0, 50.0, 150.0, 150.0),
+            ],
+            VIEW,
+        );
+        let mut rects = damage.rects().unwrap().to_vec();
+        rects.sort_by(|a, b| a.x0.total_cmp(&b.x0));
+        assert_eq!(
+            rects,
+            vec![
+                rect(0.0, 0.0, 150.0, 150.0),
+                rect(300.0, 300.0, 350.0, 350.0)
+            ]
+        );
+    }
+
+    #[test]
+    fn rects_are_clipped_to_the_view() {
+        let damage = simplify_damage(
+            vec![
+                rect(-50.0, 590.0, 10.0, 700.0),
+                rect(900.0, 0.0, 950.0, 10.0),
+            ],
+            VIEW,
+        );
+        assert_eq!(
+            damage,
+            PaintDamage::Partial(vec![rect(0.0, 590.0, 10.0, 600.0)])
+        );
+    }
+
+    #[test]
+    fn rect_count_is_capped() {
+        let input: Vec<Rect> = (0..12)
+            .map(|i| {
+                let x = (i % 4) as f64 * 200.0;
+                let y = (i / 4) as f64 * 200.0;
+                rect(x, y, x + 10.0, y + 10.0)
+            })
+            .collect();
+        let damage = simplify_damage(input.clone(), VIEW);
+        let rects = damage.rects().unwrap();
+        assert!(rects.len() <= MAX_DAMAGE_RECTS, "{} rects", rects.len());
+        for r in input {
+            assert!(
+                rects.iter().any(|out| out.intersect(r) == r),
+                "{r:?} not covered by {rects:?}"
+            );
+        }
+    }
+
+    #[test]
+    fn most_of_the_view_falls_back_to_full() {
+        // 70% and 50% of the view
+        let mostly = rect(0.0, 0.0, 800.0, 420.0);
+        assert_eq!(simplify_damage(vec![mostly], VIEW), PaintDamage::Full);
+        let under = rect(0.0, 0.0, 800.0, 300.0);
+        assert_eq!(
+            simplify_damage(vec![under], VIEW),
+            PaintDamage::Partial(vec![under])
+        );
+    }
+
+    #[test]
+    fn unchanged_frame_has_no_damage() {
+        let (mut doc, _) = painted();
+        doc.resolve();
+        assert!(doc.take_paint_damage().is_empty());
+    }
+
+    #[test]
+    fn viewport_or_scroll_change_is_full() {
+        let (mut doc, _) = painted();
+        doc.set_viewport(Viewport::new(600, 600, 1.0, ColorScheme::Light));
+        doc.resolve();
+        assert_eq!(doc.take_paint_damage(), PaintDamage::Full);
+
+        doc.resolve();
+        assert!(doc.take_paint_damage().is_empty());
+        doc.set_viewport_scroll(Point::new(0.0, 20.0));
+        doc.resolve();
+        assert_eq!(doc.take_paint_damage(), PaintDamage::Full);
+    }
+
+    // Paint bounds include a 1px antialiasing margin, clipped to the view at its edges
+    #[test]
+    fn reported_node_is_repainted() {
+        let (mut doc, [_, b, _]) = painted();
+        doc.damage_node(b);
+        doc.resolve();
+        assert_eq!(
+            doc.take_paint_damage(),
+            PaintDamage::Partial(vec![rect(0.0, 49.0, 800.0, 101.0)])
+        );
+    }
+
+    #[test]
+    fn moved_nodes_damage_old_and_new_bounds() {
+        let (mut doc, [a, _, _]) = painted();
+        doc.mutate()
+            .set_attribute(a, qual(local_name!("style")), "height: 80px");
+        doc.resolve();
+        // a grew by 30px and pushed b and c down: everything from the top to c's new bottom edge
+        assert_eq!(
+            doc.take_paint_damage(),
+            PaintDamage::Partial(vec![rect(0.0, 0.0, 800.0, 181.0)])
+        );
+    }
+}
@@ -0,0 +1,67 @@
+//! User-agent stylesheets shared by every document in the process.
+//!
+//! Each document used to parse its own copy of `default.css` (and of any other UA sheet it was configured with)
+//! and Stylo compiled cascade data for each copy. A UA sheet is now parsed once per process, under a process-wide
+//! lock that is only ever read after parsing, and every document using the same CSS appends that same sheet to
+//! its Stylist (reading it with [`ua_lock`] as the `ua_or_user` guard). Stylo caches the cascade data of a set of
+//! UA sheets by sheet identity, so documents sharing UA sheets also share the rule maps compiled from them.
+//!
+//! UA sheets are parsed without a stylesheet loader: `@import` rules in them are not followed.
+
+use std::collections::HashMap;
+use std::sync::{Arc, LazyLock, Mutex};
+
+use selectors::matching::QuirksMode;
+use style::media_queries::MediaList;
+use style::servo_arc::Arc as ServoArc;
+use style::shared_lock::SharedRwLock;
+use style::stylesheets::{AllowImportRules, DocumentStyleSheet, Origin, Stylesheet};
+
+use crate::url::DocumentUrl;
+
+static UA_LOCK: LazyLock<SharedRwLock> = LazyLock::new(SharedRwLock::new);
+// Keyed by the CSS itself; documents keep the key too, so it is stored once
+static UA_SHEETS: LazyLock<Mutex<HashMap<Arc<str>, DocumentStyleSheet>>> =
+    LazyLock::new(Default::default);
+
+/// The lock every shared UA sheet was parsed under
+pub(crate) fn ua_lock() -> &'static SharedRwLock {
+    &UA_LOCK
+}
+
+/// The shared sheet for `css`, parsing it if no document has used it yet
+pub(crate) fn user_agent_stylesheet(css: &str) -> (Arc<str>, DocumentStyleSheet) {
+    let mut sheets = UA_SHEETS.lock().unwrap();
+    if let Some((key, sheet)) = sheets.get_key_value(css) {
+        return (key.clone(), sheet.clone());
+    }
+    let lock = ua_lock();
+    let data = Stylesheet::from_str(
+        css,
+        DocumentUrl::default().url_extra_data(),
+        Origin::UserAgent,
+        ServoArc::new(lock.wrap(MediaList::empty())),
+        lock.clone(),
+        None,
+        None,
+        QuirksMode::NoQuirks,
+        AllowImportRules::Yes,
+    );
+    let key: Arc<str> = css.into();
+    let sheet = DocumentStyleSheet(ServoArc::new(data));
+    sheets.insert(key.clone(), sheet.clone());
+    (key, sheet)
+}
+
+/// Parse a user-agent stylesheet ahead of the first document that uses it (e.g. [`DEFAULT_CSS`] from a startup
+/// thread), so creating that document only appends it.
+///
+/// [`DEFAULT_CSS`]: crate::DEFAULT_CSS
+pub fn preparse_user_agent_stylesheet(css: &str) {
+    user_agent_stylesheet(css);
+}
+
+/// Number of distinct user-agent stylesheets parsed in this process (each shared by every document using it)
+pub fn shared_user_agent_stylesheet_count() -> usize {
+    UA_SHEETS.lock().unwrap().len()
+}
@@ -51,10 +51,10 @@ impl crate::document::BaseDocument {
     let style_guard = blitz_metrics::start_phase("style");
         style::thread_state::enter(ThreadState::LAYOUT);
 
-        let guard = &self.guard;
+        // UA sheets are shared between documents, under a lock of their own
         let guards = StylesheetGuards {
-            author: &guard.read(),
-            ua_or_user: &guard.read(),
+            author: &self.guard.read(),
+            ua_or_user: &crate::shared_styles::ua_lock().read(),
         };
 
         let root = TDocument::as_node(&&self.nodes[0])
@@ -87,7 +87,8 @@ impl crate::document::BaseDocument {
     if token.should_traverse() {
             // Style the elements, resolving their data
             let traverser = RecalcStyle::new(context);
-            style::driver::traverse_dom(&traverser, token, None);
+            let pool = crate::layout_threads::layout_pool();
+            style::driver::traverse_dom(&traverser, token, pool.as_deref());
         }
     // Explicitly end style phase (initial only recorded by metrics layer)
     style_guard.end();
@@ -413,14 +414,18 @@ impl selectors::Element for BlitzNode<'_> {
         // Handle flags that apply to the element.
         let self_flags = flags.for_self();
         if !self_flags.is_empty() {
-            *self.selector_flags.borrow_mut() |= self_flags;
+            self.selector_flags
+                .fetch_or(self_flags.bits() as usize, Ordering::Relaxed);
         }
 
         // Handle flags that apply to the parent.
         let parent_flags = flags.for_parent();
         if !parent_flags.is_empty() {
             if let Some(parent) = self.parent_node() {
-                *parent.selector_flags.borrow_mut() |= parent_flags;
+                // Siblings can be styled on different threads, hence the atomic
+                parent
+                    .selector_flags
+                    .fetch_or(parent_flags.bits() as usize, Ordering::Relaxed);
             }
         }
     }
@@ -889,11 +894,11 @@ impl<'a> TElement for BlitzNode<'a> {
     }
 
     fn has_selector_flags(&self, flags: ElementSelectorFlags) -> bool {
-        self.selector_flags.borrow().contains(flags)
+        self.selector_flags().contains(flags)
     }
 
     fn relative_selector_search_direction(&self) -> ElementSelectorFlags {
-        let flags = self.selector_flags.borrow();
+        let flags = self.selector_flags();
         if flags.contains(ElementSelectorFlags::RELATIVE_SELECTOR_SEARCH_DIRECTION_ANCESTOR_SIBLING)
         {
             ElementSelectorFlags::RELATIVE_SELECTOR_SEARCH_DIRECTION_ANCESTOR_SIBLING
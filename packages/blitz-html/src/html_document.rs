@@ -46,8 +46,170 @@ impl HtmlDocument {
         HtmlDocument { inner: doc }
     }
 
+    /// Update the document in place to match `html`.
+    ///
+    /// The markup is parsed into a scratch document (without stylesheets or a net provider) which is then
+    /// diffed against the current DOM; only the differences are applied through the [`DocumentMutator`],
+    /// so unchanged subtrees keep their styles and loaded resources. Returns the number of mutations.
+    ///
+    /// [`DocumentMutator`]: blitz_dom::DocumentMutator
+    pub fn patch_html(&mut self, html: &str) -> usize {
+        // Same base url, so relative links and images in the new markup resolve as they will in this document
+        let mut scratch = BaseDocument::new(DocumentConfig {
+            base_url: Some(self.inner.base_url().to_string()),
+            ua_stylesheets: Some(Vec::new()),
+            ..Default::default()
+        });
+        let mut mutr = scratch.mutate();
+        DocumentHtmlParser::parse_into_mutator(&mut mutr, html);
+        drop(mutr);
+
+        let root_id = self.inner.root_node().id;
+        let scratch_root_id = scratch.root_node().id;
+        let mut mutr = self.inner.mutate();
+        let changes = mutr.patch_children_from(root_id, &scratch, scratch_root_id);
+        drop(mutr);
+        changes
+    }
+
     /// Convert the [`HtmlDocument`] into it's inner [`BaseDocument`]
     pub fn into_inner(self) -> BaseDocument {
         self.into()
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::HtmlDocument;
+    use blitz_dom::DocumentConfig;
+    use blitz_traits::shell::{ColorScheme, Viewport};
+
+    fn load(html: &str) -> HtmlDocument {
+        let mut doc = HtmlDocument::from_html(
+            html,
+            DocumentConfig {
+                base_url: Some("https://example.com/".to_string()),
+                ..Default::default()
+            },
+        );
+        doc.set_viewport(Viewport::new(800, 600, 1.0, ColorScheme::Light));
+        doc.resolve();
+        doc
+    }
+
+    fn page(body: &str) -> String {
+        format!("<html><head></head><body>{body}</body></html>")
+    }
+
+    fn by_id(doc: &HtmlDocument, id: &str) -> usize {
+        doc.query_selector(&format!("#{id}")).unwrap().unwrap()
+    }
+
+    fn attr(doc: &HtmlDocument, node_id: usize, name: &str) -> Option<String> {
+        let attrs = doc.get_node(node_id)?.attrs()?;
+        let attr = attrs.iter().find(|attr| &*attr.name.local == name)?;
+        Some(attr.value.to_string())
+    }
+
+    fn has_styles(doc: &HtmlDocument, node_id: usize) -> bool {
+        doc.get_node(node_id)
+            .unwrap()
+            .stylo_element_data
+            .borrow()
+            .is_some()
+    }
+
+    #[test]
+    fn text_edit_keeps_nodes_and_styles() {
+        let mut doc = load(&page("<p id=a>hello</p>"));
+        let p = by_id(&doc, "a");
+        let text = doc.get_node(p).unwrap().children.clone();
+        assert!(has_styles(&doc, p));
+
+        assert_eq!(doc.patch_html(&page("<p id=a>world</p>")), 1);
+        assert_eq!(by_id(&doc, "a"), p);
+        let node = doc.get_node(p).unwrap();
+        assert_eq!(node.children, text);
+        assert_eq!(node.text_content(), "world");
+        assert!(has_styles(&doc, p));
+    }
+
+    #[test]
+    fn insertion_replaces_only_the_changed_range() {
+        let mut doc = load(&page(
+            "<ul id=l><li id=a>a</li><li id=b>b</li><li id=c>c</li></ul>",
+        ));
+        let [a, b, c] = ["a", "b", "c"].map(|id| by_id(&doc, id));
+
+        let changes = doc.patch_html(&page(
+            "<ul id=l><li id=a>a</li><li id=x>x</li><li id=b>b</li><li id=c>c</li></ul>",
+        ));
+        assert_eq!(changes, 1);
+        let x = by_id(&doc, "x");
+        assert_eq!(
+            [by_id(&doc, "a"), by_id(&doc, "b"), by_id(&doc, "c")],
+            [a, b, c]
+        );
+        assert_eq!(
+            doc.get_node(by_id(&doc, "l")).unwrap().children,
+            vec![a, x, b, c]
+        );
+        assert!(has_styles(&doc, a) && has_styles(&doc, b) && has_styles(&doc, c));
+    }
+
+    #[test]
+    fn removed_attribute_is_cleared() {
+        let mut doc = load(&page("<div id=d class=big title=t></div>"));
+        let d = by_id(&doc, "d");
+
+        assert_eq!(doc.patch_html(&page("<div id=d class=big></div>")), 1);
+        assert_eq!(by_id(&doc, "d"), d);
+        assert_eq!(attr(&doc, d, "title"), None);
+        assert_eq!(attr(&doc, d, "class").as_deref(), Some("big"));
+    }
+
+    #[test]
+    fn style_text_edit_reprocesses_the_sheet() {
+        let style = |height: u32| {
+            page(&format!(
+                "<style>#p {{ height: {height}px }}</style><div id=p></div>"
+            ))
+        };
+        let mut doc = load(&style(10));
+        let p = by_id(&doc, "p");
+        assert_eq!(doc.get_node(p).unwrap().final_layout.size.height, 10.0);
+
+        assert_eq!(doc.patch_html(&style(30)), 1);
+        doc.resolve();
+        assert_eq!(by_id(&doc, "p"), p);
+        assert_eq!(doc.get_node(p).unwrap().final_layout.size.height, 30.0);
+    }
+
+    #[test]
+    fn identity_changes_replace_the_node() {
+        let cases = [
+            ("<div id=a></div>", "<div id=b></div>", "a", "b"),
+            (
+                "<input id=i type=text>",
+                "<input id=i type=checkbox>",
+                "i",
+                "i",
+            ),
+            (
+                "<link id=s rel=stylesheet href=a.css>",
+                "<link id=s rel=stylesheet href=b.css>",
+                "s",
+                "s",
+            ),
+        ];
+        for (old, new, old_id, new_id) in cases {
+            let mut doc = load(&page(old));
+            let before = by_id(&doc, old_id);
+
+            assert_eq!(doc.patch_html(&page(new)), 2, "{old} -> {new}");
+            let after = by_id(&doc, new_id);
+            assert_ne!(after, before, "{old} -> {new}");
+            assert!(doc.get_node(before).is_none(), "{old} -> {new}");
+        }
+    }
+}
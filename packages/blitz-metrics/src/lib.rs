@@ -1,6 +1,11 @@
 //! Shared metric types for Blitz instrumentation.
-use std::sync::Mutex;
-use std::sync::atomic::{AtomicBool, Ordering};
+//!
+//! Phase timings (parse, style, layout, shape, scene) are accumulated twice, both without locks:
+//! - into process-wide init totals, until [`freeze`] ends the init window (the debug overlay's startup breakdown);
+//! - into per-thread frame totals, always. A shell takes them with [`take_frame_phases`] on the thread that
+//!   rendered the frame, completes the record with its own timings and keeps it in a [`FrameRing`].
+use std::cell::Cell;
+use std::sync::atomic::{AtomicBool, AtomicU32, AtomicU64, Ordering};
 use std::time::{Duration, Instant};
 
 #[derive(Default, Debug, Clone)]
@@ -43,20 +48,45 @@ impl FrameTimings {
             _ => {}
         }
     }
+    fn from_phase_nanos(nanos: [u64; PHASES.len()]) -> Self {
+        let ms = |i: usize| nanos[i] as f32 / 1_000_000.0;
+        FrameTimings {
+            html_parse_ms: ms(0),
+            style_ms: ms(1),
+            layout_ms: ms(2),
+            text_shaping_ms: ms(3),
+            scene_build_ms: ms(4),
+            ..Default::default()
+        }
+    }
 }
 
-static PHASE_TIMINGS: once_cell::sync::Lazy<Mutex<FrameTimings>> = once_cell::sync::Lazy::new(|| Mutex::new(FrameTimings::default()));
+// Phases recorded by PhaseGuard, in FrameTimings order
+const PHASES: [&str; 5] = ["parse", "style", "layout", "shape", "scene"];
+
+fn phase_index(name: &str) -> Option<usize> { PHASES.iter().position(|p| *p == name) }
+
+static INIT_PHASE_NANOS: [AtomicU64; PHASES.len()] = [const { AtomicU64::new(0) }; PHASES.len()];
 static FROZEN: AtomicBool = AtomicBool::new(false);
 
+thread_local! {
+    static FRAME_PHASE_NANOS: [Cell<u64>; PHASES.len()] = const { [const { Cell::new(0) }; PHASES.len()] };
+}
+
+fn record_phase(name: &str, dur: Duration) {
+    let Some(i) = phase_index(name) else { return };
+    let nanos = dur.as_nanos() as u64;
+    FRAME_PHASE_NANOS.with(|f| f[i].set(f[i].get() + nanos));
+    if !FROZEN.load(Ordering::SeqCst) {
+        INIT_PHASE_NANOS[i].fetch_add(nanos, Ordering::Relaxed);
+    }
+}
+
 pub struct PhaseGuard { name: &'static str, start: Option<Instant> }
 impl PhaseGuard {
     pub fn end(mut self) {
         if let Some(st) = self.start.take() {
-            let dur = st.elapsed();
-            if !FROZEN.load(Ordering::SeqCst) {
-                let mut g = PHASE_TIMINGS.lock().unwrap();
-                g.add(self.name, dur);
-            }
+            record_phase(self.name, st.elapsed());
         }
     }
 }
@@ -64,22 +94,205 @@ impl PhaseGuard {
 impl Drop for PhaseGuard {
     fn drop(&mut self) {
         if let Some(st) = self.start.take() {
-            if !FROZEN.load(Ordering::SeqCst) {
-                let dur = st.elapsed();
-                let mut g = PHASE_TIMINGS.lock().unwrap();
-                g.add(self.name, dur);
-            }
+            record_phase(self.name, st.elapsed());
         }
     }
 }
 
+fn reset_init() { for n in &INIT_PHASE_NANOS { n.store(0, Ordering::Relaxed); } }
+
 pub fn start_phase(name: &'static str) -> PhaseGuard { PhaseGuard { name, start: Some(Instant::now()) } }
-pub fn snapshot() -> FrameTimings { PHASE_TIMINGS.lock().unwrap().clone() }
-pub fn reset_frame() { *PHASE_TIMINGS.lock().unwrap() = FrameTimings::default(); }
+/// Phase totals of the init window (everything so far while not frozen)
+pub fn snapshot() -> FrameTimings { FrameTimings::from_phase_nanos(std::array::from_fn(|i| INIT_PHASE_NANOS[i].load(Ordering::Relaxed))) }
+pub fn reset_frame() { reset_init(); }
 pub fn freeze() { FROZEN.store(true, Ordering::SeqCst); }
 pub fn is_frozen() -> bool { FROZEN.load(Ordering::SeqCst) }
-pub fn reset_for_testing() { FROZEN.store(false, Ordering::SeqCst); *PHASE_TIMINGS.lock().unwrap() = FrameTimings::default(); }
-pub fn unfreeze_and_reset() { FROZEN.store(false, Ordering::SeqCst); *PHASE_TIMINGS.lock().unwrap() = FrameTimings::default(); }
+pub fn reset_for_testing() { FROZEN.store(false, Ordering::SeqCst); reset_init(); take_frame_phases(); }
+pub fn unfreeze_and_reset() { FROZEN.store(false, Ordering::SeqCst); reset_init(); }
 pub fn begin_init_window(_start: Instant) { /* no-op with always-active gating */ }
 pub fn end_init_window() { /* no-op; freeze() stops recording */ }
 pub fn init_active() -> bool { !FROZEN.load(Ordering::SeqCst) }
+
+/// Phase timings recorded on this thread since the previous call (unaffected by [`freeze`]).
+pub fn take_frame_phases() -> FrameTimings {
+    FrameTimings::from_phase_nanos(FRAME_PHASE_NANOS.with(|f| std::array::from_fn(|i| f[i].take())))
+}
+
+/// One presented frame.
+#[derive(Default, Debug, Clone)]
+pub struct FrameRecord {
+    /// 1-based, assigned by [`FrameRing::push`]
+    pub frame: u64,
+    pub timings: FrameTimings,
+    pub command_count: u32,
+    /// Time spent in Present
+    pub present_ms: f32,
+}
+
+// FrameRecord fields as f32 bits (frame and command count aside)
+const SLOT_FLOATS: usize = 10;
+
+struct FrameSlot {
+    // Seqlock: odd while being written, else 2 * (frame number stored)
+    seq: AtomicU64,
+    command_count: AtomicU32,
+    floats: [AtomicU32; SLOT_FLOATS],
+}
+
+impl FrameSlot {
+    const fn new() -> Self {
+        FrameSlot { seq: AtomicU64::new(0), command_count: AtomicU32::new(0), floats: [const { AtomicU32::new(0) }; SLOT_FLOATS] }
+    }
+}
+
+fn record_floats(r: &FrameRecord) -> [f32; SLOT_FLOATS] {
+    let t = &r.timings;
+    [t.html_parse_ms, t.style_ms, t.layout_ms, t.text_shaping_ms, t.scene_build_ms, t.device_init_ms,
+     t.backbuffer_ms, t.playback_ms, t.frame_total_ms, r.present_ms]
+}
+
+fn floats_record(frame: u64, command_count: u32, f: [f32; SLOT_FLOATS]) -> FrameRecord {
+    FrameRecord {
+        frame,
+        timings: FrameTimings {
+            html_parse_ms: f[0], style_ms: f[1], layout_ms: f[2], text_shaping_ms: f[3], scene_build_ms: f[4],
+            device_init_ms: f[5], backbuffer_ms: f[6], playback_ms: f[7], frame_total_ms: f[8],
+        },
+        command_count,
+        present_ms: f[9],
+    }
+}
+
+/// Fixed-size history of the last [`FrameRing::CAPACITY`] frames. Writers and readers never block each other:
+/// a writer claims the next slot with one atomic increment, and a reader retries (or gives up on) a slot that was
+/// overwritten while it read it.
+pub struct FrameRing {
+    next: AtomicU64,
+    slots: [FrameSlot; FrameRing::CAPACITY],
+}
+
+impl Default for FrameRing {
+    fn default() -> Self { Self::new() }
+}
+
+impl FrameRing {
+    pub const CAPACITY: usize = 256;
+
+    pub const fn new() -> Self {
+        FrameRing { next: AtomicU64::new(0), slots: [const { FrameSlot::new() }; FrameRing::CAPACITY] }
+    }
+
+    /// Store a frame (its `frame` field is ignored) and return the number it was assigned.
+    pub fn push(&self, record: &FrameRecord) -> u64 {
+        let frame = self.next.fetch_add(1, Ordering::AcqRel) + 1;
+        let slot = &self.slots[(frame as usize - 1) % Self::CAPACITY];
+        slot.seq.store(frame * 2 - 1, Ordering::Release);
+        std::sync::atomic::fence(Ordering::Release);
+        slot.command_count.store(record.command_count, Ordering::Relaxed);
+        for (a, v) in slot.floats.iter().zip(record_floats(record)) {
+            a.store(v.to_bits(), Ordering::Relaxed);
+        }
+        slot.seq.store(frame * 2, Ordering::Release);
+        frame
+    }
+
+    /// Number of the most recent frame (0 before the first)
+    pub fn latest_frame(&self) -> u64 { self.next.load(Ordering::Acquire) }
+
+    /// Frame number `frame`, if it is still in the ring and not being overwritten.
+    pub fn get(&self, frame: u64) -> Option<FrameRecord> {
+        if frame == 0 || frame > self.latest_frame() { return None; }
+        let slot = &self.slots[(frame as usize - 1) % Self::CAPACITY];
+        for _ in 0..4 {
+            let before = slot.seq.load(Ordering::Acquire);
+            if before != frame * 2 {
+                if before > frame * 2 { return None; } // overwritten by a newer frame
+                std::hint::spin_loop();
+                continue; // still being written
+            }
+            let command_count = slot.command_count.load(Ordering::Relaxed);
+            let floats: [f32; SLOT_FLOATS] = std::array::from_fn(|i| f32::from_bits(slot.floats[i].load(Ordering::Relaxed)));
+            std::sync::atomic::fence(Ordering::Acquire);
+            if slot.seq.load(Ordering::Relaxed) == before {
+                return Some(floats_record(frame, command_count, floats));
+            }
+        }
+        None
+    }
+
+    /// The frame `frames_ago` frames before the latest one (0 = latest).
+    pub fn recent(&self, frames_ago: u64) -> Option<FrameRecord> {
+        self.latest_frame().checked_sub(frames_ago).and_then(|f| self.get(f))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn record(command_count: u32, present_ms: f32) -> FrameRecord {
+        FrameRecord {
+            command_count,
+            present_ms,
+            timings: FrameTimings { layout_ms: 1.5, frame_total_ms: 4.0, ..Default::default() },
+            ..Default::default()
+        }
+    }
+
+    #[test]
+    fn push_then_get_round_trips() {
+        let ring = FrameRing::new();
+        assert_eq!(ring.push(&record(7, 0.25)), 1);
+        assert_eq!(ring.push(&record(9, 0.5)), 2);
+        assert_eq!(ring.latest_frame(), 2);
+
+        let first = ring.get(1).unwrap();
+        assert_eq!(first.frame, 1);
+        assert_eq!(first.command_count, 7);
+        assert_eq!(first.present_ms, 0.25);
+        assert_eq!(first.timings.layout_ms, 1.5);
+        assert_eq!(first.timings.frame_total_ms, 4.0);
+        assert_eq!(ring.recent(0).unwrap().command_count, 9);
+        assert_eq!(ring.recent(1).unwrap().frame, 1);
+        assert!(ring.get(0).is_none());
+        assert!(ring.get(3).is_none());
+    }
+
+    #[test]
+    fn overwritten_frames_are_gone() {
+        let ring = FrameRing::new();
+        let total = FrameRing::CAPACITY as u64 + 3;
+        for i in 0..total {
+            ring.push(&record(i as u32, 0.0));
+        }
+        assert!(ring.get(1).is_none());
+        assert!(ring.get(3).is_none());
+        assert_eq!(ring.get(4).unwrap().command_count, 3);
+        assert_eq!(ring.get(total).unwrap().command_count, total as u32 - 1);
+        assert!(ring.recent(FrameRing::CAPACITY as u64).is_none());
+    }
+
+    #[test]
+    fn empty_ring_has_no_recent_frame() {
+        let ring = FrameRing::new();
+        assert_eq!(ring.latest_frame(), 0);
+        assert!(ring.recent(0).is_none());
+        assert!(ring.recent(5).is_none());
+    }
+
+    #[test]
+    fn take_frame_phases_resets_thread_totals() {
+        take_frame_phases();
+        record_phase("layout", Duration::from_millis(2));
+        record_phase("layout", Duration::from_millis(1));
+        record_phase("style", Duration::from_millis(4));
+
+        let taken = take_frame_phases();
+        assert_eq!(taken.layout_ms, 3.0);
+        assert_eq!(taken.style_ms, 4.0);
+
+        let again = take_frame_phases();
+        assert_eq!(again.layout_ms, 0.0);
+        assert_eq!(again.style_ms, 0.0);
+    }
+}
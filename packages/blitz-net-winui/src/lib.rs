@@ -5,54 +5,145 @@
 use std::collections::HashMap;
 use std::sync::{Arc, Mutex};
 use std::sync::atomic::{AtomicU32, Ordering};
-use blitz_traits::net::{NetProvider, Request, BoxedHandler};
+use blitz_traits::net::{NetProvider, Request, BoxedHandler, Bytes, Destination, Priority};
 
 // Lightweight logging hook (the shell exposes debug_log; we gate behind feature-less fn pointer lookup).
+extern "C" {
+    fn __blitz_host_debug_log(ptr: *const u8, len: usize);
+    fn __blitz_host_log_enabled() -> bool;
+}
+
 #[inline(always)]
 fn host_debug_log(msg: &str) {
-    extern "C" { fn __blitz_host_debug_log(ptr: *const u8, len: usize); }
     unsafe { let _ = std::panic::catch_unwind(|| __blitz_host_debug_log(msg.as_ptr(), msg.len())); }
 }
 
+fn host_log_enabled() -> bool {
+    unsafe { __blitz_host_log_enabled() }
+}
+
+// Formats only when the host would write the message somewhere
+macro_rules! host_log {
+    ($($arg:tt)*) => {
+        if host_log_enabled() { host_debug_log(&format!($($arg)*)); }
+    };
+}
+
 // Trait the shell implements to let the provider ask the host to start a fetch.
 pub trait HostFetcher: Send + Sync {
-    // Return true if dispatch accepted; false if host not ready.
-    fn request_url(&self, doc_id: usize, url: &str, request_id: u32) -> bool;
+    // Return true if dispatch accepted; false if host not ready. `kind` is a resource kind name
+    // ("Css", "Font", "Image", ...) the host may use to prioritize the request.
+    fn request_url(&self, doc_id: usize, url: &str, request_id: u32, kind: &str) -> bool;
+    // Synchronous cache probe: a fresh cached body for `url`, if the host has one. Must not call back into
+    // the Host (it runs inside document mutation).
+    fn try_get_cached(&self, _url: &str) -> Option<Bytes> { None }
+    // Best-effort: stop a queued or in-flight request; no completion is expected afterwards.
+    fn cancel(&self, _request_id: u32) {}
+    // Best-effort: stop every request issued for a document.
+    fn cancel_document(&self, _doc_id: usize) {}
+}
+
+/// Resource kind name for a request destination (same names the shell logs for loaded resources).
+pub fn destination_kind_name(d: Destination) -> &'static str {
+    match d {
+        Destination::Style => "Css",
+        Destination::Font => "Font",
+        Destination::Image => "Image",
+        Destination::Document => "Navigation",
+        Destination::Empty => "None",
+    }
+}
+
+/// Kind name sent to the host for a request: its destination's name, except that low-priority images (loaded
+/// ahead of scrolling, outside the viewport) are "OffscreenImage" so the host can queue them last.
+pub fn request_kind_name(request: &Request) -> &'static str {
+    match (request.destination, request.priority) {
+        (Destination::Image, Priority::Low) => "OffscreenImage",
+        (destination, _) => destination_kind_name(destination),
+    }
 }
 
 pub struct WinUiNetProvider<D: 'static> {
     host: Arc<dyn HostFetcher>,
     next_id: AtomicU32,
-    // request_id -> (doc_id, handler)
-    pending: Mutex<HashMap<u32, (usize, BoxedHandler<D>)>>,
+    // request_id -> (doc_id, destination, handler)
+    pending: Mutex<HashMap<u32, (usize, Destination, BoxedHandler<D>)>>,
+    // Requests answered synchronously from the host cache, waiting for the shell to run their handlers
+    // (handlers can't run inside fetch(): it is called while the document is being mutated)
+    ready: Mutex<Vec<(usize, Destination, BoxedHandler<D>, Bytes)>>,
 }
 
 impl<D: 'static> WinUiNetProvider<D> {
     pub fn new(host: Arc<dyn HostFetcher>) -> Self {
-    host_debug_log("WinUiNetProvider: created");
-    Self { host, next_id: AtomicU32::new(1), pending: Mutex::new(HashMap::new()) }
+    host_log!("WinUiNetProvider: created");
+    Self { host, next_id: AtomicU32::new(1), pending: Mutex::new(HashMap::new()), ready: Mutex::new(Vec::new()) }
     }
 
     pub fn shared(host: Arc<dyn HostFetcher>) -> Arc<Self> { Arc::new(Self::new(host)) }
 
     pub fn take_handler(&self, id: u32) -> Option<(usize, BoxedHandler<D>)> {
+        self.take_request(id).map(|(doc_id, _, handler)| (doc_id, handler))
+    }
+
+    /// Like [`take_handler`](Self::take_handler), also returning what the request was for.
+    pub fn take_request(&self, id: u32) -> Option<(usize, Destination, BoxedHandler<D>)> {
         self.pending.lock().ok().and_then(|mut m| m.remove(&id))
     }
+
+    /// Cache hits collected by fetch() since the last call.
+    pub fn take_ready(&self) -> Vec<(usize, Destination, BoxedHandler<D>, Bytes)> {
+        self.ready.lock().map(|mut r| std::mem::take(&mut *r)).unwrap_or_default()
+    }
+
+    pub fn has_ready(&self) -> bool {
+        self.ready.lock().map(|r| !r.is_empty()).unwrap_or(false)
+    }
+
+    /// Drop a request's handler and tell the host to stop fetching it.
+    pub fn cancel(&self, id: u32) {
+        if self.take_handler(id).is_some() {
+            self.host.cancel(id);
+        }
+    }
+
+    /// Drop every outstanding handler for `doc_id` (e.g. the document was replaced) and cancel them host-side.
+    /// Returns the number of requests dropped.
+    pub fn cancel_document(&self, doc_id: usize) -> usize {
+        let ids: Vec<u32> = match self.pending.lock() {
+            Ok(mut m) => {
+                let ids: Vec<u32> = m.iter().filter(|(_, (d, _, _))| *d == doc_id).map(|(id, _)| *id).collect();
+                for id in &ids { m.remove(id); }
+                ids
+            }
+            Err(_) => return 0,
+        };
+        if !ids.is_empty() {
+            host_log!("WinUiNetProvider.cancel_document: doc_id={} dropped={}", doc_id, ids.len());
+            self.host.cancel_document(doc_id);
+        }
+        ids.len()
+    }
 }
 
 impl<D: 'static> NetProvider<D> for WinUiNetProvider<D> {
     fn fetch(&self, doc_id: usize, request: Request, handler: BoxedHandler<D>) {
         let id = self.next_id.fetch_add(1, Ordering::Relaxed);
         let url_str = request.url.as_str().to_string();
+        let kind = request_kind_name(&request);
+        if let Some(bytes) = self.host.try_get_cached(&url_str) {
+            host_log!("WinUiNetProvider.fetch: doc_id={} url={} kind={} served from cache ({} bytes)", doc_id, url_str, kind, bytes.len());
+            if let Ok(mut r) = self.ready.lock() { r.push((doc_id, request.destination, handler, bytes)); }
+            return;
+        }
         let pending_len = {
             let mut guard_opt = self.pending.lock().ok();
-            if let Some(ref mut guard) = guard_opt { guard.insert(id, (doc_id, handler)); guard.len() } else { 0 }
+            if let Some(ref mut guard) = guard_opt { guard.insert(id, (doc_id, request.destination, handler)); guard.len() } else { 0 }
         };
-        host_debug_log(&format!("WinUiNetProvider.fetch: id={} doc_id={} url={} pending={} (dispatching)", id, doc_id, url_str, pending_len));
-        if !self.host.request_url(doc_id, &url_str, id) {
+        host_log!("WinUiNetProvider.fetch: id={} doc_id={} url={} kind={} pending={} (dispatching)", id, doc_id, url_str, kind, pending_len);
+        if !self.host.request_url(doc_id, &url_str, id, kind) {
             // Host rejected; remove handler and (best-effort) drop silently. Upstream can add error callback here.
             let _ = self.take_handler(id);
-            host_debug_log(&format!("WinUiNetProvider.fetch: id={} rejected by host", id));
+            host_log!("WinUiNetProvider.fetch: id={} rejected by host", id);
         }
     }
 }
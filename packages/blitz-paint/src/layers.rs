@@ -1,20 +1,62 @@
 use anyrender::PaintScene;
 use kurbo::{Affine, Shape};
 use peniko::Mix;
-use std::sync::atomic::{AtomicUsize, Ordering};
+use std::cell::Cell;
 
 const LAYER_LIMIT: usize = 1024;
 
-static LAYERS_USED: AtomicUsize = AtomicUsize::new(0);
-static LAYER_DEPTH: AtomicUsize = AtomicUsize::new(0);
-static LAYER_DEPTH_USED: AtomicUsize = AtomicUsize::new(0);
-static LAYERS_WANTED: AtomicUsize = AtomicUsize::new(0);
+/// Layer accounting for one recording. Each thread keeps its own, so the layers a subtree recorded on a rayon
+/// worker gets never depend on how far other workers have got with theirs.
+#[derive(Clone, Copy)]
+pub(crate) struct LayerStats {
+    used: usize,
+    depth: usize,
+    depth_used: usize,
+    wanted: usize,
+}
+
+impl LayerStats {
+    const EMPTY: Self = Self {
+        used: 0,
+        depth: 0,
+        depth_used: 0,
+        wanted: 0,
+    };
+}
+
+thread_local! {
+    static LAYERS: Cell<LayerStats> = const { Cell::new(LayerStats::EMPTY) };
+}
 
 pub(crate) fn reset_layer_stats() {
-    LAYERS_USED.store(0, Ordering::SeqCst);
-    LAYERS_WANTED.store(0, Ordering::SeqCst);
-    LAYER_DEPTH.store(0, Ordering::SeqCst);
-    LAYER_DEPTH_USED.store(0, Ordering::SeqCst);
+    LAYERS.set(LayerStats::EMPTY);
+}
+
+pub(crate) fn layer_stats() -> LayerStats {
+    LAYERS.get()
+}
+
+/// Run `record` with this thread's accounting set to `start`, returning the accounting it finished with. Fragments
+/// forked from one scene all start from the accounting at the fork, so each gets the same budget whichever thread
+/// records it and in whatever order.
+pub(crate) fn with_layer_stats<R>(
+    start: LayerStats,
+    record: impl FnOnce() -> R,
+) -> (R, LayerStats) {
+    let saved = LAYERS.replace(start);
+    let result = record();
+    (result, LAYERS.replace(saved))
+}
+
+/// Add the layers of fragments forked at `start` (see [`with_layer_stats`]) to this thread's accounting
+pub(crate) fn join_layer_stats(start: LayerStats, fragments: &[LayerStats]) {
+    let mut stats = start;
+    for fragment in fragments {
+        stats.used += fragment.used - start.used;
+        stats.wanted += fragment.wanted - start.wanted;
+        stats.depth_used = stats.depth_used.max(fragment.depth_used);
+    }
+    LAYERS.set(stats);
 }
 
 pub(crate) fn maybe_with_layer<S: PaintScene, F: FnOnce(&mut S)>(
@@ -40,11 +82,13 @@ pub(crate) fn maybe_push_layer(
     if !condition {
         return false;
     }
-    LAYERS_WANTED.fetch_add(1, Ordering::SeqCst);
+    let mut stats = LAYERS.get();
+    stats.wanted += 1;
 
     // Check if clips are above limit
-    let layers_available = LAYERS_USED.load(Ordering::SeqCst) <= LAYER_LIMIT;
+    let layers_available = stats.used <= LAYER_LIMIT;
     if !layers_available {
+        LAYERS.set(stats);
         return false;
     }
 
@@ -58,9 +102,10 @@ pub(crate) fn maybe_push_layer(
     scene.push_layer(blend_mode, opacity, transform, shape);
 
     // Update accounting
-    LAYERS_USED.fetch_add(1, Ordering::SeqCst);
-    let depth = LAYER_DEPTH.fetch_add(1, Ordering::SeqCst) + 1;
-    LAYER_DEPTH_USED.fetch_max(depth, Ordering::SeqCst);
+    stats.used += 1;
+    stats.depth += 1;
+    stats.depth_used = stats.depth_used.max(stats.depth);
+    LAYERS.set(stats);
 
     true
 }
@@ -68,6 +113,8 @@ pub(crate) fn maybe_push_layer(
 pub(crate) fn maybe_pop_layer(scene: &mut impl PaintScene, condition: bool) {
     if condition {
         scene.pop_layer();
-        LAYER_DEPTH.fetch_sub(1, Ordering::SeqCst);
+        let mut stats = LAYERS.get();
+        stats.depth -= 1;
+        LAYERS.set(stats);
     }
 }
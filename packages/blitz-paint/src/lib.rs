@@ -6,11 +6,12 @@ mod debug_overlay;
 mod gradient;
 mod kurbo_css;
 mod layers;
+mod parallel;
 mod render;
 mod sizing;
 mod text;
 
-use anyrender::PaintScene;
+use anyrender::{ForkPaintScene, PaintScene};
 use blitz_dom::BaseDocument;
 use layers::reset_layer_stats;
 use render::BlitzDomPainter;
@@ -30,6 +31,20 @@ pub fn paint_scene(
     scale: f64,
     width: u32,
     height: u32,
+) {
+    paint_scene_with_damage(scene, dom, scale, width, height, None);
+}
+
+/// Like [`paint_scene`], but only emits commands for elements that paint inside `damage` (scene coordinates,
+/// i.e. CSS pixels multiplied by `scale`). The renderer is expected to clip playback to the same region and keep
+/// the previous frame's pixels everywhere else. `None` paints everything.
+pub fn paint_scene_with_damage(
+    scene: &mut impl PaintScene,
+    dom: &BaseDocument,
+    scale: f64,
+    width: u32,
+    height: u32,
+    damage: Option<&[kurbo::Rect]>,
 ) {
     reset_layer_stats();
 
@@ -40,6 +55,7 @@ pub fn paint_scene(
         width,
         height,
         devtools,
+        damage,
     };
     generator.paint_scene(scene);
 
@@ -50,3 +66,28 @@ pub fn paint_scene(
     //     CLIPS_WANTED.load(atomic::Ordering::SeqCst)
     // );
 }
+
+/// Like [`paint_scene_with_damage`], but records independent subtrees of large documents on the rayon thread pool
+/// and splices them back in paint order, producing the same commands while the document stays under the layer
+/// limit. Small documents are painted sequentially.
+pub fn paint_scene_parallel<S: ForkPaintScene>(
+    scene: &mut S,
+    dom: &BaseDocument,
+    scale: f64,
+    width: u32,
+    height: u32,
+    damage: Option<&[kurbo::Rect]>,
+) {
+    reset_layer_stats();
+
+    let devtools = *dom.devtools();
+    let generator = BlitzDomPainter {
+        dom,
+        scale,
+        width,
+        height,
+        devtools,
+        damage,
+    };
+    generator.paint_scene_parallel(scene);
+}
@@ -0,0 +1,305 @@
+//! Parallel scene recording.
+//!
+//! Paint order in Blitz is a plain walk of every element's `paint_children`, and each element's transform and
+//! layers are computed from its own style and position, so the subtrees below one element record independently
+//! of each other. Large documents are split at the first element (walking down from the root) that has more than
+//! one paint child: everything above it is recorded on the calling thread as usual, its children are recorded in
+//! parallel into separate fragments of the scene, and the fragments are spliced back in paint order inside the
+//! element's layers, giving exactly the commands the sequential walk produces (as long as the document stays under
+//! the layer limit, which each fragment counts against separately).
+
+use anyrender::{ForkPaintScene, PaintScene};
+use blitz_dom::node::NodeData;
+use kurbo::Point;
+use rayon::prelude::*;
+
+use crate::layers::{LayerStats, join_layer_stats, layer_stats, with_layer_stats};
+use crate::render::BlitzDomPainter;
+
+/// Below this many nodes the sequential walk is faster than forking
+const PARALLEL_MIN_NODES: usize = 1000;
+/// Fragments per worker thread, so uneven subtrees still balance across the pool
+const FRAGMENTS_PER_THREAD: usize = 4;
+
+/// Lets rayon workers share the painter.
+///
+/// SAFETY: painting only reads the document, and nothing mutates it while the painter exists. What keeps the
+/// document from being `Sync` is the interior mutability on each [`Node`](blitz_dom::node::Node) and the raw tree
+/// pointer it carries:
+/// - `paint_children` (`RefCell`): even `borrow()` updates the borrow count, so each list must stay on one thread.
+///   A node's list is only borrowed while that node is rendered. The lists along the split path are borrowed on the
+///   calling thread, and the children recorded in parallel root disjoint subtrees, so every list is borrowed by
+///   exactly one thread.
+/// - `layout_children` (`RefCell`): not borrowed while painting.
+/// - `layout_parent` (`Cell`): only read by the hover debug overlay, which runs on the calling thread after the
+///   fragments have been joined.
+/// - `stylo_element_data` is an `AtomicRefCell` and the node flags touched during styling are atomics.
+/// - the tree pointer is only dereferenced to read other nodes.
+///
+/// Everything else the painter reaches (element data, text layouts, images, the damage list) is plain data or
+/// shared through `Arc`. Layer accounting is kept per thread (see `layers.rs`).
+struct SharedPainter<'a, 'dom>(&'a BlitzDomPainter<'dom>);
+unsafe impl Sync for SharedPainter<'_, '_> {}
+
+impl BlitzDomPainter<'_> {
+    /// Like [`paint_scene`](Self::paint_scene), recording independent subtrees on the rayon thread pool. Falls
+    /// back to the sequential walk for small documents or when the tree has nowhere to split.
+    pub(crate) fn paint_scene_parallel<S: ForkPaintScene>(&self, scene: &mut S) {
+        let Some(path) = self.split_path() else {
+            self.paint_scene(scene);
+            return;
+        };
+        self.paint_scene_with(scene, |scene, root_id, location| {
+            debug_assert_eq!(path[0], root_id);
+            self.render_split(scene, root_id, location, &path[1..]);
+        });
+    }
+
+    /// Element ids from the root down to (and including) the first element with more than one paint child
+    fn split_path(&self) -> Option<Vec<usize>> {
+        let tree = self.dom.as_ref().tree();
+        if tree.len() < PARALLEL_MIN_NODES || rayon::current_num_threads() < 2 {
+            return None;
+        }
+        let mut path = vec![self.dom.as_ref().root_element().id];
+        loop {
+            let node = &tree[*path.last().unwrap()];
+            let children = node.paint_children.borrow();
+            match children.as_deref() {
+                Some([only]) if is_element(&tree[*only].data) => path.push(*only),
+                Some(children) if children.len() > 1 => return Some(path),
+                _ => return None,
+            }
+        }
+    }
+
+    /// Render `node_id` with its children drawn along `rest` (its single paint child, and so on), and the last
+    /// element's children recorded in parallel
+    fn render_split<S: ForkPaintScene>(
+        &self,
+        scene: &mut S,
+        node_id: usize,
+        location: Point,
+        rest: &[usize],
+    ) {
+        self.render_element_with(scene, node_id, location, |cx, scene| match rest {
+            [next, rest @ ..] => self.render_split(scene, *next, cx.pos, rest),
+            [] => {
+                if let Some(children) = &*cx.node.paint_children.borrow() {
+                    self.render_children_parallel(scene, children, cx.pos);
+                }
+            }
+        });
+    }
+
+    fn render_children_parallel<S: ForkPaintScene>(
+        &self,
+        scene: &mut S,
+        children: &[usize],
+        location: Point,
+    ) {
+        let fragment_count = rayon::current_num_threads() * FRAGMENTS_PER_THREAD;
+        let chunk_size = children.len().div_ceil(fragment_count).max(1);
+        // Every fragment starts from the layer count at the fork, so which layers fit under the limit does not
+        // depend on scheduling. Below the limit this matches the sequential walk exactly.
+        let start = layer_stats();
+        let mut fragments: Vec<(S::Fragment, LayerStats)> = children
+            .chunks(chunk_size)
+            .map(|_| (scene.fork(), start))
+            .collect();
+
+        let painter = SharedPainter(self);
+        fragments
+            .par_iter_mut()
+            .zip(children.par_chunks(chunk_size))
+            .for_each(|((fragment, stats), chunk)| {
+                // Capture the Sync wrapper, not the field it wraps
+                let painter = &painter;
+                *stats = with_layer_stats(start, || {
+                    for &child_id in chunk {
+                        painter.0.render_node(fragment, child_id, location);
+                    }
+                })
+                .1;
+            });
+
+        let stats: Vec<LayerStats> = fragments.iter().map(|(_, stats)| *stats).collect();
+        join_layer_stats(start, &stats);
+        for (fragment, _) in fragments {
+            scene.join(fragment);
+        }
+    }
+}
+
+fn is_element(data: &NodeData) -> bool {
+    matches!(data, NodeData::Element(_) | NodeData::AnonymousBlock(_))
+}
+
+#[cfg(test)]
+mod tests {
+    use anyrender::{ForkPaintScene, Glyph, NormalizedCoord, Paint, PaintScene};
+    use blitz_dom::DocumentConfig;
+    use blitz_html::HtmlDocument;
+    use blitz_traits::shell::{ColorScheme, Viewport};
+    use kurbo::{Affine, Rect, Shape, Stroke};
+    use peniko::{BlendMode, BrushRef, Color, Fill, Font, StyleRef};
+
+    /// Commands in the order they were issued, formatted for comparison
+    #[derive(Default)]
+    struct Recording(Vec<String>);
+
+    impl PaintScene for Recording {
+        fn reset(&mut self) {
+            self.0.clear();
+        }
+
+        fn push_layer(
+            &mut self,
+            blend: impl Into<BlendMode>,
+            alpha: f32,
+            transform: Affine,
+            clip: &impl Shape,
+        ) {
+            let blend = blend.into();
+            let clip = clip.to_path(0.1);
+            self.0.push(format!(
+                "push_layer {blend:?} {alpha} {transform:?} {clip:?}"
+            ));
+        }
+
+        fn pop_layer(&mut self) {
+            self.0.push("pop_layer".to_string());
+        }
+
+        fn stroke<'a>(
+            &mut self,
+            style: &Stroke,
+            transform: Affine,
+            brush: impl Into<BrushRef<'a>>,
+            brush_transform: Option<Affine>,
+            shape: &impl Shape,
+        ) {
+            let brush = brush.into();
+            let shape = shape.to_path(0.1);
+            self.0.push(format!(
+                "stroke {:?} {transform:?} {brush:?} {brush_transform:?} {shape:?}",
+                style.width
+            ));
+        }
+
+        fn fill<'a>(
+            &mut self,
+            style: Fill,
+            transform: Affine,
+            brush: impl Into<Paint<'a>>,
+            brush_transform: Option<Affine>,
+            shape: &impl Shape,
+        ) {
+            let brush = brush.into();
+            let shape = shape.to_path(0.1);
+            self.0.push(format!(
+                "fill {style:?} {transform:?} {brush:?} {brush_transform:?} {shape:?}"
+            ));
+        }
+
+        fn draw_glyphs<'a, 's: 'a>(
+            &'s mut self,
+            _font: &'a Font,
+            font_family: &str,
+            font_size: f32,
+            font_weight: u16,
+            _hint: bool,
+            _normalized_coords: &'a [NormalizedCoord],
+            _style: impl Into<StyleRef<'a>>,
+            brush: impl Into<BrushRef<'a>>,
+            brush_alpha: f32,
+            transform: Affine,
+            glyph_transform: Option<Affine>,
+            glyphs: impl Iterator<Item = Glyph>,
+        ) {
+            let brush = brush.into();
+            let glyphs: Vec<Glyph> = glyphs.collect();
+            self.0.push(format!(
+                "glyphs {font_family} {font_size} {font_weight} {brush:?} {brush_alpha} {transform:?} \
+                 {glyph_transform:?} {glyphs:?}"
+            ));
+        }
+
+        fn draw_box_shadow(
+            &mut self,
+            transform: Affine,
+            rect: Rect,
+            brush: Color,
+            radius: f64,
+            std_dev: f64,
+        ) {
+            self.0.push(format!(
+                "box_shadow {transform:?} {rect:?} {brush:?} {radius} {std_dev}"
+            ));
+        }
+    }
+
+    impl ForkPaintScene for Recording {
+        type Fragment = Recording;
+
+        fn fork(&self) -> Recording {
+            Recording::default()
+        }
+
+        fn join(&mut self, fragment: Recording) {
+            self.0.extend(fragment.0);
+        }
+    }
+
+    fn document(body: &str) -> HtmlDocument {
+        let html = format!("<html><body>{body}</body></html>");
+        let mut doc = HtmlDocument::from_html(&html, DocumentConfig::default());
+        doc.set_viewport(Viewport::new(800, 600, 1.0, ColorScheme::Light));
+        doc.resolve();
+        doc
+    }
+
+    fn record(doc: &HtmlDocument, parallel: bool) -> Vec<String> {
+        let mut scene = Recording::default();
+        if parallel {
+            crate::paint_scene_parallel(&mut scene, doc, 1.0, 800, 600, None);
+        } else {
+            crate::paint_scene(&mut scene, doc, 1.0, 800, 600);
+        }
+        scene.0
+    }
+
+    fn pool() -> rayon::ThreadPool {
+        rayon::ThreadPoolBuilder::new()
+            .num_threads(4)
+            .build()
+            .unwrap()
+    }
+
+    #[test]
+    fn parallel_matches_sequential() {
+        // Rounded, semi-transparent boxes with text (one layer each), under the layer limit
+        let item = concat!(
+            r#"<div style="opacity: 0.5; overflow: hidden; border-radius: 4px; height: 10px; "#,
+            r#"background: teal; box-shadow: 1px 1px 2px black">x</div>"#,
+        );
+        let doc = document(&item.repeat(600));
+        assert!(doc.tree().len() >= super::PARALLEL_MIN_NODES);
+        let sequential = record(&doc, false);
+        let parallel = pool().install(|| record(&doc, true));
+        assert!(sequential.iter().any(|c| c.starts_with("push_layer")));
+        assert_eq!(parallel, sequential);
+    }
+
+    #[test]
+    fn parallel_is_deterministic_past_layer_limit() {
+        // 64 layers per top-level box, so each of the 16 fragments (4 per thread) wants more than LAYER_LIMIT
+        let inner = r#"<div style="opacity: 0.5; height: 1px; background: teal"></div>"#.repeat(64);
+        let doc = document(&format!("<div>{inner}</div>").repeat(320));
+        let pool = pool();
+        let first = pool.install(|| record(&doc, true));
+        for _ in 0..3 {
+            assert_eq!(pool.install(|| record(&doc, true)), first);
+        }
+    }
+}
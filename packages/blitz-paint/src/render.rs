@@ -46,9 +46,19 @@ pub struct BlitzDomPainter<'dom> {
     pub(crate) width: u32,
     pub(crate) height: u32,
     pub(crate) devtools: DevtoolSettings,
+    /// Region being repainted (scene coordinates); `None` repaints everything
+    pub(crate) damage: Option<&'dom [Rect]>,
 }
 
 impl BlitzDomPainter<'_> {
+    /// Whether anything painted within `bounds` (scene coordinates) can be visible in this frame
+    fn in_damage(&self, bounds: Rect) -> bool {
+        match self.damage {
+            None => true,
+            Some(rects) => rects.iter().any(|r| !r.intersect(bounds).is_zero_area()),
+        }
+    }
+
     fn node_position(&self, node: usize, location: Point) -> (Layout, Point) {
         let layout = self.layout(node);
         let pos = location + Vec2::new(layout.location.x as f64, layout.location.y as f64);
@@ -66,6 +76,18 @@ impl BlitzDomPainter<'_> {
     /// This assumes styles are resolved and layout is complete.
     /// Make sure you do those before trying to render
     pub fn paint_scene(&self, scene: &mut impl PaintScene) {
+        self.paint_scene_with(scene, |scene, root_id, location| {
+            self.render_element(scene, root_id, location)
+        });
+    }
+
+    /// The frame around the document tree (canvas background, metrics, debug overlay), with the root element
+    /// painted by `render_root`
+    pub(crate) fn paint_scene_with<S: PaintScene>(
+        &self,
+        scene: &mut S,
+        render_root: impl FnOnce(&mut S, usize, Point),
+    ) {
     let scene_guard = blitz_metrics::start_phase("scene");
         // Simply render the document (the root element (note that this is not the same as the root node)))
         scene.reset();
@@ -110,7 +132,7 @@ impl BlitzDomPainter<'_> {
             scene.fill(Fill::NonZero, Affine::IDENTITY, bg_color, None, &rect);
         }
 
-    self.render_element(
+    render_root(
             scene,
             root_id,
             Point {
@@ -138,6 +160,20 @@ impl BlitzDomPainter<'_> {
     /// Approaching rendering this way guarantees we have all the styles we need when rendering text with not having
     /// to traverse back to the parent for its styles, or needing to pass down styles
     fn render_element(&self, scene: &mut impl PaintScene, node_id: usize, location: Point) {
+        self.render_element_with(scene, node_id, location, |cx, scene| {
+            cx.draw_children(scene)
+        });
+    }
+
+    /// [`render_element`](Self::render_element) with the element's children painted by `draw_children` (called
+    /// inside the element's clip/opacity layer, with `cx` positioned for the scrolled content)
+    pub(crate) fn render_element_with<S: PaintScene>(
+        &self,
+        scene: &mut S,
+        node_id: usize,
+        location: Point,
+        draw_children: impl FnOnce(&ElementCx<'_>, &mut S),
+    ) {
         let node = &self.dom.as_ref().tree()[node_id];
 
         // Early return if the element is hidden
@@ -218,19 +254,31 @@ impl BlitzDomPainter<'_> {
             return;
         }
 
+        // Outside the damaged region this element's own painting can be skipped. Its children are still visited
+        // (they may overflow it) unless it clips them to its box.
+        let paint_bounds = (node.paint_bounds() + box_position.to_vec2()).scale_from_origin(self.scale);
+        let paints_self = self.in_damage(paint_bounds);
+        if !paints_self && should_clip {
+            return;
+        }
+
         let mut cx = self.element_cx(node, layout, box_position);
-        cx.draw_outline(scene);
-        cx.draw_outset_box_shadow(scene);
-        cx.draw_background(scene);
-        cx.draw_border(scene);
+        if paints_self {
+            cx.draw_outline(scene);
+            cx.draw_outset_box_shadow(scene);
+            cx.draw_background(scene);
+            cx.draw_border(scene);
+        }
 
         // TODO: allow layers with opacity to be unclipped (overflow: visible)
         let wants_layer = should_clip | has_opacity;
         let clip = &cx.frame.padding_box_path();
 
         maybe_with_layer(scene, wants_layer, opacity, cx.transform, clip, |scene| {
-            cx.draw_inset_box_shadow(scene);
-            cx.stroke_devtools(scene);
+            if paints_self {
+                cx.draw_inset_box_shadow(scene);
+                cx.stroke_devtools(scene);
+            }
 
             // Now that background has been drawn, offset pos and cx in order to draw our contents scrolled
             let content_position = Point {
@@ -245,20 +293,23 @@ impl BlitzDomPainter<'_> {
                 x: -node.scroll_offset.x,
                 y: -node.scroll_offset.y,
             });
-            cx.draw_image(scene);
-            #[cfg(feature = "svg")]
-            cx.draw_svg(scene);
-            cx.draw_canvas(scene);
-            cx.draw_input(scene);
-
-            cx.draw_text_input_text(scene, content_position);
-            cx.draw_inline_layout(scene, content_position);
+            if paints_self {
+                cx.draw_image(scene);
+                #[cfg(feature = "svg")]
+                cx.draw_svg(scene);
+                cx.draw_canvas(scene);
+                cx.draw_input(scene);
+
+                cx.draw_text_input_text(scene, content_position);
+                cx.draw_inline_layout(scene, content_position);
+            }
+            // Outside markers sit left of the box, beyond its paint bounds
             cx.draw_marker(scene, content_position);
-            cx.draw_children(scene);
+            draw_children(&cx, scene);
         });
     }
 
-    fn render_node(&self, scene: &mut impl PaintScene, node_id: usize, location: Point) {
+    pub(crate) fn render_node(&self, scene: &mut impl PaintScene, node_id: usize, location: Point) {
         let node = &self.dom.as_ref().tree()[node_id];
 
         match &node.data {
@@ -381,13 +432,13 @@ fn to_peniko_image(image: &RasterImageData, quality: peniko::ImageQuality) -> pe
 }
 
 /// A context of loaded and hot data to draw the element from
-struct ElementCx<'a> {
+pub(crate) struct ElementCx<'a> {
     context: &'a BlitzDomPainter<'a>,
     frame: CssBox,
     style: style::servo_arc::Arc<ComputedValues>,
-    pos: Point,
+    pub(crate) pos: Point,
     scale: f64,
-    node: &'a Node,
+    pub(crate) node: &'a Node,
     element: &'a ElementData,
     transform: Affine,
     #[cfg(feature = "svg")]
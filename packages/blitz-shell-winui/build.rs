@@ -2,6 +2,14 @@ use std::{env, process::Command};
 
 fn main() {
     println!("cargo:rerun-if-changed=idl/BlitzWinUI.idl");
+    println!("cargo:rerun-if-changed=src/bindings.rs");
+    generate_bindings();
+    // bindings.rs is checked in and only regenerated where midlrt is available, so make sure a hand edit (or a
+    // stale file) still lays out IHost the way the IDL does: C++/C# callers index its vtable by IDL order.
+    check_host_vtable_order();
+}
+
+fn generate_bindings() {
     let metadata_dir = format!("{}\\System32\\WinMetadata", env!("windir"));
     let winmd_str = "Generated Files/BlitzWinUI.winmd";
 
@@ -63,6 +71,58 @@ fn main() {
     }
 }
 
+// Host methods in declaration order, as the vtable lays them out (an event takes an add and a remove slot)
+fn idl_host_methods(idl: &str) -> Vec<String> {
+    let start = idl.find("runtimeclass Host").expect("runtimeclass Host in BlitzWinUI.idl");
+    let body = &idl[start..];
+    let body = &body[body.find('{').unwrap() + 1..];
+    let mut methods = Vec::new();
+    for line in body.lines() {
+        let line = line.split("//").next().unwrap().trim();
+        if line.starts_with('}') { break; }
+        if line.is_empty() || line.starts_with("static ") || line.starts_with("Host(") { continue; }
+        if let Some(event) = line.strip_prefix("event ") {
+            let name = event.trim_end_matches(';').rsplit(' ').next().unwrap();
+            methods.push(name.to_string());
+            methods.push(format!("Remove{name}"));
+            continue;
+        }
+        if let Some(rest) = line.strip_prefix("[method_name(\"") {
+            methods.push(rest[..rest.find('"').unwrap()].to_string());
+            continue;
+        }
+        let Some(paren) = line.find('(') else { continue };
+        methods.push(line[..paren].rsplit(' ').next().unwrap().to_string());
+    }
+    methods
+}
+
+fn bindings_host_slots(bindings: &str) -> Vec<String> {
+    let start = bindings.find("pub struct IHost_Vtbl {").expect("IHost_Vtbl in bindings.rs");
+    let body = &bindings[start..];
+    let body = &body[..body.find("\n}").unwrap()];
+    body.lines()
+        .filter_map(|l| l.trim().strip_prefix("pub ")?.split_once(':').map(|(name, _)| name.to_string()))
+        .filter(|name| name != "base__")
+        .collect()
+}
+
+fn check_host_vtable_order() {
+    let idl = std::fs::read_to_string("idl/BlitzWinUI.idl").unwrap();
+    let bindings = std::fs::read_to_string("src/bindings.rs").unwrap();
+    let declared = idl_host_methods(&idl);
+    let slots = bindings_host_slots(&bindings);
+    if declared != slots {
+        let first = declared.iter().zip(&slots).position(|(a, b)| a != b).unwrap_or(declared.len().min(slots.len()));
+        panic!(
+            "IHost_Vtbl in src/bindings.rs does not match runtimeclass Host in idl/BlitzWinUI.idl from slot {first} \
+             (IDL: {:?}, bindings: {:?}). New Host methods must be appended to the IDL and to IHost_Vtbl in the same order.",
+            declared.get(first),
+            slots.get(first),
+        );
+    }
+}
+
 fn shell_escape(arg: &str) -> String {
     if arg.is_empty() { return "''".into(); }
     if !arg.contains([' ', '"', '\'', '`', '$', ';', '(', ')', '&', '|', '<', '>', '^', '%']) {
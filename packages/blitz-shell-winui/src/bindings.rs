@@ -8,6 +8,44 @@
     clippy::all
 )]
 
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct FrameStats {
+    pub FrameIndex: u64,
+    pub ParseMs: f32,
+    pub StyleMs: f32,
+    pub LayoutMs: f32,
+    pub ShapeMs: f32,
+    pub SceneMs: f32,
+    pub PlaybackMs: f32,
+    pub PresentMs: f32,
+    pub TotalMs: f32,
+    pub CommandCount: u32,
+}
+impl windows_core::TypeKind for FrameStats {
+    type TypeKind = windows_core::CopyType;
+}
+impl windows_core::RuntimeType for FrameStats {
+    const SIGNATURE: windows_core::imp::ConstBuffer = windows_core::imp::ConstBuffer::from_slice(
+        b"struct(BlitzWinUI.FrameStats;u8;f4;f4;f4;f4;f4;f4;f4;f4;u4)",
+    );
+}
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct HostStats {
+    pub RendererCacheBytes: u64,
+    pub CreateMs: f32,
+    pub NodeCount: u32,
+    pub SharedUaStylesheets: u32,
+    pub SharedFontFaces: u32,
+}
+impl windows_core::TypeKind for HostStats {
+    type TypeKind = windows_core::CopyType;
+}
+impl windows_core::RuntimeType for HostStats {
+    const SIGNATURE: windows_core::imp::ConstBuffer =
+        windows_core::imp::ConstBuffer::from_slice(b"struct(BlitzWinUI.HostStats;u8;f4;u4;u4;u4)");
+}
 #[repr(transparent)]
 #[derive(Clone, Debug, Eq, PartialEq)]
 pub struct Host(windows_core::IUnknown);
@@ -223,6 +261,225 @@ impl Host {
             .ok()
         }
     }
+    pub fn SetFrameScheduler<P0>(&self, scheduler: P0) -> windows_core::Result<()>
+    where
+        P0: windows_core::Param<windows_core::IInspectable>,
+    {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).SetFrameScheduler)(
+                windows_core::Interface::as_raw(this),
+                scheduler.param().abi(),
+            )
+            .ok()
+        }
+    }
+    pub fn RenderPendingFrame(&self) -> windows_core::Result<bool> {
+        let this = self;
+        unsafe {
+            let mut result__ = core::mem::zeroed();
+            (windows_core::Interface::vtable(this).RenderPendingFrame)(
+                windows_core::Interface::as_raw(this),
+                &mut result__,
+            )
+            .map(|| result__)
+        }
+    }
+    pub fn SkippedFrameCount(&self) -> windows_core::Result<u64> {
+        let this = self;
+        unsafe {
+            let mut result__ = core::mem::zeroed();
+            (windows_core::Interface::vtable(this).SkippedFrameCount)(
+                windows_core::Interface::as_raw(this),
+                &mut result__,
+            )
+            .map(|| result__)
+        }
+    }
+    pub fn SetRenderWorkerEnabled(&self, enabled: bool) -> windows_core::Result<()> {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).SetRenderWorkerEnabled)(
+                windows_core::Interface::as_raw(this),
+                enabled,
+            )
+            .ok()
+        }
+    }
+    pub fn SubmitInputBatch(
+        &self,
+        points: &[f32],
+        buttons: u32,
+        modifiers: u32,
+    ) -> windows_core::Result<()> {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).SubmitInputBatch)(
+                windows_core::Interface::as_raw(this),
+                points.len().try_into().unwrap(),
+                points.as_ptr(),
+                buttons,
+                modifiers,
+            )
+            .ok()
+        }
+    }
+    pub fn CompleteFetchBuffer<P0>(
+        &self,
+        requestid: u32,
+        docid: u32,
+        buffer: P0,
+    ) -> windows_core::Result<()>
+    where
+        P0: windows_core::Param<windows_core::IInspectable>,
+    {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).CompleteFetchBuffer)(
+                windows_core::Interface::as_raw(this),
+                requestid,
+                docid,
+                buffer.param().abi(),
+            )
+            .ok()
+        }
+    }
+    pub fn UpdateHtml(&self, html: &windows_core::HSTRING) -> windows_core::Result<()> {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).UpdateHtml)(
+                windows_core::Interface::as_raw(this),
+                core::mem::transmute_copy(html),
+            )
+            .ok()
+        }
+    }
+    pub fn SetCompositorScrolling(&self, overscan: u32) -> windows_core::Result<()> {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).SetCompositorScrolling)(
+                windows_core::Interface::as_raw(this),
+                overscan,
+            )
+            .ok()
+        }
+    }
+    pub fn CompositorScrollOffset(&self) -> windows_core::Result<f64> {
+        let this = self;
+        unsafe {
+            let mut result__ = core::mem::zeroed();
+            (windows_core::Interface::vtable(this).CompositorScrollOffset)(
+                windows_core::Interface::as_raw(this),
+                &mut result__,
+            )
+            .map(|| result__)
+        }
+    }
+    pub fn SetTiledRendering(&self, enabled: bool) -> windows_core::Result<()> {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).SetTiledRendering)(
+                windows_core::Interface::as_raw(this),
+                enabled,
+            )
+            .ok()
+        }
+    }
+    pub fn SetMemoryBudget(&self, bytes: u64) -> windows_core::Result<()> {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).SetMemoryBudget)(
+                windows_core::Interface::as_raw(this),
+                bytes,
+            )
+            .ok()
+        }
+    }
+    pub fn Trim(&self) -> windows_core::Result<()> {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).Trim)(windows_core::Interface::as_raw(this)).ok()
+        }
+    }
+    pub fn SetMaximumFrameLatency(&self, frames: u32) -> windows_core::Result<()> {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).SetMaximumFrameLatency)(
+                windows_core::Interface::as_raw(this),
+                frames,
+            )
+            .ok()
+        }
+    }
+    pub fn SetTransparent(&self, enabled: bool) -> windows_core::Result<()> {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).SetTransparent)(
+                windows_core::Interface::as_raw(this),
+                enabled,
+            )
+            .ok()
+        }
+    }
+    pub fn GetFrameStats(&self) -> windows_core::Result<FrameStats> {
+        let this = self;
+        unsafe {
+            let mut result__ = core::mem::zeroed();
+            (windows_core::Interface::vtable(this).GetFrameStats)(
+                windows_core::Interface::as_raw(this),
+                &mut result__,
+            )
+            .map(|| result__)
+        }
+    }
+    pub fn GetFrameStatsAt(&self, framesago: u32) -> windows_core::Result<FrameStats> {
+        let this = self;
+        unsafe {
+            let mut result__ = core::mem::zeroed();
+            (windows_core::Interface::vtable(this).GetFrameStatsAt)(
+                windows_core::Interface::as_raw(this),
+                framesago,
+                &mut result__,
+            )
+            .map(|| result__)
+        }
+    }
+    pub fn FrameCompleted<P0>(&self, handler: P0) -> windows_core::Result<i64>
+    where
+        P0: windows_core::Param<windows::Foundation::EventHandler<FrameStats>>,
+    {
+        let this = self;
+        unsafe {
+            let mut result__ = core::mem::zeroed();
+            (windows_core::Interface::vtable(this).FrameCompleted)(
+                windows_core::Interface::as_raw(this),
+                handler.param().abi(),
+                &mut result__,
+            )
+            .map(|| result__)
+        }
+    }
+    pub fn RemoveFrameCompleted(&self, token: i64) -> windows_core::Result<()> {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).RemoveFrameCompleted)(
+                windows_core::Interface::as_raw(this),
+                token,
+            )
+            .ok()
+        }
+    }
+    pub fn GetHostStats(&self) -> windows_core::Result<HostStats> {
+        let this = self;
+        unsafe {
+            let mut result__ = core::mem::zeroed();
+            (windows_core::Interface::vtable(this).GetHostStats)(
+                windows_core::Interface::as_raw(this),
+                &mut result__,
+            )
+            .map(|| result__)
+        }
+    }
     pub fn CreateInstance<P0>(
         attacher: P0,
         width: u32,
@@ -247,6 +504,21 @@ impl Host {
             .and_then(|| windows_core::Type::from_abi(result__))
         })
     }
+    pub fn Prewarm() -> windows_core::Result<()> {
+        Self::IHostStatics(|this| unsafe {
+            (windows_core::Interface::vtable(this).Prewarm)(windows_core::Interface::as_raw(this))
+                .ok()
+        })
+    }
+    pub fn SetWorkerThreads(count: u32) -> windows_core::Result<()> {
+        Self::IHostStatics(|this| unsafe {
+            (windows_core::Interface::vtable(this).SetWorkerThreads)(
+                windows_core::Interface::as_raw(this),
+                count,
+            )
+            .ok()
+        })
+    }
     fn IHostFactory<R, F: FnOnce(&IHostFactory) -> windows_core::Result<R>>(
         callback: F,
     ) -> windows_core::Result<R> {
@@ -254,6 +526,13 @@ impl Host {
             windows_core::imp::FactoryCache::new();
         SHARED.call(callback)
     }
+    fn IHostStatics<R, F: FnOnce(&IHostStatics) -> windows_core::Result<R>>(
+        callback: F,
+    ) -> windows_core::Result<R> {
+        static SHARED: windows_core::imp::FactoryCache<Host, IHostStatics> =
+            windows_core::imp::FactoryCache::new();
+        SHARED.call(callback)
+    }
 }
 impl windows_core::RuntimeType for Host {
     const SIGNATURE: windows_core::imp::ConstBuffer =
@@ -325,6 +604,41 @@ pub trait IHost_Impl: windows_core::IUnknownImpl {
         modifiers: u32,
     ) -> windows_core::Result<()>;
     fn ReportAttachSubPhase(&self, kind: u8, ms: f32) -> windows_core::Result<()>;
+    fn SetFrameScheduler(
+        &self,
+        scheduler: windows_core::Ref<'_, windows_core::IInspectable>,
+    ) -> windows_core::Result<()>;
+    fn RenderPendingFrame(&self) -> windows_core::Result<bool>;
+    fn SkippedFrameCount(&self) -> windows_core::Result<u64>;
+    fn SetRenderWorkerEnabled(&self, enabled: bool) -> windows_core::Result<()>;
+    fn SubmitInputBatch(
+        &self,
+        points: &[f32],
+        buttons: u32,
+        modifiers: u32,
+    ) -> windows_core::Result<()>;
+    fn CompleteFetchBuffer(
+        &self,
+        requestId: u32,
+        docId: u32,
+        buffer: windows_core::Ref<'_, windows_core::IInspectable>,
+    ) -> windows_core::Result<()>;
+    fn UpdateHtml(&self, html: &windows_core::HSTRING) -> windows_core::Result<()>;
+    fn SetCompositorScrolling(&self, overscan: u32) -> windows_core::Result<()>;
+    fn CompositorScrollOffset(&self) -> windows_core::Result<f64>;
+    fn SetTiledRendering(&self, enabled: bool) -> windows_core::Result<()>;
+    fn SetMemoryBudget(&self, bytes: u64) -> windows_core::Result<()>;
+    fn Trim(&self) -> windows_core::Result<()>;
+    fn SetMaximumFrameLatency(&self, frames: u32) -> windows_core::Result<()>;
+    fn SetTransparent(&self, enabled: bool) -> windows_core::Result<()>;
+    fn GetFrameStats(&self) -> windows_core::Result<FrameStats>;
+    fn GetFrameStatsAt(&self, framesAgo: u32) -> windows_core::Result<FrameStats>;
+    fn FrameCompleted(
+        &self,
+        handler: windows_core::Ref<'_, windows::Foundation::EventHandler<FrameStats>>,
+    ) -> windows_core::Result<i64>;
+    fn RemoveFrameCompleted(&self, token: i64) -> windows_core::Result<()>;
+    fn GetHostStats(&self) -> windows_core::Result<HostStats>;
 }
 impl IHost_Vtbl {
     pub const fn new<Identity: IHost_Impl, const OFFSET: isize>() -> Self {
@@ -522,58 +836,345 @@ impl IHost_Vtbl {
                 IHost_Impl::ReportAttachSubPhase(this, kind, ms).into()
             }
         }
-        Self {
-            base__: windows_core::IInspectable_Vtbl::new::<Identity, IHost, OFFSET>(),
-            SetPanel: SetPanel::<Identity, OFFSET>,
-            Resize: Resize::<Identity, OFFSET>,
-            RenderOnce: RenderOnce::<Identity, OFFSET>,
-            LoadHtml: LoadHtml::<Identity, OFFSET>,
-            SetVerboseLogging: SetVerboseLogging::<Identity, OFFSET>,
-            SetDebugOverlay: SetDebugOverlay::<Identity, OFFSET>,
-            SetNetworkFetcher: SetNetworkFetcher::<Identity, OFFSET>,
-            CompleteFetch: CompleteFetch::<Identity, OFFSET>,
-            RequestUrl: RequestUrl::<Identity, OFFSET>,
-            TestAttacherConnection: TestAttacherConnection::<Identity, OFFSET>,
-            WheelScroll: WheelScroll::<Identity, OFFSET>,
-            PointerMove: PointerMove::<Identity, OFFSET>,
-            PointerDown: PointerDown::<Identity, OFFSET>,
-            PointerUp: PointerUp::<Identity, OFFSET>,
-            ReportAttachSubPhase: ReportAttachSubPhase::<Identity, OFFSET>,
+        unsafe extern "system" fn SetFrameScheduler<Identity: IHost_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+            scheduler: *mut core::ffi::c_void,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IHost_Impl::SetFrameScheduler(this, core::mem::transmute_copy(&scheduler)).into()
+            }
         }
-    }
-    pub fn matches(iid: &windows_core::GUID) -> bool {
-        iid == &<IHost as windows_core::Interface>::IID
-    }
-}
-#[repr(C)]
-#[doc(hidden)]
-pub struct IHost_Vtbl {
-    pub base__: windows_core::IInspectable_Vtbl,
-    pub SetPanel: unsafe extern "system" fn(
-        *mut core::ffi::c_void,
-        *mut core::ffi::c_void,
-    ) -> windows_core::HRESULT,
-    pub Resize:
-        unsafe extern "system" fn(*mut core::ffi::c_void, u32, u32, f32) -> windows_core::HRESULT,
-    pub RenderOnce: unsafe extern "system" fn(*mut core::ffi::c_void) -> windows_core::HRESULT,
-    pub LoadHtml: unsafe extern "system" fn(
-        *mut core::ffi::c_void,
-        *mut core::ffi::c_void,
-    ) -> windows_core::HRESULT,
-    pub SetVerboseLogging:
-        unsafe extern "system" fn(*mut core::ffi::c_void, bool) -> windows_core::HRESULT,
-    pub SetDebugOverlay:
-        unsafe extern "system" fn(*mut core::ffi::c_void, bool) -> windows_core::HRESULT,
-    pub SetNetworkFetcher: unsafe extern "system" fn(
-        *mut core::ffi::c_void,
-        *mut core::ffi::c_void,
-    ) -> windows_core::HRESULT,
-    pub CompleteFetch: unsafe extern "system" fn(
-        *mut core::ffi::c_void,
-        u32,
-        u32,
-        bool,
-        u32,
+        unsafe extern "system" fn RenderPendingFrame<Identity: IHost_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+            result__: *mut bool,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                match IHost_Impl::RenderPendingFrame(this) {
+                    Ok(ok__) => {
+                        result__.write(core::mem::transmute_copy(&ok__));
+                        windows_core::HRESULT(0)
+                    }
+                    Err(err) => err.into(),
+                }
+            }
+        }
+        unsafe extern "system" fn SkippedFrameCount<Identity: IHost_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+            result__: *mut u64,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                match IHost_Impl::SkippedFrameCount(this) {
+                    Ok(ok__) => {
+                        result__.write(core::mem::transmute_copy(&ok__));
+                        windows_core::HRESULT(0)
+                    }
+                    Err(err) => err.into(),
+                }
+            }
+        }
+        unsafe extern "system" fn SetRenderWorkerEnabled<
+            Identity: IHost_Impl,
+            const OFFSET: isize,
+        >(
+            this: *mut core::ffi::c_void,
+            enabled: bool,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IHost_Impl::SetRenderWorkerEnabled(this, enabled).into()
+            }
+        }
+        unsafe extern "system" fn SubmitInputBatch<Identity: IHost_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+            points_array_size: u32,
+            points: *const f32,
+            buttons: u32,
+            modifiers: u32,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IHost_Impl::SubmitInputBatch(
+                    this,
+                    core::slice::from_raw_parts(
+                        core::mem::transmute_copy(&points),
+                        points_array_size as usize,
+                    ),
+                    buttons,
+                    modifiers,
+                )
+                .into()
+            }
+        }
+        unsafe extern "system" fn CompleteFetchBuffer<Identity: IHost_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+            requestid: u32,
+            docid: u32,
+            buffer: *mut core::ffi::c_void,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IHost_Impl::CompleteFetchBuffer(
+                    this,
+                    requestid,
+                    docid,
+                    core::mem::transmute_copy(&buffer),
+                )
+                .into()
+            }
+        }
+        unsafe extern "system" fn UpdateHtml<Identity: IHost_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+            html: *mut core::ffi::c_void,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IHost_Impl::UpdateHtml(this, core::mem::transmute(&html)).into()
+            }
+        }
+        unsafe extern "system" fn SetCompositorScrolling<
+            Identity: IHost_Impl,
+            const OFFSET: isize,
+        >(
+            this: *mut core::ffi::c_void,
+            overscan: u32,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IHost_Impl::SetCompositorScrolling(this, overscan).into()
+            }
+        }
+        unsafe extern "system" fn CompositorScrollOffset<
+            Identity: IHost_Impl,
+            const OFFSET: isize,
+        >(
+            this: *mut core::ffi::c_void,
+            result__: *mut f64,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                match IHost_Impl::CompositorScrollOffset(this) {
+                    Ok(ok__) => {
+                        result__.write(core::mem::transmute_copy(&ok__));
+                        windows_core::HRESULT(0)
+                    }
+                    Err(err) => err.into(),
+                }
+            }
+        }
+        unsafe extern "system" fn SetTiledRendering<Identity: IHost_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+            enabled: bool,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IHost_Impl::SetTiledRendering(this, enabled).into()
+            }
+        }
+        unsafe extern "system" fn SetMemoryBudget<Identity: IHost_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+            bytes: u64,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IHost_Impl::SetMemoryBudget(this, bytes).into()
+            }
+        }
+        unsafe extern "system" fn Trim<Identity: IHost_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IHost_Impl::Trim(this).into()
+            }
+        }
+        unsafe extern "system" fn SetMaximumFrameLatency<
+            Identity: IHost_Impl,
+            const OFFSET: isize,
+        >(
+            this: *mut core::ffi::c_void,
+            frames: u32,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IHost_Impl::SetMaximumFrameLatency(this, frames).into()
+            }
+        }
+        unsafe extern "system" fn SetTransparent<Identity: IHost_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+            enabled: bool,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IHost_Impl::SetTransparent(this, enabled).into()
+            }
+        }
+        unsafe extern "system" fn GetFrameStats<Identity: IHost_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+            result__: *mut FrameStats,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                match IHost_Impl::GetFrameStats(this) {
+                    Ok(ok__) => {
+                        result__.write(core::mem::transmute_copy(&ok__));
+                        windows_core::HRESULT(0)
+                    }
+                    Err(err) => err.into(),
+                }
+            }
+        }
+        unsafe extern "system" fn GetFrameStatsAt<Identity: IHost_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+            framesago: u32,
+            result__: *mut FrameStats,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                match IHost_Impl::GetFrameStatsAt(this, framesago) {
+                    Ok(ok__) => {
+                        result__.write(core::mem::transmute_copy(&ok__));
+                        windows_core::HRESULT(0)
+                    }
+                    Err(err) => err.into(),
+                }
+            }
+        }
+        unsafe extern "system" fn FrameCompleted<Identity: IHost_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+            handler: *mut core::ffi::c_void,
+            result__: *mut i64,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                match IHost_Impl::FrameCompleted(this, core::mem::transmute_copy(&handler)) {
+                    Ok(ok__) => {
+                        result__.write(core::mem::transmute_copy(&ok__));
+                        windows_core::HRESULT(0)
+                    }
+                    Err(err) => err.into(),
+                }
+            }
+        }
+        unsafe extern "system" fn RemoveFrameCompleted<
+            Identity: IHost_Impl,
+            const OFFSET: isize,
+        >(
+            this: *mut core::ffi::c_void,
+            token: i64,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IHost_Impl::RemoveFrameCompleted(this, token).into()
+            }
+        }
+        unsafe extern "system" fn GetHostStats<Identity: IHost_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+            result__: *mut HostStats,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                match IHost_Impl::GetHostStats(this) {
+                    Ok(ok__) => {
+                        result__.write(core::mem::transmute_copy(&ok__));
+                        windows_core::HRESULT(0)
+                    }
+                    Err(err) => err.into(),
+                }
+            }
+        }
+        Self {
+            base__: windows_core::IInspectable_Vtbl::new::<Identity, IHost, OFFSET>(),
+            SetPanel: SetPanel::<Identity, OFFSET>,
+            Resize: Resize::<Identity, OFFSET>,
+            RenderOnce: RenderOnce::<Identity, OFFSET>,
+            LoadHtml: LoadHtml::<Identity, OFFSET>,
+            SetVerboseLogging: SetVerboseLogging::<Identity, OFFSET>,
+            SetDebugOverlay: SetDebugOverlay::<Identity, OFFSET>,
+            SetNetworkFetcher: SetNetworkFetcher::<Identity, OFFSET>,
+            CompleteFetch: CompleteFetch::<Identity, OFFSET>,
+            RequestUrl: RequestUrl::<Identity, OFFSET>,
+            TestAttacherConnection: TestAttacherConnection::<Identity, OFFSET>,
+            WheelScroll: WheelScroll::<Identity, OFFSET>,
+            PointerMove: PointerMove::<Identity, OFFSET>,
+            PointerDown: PointerDown::<Identity, OFFSET>,
+            PointerUp: PointerUp::<Identity, OFFSET>,
+            ReportAttachSubPhase: ReportAttachSubPhase::<Identity, OFFSET>,
+            SetFrameScheduler: SetFrameScheduler::<Identity, OFFSET>,
+            RenderPendingFrame: RenderPendingFrame::<Identity, OFFSET>,
+            SkippedFrameCount: SkippedFrameCount::<Identity, OFFSET>,
+            SetRenderWorkerEnabled: SetRenderWorkerEnabled::<Identity, OFFSET>,
+            SubmitInputBatch: SubmitInputBatch::<Identity, OFFSET>,
+            CompleteFetchBuffer: CompleteFetchBuffer::<Identity, OFFSET>,
+            UpdateHtml: UpdateHtml::<Identity, OFFSET>,
+            SetCompositorScrolling: SetCompositorScrolling::<Identity, OFFSET>,
+            CompositorScrollOffset: CompositorScrollOffset::<Identity, OFFSET>,
+            SetTiledRendering: SetTiledRendering::<Identity, OFFSET>,
+            SetMemoryBudget: SetMemoryBudget::<Identity, OFFSET>,
+            Trim: Trim::<Identity, OFFSET>,
+            SetMaximumFrameLatency: SetMaximumFrameLatency::<Identity, OFFSET>,
+            SetTransparent: SetTransparent::<Identity, OFFSET>,
+            GetFrameStats: GetFrameStats::<Identity, OFFSET>,
+            GetFrameStatsAt: GetFrameStatsAt::<Identity, OFFSET>,
+            FrameCompleted: FrameCompleted::<Identity, OFFSET>,
+            RemoveFrameCompleted: RemoveFrameCompleted::<Identity, OFFSET>,
+            GetHostStats: GetHostStats::<Identity, OFFSET>,
+        }
+    }
+    pub fn matches(iid: &windows_core::GUID) -> bool {
+        iid == &<IHost as windows_core::Interface>::IID
+    }
+}
+#[repr(C)]
+#[doc(hidden)]
+pub struct IHost_Vtbl {
+    pub base__: windows_core::IInspectable_Vtbl,
+    pub SetPanel: unsafe extern "system" fn(
+        *mut core::ffi::c_void,
+        *mut core::ffi::c_void,
+    ) -> windows_core::HRESULT,
+    pub Resize:
+        unsafe extern "system" fn(*mut core::ffi::c_void, u32, u32, f32) -> windows_core::HRESULT,
+    pub RenderOnce: unsafe extern "system" fn(*mut core::ffi::c_void) -> windows_core::HRESULT,
+    pub LoadHtml: unsafe extern "system" fn(
+        *mut core::ffi::c_void,
+        *mut core::ffi::c_void,
+    ) -> windows_core::HRESULT,
+    pub SetVerboseLogging:
+        unsafe extern "system" fn(*mut core::ffi::c_void, bool) -> windows_core::HRESULT,
+    pub SetDebugOverlay:
+        unsafe extern "system" fn(*mut core::ffi::c_void, bool) -> windows_core::HRESULT,
+    pub SetNetworkFetcher: unsafe extern "system" fn(
+        *mut core::ffi::c_void,
+        *mut core::ffi::c_void,
+    ) -> windows_core::HRESULT,
+    pub CompleteFetch: unsafe extern "system" fn(
+        *mut core::ffi::c_void,
+        u32,
+        u32,
+        bool,
+        u32,
         *const u8,
         *mut core::ffi::c_void,
     ) -> windows_core::HRESULT,
@@ -612,6 +1213,122 @@ pub struct IHost_Vtbl {
     ) -> windows_core::HRESULT,
     pub ReportAttachSubPhase:
         unsafe extern "system" fn(*mut core::ffi::c_void, u8, f32) -> windows_core::HRESULT,
+    pub SetFrameScheduler: unsafe extern "system" fn(
+        *mut core::ffi::c_void,
+        *mut core::ffi::c_void,
+    ) -> windows_core::HRESULT,
+    pub RenderPendingFrame:
+        unsafe extern "system" fn(*mut core::ffi::c_void, *mut bool) -> windows_core::HRESULT,
+    pub SkippedFrameCount:
+        unsafe extern "system" fn(*mut core::ffi::c_void, *mut u64) -> windows_core::HRESULT,
+    pub SetRenderWorkerEnabled:
+        unsafe extern "system" fn(*mut core::ffi::c_void, bool) -> windows_core::HRESULT,
+    pub SubmitInputBatch: unsafe extern "system" fn(
+        *mut core::ffi::c_void,
+        u32,
+        *const f32,
+        u32,
+        u32,
+    ) -> windows_core::HRESULT,
+    pub CompleteFetchBuffer: unsafe extern "system" fn(
+        *mut core::ffi::c_void,
+        u32,
+        u32,
+        *mut core::ffi::c_void,
+    ) -> windows_core::HRESULT,
+    pub UpdateHtml: unsafe extern "system" fn(
+        *mut core::ffi::c_void,
+        *mut core::ffi::c_void,
+    ) -> windows_core::HRESULT,
+    pub SetCompositorScrolling:
+        unsafe extern "system" fn(*mut core::ffi::c_void, u32) -> windows_core::HRESULT,
+    pub CompositorScrollOffset:
+        unsafe extern "system" fn(*mut core::ffi::c_void, *mut f64) -> windows_core::HRESULT,
+    pub SetTiledRendering:
+        unsafe extern "system" fn(*mut core::ffi::c_void, bool) -> windows_core::HRESULT,
+    pub SetMemoryBudget:
+        unsafe extern "system" fn(*mut core::ffi::c_void, u64) -> windows_core::HRESULT,
+    pub Trim: unsafe extern "system" fn(*mut core::ffi::c_void) -> windows_core::HRESULT,
+    pub SetMaximumFrameLatency:
+        unsafe extern "system" fn(*mut core::ffi::c_void, u32) -> windows_core::HRESULT,
+    pub SetTransparent:
+        unsafe extern "system" fn(*mut core::ffi::c_void, bool) -> windows_core::HRESULT,
+    pub GetFrameStats:
+        unsafe extern "system" fn(*mut core::ffi::c_void, *mut FrameStats) -> windows_core::HRESULT,
+    pub GetFrameStatsAt: unsafe extern "system" fn(
+        *mut core::ffi::c_void,
+        u32,
+        *mut FrameStats,
+    ) -> windows_core::HRESULT,
+    pub FrameCompleted: unsafe extern "system" fn(
+        *mut core::ffi::c_void,
+        *mut core::ffi::c_void,
+        *mut i64,
+    ) -> windows_core::HRESULT,
+    pub RemoveFrameCompleted:
+        unsafe extern "system" fn(*mut core::ffi::c_void, i64) -> windows_core::HRESULT,
+    pub GetHostStats:
+        unsafe extern "system" fn(*mut core::ffi::c_void, *mut HostStats) -> windows_core::HRESULT,
+}
+windows_core::imp::define_interface!(
+    IFrameScheduler,
+    IFrameScheduler_Vtbl,
+    0x8c1f4e27_3b5a_4d6e_9f70_2a4b6c8d0e13
+);
+impl windows_core::RuntimeType for IFrameScheduler {
+    const SIGNATURE: windows_core::imp::ConstBuffer =
+        windows_core::imp::ConstBuffer::for_interface::<Self>();
+}
+windows_core::imp::interface_hierarchy!(
+    IFrameScheduler,
+    windows_core::IUnknown,
+    windows_core::IInspectable
+);
+impl IFrameScheduler {
+    pub fn RequestFrame(&self) -> windows_core::Result<()> {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).RequestFrame)(windows_core::Interface::as_raw(
+                this,
+            ))
+            .ok()
+        }
+    }
+}
+impl windows_core::RuntimeName for IFrameScheduler {
+    const NAME: &'static str = "BlitzWinUI.IFrameScheduler";
+}
+pub trait IFrameScheduler_Impl: windows_core::IUnknownImpl {
+    fn RequestFrame(&self) -> windows_core::Result<()>;
+}
+impl IFrameScheduler_Vtbl {
+    pub const fn new<Identity: IFrameScheduler_Impl, const OFFSET: isize>() -> Self {
+        unsafe extern "system" fn RequestFrame<
+            Identity: IFrameScheduler_Impl,
+            const OFFSET: isize,
+        >(
+            this: *mut core::ffi::c_void,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IFrameScheduler_Impl::RequestFrame(this).into()
+            }
+        }
+        Self {
+            base__: windows_core::IInspectable_Vtbl::new::<Identity, IFrameScheduler, OFFSET>(),
+            RequestFrame: RequestFrame::<Identity, OFFSET>,
+        }
+    }
+    pub fn matches(iid: &windows_core::GUID) -> bool {
+        iid == &<IFrameScheduler as windows_core::Interface>::IID
+    }
+}
+#[repr(C)]
+#[doc(hidden)]
+pub struct IFrameScheduler_Vtbl {
+    pub base__: windows_core::IInspectable_Vtbl,
+    pub RequestFrame: unsafe extern "system" fn(*mut core::ffi::c_void) -> windows_core::HRESULT,
 }
 windows_core::imp::define_interface!(
     IHostFactory,
@@ -692,6 +1409,64 @@ pub struct IHostFactory_Vtbl {
         *mut *mut core::ffi::c_void,
     ) -> windows_core::HRESULT,
 }
+windows_core::imp::define_interface!(
+    IHostStatics,
+    IHostStatics_Vtbl,
+    0xe6c29ec3_18df_5a4d_af61_4209c80bcced
+);
+impl windows_core::RuntimeType for IHostStatics {
+    const SIGNATURE: windows_core::imp::ConstBuffer =
+        windows_core::imp::ConstBuffer::for_interface::<Self>();
+}
+impl windows_core::RuntimeName for IHostStatics {
+    const NAME: &'static str = "BlitzWinUI.IHostStatics";
+}
+pub trait IHostStatics_Impl: windows_core::IUnknownImpl {
+    fn Prewarm(&self) -> windows_core::Result<()>;
+    fn SetWorkerThreads(&self, count: u32) -> windows_core::Result<()>;
+}
+impl IHostStatics_Vtbl {
+    pub const fn new<Identity: IHostStatics_Impl, const OFFSET: isize>() -> Self {
+        unsafe extern "system" fn Prewarm<Identity: IHostStatics_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IHostStatics_Impl::Prewarm(this).into()
+            }
+        }
+        unsafe extern "system" fn SetWorkerThreads<
+            Identity: IHostStatics_Impl,
+            const OFFSET: isize,
+        >(
+            this: *mut core::ffi::c_void,
+            count: u32,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                IHostStatics_Impl::SetWorkerThreads(this, count).into()
+            }
+        }
+        Self {
+            base__: windows_core::IInspectable_Vtbl::new::<Identity, IHostStatics, OFFSET>(),
+            Prewarm: Prewarm::<Identity, OFFSET>,
+            SetWorkerThreads: SetWorkerThreads::<Identity, OFFSET>,
+        }
+    }
+    pub fn matches(iid: &windows_core::GUID) -> bool {
+        iid == &<IHostStatics as windows_core::Interface>::IID
+    }
+}
+#[repr(C)]
+#[doc(hidden)]
+pub struct IHostStatics_Vtbl {
+    pub base__: windows_core::IInspectable_Vtbl,
+    pub Prewarm: unsafe extern "system" fn(*mut core::ffi::c_void) -> windows_core::HRESULT,
+    pub SetWorkerThreads:
+        unsafe extern "system" fn(*mut core::ffi::c_void, u32) -> windows_core::HRESULT,
+}
 windows_core::imp::define_interface!(
     INetworkFetcher,
     INetworkFetcher_Vtbl,
@@ -726,6 +1501,62 @@ impl INetworkFetcher {
             .ok()
         }
     }
+    pub fn FetchWithKind(
+        &self,
+        requestid: u32,
+        docid: u32,
+        url: &windows_core::HSTRING,
+        method: &windows_core::HSTRING,
+        kind: &windows_core::HSTRING,
+    ) -> windows_core::Result<()> {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).FetchWithKind)(
+                windows_core::Interface::as_raw(this),
+                requestid,
+                docid,
+                core::mem::transmute_copy(url),
+                core::mem::transmute_copy(method),
+                core::mem::transmute_copy(kind),
+            )
+            .ok()
+        }
+    }
+    pub fn Cancel(&self, requestid: u32) -> windows_core::Result<()> {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).Cancel)(
+                windows_core::Interface::as_raw(this),
+                requestid,
+            )
+            .ok()
+        }
+    }
+    pub fn CancelDocument(&self, docid: u32) -> windows_core::Result<()> {
+        let this = self;
+        unsafe {
+            (windows_core::Interface::vtable(this).CancelDocument)(
+                windows_core::Interface::as_raw(this),
+                docid,
+            )
+            .ok()
+        }
+    }
+    pub fn TryGetCached(
+        &self,
+        url: &windows_core::HSTRING,
+    ) -> windows_core::Result<windows_core::IInspectable> {
+        let this = self;
+        unsafe {
+            let mut result__ = core::mem::zeroed();
+            (windows_core::Interface::vtable(this).TryGetCached)(
+                windows_core::Interface::as_raw(this),
+                core::mem::transmute_copy(url),
+                &mut result__,
+            )
+            .and_then(|| windows_core::Type::from_abi(result__))
+        }
+    }
 }
 impl windows_core::RuntimeName for INetworkFetcher {
     const NAME: &'static str = "BlitzWinUI.INetworkFetcher";
@@ -738,6 +1569,20 @@ pub trait INetworkFetcher_Impl: windows_core::IUnknownImpl {
         url: &windows_core::HSTRING,
         method: &windows_core::HSTRING,
     ) -> windows_core::Result<()>;
+    fn FetchWithKind(
+        &self,
+        requestId: u32,
+        docId: u32,
+        url: &windows_core::HSTRING,
+        method: &windows_core::HSTRING,
+        kind: &windows_core::HSTRING,
+    ) -> windows_core::Result<()>;
+    fn Cancel(&self, requestId: u32) -> windows_core::Result<()>;
+    fn CancelDocument(&self, docId: u32) -> windows_core::Result<()>;
+    fn TryGetCached(
+        &self,
+        url: &windows_core::HSTRING,
+    ) -> windows_core::Result<windows_core::IInspectable>;
 }
 impl INetworkFetcher_Vtbl {
     pub const fn new<Identity: INetworkFetcher_Impl, const OFFSET: isize>() -> Self {
@@ -761,9 +1606,82 @@ impl INetworkFetcher_Vtbl {
                 .into()
             }
         }
+        unsafe extern "system" fn FetchWithKind<
+            Identity: INetworkFetcher_Impl,
+            const OFFSET: isize,
+        >(
+            this: *mut core::ffi::c_void,
+            requestid: u32,
+            docid: u32,
+            url: *mut core::ffi::c_void,
+            method: *mut core::ffi::c_void,
+            kind: *mut core::ffi::c_void,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                INetworkFetcher_Impl::FetchWithKind(
+                    this,
+                    requestid,
+                    docid,
+                    core::mem::transmute(&url),
+                    core::mem::transmute(&method),
+                    core::mem::transmute(&kind),
+                )
+                .into()
+            }
+        }
+        unsafe extern "system" fn Cancel<Identity: INetworkFetcher_Impl, const OFFSET: isize>(
+            this: *mut core::ffi::c_void,
+            requestid: u32,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                INetworkFetcher_Impl::Cancel(this, requestid).into()
+            }
+        }
+        unsafe extern "system" fn CancelDocument<
+            Identity: INetworkFetcher_Impl,
+            const OFFSET: isize,
+        >(
+            this: *mut core::ffi::c_void,
+            docid: u32,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                INetworkFetcher_Impl::CancelDocument(this, docid).into()
+            }
+        }
+        unsafe extern "system" fn TryGetCached<
+            Identity: INetworkFetcher_Impl,
+            const OFFSET: isize,
+        >(
+            this: *mut core::ffi::c_void,
+            url: *mut core::ffi::c_void,
+            result__: *mut *mut core::ffi::c_void,
+        ) -> windows_core::HRESULT {
+            unsafe {
+                let this: &Identity =
+                    &*((this as *const *const ()).offset(OFFSET) as *const Identity);
+                match INetworkFetcher_Impl::TryGetCached(this, core::mem::transmute(&url)) {
+                    Ok(ok__) => {
+                        result__.write(core::mem::transmute_copy(&ok__));
+                        core::mem::forget(ok__);
+                        windows_core::HRESULT(0)
+                    }
+                    Err(err) => err.into(),
+                }
+            }
+        }
         Self {
             base__: windows_core::IInspectable_Vtbl::new::<Identity, INetworkFetcher, OFFSET>(),
             Fetch: Fetch::<Identity, OFFSET>,
+            FetchWithKind: FetchWithKind::<Identity, OFFSET>,
+            Cancel: Cancel::<Identity, OFFSET>,
+            CancelDocument: CancelDocument::<Identity, OFFSET>,
+            TryGetCached: TryGetCached::<Identity, OFFSET>,
         }
     }
     pub fn matches(iid: &windows_core::GUID) -> bool {
@@ -781,6 +1699,22 @@ pub struct INetworkFetcher_Vtbl {
         *mut core::ffi::c_void,
         *mut core::ffi::c_void,
     ) -> windows_core::HRESULT,
+    pub FetchWithKind: unsafe extern "system" fn(
+        *mut core::ffi::c_void,
+        u32,
+        u32,
+        *mut core::ffi::c_void,
+        *mut core::ffi::c_void,
+        *mut core::ffi::c_void,
+    ) -> windows_core::HRESULT,
+    pub Cancel: unsafe extern "system" fn(*mut core::ffi::c_void, u32) -> windows_core::HRESULT,
+    pub CancelDocument:
+        unsafe extern "system" fn(*mut core::ffi::c_void, u32) -> windows_core::HRESULT,
+    pub TryGetCached: unsafe extern "system" fn(
+        *mut core::ffi::c_void,
+        *mut core::ffi::c_void,
+        *mut *mut core::ffi::c_void,
+    ) -> windows_core::HRESULT,
 }
 windows_core::imp::define_interface!(
     ISwapChainAttacher,
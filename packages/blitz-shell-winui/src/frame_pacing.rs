@@ -0,0 +1,59 @@
+//! Frame pacing through the swapchain's frame-latency waitable object.
+//!
+//! Swapchains are created with DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT. The waitable object is a
+//! semaphore DXGI signals each time a queued frame leaves the present queue; waiting on it before input is
+//! sampled and the document resolved means a frame starts only once there is room for it, so frames never stack
+//! up behind vsync and input-to-photon latency stays at `max_frame_latency` frames.
+//!
+//! Each successful wait is a token for exactly one Present. Frames that turn out to need no Present (no damage)
+//! keep their token for the next frame instead of waiting again, otherwise the semaphore drifts and later waits
+//! stall until the timeout.
+
+use std::sync::atomic::{AtomicBool, Ordering};
+
+use windows::Win32::Foundation::{CloseHandle, HANDLE, WAIT_OBJECT_0};
+use windows::Win32::System::Threading::WaitForSingleObjectEx;
+
+use crate::winrt_component::debug_log;
+
+// Upper bound for one wait: a frame that never retires (device lost, occluded panel) must not hang the loop.
+const FRAME_LATENCY_TIMEOUT_MS: u32 = 100;
+
+pub(crate) struct FrameLatencyWaiter {
+    handle: HANDLE,
+    // A wait succeeded and its Present hasn't happened yet
+    ready: AtomicBool,
+}
+
+// SAFETY: the handle is a kernel semaphore, usable from any thread; `ready` is atomic.
+unsafe impl Send for FrameLatencyWaiter {}
+unsafe impl Sync for FrameLatencyWaiter {}
+
+impl FrameLatencyWaiter {
+    /// Takes ownership of the handle returned by IDXGISwapChain2::GetFrameLatencyWaitableObject.
+    pub(crate) fn new(handle: HANDLE) -> Self {
+        Self { handle, ready: AtomicBool::new(false) }
+    }
+
+    /// Block until the swapchain can take another frame (no-op if a previous wait's token is unused).
+    pub(crate) fn wait(&self) {
+        if self.ready.load(Ordering::Acquire) { return; }
+        let res = unsafe { WaitForSingleObjectEx(self.handle, FRAME_LATENCY_TIMEOUT_MS, true) };
+        if res == WAIT_OBJECT_0 {
+            self.ready.store(true, Ordering::Release);
+        } else {
+            debug_log!("frame_pacing: frame latency wait returned {:?}; rendering anyway", res);
+        }
+    }
+
+    /// A frame was presented; the next one must wait again.
+    pub(crate) fn presented(&self) {
+        self.ready.store(false, Ordering::Release);
+    }
+}
+
+impl Drop for FrameLatencyWaiter {
+    fn drop(&mut self) {
+        unsafe { let _ = CloseHandle(self.handle); }
+    }
+}
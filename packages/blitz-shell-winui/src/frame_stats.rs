@@ -0,0 +1,97 @@
+//! Per-frame telemetry (GetFrameStats / FrameCompleted).
+//!
+//! Every presented frame is recorded into a lock-free [`FrameRing`]: the document phases measured on the
+//! rendering thread (blitz_metrics::take_frame_phases), the renderer's playback time and command count, and the
+//! Present call. Readers copy a slot without locking, so the view can poll stats while a frame renders on the
+//! worker. FrameCompleted is raised by whoever rendered, but only after the host lock is released, so handlers are
+//! free to call back into the Host.
+
+use std::sync::Mutex;
+use std::sync::atomic::{AtomicI64, AtomicU64, Ordering};
+
+use blitz_metrics::{FrameRecord, FrameRing};
+use windows::Foundation::EventHandler;
+use windows_core::IInspectable;
+
+use crate::bindings::FrameStats;
+use crate::winrt_component::debug_log;
+
+// SAFETY: WinRT delegates are agile; they marshal themselves and may be invoked from any thread.
+struct Handler(EventHandler<FrameStats>);
+unsafe impl Send for Handler {}
+
+pub(crate) struct FrameStatsHub {
+    ring: FrameRing,
+    handlers: Mutex<Vec<(i64, Handler)>>,
+    next_token: AtomicI64,
+    // Last frame FrameCompleted was raised for
+    raised: AtomicU64,
+}
+
+fn to_stats(r: &FrameRecord) -> FrameStats {
+    let t = &r.timings;
+    FrameStats {
+        FrameIndex: r.frame,
+        ParseMs: t.html_parse_ms,
+        StyleMs: t.style_ms,
+        LayoutMs: t.layout_ms,
+        ShapeMs: t.text_shaping_ms,
+        SceneMs: t.scene_build_ms,
+        PlaybackMs: t.playback_ms,
+        PresentMs: r.present_ms,
+        TotalMs: t.frame_total_ms,
+        CommandCount: r.command_count,
+    }
+}
+
+impl FrameStatsHub {
+    pub(crate) fn new() -> Self {
+        Self {
+            ring: FrameRing::new(),
+            handlers: Mutex::new(Vec::new()),
+            next_token: AtomicI64::new(1),
+            raised: AtomicU64::new(0),
+        }
+    }
+
+    /// Record a presented frame (called with the host lock held; handlers are not run here).
+    pub(crate) fn push(&self, record: &FrameRecord) {
+        self.ring.push(record);
+    }
+
+    /// The frame `frames_ago` frames before the latest; FrameIndex 0 if it isn't (or is no longer) recorded.
+    pub(crate) fn stats(&self, frames_ago: u32) -> FrameStats {
+        self.ring.recent(frames_ago as u64).map(|r| to_stats(&r)).unwrap_or_default()
+    }
+
+    pub(crate) fn add_handler(&self, handler: EventHandler<FrameStats>) -> i64 {
+        let token = self.next_token.fetch_add(1, Ordering::Relaxed);
+        self.handlers.lock().unwrap().push((token, Handler(handler)));
+        token
+    }
+
+    pub(crate) fn remove_handler(&self, token: i64) {
+        self.handlers.lock().unwrap().retain(|(t, _)| *t != token);
+    }
+
+    /// Raise FrameCompleted for every frame recorded since the last call. Must not be called with the host lock held.
+    pub(crate) fn raise_completed(&self) {
+        let latest = self.ring.latest_frame();
+        let prev = self.raised.swap(latest, Ordering::AcqRel);
+        if prev >= latest { return; }
+        // Clone the delegates out so a handler can add or remove handlers
+        let handlers: Vec<EventHandler<FrameStats>> =
+            self.handlers.lock().unwrap().iter().map(|(_, h)| h.0.clone()).collect();
+        if handlers.is_empty() { return; }
+        let first = (prev + 1).max(latest.saturating_sub(FrameRing::CAPACITY as u64 - 1));
+        for frame in first..=latest {
+            let Some(record) = self.ring.get(frame) else { continue };
+            let stats = to_stats(&record);
+            for h in &handlers {
+                if let Err(e) = h.Invoke(None::<&IInspectable>, &stats) {
+                    debug_log!("frame_stats: FrameCompleted handler failed: {:?}", e);
+                }
+            }
+        }
+    }
+}
@@ -1,6 +1,9 @@
-use std::sync::OnceLock;
+use std::sync::Mutex;
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use windows::core::Interface;
+use windows::Win32::Foundation::BOOL;
 use windows::Win32::Graphics::Direct3D11::{
-    D3D11CreateDevice, ID3D11Device, ID3D11DeviceContext, D3D11_CREATE_DEVICE_BGRA_SUPPORT,
+    D3D11CreateDevice, ID3D11Device, ID3D11DeviceContext, ID3D11Multithread, D3D11_CREATE_DEVICE_BGRA_SUPPORT,
     D3D11_CREATE_DEVICE_DEBUG, D3D11_SDK_VERSION,
 };
 use windows::Win32::Graphics::Direct3D::{
@@ -8,25 +11,49 @@ use windows::Win32::Graphics::Direct3D::{
 };
 use crate::winrt_component::debug_log;
 
+// Thread affinity: the device is created on whichever thread constructs the first Host (the XAML UI thread in
+// practice, or the prewarm thread after Host.Prewarm, which never touches it again) and shared by every Host in the
+// process. ID3D11Device is free-threaded, but the immediate context is not; as long as all Hosts render on the same
+// thread nothing else is needed. Once a render worker thread
+// starts using the device we switch on ID3D11Multithread protection so D2D/DXGI calls from different Hosts on
+// different threads are serialized by the runtime (each renderer owns its own D2D factory, so D2D's factory lock
+// alone does not cover the shared context).
+//
+// Device loss (driver update, TDR, adapter change): the Host that first sees DXGI_ERROR_DEVICE_REMOVED reports it
+// with report_device_lost; the device is dropped, the generation bumped and every registered Host is told, and
+// each Host then recreates its swapchain, which creates (or shares) the replacement device here.
+// SAFETY: COM pointers here are only used under the rules above; the static Mutex requires Send.
 struct GlobalDevice {
     device: ID3D11Device,
     context: ID3D11DeviceContext,
     feature_level: D3D_FEATURE_LEVEL,
-    _thread_id: std::thread::ThreadId,
+    creator_thread: std::thread::ThreadId,
+    generation: u64,
 }
+unsafe impl Send for GlobalDevice {}
 
-static GLOBAL_DEVICE: OnceLock<GlobalDevice> = OnceLock::new();
+static GLOBAL_DEVICE: Mutex<Option<GlobalDevice>> = Mutex::new(None);
+// Bumped whenever the shared device is replaced; Hosts compare it against the device their swapchain uses
+static DEVICE_GENERATION: AtomicU64 = AtomicU64::new(0);
+// Requested once any render worker exists; applied to every device created afterwards too
+static MULTITHREAD_PROTECTED: AtomicBool = AtomicBool::new(false);
+
+type DeviceLostListener = Box<dyn Fn() + Send + Sync>;
+static DEVICE_LOST_LISTENERS: Mutex<Vec<(u64, DeviceLostListener)>> = Mutex::new(Vec::new());
+static NEXT_LISTENER_ID: AtomicU64 = AtomicU64::new(1);
 
 pub(crate) struct DeviceAcquireResult {
     pub device: ID3D11Device,
     pub context: ID3D11DeviceContext,
     pub feature_level: D3D_FEATURE_LEVEL,
     pub created: bool,
+    pub generation: u64,
 }
 
 pub(crate) fn get_or_create_d3d_device() -> Option<DeviceAcquireResult> {
-    if let Some(glob) = GLOBAL_DEVICE.get() {
-        return Some(DeviceAcquireResult { device: glob.device.clone(), context: glob.context.clone(), feature_level: glob.feature_level, created: false });
+    let mut global = GLOBAL_DEVICE.lock().unwrap();
+    if let Some(glob) = global.as_ref() {
+        return Some(DeviceAcquireResult { device: glob.device.clone(), context: glob.context.clone(), feature_level: glob.feature_level, created: false, generation: glob.generation });
     }
     let start = std::time::Instant::now();
     unsafe {
@@ -55,7 +82,7 @@ pub(crate) fn get_or_create_d3d_device() -> Option<DeviceAcquireResult> {
             #[cfg(debug_assertions)]
             {
                 if (flags & D3D11_CREATE_DEVICE_DEBUG) == D3D11_CREATE_DEVICE_DEBUG {
-                    debug_log("global_gfx: retry without DEBUG layer");
+                    debug_log!("global_gfx: retry without DEBUG layer");
                     let fallback = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
                     if try_create(fallback).is_err() { return None; }
                 } else { return None; }
@@ -66,9 +93,73 @@ pub(crate) fn get_or_create_d3d_device() -> Option<DeviceAcquireResult> {
         let device = device.unwrap();
         let context = context.unwrap();
         let create_ms = start.elapsed().as_secs_f32()*1000.0;
-        let _thread_id = std::thread::current().id();
-        let _ = GLOBAL_DEVICE.set(GlobalDevice { device: device.clone(), context: context.clone(), feature_level: chosen, _thread_id });
-        debug_log(&format!("global_gfx: created shared D3D device (feature {:?}) in {:.2} ms", chosen, create_ms));
-    Some(DeviceAcquireResult { device, context, feature_level: chosen, created: true })
+        let creator_thread = std::thread::current().id();
+        let generation = DEVICE_GENERATION.load(Ordering::Acquire);
+        if MULTITHREAD_PROTECTED.load(Ordering::Acquire) { protect(&context); }
+        *global = Some(GlobalDevice { device: device.clone(), context: context.clone(), feature_level: chosen, creator_thread, generation });
+        debug_log!("global_gfx: created shared D3D device (feature {:?}, generation {}) in {:.2} ms", chosen, generation, create_ms);
+    Some(DeviceAcquireResult { device, context, feature_level: chosen, created: true, generation })
+    }
+}
+
+/// True when called on the thread that created the shared device (or if no device exists yet).
+pub(crate) fn is_creator_thread() -> bool {
+    GLOBAL_DEVICE.lock().unwrap().as_ref().map(|g| g.creator_thread == std::thread::current().id()).unwrap_or(true)
+}
+
+/// Must be called before the shared device is used from any thread other than its creator (render workers).
+/// Idempotent (and sticky: replacement devices are protected too); returns false if the runtime refused.
+pub(crate) fn enable_multithread_protection() -> bool {
+    let already = MULTITHREAD_PROTECTED.swap(true, Ordering::AcqRel);
+    let global = GLOBAL_DEVICE.lock().unwrap();
+    let Some(glob) = global.as_ref() else { return true; };
+    if already { return true; }
+    protect(&glob.context)
+}
+
+fn protect(context: &ID3D11DeviceContext) -> bool {
+    match context.cast::<ID3D11Multithread>() {
+        Ok(mt) => {
+            unsafe { let _ = mt.SetMultithreadProtected(BOOL::from(true)); }
+            debug_log!("global_gfx: enabled ID3D11Multithread protection (render worker in use)");
+            true
+        }
+        Err(e) => { debug_log!("global_gfx: ID3D11Multithread unavailable: {:?}", e); false }
+    }
+}
+
+/// Generation of the current shared device (see DeviceAcquireResult::generation).
+pub(crate) fn device_generation() -> u64 {
+    DEVICE_GENERATION.load(Ordering::Acquire)
+}
+
+/// Report that the device of `generation` failed with DEVICE_REMOVED / RESET. The first report drops the shared
+/// device and notifies every listener; later reports for the same generation are no-ops. Returns whether this
+/// call replaced the device.
+pub(crate) fn report_device_lost(generation: u64) -> bool {
+    {
+        let mut global = GLOBAL_DEVICE.lock().unwrap();
+        if DEVICE_GENERATION.load(Ordering::Acquire) != generation { return false; }
+        if let Some(glob) = global.take() {
+            let reason = unsafe { glob.device.GetDeviceRemovedReason() };
+            debug_log!("global_gfx: device generation {} lost (reason {:?}); dropping shared device", generation, reason);
+        }
+        DEVICE_GENERATION.store(generation + 1, Ordering::Release);
     }
+    for (_, listener) in DEVICE_LOST_LISTENERS.lock().unwrap().iter() {
+        listener();
+    }
+    true
+}
+
+/// Register a callback run (on the reporting thread) when the shared device is lost. Listeners must not block
+/// on a Host lock: the reporter holds its own. Returns an id for remove_device_lost_listener.
+pub(crate) fn add_device_lost_listener(listener: DeviceLostListener) -> u64 {
+    let id = NEXT_LISTENER_ID.fetch_add(1, Ordering::Relaxed);
+    DEVICE_LOST_LISTENERS.lock().unwrap().push((id, listener));
+    id
+}
+
+pub(crate) fn remove_device_lost_listener(id: u64) {
+    DEVICE_LOST_LISTENERS.lock().unwrap().retain(|(i, _)| *i != id);
 }
@@ -0,0 +1,91 @@
+//! Background image decoding.
+//!
+//! Image bodies used to be decoded inside `CompleteFetch`, i.e. on whichever thread the host delivered them
+//! (usually the UI thread), stalling input and vsync for large images. Completed image fetches are now handed to
+//! a small dedicated thread pool instead (not rayon's global pool, which paint uses for parallel recording and
+//! must not queue behind a long decode): the document's image handler decodes there and its result is queued
+//! until the host next renders, where it is loaded into the document like any other resource. The host installs
+//! a waker so a finished decode schedules that frame.
+
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex, OnceLock};
+
+use blitz_dom::net::Resource;
+use blitz_traits::net::{BoxedHandler, Bytes, NetCallback, SharedCallback};
+
+use crate::winrt_component::debug_log;
+
+pub(crate) type Waker = Arc<dyn Fn() + Send + Sync>;
+
+// Decoding is memory-bandwidth bound; a few threads keep up with any network
+const MAX_DECODE_THREADS: usize = 4;
+
+fn decode_pool() -> &'static rayon::ThreadPool {
+    static POOL: OnceLock<rayon::ThreadPool> = OnceLock::new();
+    POOL.get_or_init(|| {
+        let cores = std::thread::available_parallelism().map_or(2, |n| n.get());
+        rayon::ThreadPoolBuilder::new()
+            .num_threads((cores / 2).clamp(1, MAX_DECODE_THREADS))
+            .thread_name(|i| format!("blitz-decode-{}", i))
+            .build()
+            .expect("image decode thread pool")
+    })
+}
+
+#[derive(Default)]
+pub(crate) struct ImageDecoder {
+    // (doc_id, decoded image) waiting for the host thread
+    decoded: Mutex<Vec<(usize, Resource)>>,
+    in_flight: AtomicUsize,
+    waker: Mutex<Option<Waker>>,
+}
+
+// Collects the handler's result on the decoding thread
+struct DecodedSink(Arc<ImageDecoder>);
+
+impl NetCallback<Resource> for DecodedSink {
+    fn call(&self, doc_id: usize, result: Result<Resource, Option<String>>) {
+        match result {
+            Ok(res) => self.0.decoded.lock().unwrap().push((doc_id, res)),
+            Err(err) => debug_log!("image_decode: doc_id={} decode failed: {:?}", doc_id, err),
+        }
+    }
+}
+
+impl ImageDecoder {
+    pub(crate) fn new() -> Arc<Self> {
+        Arc::new(Self::default())
+    }
+
+    /// Called (from a rayon thread) after each decode; `None` leaves results queued until the next frame.
+    pub(crate) fn set_waker(&self, waker: Option<Waker>) {
+        *self.waker.lock().unwrap() = waker;
+    }
+
+    /// Run `handler` on `bytes` off the calling thread.
+    pub(crate) fn decode(self: &Arc<Self>, doc_id: usize, handler: BoxedHandler<Resource>, bytes: Bytes) {
+        self.in_flight.fetch_add(1, Ordering::AcqRel);
+        let this = self.clone();
+        decode_pool().spawn(move || {
+            let sink: SharedCallback<Resource> = Arc::new(DecodedSink(this.clone()));
+            handler.bytes(doc_id, bytes, sink);
+            this.in_flight.fetch_sub(1, Ordering::AcqRel);
+            let waker = this.waker.lock().unwrap().clone();
+            if let Some(waker) = waker { waker(); }
+        });
+    }
+
+    /// Decoded images since the last call, in completion order.
+    pub(crate) fn take_decoded(&self) -> Vec<(usize, Resource)> {
+        std::mem::take(&mut *self.decoded.lock().unwrap())
+    }
+
+    pub(crate) fn has_decoded(&self) -> bool {
+        !self.decoded.lock().unwrap().is_empty()
+    }
+
+    /// Decodes still running (for diagnostics).
+    pub(crate) fn in_flight(&self) -> usize {
+        self.in_flight.load(Ordering::Acquire)
+    }
+}
@@ -12,6 +12,12 @@ mod winrt_component;
 mod global_gfx;
 mod bindings;
 mod net_bridge;
+mod render_worker;
+mod frame_pacing;
+mod image_decode;
+mod frame_stats;
+mod trace;
+mod prewarm;
 
 #[derive(Clone, Copy)]
 pub struct SwapChainPanelHandle {
@@ -122,19 +128,138 @@ use core::ffi::c_void;
 use windows::core::implement;
 use windows_core::{IInspectable, HSTRING, Interface};
 use windows_core::IUnknownImpl;
-use crate::bindings::{IHost, IHostFactory, IHost_Impl, IHostFactory_Impl};
+use crate::bindings::{IHost, IHostFactory, IHostStatics, IHost_Impl, IHostFactory_Impl, IHostStatics_Impl};
 // Note: We expose a custom factory (IHostFactory) via DllGetActivationFactory.
 
+use crate::render_worker::{HostMsg, RenderWorker, SharedHost};
+
 // HostRuntime implements only IHost; factory provided separately via HostActivationFactory
 #[implement(IHost)]
 pub struct HostRuntime {
-    inner: std::sync::Mutex<Option<Box<winrt_component::BlitzHost>>>,
+    inner: SharedHost,
+    // Present when the Host renders on its own thread (SetRenderWorkerEnabled); messages are posted instead of
+    // being applied inline on the caller (UI) thread.
+    worker: std::sync::Arc<std::sync::Mutex<Option<RenderWorker>>>,
+    // Registration with global_gfx so this Host is woken to rebuild when another Host sees the device removed
+    device_listener: u64,
+    // Compositor-scroll translation published by the host, cached on first read so the view can poll it every vsync
+    // without waiting on a frame that holds the host lock.
+    scroll_translation: std::sync::OnceLock<std::sync::Arc<std::sync::atomic::AtomicU64>>,
+    // Frame telemetry published by the host, cached the same way; FrameCompleted is raised from here once the host
+    // lock is released.
+    frame_stats: std::sync::OnceLock<std::sync::Arc<frame_stats::FrameStatsHub>>,
+    // How long CreateInstance took to build the host, reported by GetHostStats
+    create_ms: f32,
 }
 
 #[allow(non_snake_case)]
 impl HostRuntime {
     fn new() -> HostRuntime {
-        HostRuntime { inner: std::sync::Mutex::new(None) }
+        crate::trace::register();
+        let inner: SharedHost = std::sync::Arc::new(std::sync::Mutex::new(None));
+        let worker = std::sync::Arc::new(std::sync::Mutex::new(None));
+        let device_listener = crate::global_gfx::add_device_lost_listener(Box::new(DeviceLostWaker {
+            inner: std::sync::Arc::downgrade(&inner),
+            worker: std::sync::Arc::downgrade(&worker),
+        }.into_fn()));
+        HostRuntime {
+            inner,
+            worker,
+            device_listener,
+            scroll_translation: std::sync::OnceLock::new(),
+            frame_stats: std::sync::OnceLock::new(),
+            create_ms: 0.0,
+        }
+    }
+
+    fn has_worker(&self) -> bool {
+        self.worker.lock().unwrap().is_some()
+    }
+
+    // Route a host operation to the render worker when one is running, otherwise apply it inline.
+    fn dispatch(&self, msg: HostMsg) {
+        let msg = match self.worker.lock().unwrap().as_ref() {
+            Some(w) => match w.post(msg) { Ok(()) => return, Err(m) => m },
+            None => msg,
+        };
+        if let Some(inner) = self.inner.lock().unwrap().as_mut() {
+            msg.apply(inner);
+        }
+        self.raise_frame_completed();
+    }
+
+    fn frame_stats(&self) -> Option<&frame_stats::FrameStatsHub> {
+        if let Some(hub) = self.frame_stats.get() { return Some(hub); }
+        let hub = self.inner.lock().unwrap().as_ref().map(|h| h.frame_stats_handle())?;
+        Some(self.frame_stats.get_or_init(|| hub))
+    }
+
+    // Call without the host lock: handlers may call back into the Host
+    fn raise_frame_completed(&self) {
+        if let Some(hub) = self.frame_stats() { hub.raise_completed(); }
+    }
+
+    fn set_render_worker_enabled(&self, enabled: bool) {
+        let mut worker = self.worker.lock().unwrap();
+        if enabled == worker.is_some() { return; }
+        if enabled {
+            if let Some(inner) = self.inner.lock().unwrap().as_mut() { inner.set_render_worker_active(true); }
+            match RenderWorker::spawn(self.inner.clone()) {
+                Ok(w) => {
+                    if let Some(inner) = self.inner.lock().unwrap().as_mut() { inner.set_render_worker_waker(Some(w.waker())); }
+                    *worker = Some(w);
+                    crate::winrt_component::debug_log!("HostRuntime: render worker enabled");
+                }
+                Err(e) => {
+                    crate::winrt_component::debug_log!("HostRuntime: render worker spawn failed: {:?}", e);
+                    if let Some(inner) = self.inner.lock().unwrap().as_mut() { inner.set_render_worker_active(false); }
+                }
+            }
+        } else {
+            // Dropping only asks the worker to stop; it applies what was queued before that under the host lock
+            // and exits on its own, so the UI thread never waits for its frame.
+            *worker = None;
+            if let Some(inner) = self.inner.lock().unwrap().as_mut() {
+                inner.set_render_worker_waker(None);
+                inner.set_render_worker_active(false);
+            }
+            crate::winrt_component::debug_log!("HostRuntime: render worker disabled");
+        }
+    }
+}
+
+impl Drop for HostRuntime {
+    fn drop(&mut self) {
+        crate::global_gfx::remove_device_lost_listener(self.device_listener);
+    }
+}
+
+// Wakes a Host after the shared device was lost so it rebuilds even if nothing else is pending. Runs on the
+// thread that saw the loss, which may hold another Host's lock, so nothing here blocks: a worker is sent a frame,
+// an inline Host asks its frame scheduler for one, and a Host whose lock is taken is mid-frame and will find the
+// new device generation itself.
+struct DeviceLostWaker {
+    inner: std::sync::Weak<std::sync::Mutex<Option<Box<winrt_component::BlitzHost>>>>,
+    worker: std::sync::Weak<std::sync::Mutex<Option<RenderWorker>>>,
+}
+// SAFETY: same rules as the render worker's SendHost; the host is only touched under its lock.
+unsafe impl Send for DeviceLostWaker {}
+unsafe impl Sync for DeviceLostWaker {}
+
+impl DeviceLostWaker {
+    fn into_fn(self) -> impl Fn() + Send + Sync {
+        move || {
+            if let Some(worker) = self.worker.upgrade() {
+                if let Ok(worker) = worker.try_lock() {
+                    if let Some(w) = worker.as_ref() { let _ = w.post(HostMsg::RenderOnce); return; }
+                }
+            }
+            if let Some(inner) = self.inner.upgrade() {
+                if let Ok(mut inner) = inner.try_lock() {
+                    if let Some(host) = inner.as_mut() { host.wake_for_device_lost(); }
+                }
+            }
+        }
     }
 }
 
@@ -150,42 +275,36 @@ impl IHost_Impl for HostRuntime_Impl {
     }
 
     fn Resize(&self, width: u32, height: u32, scale: f32) -> windows_core::Result<()> {
-        let imp = self.get_impl();
-        if let Some(inner) = imp.inner.lock().unwrap().as_mut() {
-            inner.resize(width, height, scale);
-        }
+        self.get_impl().dispatch(HostMsg::Resize(width, height, scale));
         Ok(())
     }
 
     fn RenderOnce(&self) -> windows_core::Result<()> {
-        let imp = self.get_impl();
-        if let Some(inner) = imp.inner.lock().unwrap().as_mut() {
-            inner.render_once();
-        }
+        self.get_impl().dispatch(HostMsg::RenderOnce);
         Ok(())
     }
 
     fn LoadHtml(&self, html: &HSTRING) -> windows_core::Result<()> {
-        let imp = self.get_impl();
-        if let Some(inner) = imp.inner.lock().unwrap().as_mut() {
-            let s: String = html.to_string();
-            inner.load_html(&s); // load_html now triggers render_once itself
-        }
+        // load_html triggers render_once itself
+        self.get_impl().dispatch(HostMsg::LoadHtml(html.to_string()));
+        Ok(())
+    }
+
+    fn UpdateHtml(&self, html: &HSTRING) -> windows_core::Result<()> {
+        self.get_impl().dispatch(HostMsg::UpdateHtml(html.to_string()));
         Ok(())
     }
 
     fn SetVerboseLogging(&self, enabled: bool) -> windows_core::Result<()> {
-        // Toggle global verbose logging in the D2D backend.
+        // Toggle global verbose logging in the D2D backend and for debug_log! messages.
         anyrender_d2d::set_verbose_logging(enabled);
-        crate::winrt_component::debug_log(&format!("HostRuntime::SetVerboseLogging: enabled={}", enabled));
+        crate::trace::set_verbose(enabled);
+        crate::winrt_component::debug_log!("HostRuntime::SetVerboseLogging: enabled={}", enabled);
         Ok(())
     }
 
     fn SetDebugOverlay(&self, enabled: bool) -> windows_core::Result<()> {
-        let imp = self.get_impl();
-        if let Some(inner) = imp.inner.lock().unwrap().as_mut() {
-            inner.set_debug_overlay(enabled);
-        }
+        self.get_impl().dispatch(HostMsg::SetDebugOverlay(enabled));
         Ok(())
     }
 
@@ -199,6 +318,12 @@ impl IHost_Impl for HostRuntime_Impl {
 
     fn CompleteFetch(&self, request_id: u32, doc_id: u32, success: bool, data: &[u8], error_message: &HSTRING) -> windows_core::Result<()> {
         let imp = self.get_impl();
+        if imp.has_worker() {
+            // Completions can arrive on thread-pool threads; the worker owns the document.
+            let data = blitz_traits::net::Bytes::copy_from_slice(data);
+            imp.dispatch(HostMsg::CompleteFetch { request_id, doc_id, success, data, error: error_message.to_string() });
+            return Ok(());
+        }
         if let Some(inner) = imp.inner.lock().unwrap().as_mut() {
             let err = error_message.to_string();
             inner.complete_fetch(request_id, doc_id, success, data, &err);
@@ -206,6 +331,18 @@ impl IHost_Impl for HostRuntime_Impl {
         Ok(())
     }
 
+    fn CompleteFetchBuffer(&self, request_id: u32, doc_id: u32, buffer: windows_core::Ref<'_, IInspectable>) -> windows_core::Result<()> {
+        // The Bytes handed to the decoder borrow the IBuffer's memory, so this path is copy-free on the
+        // inline and worker paths alike.
+        let (success, data, err) = match buffer.as_ref().map(net_bridge::bytes_from_ibuffer) {
+            Some(Ok(bytes)) => (true, bytes, String::new()),
+            Some(Err(e)) => (false, blitz_traits::net::Bytes::new(), format!("CompleteFetchBuffer: not an IBuffer ({:?})", e.code())),
+            None => (false, blitz_traits::net::Bytes::new(), "CompleteFetchBuffer: null buffer".to_string()),
+        };
+        self.get_impl().dispatch(HostMsg::CompleteFetch { request_id, doc_id, success, data, error: err });
+        Ok(())
+    }
+
     fn RequestUrl(&self, doc_id: u32, url: &::windows::core::HSTRING, _request_id: u32) -> ::windows::core::Result<()> {
         use blitz_dom::net::Resource;
         let imp = self.get_impl();
@@ -232,41 +369,140 @@ impl IHost_Impl for HostRuntime_Impl {
     }
 
     fn WheelScroll(&self, dx: f64, dy: f64) -> windows_core::Result<()> {
-        let imp = self.get_impl();
-        if let Some(inner) = imp.inner.lock().unwrap().as_mut() {
-            inner.wheel_scroll(dx, dy);
-        }
+        self.get_impl().dispatch(HostMsg::WheelScroll(dx, dy));
         Ok(())
     }
 
     fn PointerMove(&self, x: f32, y: f32, buttons: u32, modifiers: u32) -> windows_core::Result<()> {
-        let imp = self.get_impl();
-        if let Some(inner) = imp.inner.lock().unwrap().as_mut() {
-            inner.pointer_move(x, y, buttons, modifiers);
-        }
+        self.get_impl().dispatch(HostMsg::PointerMove(x, y, buttons, modifiers));
         Ok(())
     }
 
     fn PointerDown(&self, x: f32, y: f32, button: u8, buttons: u32, modifiers: u32) -> windows_core::Result<()> {
+        self.get_impl().dispatch(HostMsg::PointerDown(x, y, button, buttons, modifiers));
+        Ok(())
+    }
+
+    fn PointerUp(&self, x: f32, y: f32, button: u8, buttons: u32, modifiers: u32) -> windows_core::Result<()> {
+        self.get_impl().dispatch(HostMsg::PointerUp(x, y, button, buttons, modifiers));
+        Ok(())
+    }
+
+    fn ReportAttachSubPhase(&self, kind: u8, ms: f32) -> windows_core::Result<()> {
+        self.get_impl().dispatch(HostMsg::ReportAttachSubPhase(kind, ms));
+        Ok(())
+    }
+
+    fn SetFrameScheduler(&self, scheduler: windows_core::Ref<'_, IInspectable>) -> windows_core::Result<()> {
         let imp = self.get_impl();
         if let Some(inner) = imp.inner.lock().unwrap().as_mut() {
-            inner.pointer_down(x, y, button, buttons, modifiers);
+            inner.set_frame_scheduler(scheduler.as_ref().cloned());
         }
         Ok(())
     }
 
-    fn PointerUp(&self, x: f32, y: f32, button: u8, buttons: u32, modifiers: u32) -> windows_core::Result<()> {
+    fn RenderPendingFrame(&self) -> windows_core::Result<bool> {
         let imp = self.get_impl();
-        if let Some(inner) = imp.inner.lock().unwrap().as_mut() {
-            inner.pointer_up(x, y, button, buttons, modifiers);
+        // The worker paces itself; tell a vsync-driven caller to detach.
+        if imp.has_worker() { return Ok(false); }
+        let more = imp.inner.lock().unwrap().as_mut().is_some_and(|inner| inner.render_pending_frame());
+        imp.raise_frame_completed();
+        Ok(more)
+    }
+
+    fn SkippedFrameCount(&self) -> windows_core::Result<u64> {
+        let imp = self.get_impl();
+        if let Some(inner) = imp.inner.lock().unwrap().as_ref() {
+            return Ok(inner.skipped_frame_count());
         }
+        Ok(0)
+    }
+
+    fn SetRenderWorkerEnabled(&self, enabled: bool) -> windows_core::Result<()> {
+        self.get_impl().set_render_worker_enabled(enabled);
         Ok(())
     }
 
-    fn ReportAttachSubPhase(&self, kind: u8, ms: f32) -> windows_core::Result<()> {
+    fn SetCompositorScrolling(&self, overscan: u32) -> windows_core::Result<()> {
+        self.get_impl().dispatch(HostMsg::SetCompositorScrolling(overscan));
+        Ok(())
+    }
+
+    fn CompositorScrollOffset(&self) -> windows_core::Result<f64> {
+        let imp = self.get_impl();
+        let translation = imp.scroll_translation.get_or_init(|| {
+            imp.inner.lock().unwrap().as_ref().map(|h| h.scroll_translation_handle()).unwrap_or_default()
+        });
+        Ok(f64::from_bits(translation.load(std::sync::atomic::Ordering::Acquire)))
+    }
+
+    fn SetTiledRendering(&self, enabled: bool) -> windows_core::Result<()> {
+        self.get_impl().dispatch(HostMsg::SetTiledRendering(enabled));
+        Ok(())
+    }
+
+    fn SetMemoryBudget(&self, bytes: u64) -> windows_core::Result<()> {
+        self.get_impl().dispatch(HostMsg::SetMemoryBudget(bytes));
+        Ok(())
+    }
+
+    fn Trim(&self) -> windows_core::Result<()> {
+        self.get_impl().dispatch(HostMsg::Trim);
+        Ok(())
+    }
+
+    fn SetMaximumFrameLatency(&self, frames: u32) -> windows_core::Result<()> {
+        self.get_impl().dispatch(HostMsg::SetMaximumFrameLatency(frames));
+        Ok(())
+    }
+
+    fn SetTransparent(&self, enabled: bool) -> windows_core::Result<()> {
+        self.get_impl().dispatch(HostMsg::SetTransparent(enabled));
+        Ok(())
+    }
+
+    fn GetFrameStats(&self) -> windows_core::Result<bindings::FrameStats> {
+        self.GetFrameStatsAt(0)
+    }
+
+    fn GetFrameStatsAt(&self, frames_ago: u32) -> windows_core::Result<bindings::FrameStats> {
+        Ok(self.get_impl().frame_stats().map(|hub| hub.stats(frames_ago)).unwrap_or_default())
+    }
+
+    fn FrameCompleted(&self, handler: windows_core::Ref<'_, windows::Foundation::EventHandler<bindings::FrameStats>>) -> windows_core::Result<i64> {
+        let handler = handler.ok()?.clone();
+        let hub = self.get_impl().frame_stats()
+            .ok_or_else(|| windows_core::Error::new(windows_core::HRESULT(0x8000000Eu32 as i32), "Host not initialized"))?;
+        Ok(hub.add_handler(handler))
+    }
+
+    fn RemoveFrameCompleted(&self, token: i64) -> windows_core::Result<()> {
+        if let Some(hub) = self.get_impl().frame_stats() { hub.remove_handler(token); }
+        Ok(())
+    }
+
+    fn GetHostStats(&self) -> windows_core::Result<bindings::HostStats> {
         let imp = self.get_impl();
+        let mut stats = bindings::HostStats {
+            CreateMs: imp.create_ms,
+            SharedUaStylesheets: blitz_dom::shared_user_agent_stylesheet_count() as u32,
+            SharedFontFaces: anyrender_d2d::shared_font_face_count() as u32,
+            ..Default::default()
+        };
+        if let Some(inner) = imp.inner.lock().unwrap().as_ref() {
+            (stats.RendererCacheBytes, stats.NodeCount) = inner.resource_stats();
+        }
+        Ok(stats)
+    }
+
+    fn SubmitInputBatch(&self, points: &[f32], buttons: u32, modifiers: u32) -> windows_core::Result<()> {
+        let imp = self.get_impl();
+        if imp.has_worker() {
+            imp.dispatch(HostMsg::InputBatch(points.to_vec(), buttons, modifiers));
+            return Ok(());
+        }
         if let Some(inner) = imp.inner.lock().unwrap().as_mut() {
-            inner.report_attach_subphase(kind, ms);
+            inner.submit_input_batch(points, buttons, modifiers);
         }
         Ok(())
     }
@@ -274,10 +510,26 @@ impl IHost_Impl for HostRuntime_Impl {
 
 
 // --- WinRT Activation Factory ---
-// Provide a factory object that implements IHostFactory; the runtime will QI for this interface.
-#[implement(IHostFactory)]
+// Provide a factory object that implements IHostFactory (constructor) and IHostStatics (static methods); the runtime
+// will QI for these interfaces.
+#[implement(IHostFactory, IHostStatics)]
 pub struct HostActivationFactory;
 
+#[allow(non_snake_case)]
+impl IHostStatics_Impl for HostActivationFactory_Impl {
+    fn Prewarm(&self) -> windows_core::Result<()> {
+        crate::trace::register();
+        prewarm::prewarm();
+        Ok(())
+    }
+
+    fn SetWorkerThreads(&self, count: u32) -> windows_core::Result<()> {
+        blitz_dom::set_layout_threads(count as usize);
+        crate::winrt_component::debug_log!("SetWorkerThreads({}): {} layout threads", count, blitz_dom::layout_threads());
+        Ok(())
+    }
+}
+
 #[allow(non_snake_case)]
 impl IHostFactory_Impl for HostActivationFactory_Impl {
 
@@ -289,34 +541,46 @@ impl IHostFactory_Impl for HostActivationFactory_Impl {
         scale: f32,
         initial_html: &windows_core::HSTRING,
     ) -> windows_core::Result<bindings::Host> {
-        let runtime = HostRuntime::new();
-    crate::winrt_component::debug_log(&format!("HostActivationFactory::CreateInstance: entered ({}x{}, scale {})", width, height, scale));
+        let t0 = std::time::Instant::now();
+        let mut runtime = HostRuntime::new();
+    crate::winrt_component::debug_log!("HostActivationFactory::CreateInstance: entered ({}x{}, scale {})", width, height, scale);
     // (Module path logging removed; required Win32 feature gates are not enabled for this crate.)
         let html_str = initial_html.to_string();
+        if attacher.as_ref().is_none() {
+            // Panel-less construction: parse/resolve now, off this thread; SetPanel attaches later
+            let shell = winrt_component::BlitzHost::new_for_swapchain(SwapChainPanelHandle { swapchain: 0 }, width, height, scale)
+                .map_err(|_| windows_core::Error::new(windows_core::HRESULT(0x80004005u32 as i32), "Host creation failed"))?;
+            *runtime.inner.lock().unwrap() = Some(Box::new(shell));
+            if !html_str.is_empty() { prewarm::preload(runtime.inner.clone(), html_str); }
+            runtime.create_ms = t0.elapsed().as_secs_f32() * 1000.0;
+            let insp: IInspectable = runtime.into();
+            return Interface::cast(&insp);
+        }
         if let Some(insp) = attacher.as_ref() {
-            crate::winrt_component::debug_log(&format!("HostActivationFactory::CreateInstance: inspecting attacher object {:?}", insp));
+            crate::winrt_component::debug_log!("HostActivationFactory::CreateInstance: inspecting attacher object {:?}", insp);
             match insp.cast::<ISwapChainAttacher>() {
                 Ok(att) => {
-                    crate::winrt_component::debug_log("HostActivationFactory::CreateInstance: cast to ISwapChainAttacher succeeded");
+                    crate::winrt_component::debug_log!("HostActivationFactory::CreateInstance: cast to ISwapChainAttacher succeeded");
                     if let Ok(mut shell) = winrt_component::BlitzHost::new_with_attacher(att, width, height, scale) {
                         if !html_str.is_empty() { shell.load_html(&html_str); }
                         *runtime.inner.lock().unwrap() = Some(Box::new(shell));
+                        runtime.create_ms = t0.elapsed().as_secs_f32() * 1000.0;
                         let insp: IInspectable = runtime.into();
                         let host: bindings::Host = Interface::cast(&insp)?;
                         return Ok(host);
                     }
                 }
                 Err(err) => {
-                    crate::winrt_component::debug_log(&format!("HostActivationFactory::CreateInstance: cast to ISwapChainAttacher FAILED hr={:?}", err.code()));
+                    crate::winrt_component::debug_log!("HostActivationFactory::CreateInstance: cast to ISwapChainAttacher FAILED hr={:?}", err.code());
                     if let Ok(name) = insp.GetRuntimeClassName() {
-                        crate::winrt_component::debug_log(&format!("  RuntimeClassName='{}'", name.to_string()));
+                        crate::winrt_component::debug_log!("  RuntimeClassName='{}'", name.to_string());
                     }
-                    crate::winrt_component::debug_log(&format!("  Expected ISwapChainAttacher IID={:?}", <ISwapChainAttacher as Interface>::IID));
-                    crate::winrt_component::debug_log("  Likely cause: object is a plain C# class not emitted as a WinRT runtime class implementing the interface.");
+                    crate::winrt_component::debug_log!("  Expected ISwapChainAttacher IID={:?}", <ISwapChainAttacher as Interface>::IID);
+                    crate::winrt_component::debug_log!("  Likely cause: object is a plain C# class not emitted as a WinRT runtime class implementing the interface.");
                 }
             }
         }
-        crate::winrt_component::debug_log("HostActivationFactory::CreateInstance: falling back to new_for_swapchain + SetPanel path");
+        crate::winrt_component::debug_log!("HostActivationFactory::CreateInstance: falling back to new_for_swapchain + SetPanel path");
         let mut shell = winrt_component::BlitzHost::new_for_swapchain(
             SwapChainPanelHandle { swapchain: 0 },
             width,
@@ -325,6 +589,7 @@ impl IHostFactory_Impl for HostActivationFactory_Impl {
         ).map_err(|_| windows_core::Error::new(windows_core::HRESULT(0x80004005u32 as i32), "Host creation failed"))?;
         if !html_str.is_empty() { shell.load_html(&html_str); }
         *runtime.inner.lock().unwrap() = Some(Box::new(shell));
+        runtime.create_ms = t0.elapsed().as_secs_f32() * 1000.0;
         let insp: IInspectable = runtime.into();
         let host: bindings::Host = Interface::cast(&insp)?;
         host.SetPanel(attacher.as_ref())?;
@@ -8,24 +8,74 @@ pub struct HostNetworkDispatcher {
     pub fetcher: IInspectable,
 }
 
-// The underlying WinRT IInspectable is apartment-threaded; we only call it on the UI thread.
-// We mark this dispatcher Send+Sync to satisfy trait bounds but ensure actual usage stays on UI thread.
+// SAFETY: the fetcher is the C++/WinRT NetworkFetcher, which is agile (C++/WinRT implementations are unless marked
+// non_agile), so it may be called from any thread: Fetch, TryGetCached, Cancel and CancelDocument run on whichever
+// thread resolves the document (the UI thread, or the render worker, where layout-driven image fetches are
+// issued every frame), and its request queue and in-flight state are guarded by m_queueLock.
 unsafe impl Send for HostNetworkDispatcher {}
 unsafe impl Sync for HostNetworkDispatcher {}
 
 impl HostFetcher for HostNetworkDispatcher {
-    fn request_url(&self, doc_id: usize, url: &str, request_id: u32) -> bool {
-        debug_log(&format!("HostNetworkDispatcher.request_url: req_id={} doc_id={} url={}", request_id, doc_id, url));
+    fn request_url(&self, doc_id: usize, url: &str, request_id: u32, kind: &str) -> bool {
+        debug_log!("HostNetworkDispatcher.request_url: req_id={} doc_id={} kind={} url={}", request_id, doc_id, kind, url);
+        crate::trace::fetch_begin(request_id, doc_id, kind, url);
         if let Ok(f) = self.fetcher.cast::<INetworkFetcher>() {
             use windows::core::HSTRING;
             let url_h = HSTRING::from(url);
             let method_h = HSTRING::from("GET");
-            let ok = f.Fetch(request_id, doc_id as u32, &url_h, &method_h).is_ok();
-            if ok { debug_log(&format!("HostNetworkDispatcher.request_url: dispatched req_id={}", request_id)); }
-            else { debug_log(&format!("HostNetworkDispatcher.request_url: Fetch call failed req_id={}", request_id)); }
+            let kind_h = HSTRING::from(kind);
+            let ok = f.FetchWithKind(request_id, doc_id as u32, &url_h, &method_h, &kind_h).is_ok();
+            if ok { debug_log!("HostNetworkDispatcher.request_url: dispatched req_id={}", request_id); }
+            else { debug_log!("HostNetworkDispatcher.request_url: Fetch call failed req_id={}", request_id); }
             ok
-        } else { debug_log("HostNetworkDispatcher.request_url: cast to INetworkFetcher failed"); false }
+        } else { debug_log!("HostNetworkDispatcher.request_url: cast to INetworkFetcher failed"); false }
     }
+
+    fn try_get_cached(&self, url: &str) -> Option<bytes::Bytes> {
+        let f = self.fetcher.cast::<INetworkFetcher>().ok()?;
+        let obj = f.TryGetCached(&windows::core::HSTRING::from(url)).ok()?;
+        bytes_from_ibuffer(&obj).ok()
+    }
+
+    fn cancel(&self, request_id: u32) {
+        if let Ok(f) = self.fetcher.cast::<INetworkFetcher>() {
+            if let Err(e) = f.Cancel(request_id) { debug_log!("HostNetworkDispatcher.cancel: req_id={} failed {:?}", request_id, e.code()); }
+        }
+    }
+
+    fn cancel_document(&self, doc_id: usize) {
+        if let Ok(f) = self.fetcher.cast::<INetworkFetcher>() {
+            if let Err(e) = f.CancelDocument(doc_id as u32) { debug_log!("HostNetworkDispatcher.cancel_document: doc_id={} failed {:?}", doc_id, e.code()); }
+        }
+    }
+}
+
+// Keeps a WinRT IBuffer alive while blitz holds a Bytes view over its memory (no copy out of the network stack).
+struct IBufferOwner {
+    _buffer: windows::Storage::Streams::IBuffer,
+    ptr: *const u8,
+    len: usize,
+}
+
+// The buffer is immutable once handed to CompleteFetchBuffer and IBuffer implementations from HttpClient are agile.
+unsafe impl Send for IBufferOwner {}
+unsafe impl Sync for IBufferOwner {}
+
+impl AsRef<[u8]> for IBufferOwner {
+    fn as_ref(&self) -> &[u8] {
+        if self.len == 0 { return &[]; }
+        unsafe { std::slice::from_raw_parts(self.ptr, self.len) }
+    }
+}
+
+/// Wrap a WinRT IBuffer (passed as IInspectable) into Bytes without copying.
+pub fn bytes_from_ibuffer(obj: &IInspectable) -> windows::core::Result<bytes::Bytes> {
+    use windows::Win32::System::WinRT::IBufferByteAccess;
+    let buffer: windows::Storage::Streams::IBuffer = obj.cast()?;
+    let len = buffer.Length()? as usize;
+    let access: IBufferByteAccess = buffer.cast()?;
+    let ptr = unsafe { access.Buffer()? } as *const u8;
+    Ok(bytes::Bytes::from_owner(IBufferOwner { _buffer: buffer, ptr, len }))
 }
 
 pub fn make_provider(fetcher: IInspectable) -> Arc<blitz_net_winui::WinUiNetProvider<blitz_dom::net::Resource>> {
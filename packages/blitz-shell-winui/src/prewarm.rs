@@ -0,0 +1,67 @@
+//! Startup fast path (Host.Prewarm and panel-less construction).
+//!
+//! A Host's first frame used to pay for everything at once, on the UI thread, once the panel had loaded: the shared
+//! D3D device, Direct2D/DirectWrite initialization, the system font enumeration behind every document's
+//! FontContext, parsing the user-agent stylesheet, then parsing and resolving the initial HTML. Prewarm starts the process-wide part on a background
+//! thread as early as the app likes (App.OnLaunched). A Host constructed without an attacher parses and resolves its
+//! initial HTML on a thread of its own; SetPanel later only creates the swapchain and presents, after waiting for
+//! that thread if it is still running (both hold the host lock).
+
+use std::sync::{Arc, Mutex, Once, OnceLock};
+
+use blitz_dom::FontContext;
+
+use crate::render_worker::SharedHost;
+use crate::winrt_component::debug_log;
+
+// Built once, cloned into every document: the system font collection is enumerated once per process
+static FONT_CONTEXT: OnceLock<Mutex<FontContext>> = OnceLock::new();
+
+/// FontContext for a new document (the first call builds it if Prewarm hasn't).
+pub(crate) fn font_context() -> FontContext {
+    FONT_CONTEXT.get_or_init(|| Mutex::new(blitz_dom::default_font_context())).lock().unwrap().clone()
+}
+
+/// Host.Prewarm: returns immediately, the work runs once per process on a "blitz-prewarm" thread.
+pub(crate) fn prewarm() {
+    static PREWARM: Once = Once::new();
+    PREWARM.call_once(|| {
+        let spawned = std::thread::Builder::new().name("blitz-prewarm".into()).spawn(|| {
+            let t0 = std::time::Instant::now();
+            // The device is only used by whichever thread renders later, one at a time (see global_gfx)
+            let device = crate::global_gfx::get_or_create_d3d_device().is_some();
+            anyrender_d2d::prewarm();
+            let _ = font_context();
+            // Shared by every document, so creating a Host only appends it to its Stylist
+            blitz_dom::preparse_user_agent_stylesheet(blitz_dom::DEFAULT_CSS);
+            debug_log!("prewarm: device={} done in {:.2} ms", device, t0.elapsed().as_secs_f32() * 1000.0);
+        });
+        if let Err(e) = spawned { debug_log!("prewarm: thread spawn failed: {:?}", e); }
+    });
+}
+
+// Same rules as the render worker's SendHost: the host is only touched under its lock.
+struct SendHost(SharedHost);
+unsafe impl Send for SendHost {}
+
+/// Parse and resolve `html` into a panel-less Host off the calling thread. Runs inline if no thread can be spawned.
+pub(crate) fn preload(host: SharedHost, html: String) {
+    let html: Arc<str> = html.into();
+    let job = (SendHost(host.clone()), html.clone());
+    let spawned = std::thread::Builder::new().name("blitz-preload".into()).spawn(move || {
+        let (send_host, html) = job;
+        load(&send_host.0, &html);
+    });
+    if let Err(e) = spawned {
+        debug_log!("preload: thread spawn failed ({:?}); loading inline", e);
+        load(&host, &html);
+    }
+}
+
+fn load(host: &SharedHost, html: &str) {
+    let t0 = std::time::Instant::now();
+    if let Some(h) = host.lock().unwrap().as_mut() { h.load_html(html); }
+    // Parse/style/layout ran here, not in a presented frame
+    blitz_metrics::take_frame_phases();
+    debug_log!("preload: {} chars parsed and resolved in {:.2} ms", html.len(), t0.elapsed().as_secs_f32() * 1000.0);
+}
@@ -0,0 +1,180 @@
+//! Optional dedicated render thread per Host.
+//!
+//! Threading model when the worker is enabled:
+//! - UI thread (XAML): posts input / resize / content messages and never blocks on resolve/paint/present.
+//!   Operations bound to UI affinity (SetPanel -> Attacher, SetNetworkFetcher, SetFrameScheduler) still run inline
+//!   on the caller thread under the host lock.
+//! - Worker thread: owns the render loop. It waits on the swapchain's frame-latency object (frame_pacing.rs), then
+//!   drains every queued message and resolves + records once, so input is sampled as late as possible. The frame
+//!   is presented after the host lock is released: Present(1) paces the loop to vsync without holding up UI-thread
+//!   calls, which only wait for an in-flight Present when they draw or change the swapchain themselves. When the
+//!   document is idle the worker sleeps on the channel.
+//! - Fetch completions may arrive on thread-pool threads; they are posted like any other message. Images are
+//!   decoded off both threads (image_decode.rs) and wake the worker with a RenderOnce when done.
+//!
+//! SwapChainPanel allows presenting from a background thread; only SetSwapChain itself needs the UI thread,
+//! which Attacher::AttachSwapChain (C++) marshals onto the panel's DispatcherQueue.
+
+use std::sync::mpsc::{self, Receiver, RecvTimeoutError, Sender};
+use std::sync::{Arc, Mutex};
+use std::time::Duration;
+
+use windows::Win32::System::Com::{CoInitializeEx, CoUninitialize, COINIT_MULTITHREADED};
+
+use crate::winrt_component::{debug_log, BlitzHost};
+
+/// Host storage shared between the WinRT object (caller threads) and the render worker.
+pub(crate) type SharedHost = Arc<Mutex<Option<Box<BlitzHost>>>>;
+
+// Re-render cadence while the document is animating and no message wakes us (Present(1) also blocks on vsync).
+const ANIMATION_POLL: Duration = Duration::from_millis(16);
+
+/// Host operations that can be deferred to whichever thread renders.
+pub(crate) enum HostMsg {
+    Resize(u32, u32, f32),
+    RenderOnce,
+    LoadHtml(String),
+    UpdateHtml(String),
+    SetDebugOverlay(bool),
+    SetCompositorScrolling(u32),
+    SetTiledRendering(bool),
+    SetMemoryBudget(u64),
+    Trim,
+    SetMaximumFrameLatency(u32),
+    SetTransparent(bool),
+    CompleteFetch { request_id: u32, doc_id: u32, success: bool, data: blitz_traits::net::Bytes, error: String },
+    WheelScroll(f64, f64),
+    PointerMove(f32, f32, u32, u32),
+    PointerDown(f32, f32, u8, u32, u32),
+    PointerUp(f32, f32, u8, u32, u32),
+    InputBatch(Vec<f32>, u32, u32),
+    ReportAttachSubPhase(u8, f32),
+    Shutdown,
+}
+
+impl HostMsg {
+    pub(crate) fn apply(self, host: &mut BlitzHost) {
+        match self {
+            HostMsg::Resize(w, h, scale) => host.resize(w, h, scale),
+            HostMsg::RenderOnce => host.render_once(),
+            HostMsg::LoadHtml(html) => host.load_html(&html),
+            HostMsg::UpdateHtml(html) => host.update_html(&html),
+            HostMsg::SetDebugOverlay(on) => host.set_debug_overlay(on),
+            HostMsg::SetCompositorScrolling(overscan) => host.set_compositor_scrolling(overscan),
+            HostMsg::SetTiledRendering(on) => host.set_tiled_rendering(on),
+            HostMsg::SetMemoryBudget(bytes) => host.set_memory_budget(bytes),
+            HostMsg::Trim => host.trim(),
+            HostMsg::SetMaximumFrameLatency(frames) => host.set_maximum_frame_latency(frames),
+            HostMsg::SetTransparent(on) => host.set_transparent(on),
+            HostMsg::CompleteFetch { request_id, doc_id, success, data, error } => {
+                host.complete_fetch_bytes(request_id, doc_id, success, data, &error)
+            }
+            HostMsg::WheelScroll(dx, dy) => host.wheel_scroll(dx, dy),
+            HostMsg::PointerMove(x, y, buttons, mods) => host.pointer_move(x, y, buttons, mods),
+            HostMsg::PointerDown(x, y, button, buttons, mods) => host.pointer_down(x, y, button, buttons, mods),
+            HostMsg::PointerUp(x, y, button, buttons, mods) => host.pointer_up(x, y, button, buttons, mods),
+            HostMsg::InputBatch(points, buttons, mods) => host.submit_input_batch(&points, buttons, mods),
+            HostMsg::ReportAttachSubPhase(kind, ms) => host.report_attach_subphase(kind, ms),
+            HostMsg::Shutdown => {}
+        }
+    }
+}
+
+// BlitzHost holds apartment-agnostic COM pointers (D3D/D2D/DXGI, agile C++/WinRT callbacks). Access is serialized
+// by the host Mutex, and the shared D3D device is switched to multithread-protected mode before the worker starts.
+struct SendHost(SharedHost);
+unsafe impl Send for SendHost {}
+
+pub(crate) struct RenderWorker {
+    tx: Sender<HostMsg>,
+}
+
+impl RenderWorker {
+    pub(crate) fn spawn(host: SharedHost) -> std::io::Result<Self> {
+        let (tx, rx) = mpsc::channel();
+        let send_host = SendHost(host);
+        // Detached: dropping the worker only asks it to stop, so the UI thread never waits out a frame
+        std::thread::Builder::new()
+            .name("blitz-render".into())
+            .spawn(move || {
+                let send_host = send_host;
+                run(send_host.0, rx)
+            })?;
+        Ok(Self { tx })
+    }
+
+    /// Queue a message for the worker. Returns the message back if the worker has exited.
+    pub(crate) fn post(&self, msg: HostMsg) -> Result<(), HostMsg> {
+        self.tx.send(msg).map_err(|e| e.0)
+    }
+
+    /// Asks the worker for a frame from any thread without touching the host lock (off-thread image work).
+    pub(crate) fn waker(&self) -> crate::image_decode::Waker {
+        let tx = self.tx.clone();
+        Arc::new(move || { let _ = tx.send(HostMsg::RenderOnce); })
+    }
+}
+
+impl Drop for RenderWorker {
+    // The thread applies what was queued before Shutdown and exits on its own; frames the caller renders in the
+    // meantime are serialized with it by the host lock (and the present gate).
+    fn drop(&mut self) {
+        let _ = self.tx.send(HostMsg::Shutdown);
+    }
+}
+
+fn run(host: SharedHost, rx: Receiver<HostMsg>) {
+    // MTA so WinRT calls made from here (INetworkFetcher.Fetch) have an apartment.
+    let com_ok = unsafe { CoInitializeEx(None, COINIT_MULTITHREADED).is_ok() };
+    if !crate::global_gfx::enable_multithread_protection() {
+        debug_log!("render_worker: shared device not multithread protected; rendering anyway");
+    }
+    debug_log!("render_worker: started");
+    let frame_latency = host.lock().unwrap().as_ref().map(|h| h.frame_latency_handle());
+    let frame_stats = host.lock().unwrap().as_ref().map(|h| h.frame_stats_handle());
+    let mut more = true; // render once right away to pick up state queued before the worker existed
+    loop {
+        let first = if more {
+            match rx.recv_timeout(ANIMATION_POLL) {
+                Ok(m) => Some(m),
+                Err(RecvTimeoutError::Timeout) => None,
+                Err(RecvTimeoutError::Disconnected) => break,
+            }
+        } else {
+            match rx.recv() {
+                Ok(m) => Some(m),
+                Err(_) => break,
+            }
+        };
+        // Wait for room in the present queue without the host lock, so UI-thread calls aren't held up
+        let waiter = frame_latency.as_ref().and_then(|f| f.lock().unwrap().clone());
+        if let Some(w) = waiter { w.wait(); }
+        let mut guard = host.lock().unwrap();
+        let Some(h) = guard.as_mut() else { break; };
+        let mut shutdown = false;
+        // Coalesce: apply everything queued so far, then produce a single frame.
+        for msg in first.into_iter().chain(rx.try_iter()) {
+            match msg {
+                HostMsg::Shutdown => { shutdown = true; break; }
+                // Rendered by the frame below; rendering here too would leave two frames to present
+                HostMsg::RenderOnce => h.request_frame(),
+                msg => msg.apply(h),
+            }
+        }
+        if shutdown { break; }
+        more = h.render_pending_frame();
+        // Present (vsync) and FrameCompleted handlers run without the host lock. The gate is taken first, so no
+        // other frame can be drawn before this one is on its way.
+        let pending = h.take_pending_present();
+        let presenting = pending.as_ref().map(|(frame, gate)| (frame, gate.lock().unwrap()));
+        drop(guard);
+        if let Some((frame, gate)) = presenting {
+            let presented = frame.present();
+            drop(gate);
+            if let Some(h) = host.lock().unwrap().as_mut() { more |= h.finish_present(presented); }
+        }
+        if let Some(stats) = &frame_stats { stats.raise_completed(); }
+    }
+    debug_log!("render_worker: stopped");
+    if com_ok { unsafe { CoUninitialize(); } }
+}
@@ -0,0 +1,149 @@
+//! ETW TraceLogging provider for the host pipeline.
+//!
+//! Events go to the "Blitz.WinUI" provider (GUID d9a325c4-cdb2-59c1-9981-129671d2b6ae, the standard hash of the
+//! name). The C++ component (BlitzTrace.h) registers the same provider, so a WPA/PerfView session enabling it sees
+//! both sides of a frame or fetch next to the XAML and DWM events. Pipeline stages are start/stop activities:
+//! Resolve, PaintScene, Playback and Present per frame, Fetch per request (RequestId correlates it with the
+//! component's HttpFetch) and Attach for the host's attach sub-phases. Nothing is formatted or allocated unless a
+//! session has the provider enabled; a disabled event costs one relaxed load. The same goes for [`debug_log!`]
+//! messages, which are verbose Log events (and debugger output in debug builds with verbose logging on).
+
+use std::sync::Once;
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+
+use tracelogging::{Guid, Level};
+
+tracelogging::define_provider!(PROVIDER, "Blitz.WinUI", id("d9a325c4-cdb2-59c1-9981-129671d2b6ae"));
+
+/// Register the provider (once per process). The DLL is never unloaded while Hosts exist, so it stays registered.
+pub(crate) fn register() {
+    static REGISTER: Once = Once::new();
+    // SAFETY: registered once and never unregistered, so the provider can't be used after an unregister.
+    REGISTER.call_once(|| {
+        unsafe { let _ = PROVIDER.register(); }
+        if std::env::var("BLITZ_VERBOSE").is_ok_and(|v| v == "1" || v.eq_ignore_ascii_case("true")) { set_verbose(true); }
+    });
+}
+
+pub(crate) fn enabled() -> bool {
+    PROVIDER.enabled(Level::Informational, 0)
+}
+
+// Activity ids: the process id, a kind, and a per-kind sequence (the request id for fetches), so they are unique
+// across processes without a call into the OS per activity.
+const KIND_FRAME: u128 = 1;
+const KIND_FETCH: u128 = 2;
+const KIND_ATTACH: u128 = 3;
+
+fn activity_id(kind: u128, seq: u64) -> Guid {
+    Guid::from_u128(&(((std::process::id() as u128) << 96) | (kind << 64) | seq as u128))
+}
+
+static NEXT_ACTIVITY: AtomicU64 = AtomicU64::new(1);
+static ATTACH_SEQ: AtomicU64 = AtomicU64::new(0);
+
+#[derive(Clone, Copy)]
+pub(crate) enum Phase {
+    Resolve,
+    PaintScene,
+    Playback,
+    Present,
+}
+
+// Event names must be literals, so each phase gets its own write_event!
+macro_rules! phase_event {
+    ($phase:expr, $opcode:ident, $id:expr) => {
+        match $phase {
+            Phase::Resolve => tracelogging::write_event!(PROVIDER, "Resolve", level(Informational), opcode($opcode), activity_id($id)),
+            Phase::PaintScene => tracelogging::write_event!(PROVIDER, "PaintScene", level(Informational), opcode($opcode), activity_id($id)),
+            Phase::Playback => tracelogging::write_event!(PROVIDER, "Playback", level(Informational), opcode($opcode), activity_id($id)),
+            Phase::Present => tracelogging::write_event!(PROVIDER, "Present", level(Informational), opcode($opcode), activity_id($id)),
+        }
+    };
+}
+
+/// A pipeline stage: the start event is written on creation, the stop event on drop.
+#[must_use]
+pub(crate) struct Activity {
+    phase: Phase,
+    id: Option<Guid>,
+}
+
+impl Activity {
+    pub(crate) fn start(phase: Phase) -> Self {
+        if !enabled() { return Self { phase, id: None }; }
+        let id = activity_id(KIND_FRAME, NEXT_ACTIVITY.fetch_add(1, Ordering::Relaxed));
+        phase_event!(phase, Start, &id);
+        Self { phase, id: Some(id) }
+    }
+}
+
+impl Drop for Activity {
+    fn drop(&mut self) {
+        if let Some(id) = self.id.take() { phase_event!(self.phase, Stop, &id); }
+    }
+}
+
+/// A request was handed to the host's INetworkFetcher.
+pub(crate) fn fetch_begin(request_id: u32, doc_id: usize, kind: &str, url: &str) {
+    if !enabled() { return; }
+    let id = activity_id(KIND_FETCH, request_id as u64);
+    tracelogging::write_event!(PROVIDER, "Fetch", level(Informational), opcode(Start), activity_id(&id),
+        u32("RequestId", &request_id), u32("DocId", &(doc_id as u32)), str8("Kind", kind), str8("Url", url));
+}
+
+/// A request completed (or failed) and its body reached the Host.
+pub(crate) fn fetch_end(request_id: u32, success: bool, bytes: usize) {
+    if !enabled() { return; }
+    let id = activity_id(KIND_FETCH, request_id as u64);
+    tracelogging::write_event!(PROVIDER, "Fetch", level(Informational), opcode(Stop), activity_id(&id),
+        u32("RequestId", &request_id), bool8("Success", &success), u64("Bytes", &(bytes as u64)));
+}
+
+/// ReportAttachSubPhase: kind 0 (Begin) starts an Attach activity, 3 (End) stops it, the others are sub-phases
+/// inside it. `ms` is the duration the host measured.
+pub(crate) fn attach_sub_phase(kind: u8, ms: f32) {
+    if !enabled() { return; }
+    let seq = if kind == 0 { ATTACH_SEQ.fetch_add(1, Ordering::Relaxed) + 1 } else { ATTACH_SEQ.load(Ordering::Relaxed) };
+    let id = activity_id(KIND_ATTACH, seq);
+    match kind {
+        0 => tracelogging::write_event!(PROVIDER, "Attach", level(Informational), opcode(Start), activity_id(&id), f32("Ms", &ms)),
+        3 => tracelogging::write_event!(PROVIDER, "Attach", level(Informational), opcode(Stop), activity_id(&id), f32("Ms", &ms)),
+        _ => tracelogging::write_event!(PROVIDER, "AttachSubPhase", level(Informational), activity_id(&id), u8("Kind", &kind), f32("Ms", &ms)),
+    }
+}
+
+// SetVerboseLogging / BLITZ_VERBOSE=1; off by default
+static VERBOSE: AtomicBool = AtomicBool::new(false);
+
+pub(crate) fn set_verbose(enabled: bool) {
+    VERBOSE.store(enabled, Ordering::Relaxed);
+}
+
+/// Whether debug_log! messages go anywhere: a session listening at verbose level, or (debug builds only) verbose
+/// logging switched on for the debugger output.
+pub(crate) fn log_enabled() -> bool {
+    PROVIDER.enabled(Level::Verbose, 0) || (cfg!(debug_assertions) && VERBOSE.load(Ordering::Relaxed))
+}
+
+/// Write a debug_log! message: a verbose Log event, and in debug builds with verbose logging on, a debugger line.
+pub(crate) fn log(msg: &str) {
+    #[cfg(debug_assertions)]
+    if VERBOSE.load(Ordering::Relaxed) {
+        let mut bytes = Vec::with_capacity(msg.len() + 2);
+        bytes.extend_from_slice(msg.as_bytes());
+        if !bytes.ends_with(b"\n") { bytes.push(b'\n'); }
+        bytes.push(0);
+        unsafe { windows::Win32::System::Diagnostics::Debug::OutputDebugStringA(windows::core::PCSTR(bytes.as_ptr())); }
+    }
+    tracelogging::write_event!(PROVIDER, "Log", level(Verbose), str8("Message", msg));
+}
+
+/// Diagnostic message with `format!` arguments. Nothing is formatted unless [`log_enabled`], so call sites on hot
+/// paths cost one check while no one is listening.
+macro_rules! debug_log {
+    ($($arg:tt)*) => {
+        if $crate::trace::log_enabled() { $crate::trace::log(&format!($($arg)*)); }
+    };
+}
+pub(crate) use debug_log;
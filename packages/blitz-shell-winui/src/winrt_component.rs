@@ -1,13 +1,20 @@
 use anyrender::WindowRenderer as _;
-use std::sync::Arc;
+use std::sync::{Arc, Mutex};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::time::Instant;
 use anyrender_d2d::D2DWindowRenderer;
 use blitz_dom::{Document, DocumentConfig};
 use blitz_html::HtmlDocument;
-use blitz_paint::paint_scene;
+use blitz_paint::{paint_scene, paint_scene_parallel};
+use blitz_traits::net::Destination;
 use blitz_traits::shell::{ColorScheme, Viewport};
 
-use crate::bindings::ISwapChainAttacher;
+use crate::bindings::{IFrameScheduler, ISwapChainAttacher};
+use crate::frame_pacing::FrameLatencyWaiter;
+use crate::frame_stats::FrameStatsHub;
+use crate::image_decode::{ImageDecoder, Waker};
 use crate::net_bridge;
+use crate::trace;
 use blitz_dom::net::Resource;
 use windows::core::{IInspectable, Interface};
 use windows::Win32::Graphics::Direct3D11::{
@@ -15,22 +22,26 @@ use windows::Win32::Graphics::Direct3D11::{
     ID3D11Resource,
 };
 use windows::Win32::Graphics::Dxgi::{
-    CreateDXGIFactory2, IDXGIFactory2, IDXGISwapChain1, DXGI_CREATE_FACTORY_FLAGS,
+    CreateDXGIFactory2, IDXGIFactory2, IDXGISwapChain1, IDXGISwapChain2, DXGI_CREATE_FACTORY_FLAGS,
     DXGI_SWAP_CHAIN_DESC1, DXGI_USAGE_RENDER_TARGET_OUTPUT, DXGI_PRESENT,
-    DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL,
+    DXGI_PRESENT_PARAMETERS, DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL, DXGI_ERROR_DEVICE_REMOVED, DXGI_ERROR_DEVICE_RESET,
+    DXGI_SWAP_CHAIN_FLAG, DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT,
 };
+use windows::Win32::Foundation::RECT;
 use windows::Win32::Graphics::Dxgi::Common::{
     DXGI_FORMAT, DXGI_SAMPLE_DESC,
 };
-use windows::Win32::System::Diagnostics::Debug::OutputDebugStringA;
-use windows::core::PCSTR;
-
-pub(crate) fn debug_log(msg: &str) {
-    // Append newline for readability in DebugView.
-    let mut bytes = msg.as_bytes().to_vec();
-    if !bytes.ends_with(b"\n") { bytes.push(b'\n'); }
-    bytes.push(0); // null terminator
-    unsafe { OutputDebugStringA(PCSTR(bytes.as_ptr())); }
+pub(crate) use crate::trace::debug_log;
+
+// renderer.render with the recording (PaintScene) and the playback that follows it traced as separate activities
+fn render_traced<F: FnOnce(&mut anyrender_d2d::D2DScenePainter<'_>)>(renderer: &mut D2DWindowRenderer, paint: F) {
+    let mut playback = None;
+    renderer.render(|scene| {
+        { let _paint = trace::Activity::start(trace::Phase::PaintScene); paint(scene); }
+        // The renderer plays the recorded scene back once this returns
+        playback = Some(trace::Activity::start(trace::Phase::Playback));
+    });
+    drop(playback);
 }
 
 fn resource_kind_name(r: &Resource) -> &'static str {
@@ -50,13 +61,92 @@ fn resource_kind_name(r: &Resource) -> &'static str {
 pub unsafe extern "C" fn __blitz_host_debug_log(ptr: *const u8, len: usize) {
     if ptr.is_null() { return; }
     let slice = unsafe { std::slice::from_raw_parts(ptr, len) };
-    if let Ok(msg) = std::str::from_utf8(slice) { debug_log(msg); }
+    if let Ok(msg) = std::str::from_utf8(slice) { trace::log(msg); }
+}
+
+// Lets the provider crate skip formatting messages no one would receive (see trace::log_enabled)
+#[unsafe(no_mangle)]
+pub extern "C" fn __blitz_host_log_enabled() -> bool {
+    trace::log_enabled()
 }
 
 // Use generated ISwapChainAttacher from bindings.rs
 
+#[derive(Clone, Copy)]
+struct PendingPointerMove {
+    x: f32,
+    y: f32,
+    buttons: u32,
+    mods: u32,
+}
+
+// Compositor-driven scrolling state (SetCompositorScrolling). The swapchain is over-sized by `overscan` logical px
+// above and below the viewport and painted with the viewport scrolled to (raster_x, raster_top); the host view
+// translates the panel by the published offset, so wheel scrolls that stay inside the raster never repaint.
+struct CompositorScroll {
+    overscan: f64,
+    raster_x: f64,
+    raster_top: f64,
+}
+
+impl CompositorScroll {
+    fn covers(&self, scroll_y: f64) -> bool {
+        let offset = scroll_y - self.raster_top;
+        offset >= 0.0 && offset <= self.overscan * 2.0
+    }
+}
+
 /// Public host object backing the WinRT class. Keeps the document and renderer alive and exposes
 /// methods called from C# to drive rendering and input.
+/// A recorded frame waiting for Present
+pub(crate) struct PendingPresent {
+    swapchain: IDXGISwapChain1,
+    // Partial frames present only the rects that were redrawn; DXGI keeps the rest of the previous frame
+    dirty_rects: Option<Vec<RECT>>,
+    frame_start: Instant,
+    // Detected while recording; the device is rebuilt once the frame has been presented
+    device_lost: bool,
+}
+
+/// Outcome of [`PendingPresent::present`], for [`BlitzHost::finish_present`]
+pub(crate) struct Presented {
+    hr: windows::core::HRESULT,
+    frame_ms: f32,
+    present_ms: f32,
+    device_lost: bool,
+}
+
+impl PendingPresent {
+    // Needs no host state, so the render worker calls it without the host lock
+    pub(crate) fn present(&self) -> Presented {
+        // Always vsync; the latency wait before the frame keeps the present queue from growing
+        let sync_interval = 1;
+        let present_start = Instant::now();
+        let present = trace::Activity::start(trace::Phase::Present);
+        let hr = unsafe {
+            match &self.dirty_rects {
+                Some(rects) => {
+                    let params = DXGI_PRESENT_PARAMETERS {
+                        DirtyRectsCount: rects.len() as u32,
+                        pDirtyRects: rects.as_ptr() as *mut _,
+                        pScrollRect: std::ptr::null_mut(),
+                        pScrollOffset: std::ptr::null_mut(),
+                    };
+                    self.swapchain.Present1(sync_interval, DXGI_PRESENT(0), &params)
+                }
+                None => self.swapchain.Present(sync_interval, DXGI_PRESENT(0)),
+            }
+        };
+        drop(present);
+        Presented {
+            hr,
+            frame_ms: self.frame_start.elapsed().as_secs_f32() * 1000.0,
+            present_ms: present_start.elapsed().as_secs_f32() * 1000.0,
+            device_lost: self.device_lost,
+        }
+    }
+}
+
 pub struct BlitzHost {
     renderer: D2DWindowRenderer,
     doc: Box<dyn Document>,
@@ -72,6 +162,22 @@ pub struct BlitzHost {
     content_loaded: bool,
     // simple frame invalidation flag (best-effort; we still allow forced render)
     needs_render: bool,
+    // Demand-driven render loop: optional host-side scheduler notified when the document goes from idle to dirty.
+    // frame_requested is edge-triggered so repeated invalidations within one frame cost a single ABI call.
+    frame_scheduler: Option<IFrameScheduler>,
+    frame_requested: bool,
+    // RenderPendingFrame calls that had nothing to draw (idle vsync ticks still reaching the host)
+    skipped_frames: u64,
+    // True while a render_worker thread drives this host; frame requests then stay internal (the worker
+    // re-renders after draining its queue) instead of calling the UI-affine frame scheduler.
+    render_worker_active: bool,
+    // Frame recorded by render_once while the worker is active, presented by the worker once it has released the
+    // host lock (so UI-thread calls aren't held up by the vsync wait in Present)
+    pending_present: Option<PendingPresent>,
+    // Held by the worker while it presents outside the host lock; frames and swapchain changes wait on it
+    present_gate: Arc<Mutex<()>>,
+    // Latest coalesced pointer move from SubmitInputBatch, dispatched once per frame before resolve().
+    pending_pointer: Option<PendingPointerMove>,
     // If real content loaded before swapchain is ready, defer starting initial measurement until activation
     pending_content_measurement: bool,
     // Async panel attach workflow
@@ -91,6 +197,38 @@ pub struct BlitzHost {
     // Device (rasterization) scale captured from XamlRoot; we force viewport scale=1.0 (CSS px == logical DIP)
     // but allocate swapchain/backbuffer at logical * device_scale for crisp text.
     device_scale: f32,
+    compositor_scroll: Option<CompositorScroll>,
+    // Vertical panel translation (f64 bits, logical px) for the host view; shared so it can be read without the
+    // host lock while a frame renders on the worker.
+    scroll_translation: Arc<AtomicU64>,
+    // Real viewport scroll while the raster origin (or, when tiled, the document origin) is swapped in for
+    // damage tracking / painting
+    saved_scroll: Option<(f64, f64)>,
+    // Generation of the shared D3D device our swapchain was created on (global_gfx); a mismatch means another
+    // Host saw the device removed and ours must be rebuilt before drawing again.
+    device_generation: u64,
+    // Frame pacing (frame_pacing.rs): frames the swapchain may queue, and the waiter for its latency object.
+    // Shared so the render worker can wait before taking the host lock.
+    max_frame_latency: u32,
+    frame_latency: Arc<Mutex<Option<Arc<FrameLatencyWaiter>>>>,
+    // Premultiplied-alpha swapchain over the content behind the panel (SetTransparent)
+    transparent: bool,
+    // Off-thread image decoding (image_decode.rs); results are loaded at the start of the next frame
+    image_decoder: Arc<ImageDecoder>,
+    // Set while the render worker runs: posts it a frame. Otherwise finished decodes go through the frame scheduler.
+    worker_waker: Option<Waker>,
+    // Presented-frame telemetry (frame_stats.rs); shared so stats can be read without the host lock
+    frame_stats: Arc<FrameStatsHub>,
+}
+
+// Latency for new swapchains until SetMaximumFrameLatency says otherwise
+const DEFAULT_MAX_FRAME_LATENCY: u32 = 1;
+// Device scale changes smaller than this keep the current buffers (Resize)
+const SCALE_TOLERANCE: f32 = 0.01;
+
+// ResizeBuffers must repeat the creation flags (the waitable-object flag can't be added or removed)
+fn swapchain_flags(sc: &IDXGISwapChain1) -> DXGI_SWAP_CHAIN_FLAG {
+    DXGI_SWAP_CHAIN_FLAG(unsafe { sc.GetDesc1() }.map(|d| d.Flags as i32).unwrap_or(0))
 }
 
 impl BlitzHost {
@@ -103,14 +241,14 @@ impl BlitzHost {
         // For now we force scale = 1.0 to avoid double device-pixel-ratio application (causing oversized content).
         let device_scale = if scale <= 0.0 { 1.0 } else { scale };
         if (device_scale - 1.0).abs() > 0.01 {
-            debug_log(&format!("new_for_swapchain: storing device_scale={} while forcing viewport scale=1.0", device_scale));
+            debug_log!("new_for_swapchain: storing device_scale={} while forcing viewport scale=1.0", device_scale);
         }
 
         // Minimal HTML doc placeholder; host can replace by calling load_html.
         // Start with an empty document so we don't flash placeholder content before real HTML loads.
         // Prepare a config that will later receive a real net provider when the host supplies
         // an INetworkFetcher. Until then it falls back to DummyNetProvider.
-        let cfg = DocumentConfig::default();
+        let cfg = DocumentConfig { font_ctx: Some(crate::prewarm::font_context()), lazy_images: true, ..Default::default() };
         let mut doc = HtmlDocument::from_html(
             "<html><head></head><body style=\"margin:0;padding:0;background:transparent;\"></body></html>",
             cfg,
@@ -132,6 +270,13 @@ impl BlitzHost {
             attacher: None,
             content_loaded: false,
             needs_render: false,
+            frame_scheduler: None,
+            frame_requested: false,
+            skipped_frames: 0,
+            render_worker_active: false,
+            pending_present: None,
+            present_gate: Arc::new(Mutex::new(())),
+            pending_pointer: None,
             pending_content_measurement: false,
             host_init_start: None,
             pending_swapchain: None,
@@ -142,6 +287,16 @@ impl BlitzHost {
             resource_callback: None,
             provider: None,
             device_scale: device_scale,
+            compositor_scroll: None,
+            scroll_translation: Arc::new(AtomicU64::new(0f64.to_bits())),
+            saved_scroll: None,
+            device_generation: 0,
+            max_frame_latency: DEFAULT_MAX_FRAME_LATENCY,
+            frame_latency: Arc::new(Mutex::new(None)),
+            transparent: false,
+            image_decoder: ImageDecoder::new(),
+            worker_waker: None,
+            frame_stats: Arc::new(FrameStatsHub::new()),
         })
     }
     
@@ -161,7 +316,7 @@ impl BlitzHost {
             if let Some(f) = &self.network_fetcher {
                 let provider = net_bridge::make_provider(f.clone());
                 self.provider = Some(provider);
-                debug_log("set_network_fetcher: provider created");
+                debug_log!("set_network_fetcher: provider created");
             }
         }
     // Ensure we have a default resource callback so completed fetches populate the document.
@@ -173,41 +328,97 @@ impl BlitzHost {
         if had_content { 
             // Retroactively schedule resource fetches missed during initial parse
             self.doc.rescan_external_resources();
-            debug_log("set_network_fetcher: rescanned external resources after late injection");
+            debug_log!("set_network_fetcher: rescanned external resources after late injection");
+            if self.apply_cached_fetches() { self.request_frame(); }
         }
     }
     }
 
     // Simplified path invoked from WinRT RequestUrl (host passes in request_id already allocated on C# side)
     pub fn request_url(&mut self, doc_id: usize, url: &str, handler: blitz_traits::net::BoxedHandler<Resource>) {
-        if blitz_traits::net::Url::parse(url).is_err() { debug_log(&format!("request_url: invalid url '{}'", url)); return; }
+        if blitz_traits::net::Url::parse(url).is_err() { debug_log!("request_url: invalid url '{}'", url); return; }
         if let Some(p) = &self.provider {
             use blitz_traits::net::{Request, NetProvider};
             if let Ok(parsed) = blitz_traits::net::Url::parse(url) {
-                debug_log(&format!("request_url: dispatching doc_id={} url={} (provider ok)", doc_id, parsed));
+                debug_log!("request_url: dispatching doc_id={} url={} (provider ok)", doc_id, parsed);
                 p.fetch(doc_id, Request::get(parsed), handler);
             }
-        } else { debug_log("request_url: no provider available"); }
+        } else { debug_log!("request_url: no provider available"); }
+    }
+
+    // Completion path invoked by HostRuntime from WinRT CompleteFetch (UInt8[] copy path)
+    pub fn complete_fetch(&mut self, request_id: u32, doc_id: u32, success: bool, data: &[u8], error: &str) {
+        let bytes = if success { blitz_traits::net::Bytes::copy_from_slice(data) } else { blitz_traits::net::Bytes::new() };
+        self.complete_fetch_bytes(request_id, doc_id, success, bytes, error);
     }
 
-    // Completion path invoked by HostRuntime from WinRT CompleteFetch
-    pub fn complete_fetch(&mut self, request_id: u32, _doc_id: u32, success: bool, data: &[u8], error: &str) {
+    // Shared completion path; `data` may borrow a WinRT IBuffer (CompleteFetchBuffer) so handing it to the
+    // handler/decoder involves no copy.
+    pub fn complete_fetch_bytes(&mut self, request_id: u32, _doc_id: u32, success: bool, data: blitz_traits::net::Bytes, error: &str) {
         if let Some(p) = &self.provider {
-            if let Some((orig_doc, handler)) = p.take_handler(request_id) {
+            if let Some((orig_doc, destination, handler)) = p.take_request(request_id) {
+                trace::fetch_end(request_id, success, data.len());
                 if let Some(cb) = &self.resource_callback {
-                    if success {
-                        debug_log(&format!("complete_fetch: request_id={} doc_id={} success bytes={}", request_id, orig_doc, data.len()));
-                        let bytes = blitz_traits::net::Bytes::from(data.to_vec());
-                        handler.bytes(orig_doc, bytes, cb.clone());
+                    if success && destination == Destination::Image {
+                        debug_log!("complete_fetch: request_id={} doc_id={} image bytes={} (decoding off-thread)", request_id, orig_doc, data.len());
+                        self.image_decoder.decode(orig_doc, handler, data);
+                    } else if success {
+                        debug_log!("complete_fetch: request_id={} doc_id={} success bytes={}", request_id, orig_doc, data.len());
+                        handler.bytes(orig_doc, data, cb.clone());
                     } else {
-                        debug_log(&format!("complete_fetch: request_id={} doc_id={} FAILED error='{}'", request_id, orig_doc, error));
+                        debug_log!("complete_fetch: request_id={} doc_id={} FAILED error='{}'", request_id, orig_doc, error);
                         cb.call(orig_doc, Err(Some(error.to_string())));
                     }
                 }
                 return;
             }
         }
-        debug_log(&format!("complete_fetch: unknown request id {} (no provider match)", request_id));
+        debug_log!("complete_fetch: unknown request id {} (no provider match)", request_id);
+    }
+
+    // Run handlers for requests the provider answered synchronously from the host cache (TryGetCached) and
+    // load the results straight into the document. Loading can issue further cached fetches (@import, fonts),
+    // so drain until quiet. Returns whether anything was loaded.
+    fn apply_cached_fetches(&mut self) -> bool {
+        let Some(p) = self.provider.clone() else { return false; };
+        let mut applied = false;
+        loop {
+            let ready = p.take_ready();
+            if ready.is_empty() { break; }
+            let loaded: std::sync::Arc<std::sync::Mutex<Vec<Resource>>> = Default::default();
+            let sink = loaded.clone();
+            let cb: blitz_traits::net::SharedCallback<Resource> = std::sync::Arc::new(move |_doc_id: usize, result: Result<Resource, Option<String>>| {
+                if let Ok(res) = result { sink.lock().unwrap().push(res); }
+            });
+            let current_doc = self.doc.id();
+            for (doc_id, destination, handler, bytes) in ready {
+                if doc_id != current_doc { continue; }
+                // Cache hits skip the network, not the decode
+                if destination == Destination::Image { self.image_decoder.decode(doc_id, handler, bytes); continue; }
+                handler.bytes(doc_id, bytes, cb.clone());
+            }
+            let resources = std::mem::take(&mut *loaded.lock().unwrap());
+            for res in resources {
+                debug_log!("apply_cached_fetches: kind={}", resource_kind_name(&res));
+                self.doc.load_resource(res);
+                applied = true;
+            }
+        }
+        applied
+    }
+
+    // Load images decoded off-thread since the last frame. Returns whether anything was loaded.
+    fn apply_decoded_images(&mut self) -> bool {
+        let decoded = self.image_decoder.take_decoded();
+        if decoded.is_empty() { return false; }
+        let current_doc = self.doc.id();
+        let count = decoded.len();
+        for (doc_id, res) in decoded {
+            // Decodes for a replaced document are dropped
+            if doc_id == current_doc { self.doc.load_resource(res); }
+        }
+        debug_log!("apply_decoded_images: loaded {} (still decoding {})", count, self.image_decoder.in_flight());
+        true
     }
 
     pub fn set_resource_callback(&mut self, cb: blitz_traits::net::SharedCallback<Resource>) { self.resource_callback = Some(cb); }
@@ -226,13 +437,15 @@ impl BlitzHost {
                     if let Some(host) = self.host.as_mut() {
                         match result {
                             Ok(res) => {
-                                debug_log(&format!("resource_callback: doc_id={} kind={}", doc_id, resource_kind_name(&res)));
+                                debug_log!("resource_callback: doc_id={} kind={}", doc_id, resource_kind_name(&res));
                                 host.doc.load_resource(res);
-                                host.needs_render = true;
-                                host.render_once();
+                                // With a frame scheduler, coalesce resource arrivals into the next vsync frame;
+                                // otherwise keep the legacy eager render.
+                                host.request_frame();
+                                if host.frame_scheduler.is_none() && !host.render_worker_active { host.render_once(); }
                             }
                             Err(err) => {
-                                debug_log(&format!("resource_callback: doc_id={} ERROR={:?}", doc_id, err));
+                                debug_log!("resource_callback: doc_id={} ERROR={:?}", doc_id, err);
                             }
                         }
                     }
@@ -241,7 +454,7 @@ impl BlitzHost {
         }
         let cb: blitz_traits::net::SharedCallback<Resource> = Arc::new(HostCallback { host: self as *mut _ });
         self.resource_callback = Some(cb);
-        debug_log("ensure_default_resource_callback: installed default resource callback");
+        debug_log!("ensure_default_resource_callback: installed default resource callback");
     }
     
     // Method to get a reference to the attacher
@@ -249,94 +462,433 @@ impl BlitzHost {
         self.attacher.clone()
     }
 
+    // Associate a WinRT IFrameScheduler implementation (None detaches and reverts to caller-driven RenderOnce).
+    pub fn set_frame_scheduler(&mut self, scheduler: Option<IInspectable>) {
+        self.frame_scheduler = scheduler.and_then(|s| match s.cast::<IFrameScheduler>() {
+            Ok(fs) => Some(fs),
+            Err(e) => { debug_log!("set_frame_scheduler: object does not implement IFrameScheduler: {:?}", e); None }
+        });
+        self.frame_requested = false;
+        self.install_image_waker();
+        debug_log!("set_frame_scheduler: scheduler {}", if self.frame_scheduler.is_some() { "installed" } else { "cleared" });
+        // Pick up anything that was invalidated before the scheduler existed.
+        if self.needs_render || self.attach_pending { self.request_frame(); }
+    }
+
+    // Mark the document dirty and, on the idle -> dirty transition, ask the host side for a frame.
+    pub(crate) fn request_frame(&mut self) {
+        self.needs_render = true;
+        if self.render_worker_active || self.frame_requested { return; }
+        if let Some(s) = &self.frame_scheduler {
+            self.frame_requested = true;
+            if let Err(e) = s.RequestFrame() {
+                debug_log!("request_frame: RequestFrame failed: {:?}", e);
+                self.frame_requested = false;
+            }
+        }
+    }
+
+    // Vsync entry point for the demand-driven loop. Renders only if something is pending and reports whether
+    // the caller should keep ticking. Returning false re-arms request_frame for the next invalidation.
+    pub fn render_pending_frame(&mut self) -> bool {
+        if self.needs_render || self.attach_pending || self.has_pending_images() {
+            self.render_once();
+        } else {
+            self.skipped_frames += 1;
+        }
+        // Placeholder frames never clear needs_render; only real content keeps the loop alive.
+        let more = (self.content_loaded && self.needs_render) || self.attach_pending || self.doc.is_animating() || self.has_pending_images();
+        if more {
+            self.needs_render = true;
+        } else {
+            self.frame_requested = false;
+        }
+        more
+    }
+
+    pub fn skipped_frame_count(&self) -> u64 { self.skipped_frames }
+
+    // Size of the painted surface in logical px: the viewport, plus the overscan bands in compositor-scroll mode.
+    fn surface_logical_size(&self) -> (u32, u32) {
+        let (w, h) = self.doc.viewport().window_size;
+        let extra = self.compositor_scroll.as_ref().map_or(0, |cs| (cs.overscan * 2.0) as u32);
+        (w.max(1), h.max(1) + extra)
+    }
+
+    fn surface_physical_size(&self) -> (u32, u32) {
+        let (w, h) = self.surface_logical_size();
+        let phys_w = ((w as f32) * self.device_scale).round().max(1.0) as u32;
+        let phys_h = ((h as f32) * self.device_scale).round().max(1.0) as u32;
+        (phys_w, phys_h)
+    }
+
+    // Enable (overscan > 0, logical px above and below the viewport) or disable compositor-driven scrolling.
+    pub fn set_compositor_scrolling(&mut self, overscan: u32) {
+        if self.compositor_scroll.as_ref().map_or(0, |cs| cs.overscan as u32) == overscan { return; }
+        self.compositor_scroll = (overscan > 0).then(|| CompositorScroll {
+            overscan: overscan as f64,
+            raster_x: f64::NAN, // place the raster on the next frame
+            raster_top: 0.0,
+        });
+        self.scroll_translation.store(0f64.to_bits(), Ordering::Release);
+        debug_log!("set_compositor_scrolling: overscan={}", overscan);
+        // Reallocate the swapchain at the new surface size
+        let (w, h) = self.doc.viewport().window_size;
+        self.resize(w, h, self.device_scale);
+    }
+
+    pub fn scroll_translation_handle(&self) -> Arc<AtomicU64> { self.scroll_translation.clone() }
+
+    // Keep the raster covering the viewport; moving it changes the scroll seen by damage tracking, so the next
+    // frame repaints the whole surface.
+    fn place_raster(&mut self) {
+        let scroll = self.doc.viewport_scroll();
+        let Some(cs) = self.compositor_scroll.as_mut() else { return; };
+        if scroll.x != cs.raster_x || !cs.covers(scroll.y) {
+            cs.raster_x = scroll.x;
+            cs.raster_top = (scroll.y - cs.overscan).max(0.0);
+        }
+    }
+
+    // Damage tracking and painting see the raster origin (tiled rendering: the document origin, tiles are
+    // positioned at composite time); hit testing keeps the real scroll (restored by leave_raster_scroll).
+    fn enter_raster_scroll(&mut self) {
+        let mut scroll = self.doc.viewport_scroll();
+        let (x, y) = if self.renderer.is_tiled() {
+            (0.0, 0.0)
+        } else if let Some(cs) = self.compositor_scroll.as_ref() {
+            (cs.raster_x, cs.raster_top)
+        } else {
+            return;
+        };
+        self.saved_scroll = Some((scroll.x, scroll.y));
+        scroll.x = x;
+        scroll.y = y;
+        self.doc.set_viewport_scroll(scroll);
+    }
+
+    fn leave_raster_scroll(&mut self) {
+        let Some((x, y)) = self.saved_scroll.take() else { return; };
+        let mut scroll = self.doc.viewport_scroll();
+        scroll.x = x;
+        scroll.y = y;
+        self.doc.set_viewport_scroll(scroll);
+    }
+
+    // Document position shown at the surface's top-left corner (CSS px)
+    fn raster_origin(&self) -> (f64, f64) {
+        match self.compositor_scroll.as_ref() {
+            Some(cs) => (if cs.raster_x.is_nan() { 0.0 } else { cs.raster_x }, cs.raster_top),
+            None => {
+                let scroll = self.doc.viewport_scroll();
+                (scroll.x, scroll.y)
+            }
+        }
+    }
+
+    // Area damage tracking and painting cover (CSS px): the surface, or when tiled the whole document
+    fn paint_area(&self) -> (f64, f64) {
+        let (w, h) = self.surface_logical_size();
+        if !self.renderer.is_tiled() { return (w as f64, h as f64); }
+        let size = self.doc.root_element().final_layout.size;
+        ((w as f64).max(size.width as f64), (h as f64).max(size.height as f64))
+    }
+
+    pub fn set_tiled_rendering(&mut self, enabled: bool) {
+        if self.renderer.is_tiled() == enabled { return; }
+        self.renderer.set_tiled(enabled);
+        // Damage switches between surface and document coordinates
+        self.doc.invalidate_paint();
+        debug_log!("SetTiledRendering: enabled={}", enabled);
+        self.request_frame();
+    }
+
+    // Cap on the renderer's cached GPU resources (bytes); least recently used ones are evicted past it.
+    pub fn set_memory_budget(&mut self, bytes: u64) {
+        self.renderer.set_memory_budget(bytes.min(usize::MAX as u64) as usize);
+        debug_log!("SetMemoryBudget: {} MB", bytes / (1024 * 1024));
+    }
+
+    // Drop all cached GPU resources (app hidden / suspended / low memory); they are recreated as frames need them.
+    pub fn trim(&mut self) {
+        self.renderer.trim();
+    }
+
+    // Bytes held by this Host's renderer caches and the number of nodes in its document, for GetHostStats
+    pub(crate) fn resource_stats(&self) -> (u64, u32) {
+        (self.renderer.memory_usage() as u64, self.doc.tree().len() as u32)
+    }
+
+    // Publish how far the view must translate the panel. Clamped to the raster so a scroll that outran it shows
+    // the raster edge (not empty space) until the re-placed raster is presented.
+    fn publish_scroll_translation(&self) {
+        let Some(cs) = self.compositor_scroll.as_ref() else { return; };
+        let offset = (self.doc.viewport_scroll().y - cs.raster_top).clamp(0.0, cs.overscan * 2.0);
+        self.scroll_translation.store(offset.to_bits(), Ordering::Release);
+    }
+
+    // The shared device was lost (here or in another Host): make sure a frame comes so render_once can rebuild.
+    pub fn wake_for_device_lost(&mut self) {
+        self.request_frame();
+    }
+
+    // Rebuild everything tied to a removed device: the renderer drops its D2D device and resources, and a new
+    // swapchain is created on the replacement shared device and handed to the panel through the Attacher again.
+    fn recover_device(&mut self) {
+        debug_log!("recover_device: device generation {} -> {}", self.device_generation, crate::global_gfx::device_generation());
+        self.renderer.release_device();
+        self.d3d_device = None;
+        self.d3d_context = None;
+        self.replace_swapchain();
+    }
+
+    // Drop the current swapchain and attach a freshly created one (device change, alpha mode change), then
+    // repaint everything into it.
+    fn replace_swapchain(&mut self) {
+        self.renderer.release_backbuffer_resources();
+        self.swapchain = None;
+        self.pending_swapchain = None;
+        *self.frame_latency.lock().unwrap() = None;
+        self.attach_pending = false;
+        self.placeholder_drawn = false;
+        self.doc.invalidate_paint();
+        self.needs_render = true;
+        self.create_and_attach_swapchain();
+    }
+
+    // Transparent hosts use a premultiplied-alpha swapchain and leave whatever the document doesn't paint
+    // transparent, so XAML content behind the panel shows through without an extra composition layer.
+    // Switching recreates the swapchain (the alpha mode is fixed at creation).
+    pub fn set_transparent(&mut self, enabled: bool) {
+        if self.transparent == enabled { return; }
+        self.transparent = enabled;
+        debug_log!("set_transparent: {}", enabled);
+        if self.swapchain.is_some() || self.pending_swapchain.is_some() { self.replace_swapchain(); }
+    }
+
+    // Apply max_frame_latency to a new swapchain and take over its latency waitable object
+    fn install_frame_latency(&mut self, sc: &IDXGISwapChain1) {
+        let waiter = match sc.cast::<IDXGISwapChain2>() {
+            Ok(sc2) => unsafe {
+                if let Err(e) = sc2.SetMaximumFrameLatency(self.max_frame_latency) {
+                    debug_log!("install_frame_latency: SetMaximumFrameLatency({}) failed: {:?}", self.max_frame_latency, e);
+                }
+                let handle = sc2.GetFrameLatencyWaitableObject();
+                if handle.is_invalid() { None } else { Some(Arc::new(FrameLatencyWaiter::new(handle))) }
+            },
+            Err(e) => { debug_log!("install_frame_latency: IDXGISwapChain2 unavailable: {:?}", e); None }
+        };
+        if waiter.is_none() { debug_log!("install_frame_latency: no frame latency waitable object; frames are paced by Present only"); }
+        *self.frame_latency.lock().unwrap() = waiter;
+    }
+
+    // How many frames may queue for presentation (1 = lowest latency). Applies to the current swapchain now.
+    pub fn set_maximum_frame_latency(&mut self, frames: u32) {
+        self.max_frame_latency = frames.clamp(1, 16);
+        if let Some(sc2) = self.swapchain.as_ref().and_then(|sc| sc.cast::<IDXGISwapChain2>().ok()) {
+            if let Err(e) = unsafe { sc2.SetMaximumFrameLatency(self.max_frame_latency) } {
+                debug_log!("set_maximum_frame_latency: failed: {:?}", e);
+            }
+        }
+        debug_log!("set_maximum_frame_latency: {}", self.max_frame_latency);
+    }
+
+    // Shared with the render worker so it can wait for the swapchain without holding the host lock
+    pub(crate) fn frame_latency_handle(&self) -> Arc<Mutex<Option<Arc<FrameLatencyWaiter>>>> {
+        self.frame_latency.clone()
+    }
+
+    // Shared with HostRuntime and the render worker, which read stats and raise FrameCompleted outside the host lock
+    pub(crate) fn frame_stats_handle(&self) -> Arc<FrameStatsHub> {
+        self.frame_stats.clone()
+    }
+
+    fn wait_for_frame_latency(&self) {
+        let waiter = self.frame_latency.lock().unwrap().clone();
+        if let Some(w) = waiter { w.wait(); }
+    }
+
+    fn is_device_lost(hr: windows::core::HRESULT) -> bool {
+        hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET
+    }
+
+    // Waker the render worker hands us while it runs (None once it stops)
+    pub fn set_render_worker_waker(&mut self, waker: Option<Waker>) {
+        self.worker_waker = waker;
+        self.install_image_waker();
+    }
+
+    // Finished image decodes and uploads arrive on pool threads, which must never block on the host lock (a frame
+    // holding it may be waiting on the same pool). They wake the worker through its channel, or, rendering
+    // inline, ask the frame scheduler for a frame directly (RequestFrame hops to the UI thread itself); the frame
+    // then finds the work through has_pending_images.
+    fn install_image_waker(&mut self) {
+        let waker: Option<Waker> = match (&self.worker_waker, &self.frame_scheduler) {
+            (Some(w), _) => Some(w.clone()),
+            (None, Some(s)) => match windows::core::AgileReference::new(s) {
+                Ok(agile) => Some(Arc::new(move || {
+                    if let Ok(s) = agile.resolve() { let _ = s.RequestFrame(); }
+                })),
+                Err(e) => { debug_log!("install_image_waker: AgileReference failed: {:?}", e); None }
+            },
+            (None, None) => None,
+        };
+        self.image_decoder.set_waker(waker.clone());
+        self.renderer.set_image_waker(waker);
+    }
+
+    // Phases measured on this thread since the last presented frame, plus the renderer's and Present's timings
+    fn record_frame_stats(&self, frame_ms: f32, present_ms: f32) {
+        let mut timings = blitz_metrics::take_frame_phases();
+        timings.playback_ms = self.renderer.last_playback_ms();
+        timings.frame_total_ms = frame_ms;
+        self.frame_stats.push(&blitz_metrics::FrameRecord {
+            frame: 0,
+            timings,
+            command_count: self.renderer.last_command_count(),
+            present_ms,
+        });
+    }
+
+    // The frame left for the render worker to present, and the gate to hold while doing so
+    pub(crate) fn take_pending_present(&mut self) -> Option<(PendingPresent, Arc<Mutex<()>>)> {
+        self.pending_present.take().map(|p| (p, self.present_gate.clone()))
+    }
+
+    // Wait until a Present the worker started outside the host lock has returned. Called under the host lock,
+    // which the worker needs before it can start another one.
+    fn wait_for_present(&mut self) {
+        drop(self.present_gate.lock().unwrap());
+        // The worker stopped between recording a frame and taking it
+        if let Some(pending) = self.pending_present.take() {
+            let presented = pending.present();
+            self.finish_present(presented);
+        }
+    }
+
+    // Bookkeeping after Present, back under the host lock. Returns true when another frame is needed.
+    pub(crate) fn finish_present(&mut self, presented: Presented) -> bool {
+        let mut device_lost = presented.device_lost;
+        if presented.hr.is_ok() {
+            if let Some(w) = self.frame_latency.lock().unwrap().as_ref() { w.presented(); }
+            self.record_frame_stats(presented.frame_ms, presented.present_ms);
+            self.publish_scroll_translation();
+        } else {
+            debug_log!("render_once: Failed to present swapchain: {:?}", presented.hr);
+            device_lost |= Self::is_device_lost(presented.hr);
+            // The backbuffer may not hold what we think it does; redraw everything next time
+            self.renderer.invalidate();
+            self.doc.invalidate_paint();
+            self.needs_render = true;
+        }
+        if device_lost {
+            // Replace the shared device (other Hosts are woken to rebuild too), then rebuild ours right away
+            crate::global_gfx::report_device_lost(self.device_generation);
+            self.recover_device();
+        }
+        self.needs_render
+    }
+
+    // Decoded images waiting to be loaded, or prepared ones waiting to replace their placeholders
+    fn has_pending_images(&self) -> bool {
+        self.image_decoder.has_decoded() || self.renderer.has_pending_images()
+    }
+
+    pub fn set_render_worker_active(&mut self, active: bool) {
+        self.render_worker_active = active;
+        self.frame_requested = false;
+        debug_log!("set_render_worker_active: {} (creator_thread={})", active, crate::global_gfx::is_creator_thread());
+        // Handing back to the UI loop: make sure a pending frame is not lost.
+        if !active && self.needs_render { self.request_frame(); }
+    }
+
     // Temporary mutable access for instrumentation augmentation; keep internal
     fn renderer_mut(&mut self) -> Option<&mut anyrender_d2d::D2DWindowRenderer> { Some(&mut self.renderer) }
 
     pub fn set_verbose_logging(&mut self, enabled: bool) {
         anyrender_d2d::set_verbose_logging(enabled);
-        debug_log(&format!("SetVerboseLogging: enabled={}", enabled));
+        trace::set_verbose(enabled);
+        debug_log!("SetVerboseLogging: enabled={}", enabled);
     }
 
     pub fn set_debug_overlay(&mut self, enabled: bool) {
         if let Some(r) = self.renderer_mut() { r.set_debug_overlay(enabled); }
-        debug_log(&format!("SetDebugOverlay: enabled={}", enabled));
+        debug_log!("SetDebugOverlay: enabled={}", enabled);
     }
 
     // SwapChainPanel interop: detect if the provided Object is an attacher callback; if so, store it and, if possible, create and attach swapchain now.
     pub fn set_panel(&mut self, panel: windows_core::Ref<'_, IInspectable>, _width: u32, _height: u32) {
         // Try casting to our attacher interface
         if let Some(insp) = panel.as_ref() {
-        debug_log(&format!("set_panel: received panel object: {:?}", insp));
+        debug_log!("set_panel: received panel object: {:?}", insp);
             match insp.cast::<ISwapChainAttacher>() {
                 Ok(att) => {
-            debug_log("set_panel: successfully cast to ISwapChainAttacher");
+            debug_log!("set_panel: successfully cast to ISwapChainAttacher");
                     self.attacher = Some(att);
                     // Always create and attach the swapchain when we get an attacher
                     self.create_and_attach_swapchain();
                 }
                 Err(e) => {
-            debug_log(&format!("set_panel: failed to cast to ISwapChainAttacher: {:?}", e));
+            debug_log!("set_panel: failed to cast to ISwapChainAttacher: {:?}", e);
                 }
             }
         } else {
-        debug_log("set_panel: no panel object received");
+        debug_log!("set_panel: no panel object received");
         }
     }
 
     fn create_and_attach_swapchain(&mut self) {
-        debug_log("create_and_attach_swapchain: entering (async queued mode)");
+        debug_log!("create_and_attach_swapchain: entering (async queued mode)");
         let host_t0 = std::time::Instant::now();
         self.host_init_start = Some(host_t0);
     let t_phase = host_t0; // phase timing reused only for initial D3D creation measurement
         // Need an attacher to complete the hookup
         let attacher = match &self.attacher { 
             Some(a) => {
-                debug_log("create_and_attach_swapchain: attacher found");
+                debug_log!("create_and_attach_swapchain: attacher found");
                 a.clone()
             }, 
             None => {
-                debug_log("create_and_attach_swapchain: no attacher available");
+                debug_log!("create_and_attach_swapchain: no attacher available");
                 return;
             } 
         };
         
         // First test the connection without a real pointer
-        debug_log("create_and_attach_swapchain: Testing attacher connection...");
+        debug_log!("create_and_attach_swapchain: Testing attacher connection...");
         match attacher.TestAttacherConnection() {
-            Ok(true) => debug_log("create_and_attach_swapchain: TestAttacherConnection succeeded"),
-            Ok(false) => debug_log("create_and_attach_swapchain: TestAttacherConnection returned false"),
-            Err(e) => debug_log(&format!("create_and_attach_swapchain: TestAttacherConnection failed: {:?}", e)),
+            Ok(true) => debug_log!("create_and_attach_swapchain: TestAttacherConnection succeeded"),
+            Ok(false) => debug_log!("create_and_attach_swapchain: TestAttacherConnection returned false"),
+            Err(e) => debug_log!("create_and_attach_swapchain: TestAttacherConnection failed: {:?}", e),
         }
         
         // Use current viewport size
-    let (logical_w, logical_h) = self.doc.viewport().window_size;
-    let logical_w = logical_w.max(1);
-    let logical_h = logical_h.max(1);
-    let phys_w = ((logical_w as f32) * self.device_scale).round().max(1.0) as u32;
-    let phys_h = ((logical_h as f32) * self.device_scale).round().max(1.0) as u32;
-    debug_log(&format!("create_and_attach_swapchain: logical {}x{} device_scale {:.3} -> physical {}x{}", logical_w, logical_h, self.device_scale, phys_w, phys_h));
+    let (logical_w, logical_h) = self.surface_logical_size();
+    let (phys_w, phys_h) = self.surface_physical_size();
+    debug_log!("create_and_attach_swapchain: logical {}x{} device_scale {:.3} -> physical {}x{}", logical_w, logical_h, self.device_scale, phys_w, phys_h);
         unsafe {
             let acquire = crate::global_gfx::get_or_create_d3d_device();
-            if acquire.is_none() { debug_log("create_and_attach_swapchain: failed to acquire global device"); return; }
+            if acquire.is_none() { debug_log!("create_and_attach_swapchain: failed to acquire global device"); return; }
             let acquire = acquire.unwrap();
             let device = acquire.device.clone();
             let context = acquire.context.clone();
+            self.device_generation = acquire.generation;
             if acquire.created {
                 let d3d_elapsed = t_phase.elapsed().as_secs_f32()*1000.0;
                 if let Some(r) = self.renderer_mut() { r.add_host_dxgi_d3d_ms(d3d_elapsed); }
-                debug_log(&format!("create_and_attach_swapchain: created shared D3D device (feature {:?}) d3d_ms={:.2}", acquire.feature_level, d3d_elapsed));
+                debug_log!("create_and_attach_swapchain: created shared D3D device (feature {:?}) d3d_ms={:.2}", acquire.feature_level, d3d_elapsed);
             } else {
-                debug_log(&format!("create_and_attach_swapchain: reused shared D3D device (feature {:?})", acquire.feature_level));
+                debug_log!("create_and_attach_swapchain: reused shared D3D device (feature {:?})", acquire.feature_level);
             }
 
             // Create swapchain for composition
             let factory: IDXGIFactory2 = match CreateDXGIFactory2::<IDXGIFactory2>(DXGI_CREATE_FACTORY_FLAGS(0)) {
                 Ok(f) => {
-                    debug_log("create_and_attach_swapchain: Created DXGI factory");
+                    debug_log!("create_and_attach_swapchain: Created DXGI factory");
                     f
                 },
                 Err(e) => {
-                    debug_log(&format!("create_and_attach_swapchain: CreateDXGIFactory2 failed: {:?}", e));
+                    debug_log!("create_and_attach_swapchain: CreateDXGIFactory2 failed: {:?}", e);
                     return;
                 },
             };
@@ -354,18 +906,24 @@ impl BlitzHost {
                 // With physical pixel sized buffers prefer NO scaling so each backbuffer pixel maps 1:1.
                     Scaling: windows::Win32::Graphics::Dxgi::DXGI_SCALING_STRETCH,
                 SwapEffect: DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL,
-                // Use IGNORE initially (opaque) to enable ClearType; fallbacks below may adjust.
-                AlphaMode: windows::Win32::Graphics::Dxgi::Common::DXGI_ALPHA_MODE_IGNORE,
-                Flags: 0,
+                // Opaque hosts use IGNORE, which also tells the compositor the whole surface is opaque (no blending
+                // with what's behind) and enables ClearType; transparent hosts need PREMULTIPLIED. Fallbacks below may adjust.
+                AlphaMode: if self.transparent {
+                    windows::Win32::Graphics::Dxgi::Common::DXGI_ALPHA_MODE_PREMULTIPLIED
+                } else {
+                    windows::Win32::Graphics::Dxgi::Common::DXGI_ALPHA_MODE_IGNORE
+                },
+                // Frame pacing: render_once waits on the latency object before sampling input (frame_pacing.rs)
+                Flags: DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT.0 as u32,
             };
-            debug_log(&format!(
+            debug_log!(
                 "create_and_attach_swapchain: Attempting swapchain ({}x{}, fmt={:?}, swap_effect={:?}, alpha={:?}, buffers={}, usage=0x{:X})",
                 desc.Width, desc.Height, desc.Format, desc.SwapEffect, desc.AlphaMode, desc.BufferCount, desc.BufferUsage.0
-            ));
+            );
             let mut sc_attempt: Option<IDXGISwapChain1> = match factory.CreateSwapChainForComposition(&device, &desc, None) {
                 Ok(s) => Some(s),
                 Err(e) => {
-                    debug_log(&format!("create_and_attach_swapchain: initial CreateSwapChainForComposition failed: {:?}", e));
+                    debug_log!("create_and_attach_swapchain: initial CreateSwapChainForComposition failed: {:?}", e);
                     None
                 }
             };
@@ -373,45 +931,50 @@ impl BlitzHost {
             if sc_attempt.is_none() {
                 // Fallback 1: straight alpha
                 desc.AlphaMode = windows::Win32::Graphics::Dxgi::Common::DXGI_ALPHA_MODE_STRAIGHT;
-                debug_log(&format!("create_and_attach_swapchain: retry with STRAIGHT alpha (alpha={:?})", desc.AlphaMode));
+                debug_log!("create_and_attach_swapchain: retry with STRAIGHT alpha (alpha={:?})", desc.AlphaMode);
                 sc_attempt = match factory.CreateSwapChainForComposition(&device, &desc, None) {
                     Ok(s) => Some(s),
-                    Err(e) => { debug_log(&format!("fallback1 failed: {:?}", e)); None }
+                    Err(e) => { debug_log!("fallback1 failed: {:?}", e); None }
                 };
             }
             if sc_attempt.is_none() {
                 // Fallback 2: ignore alpha (opaque)
                 desc.AlphaMode = windows::Win32::Graphics::Dxgi::Common::DXGI_ALPHA_MODE_IGNORE;
-                debug_log(&format!("create_and_attach_swapchain: retry with IGNORE alpha (alpha={:?})", desc.AlphaMode));
+                debug_log!("create_and_attach_swapchain: retry with IGNORE alpha (alpha={:?})", desc.AlphaMode);
                 sc_attempt = match factory.CreateSwapChainForComposition(&device, &desc, None) {
                     Ok(s) => Some(s),
-                    Err(e) => { debug_log(&format!("fallback2 failed: {:?}", e)); None }
+                    Err(e) => { debug_log!("fallback2 failed: {:?}", e); None }
                 };
             }
             if sc_attempt.is_none() {
                 // Fallback 3: change swap effect to FLIP_DISCARD
                 desc.SwapEffect = windows::Win32::Graphics::Dxgi::DXGI_SWAP_EFFECT_FLIP_DISCARD;
                 desc.AlphaMode = windows::Win32::Graphics::Dxgi::Common::DXGI_ALPHA_MODE_PREMULTIPLIED; // reset to premultiplied
-                debug_log(&format!("create_and_attach_swapchain: retry with FLIP_DISCARD (swap_effect={:?}, alpha={:?})", desc.SwapEffect, desc.AlphaMode));
+                debug_log!("create_and_attach_swapchain: retry with FLIP_DISCARD (swap_effect={:?}, alpha={:?})", desc.SwapEffect, desc.AlphaMode);
                 sc_attempt = match factory.CreateSwapChainForComposition(&device, &desc, None) {
                     Ok(s) => Some(s),
-                    Err(e) => { debug_log(&format!("fallback3 failed: {:?}", e)); None }
+                    Err(e) => { debug_log!("fallback3 failed: {:?}", e); None }
                 };
             }
             let sc: IDXGISwapChain1 = match sc_attempt {
                 Some(s) => {
-                    debug_log("create_and_attach_swapchain: Created swap chain successfully (after possible fallbacks)");
-                    if let Ok(desc1) = s.GetDesc1() { debug_log(&format!("create_and_attach_swapchain: actual desc {}x{} fmt={:?} alpha={:?} buffers={} scaling={:?}", desc1.Width, desc1.Height, desc1.Format, desc1.AlphaMode, desc1.BufferCount, desc1.Scaling)); }
+                    debug_log!("create_and_attach_swapchain: Created swap chain successfully (after possible fallbacks)");
+                    if let Ok(desc1) = s.GetDesc1() { debug_log!("create_and_attach_swapchain: actual desc {}x{} fmt={:?} alpha={:?} buffers={} scaling={:?}", desc1.Width, desc1.Height, desc1.Format, desc1.AlphaMode, desc1.BufferCount, desc1.Scaling); }
+                    // Only a premultiplied swapchain can show through; otherwise keep drawing an opaque background
+                    let premultiplied = desc.AlphaMode == windows::Win32::Graphics::Dxgi::Common::DXGI_ALPHA_MODE_PREMULTIPLIED;
+                    if self.transparent && !premultiplied { debug_log!("create_and_attach_swapchain: transparent host fell back to an opaque swapchain"); }
+                    self.renderer.set_transparent(self.transparent && premultiplied);
                     s
                 },
                 None => {
-                    debug_log("create_and_attach_swapchain: All swapchain creation attempts failed");
+                    debug_log!("create_and_attach_swapchain: All swapchain creation attempts failed");
                     return;
                 }
             };
+            self.install_frame_latency(&sc);
             let sc_elapsed = t_phase.elapsed().as_secs_f32()*1000.0; // t_phase no longer reused
             if let Some(r) = self.renderer_mut() { r.add_host_swapchain_ms(sc_elapsed); }
-            debug_log(&format!("create_and_attach_swapchain: swapchain_ms={:.2}", sc_elapsed));
+            debug_log!("create_and_attach_swapchain: swapchain_ms={:.2}", sc_elapsed);
 
             // This is the critical part - getting the raw pointer correctly
             // 1. First clone to ensure we have a separate COM reference
@@ -419,11 +982,11 @@ impl BlitzHost {
             
             // 2. Get the raw pointer from the interface
             let raw_ptr = windows::core::Interface::as_raw(&sc_ptr);
-            debug_log(&format!("create_and_attach_swapchain: Raw COM pointer: {:?}", raw_ptr));
+            debug_log!("create_and_attach_swapchain: Raw COM pointer: {:?}", raw_ptr);
             
             // 3. Convert to u64 for passing through WinRT boundary
             let ptr_u64 = raw_ptr as usize as u64;
-            debug_log(&format!("create_and_attach_swapchain: Converted to u64: 0x{:X}", ptr_u64));
+            debug_log!("create_and_attach_swapchain: Converted to u64: 0x{:X}", ptr_u64);
             
             // Store device + context now (these are immediately usable for layout text metrics etc.)
             self.d3d_device = Some(device);
@@ -433,7 +996,7 @@ impl BlitzHost {
             // Mark attach as pending; actual AttachSwapChain will execute later (e.g. at next render/poll)
             self.attach_queue_start = Some(std::time::Instant::now());
             self.attach_pending = true;
-            debug_log("create_and_attach_swapchain: queued panel AttachSwapChain (executing immediately to minimize wait)");
+            debug_log!("create_and_attach_swapchain: queued panel AttachSwapChain (executing immediately to minimize wait)");
             // Execute immediately to keep queue_ms near-zero for better overlap accounting
             self.maybe_execute_queued_attach();
         }
@@ -446,8 +1009,8 @@ impl BlitzHost {
         // Safe to proceed now; measure queue_ms
         let queue_ms = self.attach_queue_start.map(|t| t.elapsed().as_secs_f32()*1000.0).unwrap_or(0.0);
         // Perform the real attach now
-        let Some(attacher) = self.attacher.clone() else { debug_log("maybe_execute_queued_attach: no attacher (aborting)" ); self.attach_pending = false; return; };
-        let Some(sc) = self.pending_swapchain.take() else { debug_log("maybe_execute_queued_attach: no pending swapchain" ); self.attach_pending = false; return; };
+        let Some(attacher) = self.attacher.clone() else { debug_log!("maybe_execute_queued_attach: no attacher (aborting)" ); self.attach_pending = false; return; };
+        let Some(sc) = self.pending_swapchain.take() else { debug_log!("maybe_execute_queued_attach: no pending swapchain" ); self.attach_pending = false; return; };
         // Recreate raw pointer for swapchain (COM pointer still valid)
         let raw_ptr = windows::core::Interface::as_raw(&sc) as usize as u64;
         let exec_start = std::time::Instant::now();
@@ -455,13 +1018,11 @@ impl BlitzHost {
         let exec_ms = exec_start.elapsed().as_secs_f32()*1000.0;
         if let Some(r) = self.renderer_mut() { r.add_host_panel_attach_queue_ms(queue_ms); r.add_host_panel_attach_exec_ms(exec_ms); }
         match result {
-            Ok(_) => debug_log(&format!("maybe_execute_queued_attach: AttachSwapChain succeeded queue_ms={:.2} exec_ms={:.2}", queue_ms, exec_ms)),
-            Err(e) => { debug_log(&format!("maybe_execute_queued_attach: AttachSwapChain failed queue_ms={:.2} exec_ms={:.2} err={:?}", queue_ms, exec_ms, e)); }
+            Ok(_) => debug_log!("maybe_execute_queued_attach: AttachSwapChain succeeded queue_ms={:.2} exec_ms={:.2}", queue_ms, exec_ms),
+            Err(e) => { debug_log!("maybe_execute_queued_attach: AttachSwapChain failed queue_ms={:.2} exec_ms={:.2} err={:?}", queue_ms, exec_ms, e); }
         }
         // Finalize swapchain into renderer
-    let (logical_w, logical_h) = self.doc.viewport().window_size;
-    let phys_w = ((logical_w as f32) * self.device_scale).round().max(1.0) as u32;
-    let phys_h = ((logical_h as f32) * self.device_scale).round().max(1.0) as u32;
+    let (phys_w, phys_h) = self.surface_physical_size();
     self.renderer.set_swapchain(sc.clone(), phys_w, phys_h);
         self.swapchain = Some(sc);
         // Accumulate host init total after full attach completes, excluding queue wait (we only want non-overlapped exec + prior setup)
@@ -494,6 +1055,7 @@ impl BlitzHost {
     pub fn set_swapchain(&mut self, swapchain_ptr: *mut core::ffi::c_void, width: u32, height: u32, scale: f32) {
         if scale > 0.0 { self.device_scale = scale; }
         if swapchain_ptr.is_null() { return; }
+        self.wait_for_present();
         unsafe {
             // Rebuild COM interface from raw pointer without transferring ownership (we take one ref).
             let sc: IDXGISwapChain1 = Interface::from_raw(swapchain_ptr);
@@ -502,63 +1064,122 @@ impl BlitzHost {
             // Update viewport and renderer size
             let viewport = Viewport::new(width, height, 1.0, ColorScheme::Light);
             self.doc.set_viewport(viewport);
-            let phys_w = ((width as f32) * self.device_scale).round().max(1.0) as u32;
-            let phys_h = ((height as f32) * self.device_scale).round().max(1.0) as u32;
+            let (phys_w, phys_h) = self.surface_physical_size();
             self.renderer.set_size(phys_w, phys_h);
             // Try an immediate resize to desired size in case buffers differ
             if let Some(sc) = &self.swapchain {
-                let _ = sc.ResizeBuffers(0, phys_w, phys_h, DXGI_FORMAT(28), windows::Win32::Graphics::Dxgi::DXGI_SWAP_CHAIN_FLAG(0));
+                let _ = sc.ResizeBuffers(0, phys_w, phys_h, DXGI_FORMAT(28), swapchain_flags(sc));
             }
         }
     }
 
+    // Only records the new size: the swapchain is resized and the document relaid out by the next frame, so a
+    // burst of Resize calls (a window edge being dragged) costs one ResizeBuffers and one resolve per frame, and
+    // the previous frame stays on screen meanwhile instead of a freshly discarded buffer.
     pub fn resize(&mut self, width: u32, height: u32, scale: f32) {
-        if scale > 0.0 { self.device_scale = scale; }
-        let viewport = Viewport::new(width, height, 1.0, ColorScheme::Light);
-        self.doc.set_viewport(viewport);
-        let phys_w = ((width as f32) * self.device_scale).round().max(1.0) as u32;
-        let phys_h = ((height as f32) * self.device_scale).round().max(1.0) as u32;
-        self.renderer.set_size(phys_w.max(1), phys_h.max(1));
-        if let Some(sc) = &self.swapchain {
+        // RasterizationScale reports jitter slightly; only a real change reallocates the buffers
+        if scale > 0.0 && (scale - self.device_scale).abs() > SCALE_TOLERANCE { self.device_scale = scale; }
+        // A new viewport restyles the whole document, so an unchanged size must not set one
+        if self.doc.viewport().window_size != (width, height) {
+            let viewport = Viewport::new(width, height, 1.0, ColorScheme::Light);
+            self.doc.set_viewport(viewport);
+        }
+        if self.swapchain.is_none() {
+            // Created (or attached) at the surface size later
+            let (phys_w, phys_h) = self.surface_physical_size();
+            self.renderer.set_size(phys_w, phys_h);
+        }
+        self.request_frame();
+    }
+
+    // Bring the swapchain buffers to the surface size at the start of a frame; no-op when they already match.
+    fn apply_surface_size(&mut self) {
+        let Some(sc) = self.swapchain.clone() else { return; };
+        let (phys_w, phys_h) = self.surface_physical_size();
+        if unsafe { sc.GetDesc1() }.is_ok_and(|d| (d.Width, d.Height) == (phys_w, phys_h)) { return; }
+        let (width, height) = self.doc.viewport().window_size;
+        self.renderer.set_size(phys_w, phys_h);
+        self.renderer.release_backbuffer_resources();
+        let mut hr = unsafe { sc.ResizeBuffers(0, phys_w, phys_h, DXGI_FORMAT(28), swapchain_flags(&sc)) };
+        if !hr.is_ok() {
+            debug_log!("resize: first ResizeBuffers attempt failed hr={:?} (phys {}x{} from logical {}x{} scale {:.3}); retrying", hr, phys_w, phys_h, width, height, self.device_scale);
             self.renderer.release_backbuffer_resources();
-            let mut hr = unsafe { sc.ResizeBuffers(0, phys_w, phys_h, DXGI_FORMAT(28), windows::Win32::Graphics::Dxgi::DXGI_SWAP_CHAIN_FLAG(0)) };
-            if !hr.is_ok() {
-                debug_log(&format!("resize: first ResizeBuffers attempt failed hr={:?} (phys {}x{} from logical {}x{} scale {:.3}); retrying", hr, phys_w, phys_h, width, height, self.device_scale));
-                self.renderer.release_backbuffer_resources();
-                hr = unsafe { sc.ResizeBuffers(0, phys_w, phys_h, DXGI_FORMAT(28), windows::Win32::Graphics::Dxgi::DXGI_SWAP_CHAIN_FLAG(0)) };
-            }
-            if hr.is_ok() { debug_log(&format!("resize: swapchain ResizeBuffers ok (phys {}x{} from logical {}x{} scale {:.3})", phys_w, phys_h, width, height, self.device_scale)); }
-            else { debug_log(&format!("resize: ResizeBuffers failed hr={:?} (phys {}x{} from logical {}x{} scale {:.3})", hr, phys_w, phys_h, width, height, self.device_scale)); }
+            hr = unsafe { sc.ResizeBuffers(0, phys_w, phys_h, DXGI_FORMAT(28), swapchain_flags(&sc)) };
         }
-        // Mark for redraw (layout may depend on viewport size)
-        self.needs_render = true;
-        // Eagerly render once to avoid blank gap after resize
-        if self.content_loaded { self.render_once(); }
+        if hr.is_ok() { debug_log!("resize: swapchain ResizeBuffers ok (phys {}x{} from logical {}x{} scale {:.3})", phys_w, phys_h, width, height, self.device_scale); }
+        else { debug_log!("resize: ResizeBuffers failed hr={:?} (phys {}x{} from logical {}x{} scale {:.3})", hr, phys_w, phys_h, width, height, self.device_scale); }
+        // The resized buffers hold nothing; a scale-only change leaves no layout damage behind
+        self.doc.invalidate_paint();
+        if !self.content_loaded { self.placeholder_drawn = false; }
     }
 
     pub fn render_once(&mut self) {
+        self.wait_for_present();
         // Execute pending attach if any first
         self.maybe_execute_queued_attach();
+        if self.swapchain.is_some() && self.device_generation != crate::global_gfx::device_generation() {
+            // Attaching the new swapchain renders the first frame on it
+            self.recover_device();
+            return;
+        }
+        if self.content_loaded && self.has_pending_images() { self.needs_render = true; }
         if !self.content_loaded && !self.needs_render { return; }
         if self.content_loaded && !self.needs_render { return; }
-        debug_log(&format!("render_once: begin (dirty={}, content_loaded={})", self.needs_render, self.content_loaded));
-    let (logical_w, logical_h) = self.doc.viewport().window_size;
+        self.apply_surface_size();
     let scale = self.doc.viewport().scale_f64(); // always 1.0 currently
-    let phys_w = ((logical_w as f32) * self.device_scale).round().max(1.0) as u32;
-    let phys_h = ((logical_h as f32) * self.device_scale).round().max(1.0) as u32;
-        if self.content_loaded { self.doc.resolve(); }
+    let (phys_w, phys_h) = self.surface_physical_size();
+        // Start the frame only once the swapchain has room for it, then sample input and resolve as late as
+        // possible (the worker has usually waited already, before taking the host lock)
+        if self.swapchain.is_some() { self.wait_for_frame_latency(); }
+        let frame_start = Instant::now();
+        self.flush_pending_input();
+        if self.content_loaded {
+            let _resolve = trace::Activity::start(trace::Phase::Resolve);
+            self.apply_cached_fetches();
+            self.apply_decoded_images();
+            self.doc.resolve();
+            // Background images are only discovered while flushing styles; apply any cache hits now rather
+            // than a frame later.
+            if self.apply_cached_fetches() { self.doc.resolve(); }
+        }
+        // What changed since the last painted frame (scene units). Nothing at all: keep the previous frame
+        // on screen and skip both painting and presenting.
+        let damage = if self.content_loaded {
+            self.place_raster();
+            self.enter_raster_scroll();
+            let (w, h) = self.paint_area();
+            let damage = self.doc.take_paint_damage_within(w, h);
+            self.leave_raster_scroll();
+            Some(damage)
+        } else { None };
+        // Tiled frames composite cached tiles at this origin (scene units); a new origin needs a frame even
+        // without damage
+        let tile_origin = { let (x, y) = self.raster_origin(); (x * scale, y * scale) };
+        let origin_unchanged = !self.renderer.is_tiled() || self.renderer.tiled_origin() == Some(tile_origin);
+        // Placeholders whose image finished preparing off-thread (already scene units)
+        let image_damage = if self.content_loaded { self.renderer.take_image_damage() } else { Vec::new() };
+        if self.swapchain.is_some() && !self.attach_pending && origin_unchanged && image_damage.is_empty() && damage.as_ref().is_some_and(|d| d.is_empty()) {
+            // Nothing presented: the resolve work doesn't belong to any recorded frame
+            blitz_metrics::take_frame_phases();
+            self.publish_scroll_translation();
+            self.needs_render = false;
+            return;
+        }
+        let damage_rects: Option<Vec<_>> = damage
+            .as_ref()
+            .and_then(|d| d.rects())
+            .map(|rects| rects.iter().map(|r| r.scale_from_origin(scale)).chain(image_damage.iter().copied()).collect());
 
         if self.swapchain.is_none() && self.attacher.is_some() {
-            debug_log("render_once: No swapchain yet; attempting lazy creation");
+            debug_log!("render_once: No swapchain yet; attempting lazy creation");
             self.create_and_attach_swapchain();
         }
 
     // Clone swapchain COM pointer out to avoid holding an immutable borrow of self during rendering
     if let Some(sc) = self.swapchain.clone() {
+            let mut device_lost = false;
             let mut want_enable_test_pattern = false;
             let mut want_disable_test_pattern = false;
-            if self.content_loaded { debug_log("render_once: Found swapchain, attempting to render"); }
-            else { debug_log("render_once: Found swapchain, rendering placeholder (no content yet)"); }
             unsafe {
         match sc.GetBuffer::<ID3D11Texture2D>(0) {
                     Ok(tex) => {
@@ -571,46 +1192,72 @@ impl BlitzHost {
                                 }
                             }
                         }
-                        if self.d3d_context.is_none() { debug_log("render_once: No D3D context available"); return; }
+                        if self.d3d_context.is_none() { debug_log!("render_once: No D3D context available"); self.doc.invalidate_paint(); return; }
                         let (w,h) = (phys_w.max(1), phys_h.max(1));
                         if self.content_loaded {
                             want_disable_test_pattern = true;
-                            self.renderer.render(|scene| paint_scene(scene, &self.doc, scale, w, h));
-                            debug_log(&format!("render_once: D2D command_count={} ({}x{})", self.renderer.last_command_count(), w, h));
+                            if self.renderer.is_tiled() {
+                                // Damage only drops tiles; the scene covers just the tiles still to rasterize
+                                let (vw, vh) = self.surface_logical_size();
+                                let (dw, dh) = self.paint_area();
+                                let (dw, dh) = ((dw * scale).ceil() as u32, (dh * scale).ceil() as u32);
+                                let tiles = self.renderer.plan_tiled_frame(tile_origin, (vw as f64 * scale, vh as f64 * scale), (dw as f64, dh as f64), damage_rects.as_deref());
+                                self.enter_raster_scroll();
+                                let doc = &self.doc;
+                                if tiles.is_empty() {
+                                    self.renderer.render(|_scene| { /* recomposite cached tiles */ });
+                                } else {
+                                    render_traced(&mut self.renderer, |scene| paint_scene_parallel(scene, doc, scale, dw, dh, Some(&tiles)));
+                                }
+                                self.leave_raster_scroll();
+                            } else {
+                                self.renderer.set_damage(damage_rects.as_deref());
+                                self.enter_raster_scroll();
+                                let doc = &self.doc;
+                                render_traced(&mut self.renderer, |scene| paint_scene_parallel(scene, doc, scale, w, h, damage_rects.as_deref()));
+                                self.leave_raster_scroll();
+                            }
                         } else if !self.placeholder_drawn {
                             want_enable_test_pattern = true;
+                            self.renderer.set_damage(None);
                             self.renderer.render(|_scene| { /* placeholder test pattern */ });
                             self.placeholder_drawn = true;
-                            debug_log("render_once: placeholder frame rendered (no content, test pattern)");
+                            debug_log!("render_once: placeholder frame rendered (no content, test pattern)");
                         }
                     },
-                    Err(e) => debug_log(&format!("render_once: Failed to get back buffer: {:?}", e)),
+                    Err(e) => {
+                        debug_log!("render_once: Failed to get back buffer: {:?}", e);
+                        device_lost |= Self::is_device_lost(e.code());
+                        self.doc.invalidate_paint();
+                    }
                 }
-                let sync_interval = if (!self.content_loaded && self.placeholder_drawn) || (self.content_loaded && self.placeholder_drawn) { 0 } else { 1 };
-                let hr = sc.Present(sync_interval, DXGI_PRESENT(0));
-                if hr.is_ok() { debug_log("render_once: presented"); } else { debug_log(&format!("render_once: Failed to present swapchain: {:?}", hr)); }
+                device_lost |= self.renderer.take_device_lost();
+            }
+    if !device_lost {
+        if want_enable_test_pattern { if let Some(r) = self.renderer_mut() { r.set_test_pattern(true); } }
+        if want_disable_test_pattern { if let Some(r) = self.renderer_mut() { r.set_test_pattern(false); } }
+        if self.content_loaded { self.needs_render = false; }
+    }
+    let pending = PendingPresent { swapchain: sc, dirty_rects: self.renderer.dirty_rects().map(<[_]>::to_vec), frame_start, device_lost };
+    if self.render_worker_active {
+        // The worker presents after releasing the host lock (take_pending_present)
+        self.pending_present = Some(pending);
+    } else {
+        let presented = pending.present();
+        self.finish_present(presented);
     }
-    if want_enable_test_pattern { if let Some(r) = self.renderer_mut() { r.set_test_pattern(true); } }
-    if want_disable_test_pattern { if let Some(r) = self.renderer_mut() { r.set_test_pattern(false); } }
-    if self.content_loaded { self.needs_render = false; }
     return;
     }
 
         // Fallback path (should not normally trigger in WinUI panel scenario)
         if self.content_loaded {
-            let (phys_w, phys_h) = {
-                let (lw, lh) = self.doc.viewport().window_size;
-                let pw = ((lw as f32) * self.device_scale).round().max(1.0) as u32;
-                let ph = ((lh as f32) * self.device_scale).round().max(1.0) as u32;
-                (pw, ph)
-            };
+            let (phys_w, phys_h) = self.surface_physical_size();
             self.renderer.render(|scene| paint_scene(scene, &self.doc, scale, phys_w, phys_h));
-            debug_log(&format!("render_once: D2D command_count={} (fallback path)", self.renderer.last_command_count()));
             self.needs_render = false;
         } else if !self.placeholder_drawn {
             self.renderer.render(|_scene| { /* placeholder fallback */ });
             self.placeholder_drawn = true;
-            debug_log("render_once: placeholder frame rendered (fallback path, no content)");
+            debug_log!("render_once: placeholder frame rendered (fallback path, no content)");
         }
     }
 
@@ -619,38 +1266,54 @@ impl BlitzHost {
         let swapchain_ready = self.swapchain.is_some();
         if swapchain_ready { self.renderer.restart_initial_measurement(); } else { self.pending_content_measurement = true; }
         // Build config with net provider if available so new document can issue resource fetches.
-    let mut cfg = DocumentConfig::default();
+    let mut cfg = DocumentConfig { font_ctx: Some(crate::prewarm::font_context()), lazy_images: true, ..Default::default() };
     if let Some(p) = &self.provider { cfg.net_provider = Some(p.clone() as _); }
+        // The old document's outstanding fetches would only complete into a document that no longer exists.
+        if let Some(p) = &self.provider { p.cancel_document(self.doc.id()); }
         let new_doc = HtmlDocument::from_html(html, cfg);
         let scroll = self.doc.viewport_scroll();
         let viewport = self.doc.viewport().clone();
         self.doc = Box::new(new_doc);
         self.doc.set_viewport(viewport);
         self.doc.set_viewport_scroll(scroll);
+        // Cached stylesheets/images discovered while parsing are applied before the first resolve
+        self.apply_cached_fetches();
         // Perform initial style/layout/shaping before first real frame so metrics capture them
         self.doc.resolve();
         if self.provider.is_some() { 
             // Defensive: if for some reason the eager ops didn\'t schedule, force rescan
             let (sheets, imgs) = self.doc.external_resource_summary();
-            debug_log(&format!("load_html: resource summary after parse sheets={} imgs={}", sheets, imgs));
+            debug_log!("load_html: resource summary after parse sheets={} imgs={} (deferred until near the viewport: {})", sheets, imgs, self.doc.deferred_image_count());
             if sheets > 0 || imgs > 0 { 
                 self.doc.rescan_external_resources();
-                debug_log("load_html: forced rescan_external_resources after parse");
+                debug_log!("load_html: forced rescan_external_resources after parse");
             }
         } else {
-            debug_log("load_html: no provider present at parse (will rely on later rescan)");
+            debug_log!("load_html: no provider present at parse (will rely on later rescan)");
         }
-        debug_log(&format!("load_html: new document length={} chars", html.len()));
+        debug_log!("load_html: new document length={} chars", html.len());
         self.content_loaded = true;
         if swapchain_ready {
             self.needs_render = true; // schedule first real paint now
             self.render_once();
         } else {
             // Will render automatically when swapchain attaches
-            debug_log("load_html: swapchain not yet ready; deferring initial measurement start until attach");
+            debug_log!("load_html: swapchain not yet ready; deferring initial measurement start until attach");
         }
     }
 
+    // Live update: patch the current DOM to match `html` instead of rebuilding the document, so styles,
+    // loaded images/stylesheets and fetches of unchanged subtrees are kept.
+    pub fn update_html(&mut self, html: &str) {
+        if !self.content_loaded { return self.load_html(html); }
+        let Some(doc) = self.doc.as_any_mut().downcast_mut::<HtmlDocument>() else { return self.load_html(html); };
+        let changes = doc.patch_html(html);
+        debug_log!("update_html: {} mutations ({} chars)", changes, html.len());
+        if changes == 0 { return; }
+        self.request_frame();
+        if self.frame_scheduler.is_none() && !self.render_worker_active { self.render_once(); }
+    }
+
     // Helper to quickly inject a test snippet that should trigger network fetches for image + stylesheet.
     pub fn load_test_network_snippet(&mut self) {
         let snippet = r#"<html><head>
@@ -658,10 +1321,27 @@ impl BlitzHost {
             </head><body>
             <img src=\"https://example.com/test.png\" style=\"width:100px;height:100px;\">
             </body></html>"#;
-        debug_log("load_test_network_snippet: loading test HTML");
+        debug_log!("load_test_network_snippet: loading test HTML");
         self.load_html(snippet);
     }
 
+    // Batched input: keep only the newest point; hit-testing/hover restyle run once per frame in flush_pending_input.
+    // Intermediate points are accepted for ABI completeness (pen / inking consumers) but the DOM only needs the last.
+    pub fn submit_input_batch(&mut self, points: &[f32], buttons: u32, mods: u32) {
+        let n = points.len() / 2;
+        if n == 0 { return; }
+        self.pending_pointer = Some(PendingPointerMove { x: points[2 * n - 2], y: points[2 * n - 1], buttons, mods });
+        self.request_frame();
+    }
+
+    // Apply queued coalesced input. Called before resolve() and before any discrete input (down/up/wheel/key)
+    // so event ordering is preserved.
+    fn flush_pending_input(&mut self) {
+        if let Some(p) = self.pending_pointer.take() {
+            self.pointer_move(p.x, p.y, p.buttons, p.mods);
+        }
+    }
+
     // Input bridging (to be called from C# event handlers)
     pub fn pointer_move(&mut self, x: f32, y: f32, buttons: u32, mods: u32) {
         use blitz_traits::events::{BlitzMouseButtonEvent, MouseEventButtons, UiEvent};
@@ -674,10 +1354,11 @@ impl BlitzHost {
             buttons,
             mods,
         }));
-    self.needs_render = true; // hover/scroll effects etc.
+    self.request_frame(); // hover/scroll effects etc.
     }
 
     pub fn pointer_down(&mut self, x: f32, y: f32, button: u8, buttons: u32, mods: u32) {
+        self.flush_pending_input();
         use blitz_traits::events::{BlitzMouseButtonEvent, MouseEventButton, MouseEventButtons, UiEvent};
         let btn = match button {
             0 => MouseEventButton::Main,
@@ -696,10 +1377,11 @@ impl BlitzHost {
             buttons,
             mods,
         }));
-    self.needs_render = true;
+    self.request_frame();
     }
 
     pub fn pointer_up(&mut self, x: f32, y: f32, button: u8, buttons: u32, mods: u32) {
+        self.flush_pending_input();
         use blitz_traits::events::{BlitzMouseButtonEvent, MouseEventButton, MouseEventButtons, UiEvent};
         let btn = match button {
             0 => MouseEventButton::Main,
@@ -718,19 +1400,24 @@ impl BlitzHost {
             buttons,
             mods,
         }));
-    self.needs_render = true;
+    self.request_frame();
     }
 
     pub fn wheel_scroll(&mut self, dx: f64, dy: f64) {
+        self.flush_pending_input();
         if let Some(hover_node_id) = self.doc.get_hover_node_id() {
             self.doc.scroll_node_by(hover_node_id, dx, dy);
         } else {
             self.doc.scroll_viewport_by(dx, dy);
         }
-    self.needs_render = true;
+        // Compositor scrolling: inside the raster the view just moves the panel, and the frame requested below
+        // finds no damage unless an inner scroller moved.
+        self.publish_scroll_translation();
+    self.request_frame();
     }
 
     pub fn key_down(&mut self, vk: u32, ch: u32, mods: u32, is_auto_repeating: bool) {
+        self.flush_pending_input();
         use blitz_traits::events::{BlitzKeyEvent, KeyState, UiEvent};
         let key = vk_or_char_to_key(vk, ch);
         let code = keyboard_types::Code::Unidentified;
@@ -748,10 +1435,11 @@ impl BlitzHost {
             text,
         };
     self.doc.handle_ui_event(UiEvent::KeyDown(evt));
-    self.needs_render = true;
+    self.request_frame();
     }
 
     pub fn key_up(&mut self, vk: u32, ch: u32, mods: u32) {
+        self.flush_pending_input();
         use blitz_traits::events::{BlitzKeyEvent, KeyState, UiEvent};
         let key = vk_or_char_to_key(vk, ch);
         let code = keyboard_types::Code::Unidentified;
@@ -769,11 +1457,12 @@ impl BlitzHost {
             text,
         };
     self.doc.handle_ui_event(UiEvent::KeyUp(evt));
-    self.needs_render = true;
+    self.request_frame();
     }
 
     // Receive sub-phase timing from C# attacher (kind codes: 1=UI add,2=SetSwapChain)
     pub fn report_attach_subphase(&mut self, kind: u8, ms: f32) {
+        trace::attach_sub_phase(kind, ms);
         if let Some(r) = self.renderer_mut() {
             match kind {
                 1 => r.add_host_panel_attach_sub_ui_add_ms(ms),
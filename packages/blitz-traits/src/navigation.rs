@@ -3,7 +3,7 @@
 use http::{HeaderMap, Method};
 use url::Url;
 
-use crate::net::{Body, Request};
+use crate::net::{Body, Destination, Priority, Request};
 
 /// An abstraction to allow embedders to hook into "navigation events" such as clicking a link
 /// or submitting a form.
@@ -62,6 +62,8 @@ impl NavigationOptions {
             content_type: self.content_type,
             headers: HeaderMap::new(),
             body: self.document_resource,
+            destination: Destination::Document,
+            priority: Priority::Auto,
         }
     }
 }
@@ -47,6 +47,8 @@ pub struct Request {
     pub content_type: String,
     pub headers: HeaderMap,
     pub body: Body,
+    pub destination: Destination,
+    pub priority: Priority,
 }
 impl Request {
     /// A get request to the specified Url and an empty body
@@ -57,8 +59,43 @@ impl Request {
             content_type: String::new(),
             headers: HeaderMap::new(),
             body: Body::Empty,
+            destination: Destination::Empty,
+            priority: Priority::Auto,
         }
     }
+
+    /// Tag the request with what it will be used for, so providers can prioritize it
+    pub fn with_destination(mut self, destination: Destination) -> Self {
+        self.destination = destination;
+        self
+    }
+
+    /// Hint how urgently the request is needed relative to others of the same destination
+    pub fn with_priority(mut self, priority: Priority) -> Self {
+        self.priority = priority;
+        self
+    }
+}
+
+/// A subset of <https://fetch.spec.whatwg.org/#concept-request-destination>
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum Destination {
+    #[default]
+    Empty,
+    Document,
+    Style,
+    Font,
+    Image,
+}
+
+/// A subset of <https://fetch.spec.whatwg.org/#request-priority>
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum Priority {
+    #[default]
+    Auto,
+    /// Can wait behind other requests, e.g. an image outside the viewport that is only being loaded ahead of
+    /// scrolling
+    Low,
 }
 
 #[derive(Debug, Clone)]